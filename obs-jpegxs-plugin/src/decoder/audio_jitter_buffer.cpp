@@ -0,0 +1,260 @@
+/*
+ * Audio Jitter Buffer Implementation
+ */
+
+#include "audio_jitter_buffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace jpegxs {
+
+// Jitter is the worst lateness over the current and previous window
+static const uint64_t JITTER_WINDOW_NS = 2000000000ULL;
+
+// Depth control. A 10 ms depth error corrects at 500 ppm; the integral
+// (the drift estimate) settles over about half a minute
+static const double DEPTH_FILTER_SECONDS = 1.0;
+static const double KP_PPM_PER_SECOND = 50000.0;
+static const double KI_PPM_PER_SECOND2 = KP_PPM_PER_SECOND / 30.0;
+static const double MAX_DRIFT_PPM = 1000.0;
+static const double MAX_CORRECTION_PPM = 2000.0;
+
+// Above target + max(target, this) the reader skips instead of resampling
+static const double MAX_EXCESS_SECONDS = 0.02;
+
+bool AudioJitterBuffer::configure(const Config &config)
+{
+    if (config.channels == 0 || config.channels > MAX_CHANNELS || config.sample_rate == 0 ||
+        config.pull_frames == 0 || config.max_depth_ms == 0 || config.min_depth_ms > config.max_depth_ms) {
+        return false;
+    }
+    config_ = config;
+
+    // Room for the deepest target twice over plus a pull and a late burst
+    uint64_t max_frames = (uint64_t)config.sample_rate * config.max_depth_ms / 1000;
+    uint64_t needed = 2 * max_frames + config.pull_frames + config.sample_rate / 100;
+    capacity_ = 1;
+    while (capacity_ < needed) capacity_ <<= 1;
+    mask_ = capacity_ - 1;
+
+    ring_.assign((size_t)capacity_ * config.channels, 0.0f);
+    output_.assign((size_t)config.pull_frames * config.channels, 0.0f);
+    silence_.assign(config.pull_frames, 0.0f);
+    pull_index_.assign(config.pull_frames, 0);
+    pull_frac_.assign(config.pull_frames, 0.0f);
+
+    memory_.set((ring_.capacity() + output_.capacity() + silence_.capacity() + pull_frac_.capacity()) * sizeof(float) +
+                pull_index_.capacity() * sizeof(uint32_t));
+
+    reset();
+    return true;
+}
+
+void AudioJitterBuffer::reset()
+{
+    state_ = State::IDLE;
+    idle_frames_ = 0;
+    window_start_ns_ = 0;
+    depth_frames_ = 0.0;
+    integral_ppm_ = 0.0;
+    ratio_ = 1.0;
+}
+
+void AudioJitterBuffer::anchor(int64_t position)
+{
+    std::fill(ring_.begin(), ring_.end(), 0.0f);
+    read_pos_ = position;
+    read_frac_ = 0.0;
+    write_head_ = position;
+    window_start_ns_ = 0;
+    state_ = State::BUFFERING;
+}
+
+void AudioJitterBuffer::clear(int64_t from, int64_t to)
+{
+    if (to - from >= (int64_t)capacity_) {
+        std::fill(ring_.begin(), ring_.end(), 0.0f);
+        return;
+    }
+    for (int64_t pos = from; pos < to;) {
+        uint32_t index = (uint32_t)pos & mask_;
+        uint32_t run = (uint32_t)std::min<int64_t>(to - pos, capacity_ - index);
+        for (uint32_t c = 0; c < config_.channels; c++) {
+            std::memset(&ring_[(size_t)c * capacity_ + index], 0, run * sizeof(float));
+        }
+        pos += run;
+    }
+}
+
+void AudioJitterBuffer::push(const float *const planes[], uint32_t frames, uint32_t rtp_timestamp, uint64_t arrival_ns)
+{
+    if (frames == 0 || ring_.empty()) return;
+
+    // Unwrap against the write head; the 2^32 offset keeps positions positive
+    if (state_ == State::IDLE) {
+        anchor((int64_t)rtp_timestamp + (1LL << 32));
+    }
+    int64_t start = write_head_ + (int32_t)(rtp_timestamp - (uint32_t)write_head_);
+    int64_t end = start + frames;
+
+    // Further ahead or behind than the ring spans: the sender restarted or jumped
+    if (end > read_pos_ + (int64_t)capacity_ || read_pos_ - end > (int64_t)capacity_) {
+        stats_.resyncs++;
+        anchor(start);
+    } else if (end <= read_pos_) {
+        stats_.late_packets++;
+        return;
+    }
+
+    int64_t from = std::max(start, read_pos_);
+    if (from > start) stats_.late_packets++;  // Partly played already
+    for (int64_t pos = from; pos < end;) {
+        uint32_t index = (uint32_t)pos & mask_;
+        uint32_t run = (uint32_t)std::min<int64_t>(end - pos, capacity_ - index);
+        for (uint32_t c = 0; c < config_.channels; c++) {
+            std::memcpy(&ring_[(size_t)c * capacity_ + index], planes[c] + (pos - start), run * sizeof(float));
+        }
+        pos += run;
+    }
+    write_head_ = std::max(write_head_, end);
+
+    idle_frames_ = 0;
+    packet_frames_ = frames;
+    update_jitter(start, arrival_ns);
+}
+
+void AudioJitterBuffer::update_jitter(int64_t position, uint64_t arrival_ns)
+{
+    if (window_start_ns_ == 0) {
+        first_position_ = position;
+        first_arrival_ns_ = arrival_ns;
+        window_start_ns_ = arrival_ns;
+        window_min_transit_ = previous_min_transit_ = 0.0;
+        window_max_late_ = previous_max_late_ = 0.0;
+    }
+
+    // Transit up to a constant: arrival time less the media time of the packet
+    double media_ns = (double)(position - first_position_) * 1e9 / config_.sample_rate;
+    double transit = (double)(int64_t)(arrival_ns - first_arrival_ns_) - media_ns;
+
+    if (arrival_ns - window_start_ns_ >= JITTER_WINDOW_NS) {
+        previous_min_transit_ = window_min_transit_;
+        previous_max_late_ = window_max_late_;
+        window_min_transit_ = transit;
+        window_max_late_ = 0.0;
+        window_start_ns_ = arrival_ns;
+    }
+    window_min_transit_ = std::min(window_min_transit_, transit);
+    double late = transit - std::min(window_min_transit_, previous_min_transit_);
+    window_max_late_ = std::max(window_max_late_, late);
+    stats_.jitter_ms = std::max(window_max_late_, previous_max_late_) / 1e6;
+}
+
+void AudioJitterBuffer::update_target()
+{
+    // Cover the worst recent lateness with a quarter to spare, plus the
+    // packet still arriving and the block being pulled
+    double rate = config_.sample_rate;
+    double jitter_frames = stats_.jitter_ms * rate / 1000.0;
+    double wanted = jitter_frames * 1.25 + packet_frames_ + config_.pull_frames;
+    double minimum = config_.min_depth_ms * rate / 1000.0;
+    double maximum = config_.max_depth_ms * rate / 1000.0;
+    target_frames_ = std::min(std::max(wanted, minimum), maximum);
+}
+
+bool AudioJitterBuffer::pull(const float *planes[])
+{
+    if (state_ == State::IDLE) return false;
+
+    // A second without packets: the stream has stopped
+    idle_frames_ += config_.pull_frames;
+    if (idle_frames_ >= config_.sample_rate) {
+        reset();
+        return false;
+    }
+
+    uint32_t frames = config_.pull_frames;
+    double rate = config_.sample_rate;
+    update_target();
+    double depth = (double)(write_head_ - read_pos_) - read_frac_;
+
+    if (state_ != State::PLAYING) {
+        if (depth < target_frames_) {
+            for (uint32_t c = 0; c < config_.channels; c++) planes[c] = silence_.data();
+            return state_ == State::REBUFFERING;
+        }
+        state_ = State::PLAYING;
+        depth_frames_ = depth;
+    }
+
+    // Far above target, as after a stall the target did not cover: drop
+    // straight back rather than resample for minutes
+    double excess_limit = target_frames_ + std::max(target_frames_, MAX_EXCESS_SECONDS * rate);
+    if (depth > excess_limit) {
+        int64_t skip = (int64_t)(depth - target_frames_);
+        clear(read_pos_, read_pos_ + skip);
+        read_pos_ += skip;
+        stats_.skipped_frames += (uint64_t)skip;
+        depth -= (double)skip;
+        depth_frames_ = depth;
+    }
+
+    // PI control on the filtered depth: consume faster when above target
+    double dt = frames / rate;
+    depth_frames_ += (depth - depth_frames_) * std::min(1.0, dt / DEPTH_FILTER_SECONDS);
+    double error = (depth_frames_ - target_frames_) / rate;
+    integral_ppm_ = std::min(std::max(integral_ppm_ + KI_PPM_PER_SECOND2 * error * dt, -MAX_DRIFT_PPM), MAX_DRIFT_PPM);
+    double ppm = std::min(std::max(KP_PPM_PER_SECOND * error + integral_ppm_, -MAX_CORRECTION_PPM), MAX_CORRECTION_PPM);
+    ratio_ = 1.0 + ppm * 1e-6;
+
+    // The last output frame interpolates up to one past its index
+    double last = read_frac_ + (frames - 1) * ratio_;
+    if (read_pos_ + (int64_t)last + 1 >= write_head_) {
+        stats_.underruns++;
+        state_ = State::REBUFFERING;
+        for (uint32_t c = 0; c < config_.channels; c++) planes[c] = silence_.data();
+        return true;
+    }
+
+    pull_timestamp_ = (uint32_t)read_pos_;
+    double pos = read_frac_;
+    for (uint32_t i = 0; i < frames; i++) {
+        uint32_t index = (uint32_t)pos;
+        pull_index_[i] = index;
+        pull_frac_[i] = (float)(pos - index);
+        pos += ratio_;
+    }
+    int64_t advance = (int64_t)pos;
+    read_frac_ = pos - (double)advance;
+
+    uint32_t base = (uint32_t)read_pos_;
+    for (uint32_t c = 0; c < config_.channels; c++) {
+        const float *ring = &ring_[(size_t)c * capacity_];
+        float *out = &output_[(size_t)c * frames];
+        for (uint32_t i = 0; i < frames; i++) {
+            uint32_t q = (base + pull_index_[i]) & mask_;
+            float a = ring[q];
+            float b = ring[(q + 1) & mask_];
+            out[i] = a + (b - a) * pull_frac_[i];
+        }
+        planes[c] = out;
+    }
+
+    // Played samples go back to silence, so a lost packet reads as zeros next time round
+    clear(read_pos_, read_pos_ + advance);
+    read_pos_ += advance;
+    return true;
+}
+
+AudioJitterBuffer::Stats AudioJitterBuffer::get_stats() const
+{
+    Stats stats = stats_;
+    double rate = config_.sample_rate;
+    stats.depth_ms = depth_frames_ * 1000.0 / rate;
+    stats.target_ms = target_frames_ * 1000.0 / rate;
+    stats.drift_ppm = integral_ppm_;
+    return stats;
+}
+
+} // namespace jpegxs
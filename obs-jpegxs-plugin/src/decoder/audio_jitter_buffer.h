@@ -0,0 +1,141 @@
+/*
+ * Audio Jitter Buffer
+ * Reorders received audio by RTP timestamp and plays it out at a steady depth
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../network/memory_accounting.h"
+
+namespace jpegxs {
+
+/**
+ * Audio Jitter Buffer
+ * Packets are written into a per-channel ring at the position their RTP
+ * timestamp names, so reordered packets land in place and lost ones play
+ * as silence. The reader pulls fixed-size blocks on the local clock.
+ *
+ * The target depth adapts to the arrival jitter seen over the last few
+ * seconds (never below the configured minimum). Sender and receiver
+ * clocks never run at exactly the same rate, so the reader consumes
+ * slightly faster or slower than it produces: a PI controller on the
+ * buffer depth sets that ratio, and its integral term is the drift
+ * estimate. The ratio is applied with linear interpolation, which is
+ * inaudible at the few hundred ppm involved. An underrun rebuffers to the
+ * target with silence; a buffer far above target skips ahead.
+ *
+ * Single-threaded: push() and pull() come from the audio thread.
+ */
+class AudioJitterBuffer {
+public:
+    static constexpr uint32_t MAX_CHANNELS = 16;
+
+    struct Config {
+        uint32_t channels = 2;
+        uint32_t sample_rate = 48000;
+        uint32_t min_depth_ms = 5;     // Floor for the adaptive target
+        uint32_t max_depth_ms = 250;   // Ceiling; also sizes the ring
+        uint32_t pull_frames = 48;     // Frames per pull()
+    };
+
+    AudioJitterBuffer() = default;
+
+    AudioJitterBuffer(const AudioJitterBuffer &) = delete;
+    AudioJitterBuffer &operator=(const AudioJitterBuffer &) = delete;
+
+    // Allocates the ring and output planes; drops anything buffered
+    bool configure(const Config &config);
+    const Config &config() const { return config_; }
+
+    // Forget the stream; the next packet starts buffering afresh
+    void reset();
+
+    // Store one packet's planar samples at their RTP position
+    void push(const float *const planes[], uint32_t frames, uint32_t rtp_timestamp, uint64_t arrival_ns);
+
+    /**
+     * Take config().pull_frames frames of output, valid until the next call
+     * @return false until the first fill completes (and again once the
+     *         stream has been silent for a second); while rebuffering after
+     *         an underrun the planes hold silence
+     */
+    bool pull(const float *planes[]);
+
+    // Whether the last pull() returned audio rather than silence or nothing
+    bool playing() const { return state_ == State::PLAYING; }
+
+    // RTP timestamp of the first frame the last audio-bearing pull() returned
+    uint32_t pull_timestamp() const { return pull_timestamp_; }
+
+    struct Stats {
+        double depth_ms = 0.0;      // Filtered buffer depth
+        double target_ms = 0.0;
+        double jitter_ms = 0.0;     // Peak arrival lateness, last few seconds
+        double drift_ppm = 0.0;     // Sender clock relative to ours (+ = sender faster)
+        uint64_t underruns = 0;
+        uint64_t late_packets = 0;  // Arrived after their samples were played
+        uint64_t skipped_frames = 0;
+        uint64_t resyncs = 0;       // Timestamp jumps the ring could not span
+    };
+
+    Stats get_stats() const;
+
+    // Bytes held by the ring and output planes (counted under MemoryComponent::DEPACKETIZER)
+    size_t get_memory_usage() const { return memory_.bytes(); }
+
+private:
+    enum class State {
+        IDLE,         // No stream
+        BUFFERING,    // First fill, nothing output yet
+        PLAYING,
+        REBUFFERING   // After an underrun, refilling behind silence
+    };
+
+    void anchor(int64_t position);
+    void update_jitter(int64_t position, uint64_t arrival_ns);
+    void update_target();
+    void clear(int64_t from, int64_t to);
+
+    Config config_;
+    uint32_t capacity_ = 0;   // Ring frames, a power of two
+    uint32_t mask_ = 0;
+    std::vector<float> ring_;     // channels x capacity_
+    std::vector<float> output_;   // channels x pull_frames
+    std::vector<float> silence_;
+    std::vector<uint32_t> pull_index_;
+    std::vector<float> pull_frac_;
+
+    State state_ = State::IDLE;
+    int64_t read_pos_ = 0;     // Unwrapped RTP position of the next frame played
+    double read_frac_ = 0.0;
+    int64_t write_head_ = 0;   // One past the newest frame received
+    uint32_t idle_frames_ = 0; // Pulled since the last packet
+    uint32_t pull_timestamp_ = 0;
+
+    // Jitter: transit time (arrival minus media time) against the fastest
+    // transit of the current and previous window
+    uint64_t window_start_ns_ = 0;
+    double window_min_transit_ = 0.0;
+    double previous_min_transit_ = 0.0;
+    double window_max_late_ = 0.0;
+    double previous_max_late_ = 0.0;
+    int64_t first_position_ = 0;
+    uint64_t first_arrival_ns_ = 0;
+    uint32_t packet_frames_ = 0;
+
+    // Depth control
+    double target_frames_ = 0.0;
+    double depth_frames_ = 0.0;   // Filtered
+    double integral_ppm_ = 0.0;
+    double ratio_ = 1.0;
+
+    Stats stats_;
+
+    MemoryAccounting::Tracker memory_{MemoryComponent::DEPACKETIZER};
+};
+
+} // namespace jpegxs
@@ -0,0 +1,259 @@
+/*
+ * Audio Receiver Implementation
+ */
+
+#include "audio_receiver.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define JPEGXS_AUDIO_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define JPEGXS_AUDIO_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#if defined(JPEGXS_AUDIO_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define JPEGXS_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define JPEGXS_TARGET(isa)
+#endif
+
+namespace jpegxs {
+
+namespace {
+
+// Largest datagram the receive loop reads
+const size_t MAX_PACKET_BYTES = 9216;
+
+const float L16_SCALE = 1.0f / 32768.0f;
+const float L24_SCALE = 1.0f / 2147483648.0f;  // Samples sit in the top 24 bits of an int32
+
+void convert_l16_scalar(const uint8_t *src, float *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int16_t sample = (int16_t)((src[2 * i] << 8) | src[2 * i + 1]);
+        dst[i] = sample * L16_SCALE;
+    }
+}
+
+void convert_l24_scalar(const uint8_t *src, float *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *p = src + 3 * i;
+        int32_t sample = (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8));
+        dst[i] = sample * L24_SCALE;
+    }
+}
+
+#ifdef JPEGXS_AUDIO_X86
+JPEGXS_TARGET("sse4.1")
+void convert_l16_sse41(const uint8_t *src, float *dst, size_t count)
+{
+    const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m128 scale = _mm_set1_ps(L16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 2 * i)), swap);
+        __m128i lo = _mm_cvtepi16_epi32(s);
+        __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(s, 8));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    convert_l16_scalar(src + 2 * i, dst + i, count - i);
+}
+
+JPEGXS_TARGET("sse4.1")
+void convert_l24_sse41(const uint8_t *src, float *dst, size_t count)
+{
+    // Four 3-byte samples into the top of four int32 lanes (low byte zero)
+    const __m128i spread = _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+    const __m128 scale = _mm_set1_ps(L24_SCALE);
+    size_t i = 0;
+    // Each load reads 16 bytes for 12, so stop while 4 spare bytes remain
+    for (; 3 * i + 16 <= 3 * count; i += 4) {
+        __m128i s = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 3 * i)), spread);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(s), scale));
+    }
+    convert_l24_scalar(src + 3 * i, dst + i, count - i);
+}
+#endif
+
+#ifdef JPEGXS_AUDIO_NEON
+void convert_l16_neon(const uint8_t *src, float *dst, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(L16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t s = vreinterpretq_s16_u8(vrev16q_u8(vld1q_u8(src + 2 * i)));
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), scale));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), scale));
+    }
+    convert_l16_scalar(src + 2 * i, dst + i, count - i);
+}
+
+void convert_l24_neon(const uint8_t *src, float *dst, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(L24_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Bytes of eight samples split by position: most significant first
+        uint8x8x3_t b = vld3_u8(src + 3 * i);
+        uint16x8_t high = vorrq_u16(vshll_n_u8(b.val[0], 8), vmovl_u8(b.val[1]));
+        uint16x8_t low = vshll_n_u8(b.val[2], 8);
+        int32x4_t s0 = vreinterpretq_s32_u32(vorrq_u32(vshll_n_u16(vget_low_u16(high), 16), vmovl_u16(vget_low_u16(low))));
+        int32x4_t s1 = vreinterpretq_s32_u32(vorrq_u32(vshll_n_u16(vget_high_u16(high), 16), vmovl_u16(vget_high_u16(low))));
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(s0), scale));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(s1), scale));
+    }
+    convert_l24_scalar(src + 3 * i, dst + i, count - i);
+}
+#endif
+
+AudioReceiver::ConvertFn select_convert(RepackIsa isa, int bit_depth)
+{
+    bool l24 = bit_depth == 24;
+    switch (isa) {
+#ifdef JPEGXS_AUDIO_X86
+    case RepackIsa::AVX512:
+    case RepackIsa::AVX2:
+    case RepackIsa::SSE41:
+        return l24 ? convert_l24_sse41 : convert_l16_sse41;
+#endif
+#ifdef JPEGXS_AUDIO_NEON
+    case RepackIsa::NEON:
+        return l24 ? convert_l24_neon : convert_l16_neon;
+#endif
+    default:
+        return l24 ? convert_l24_scalar : convert_l16_scalar;
+    }
+}
+
+// Interleaved floats to planes; fixed channel counts let the compiler unroll
+template <uint32_t Channels>
+void deinterleave_fixed(const float *src, float *const dst[], uint32_t frames)
+{
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t c = 0; c < Channels; c++) {
+            dst[c][f] = src[f * Channels + c];
+        }
+    }
+}
+
+void deinterleave(const float *src, float *const dst[], uint32_t channels, uint32_t frames)
+{
+    switch (channels) {
+    case 1: std::copy(src, src + frames, dst[0]); return;
+    case 2: deinterleave_fixed<2>(src, dst, frames); return;
+    case 4: deinterleave_fixed<4>(src, dst, frames); return;
+    case 6: deinterleave_fixed<6>(src, dst, frames); return;
+    case 8: deinterleave_fixed<8>(src, dst, frames); return;
+    case 16: deinterleave_fixed<16>(src, dst, frames); return;
+    default:
+        for (uint32_t f = 0; f < frames; f++) {
+            for (uint32_t c = 0; c < channels; c++) {
+                dst[c][f] = src[f * channels + c];
+            }
+        }
+    }
+}
+
+} // namespace
+
+AudioReceiver::AudioReceiver()
+    : isa_(PixelRepacker::detect_isa())
+{
+    configure(Format(), 1);
+}
+
+bool AudioReceiver::configure(const Format &format, uint32_t batch_ms)
+{
+    if ((format.bit_depth != 16 && format.bit_depth != 24) || format.channels == 0 ||
+        format.channels > MAX_CHANNELS || format.sample_rate == 0) {
+        return false;
+    }
+
+    format_ = format;
+    convert_ = select_convert(isa_, format.bit_depth);
+    batch_frames_ = std::max(1u, format.sample_rate * batch_ms / 1000);
+
+    // A batch can overshoot by one packet less a frame, and no packet is larger than a datagram
+    uint32_t frame_bytes = format.channels * (format.bit_depth / 8);
+    uint32_t packet_frames = (uint32_t)(MAX_PACKET_BYTES / frame_bytes);
+    capacity_frames_ = batch_frames_ + packet_frames;
+    interleaved_.assign((size_t)packet_frames * format.channels, 0.0f);
+    planar_.assign((size_t)capacity_frames_ * format.channels, 0.0f);
+
+    batch_ = Batch();
+    batch_.channels = format.channels;
+    for (uint32_t c = 0; c < format.channels; c++) {
+        batch_.planes[c] = planar_.data() + (size_t)c * capacity_frames_;
+    }
+    batch_done_ = false;
+
+    memory_.set((interleaved_.capacity() + planar_.capacity()) * sizeof(float));
+    return true;
+}
+
+bool AudioReceiver::push_packet(const uint8_t *data, size_t size, uint64_t arrival_ns)
+{
+    if (batch_done_) {
+        batch_.frames = 0;
+        batch_done_ = false;
+    }
+
+    // RTP header: 12 bytes, CSRCs, optional extension, optional padding
+    if (size < 12 || ((data[0] >> 6) & 0x03) != 2) {
+        stats_.malformed++;
+        return false;
+    }
+    size_t header_len = 12 + (size_t)(data[0] & 0x0F) * 4;
+    if ((data[0] & 0x10) && size >= header_len + 4) {
+        header_len += 4 + (size_t)((data[header_len + 2] << 8) | data[header_len + 3]) * 4;
+    } else if (data[0] & 0x10) {
+        header_len = size;
+    }
+    size_t end = size;
+    if (data[0] & 0x20) {
+        end -= std::min<size_t>(data[size - 1], size);
+    }
+    if (end <= header_len) {
+        stats_.malformed++;
+        return false;
+    }
+
+    const uint8_t *payload = data + header_len;
+    size_t payload_len = end - header_len;
+    size_t frame_bytes = (size_t)format_.channels * (format_.bit_depth / 8);
+    uint32_t frames = (uint32_t)(payload_len / frame_bytes);
+    if (frames == 0 || payload_len % frame_bytes != 0 || batch_.frames + frames > capacity_frames_) {
+        stats_.malformed++;
+        return false;
+    }
+
+    if (batch_.frames == 0) {
+        batch_.arrival_ns = arrival_ns;
+        batch_.rtp_timestamp = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) |
+                               ((uint32_t)data[6] << 8) | data[7];
+    }
+
+    convert_(payload, interleaved_.data(), (size_t)frames * format_.channels);
+    float *planes[MAX_CHANNELS];
+    for (uint32_t c = 0; c < format_.channels; c++) {
+        planes[c] = planar_.data() + (size_t)c * capacity_frames_ + batch_.frames;
+    }
+    deinterleave(interleaved_.data(), planes, format_.channels, frames);
+
+    batch_.frames += frames;
+    stats_.packets++;
+    stats_.frames += frames;
+
+    if (batch_.frames >= batch_frames_) {
+        batch_done_ = true;
+        stats_.batches++;
+        return true;
+    }
+    return false;
+}
+
+} // namespace jpegxs
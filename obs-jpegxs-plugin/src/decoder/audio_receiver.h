@@ -0,0 +1,104 @@
+/*
+ * Audio Receiver
+ * Turns AES67 / ST 2110-30 RTP packets into planar float for OBS
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../encoder/pixel_repack.h"
+#include "../network/memory_accounting.h"
+
+namespace jpegxs {
+
+/**
+ * Audio Receiver
+ * Converts big-endian L16/L24 payloads of 1-16 channels straight into
+ * preallocated planar float buffers and batches packets into larger pushes
+ * (1 ms packets would otherwise mean 1000 OBS pushes a second). Nothing is
+ * allocated per packet; the byte swap and int-to-float conversion run on
+ * SIMD kernels picked at runtime like PixelRepacker's.
+ */
+class AudioReceiver {
+public:
+    static constexpr uint32_t MAX_CHANNELS = 16;
+
+    struct Format {
+        int bit_depth = 16;            // 16 (L16) or 24 (L24)
+        uint32_t channels = 2;
+        uint32_t sample_rate = 48000;
+    };
+
+    // A batch of converted audio, valid until the next push_packet()
+    struct Batch {
+        const float *planes[MAX_CHANNELS] = {};
+        uint32_t channels = 0;
+        uint32_t frames = 0;
+        uint64_t arrival_ns = 0;      // Arrival of the batch's first packet
+        uint32_t rtp_timestamp = 0;   // RTP timestamp of its first sample
+    };
+
+    AudioReceiver();
+
+    AudioReceiver(const AudioReceiver &) = delete;
+    AudioReceiver &operator=(const AudioReceiver &) = delete;
+
+    /**
+     * @param batch_ms Audio gathered per push (packets are not split, so a
+     *                 batch holds at least one packet; 0 = every packet)
+     * @return false if the format is not supported
+     */
+    bool configure(const Format &format, uint32_t batch_ms);
+    const Format &format() const { return format_; }
+
+    // Most frames a batch can hold (a full batch plus the packet that overshot it)
+    uint32_t max_batch_frames() const { return capacity_frames_; }
+
+    /**
+     * Convert one RTP packet (header included) into the current batch
+     * @return true when the batch is full; read it with batch() before the next packet
+     */
+    bool push_packet(const uint8_t *data, size_t size, uint64_t arrival_ns);
+
+    // The pending (possibly partial) batch; emptied by the next push_packet()
+    const Batch &batch() const { return batch_; }
+
+    struct Stats {
+        uint64_t packets = 0;
+        uint64_t frames = 0;
+        uint64_t batches = 0;
+        uint64_t malformed = 0;   // Not RTP, or not a whole number of sample frames
+    };
+
+    Stats get_stats() const { return stats_; }
+
+    RepackIsa isa() const { return isa_; }
+
+    // Bytes held by the sample buffers (counted under MemoryComponent::DEPACKETIZER)
+    size_t get_memory_usage() const { return memory_.bytes(); }
+
+    // Big-endian PCM to float, interleaved order kept; count is in samples
+    using ConvertFn = void (*)(const uint8_t *src, float *dst, size_t count);
+
+private:
+    Format format_;
+    uint32_t batch_frames_ = 48;
+    uint32_t capacity_frames_ = 0;
+
+    RepackIsa isa_;
+    ConvertFn convert_ = nullptr;
+
+    std::vector<float> interleaved_;  // One packet, converted
+    std::vector<float> planar_;       // channels x capacity_frames_
+    Batch batch_;
+    bool batch_done_ = false;
+
+    Stats stats_;
+
+    MemoryAccounting::Tracker memory_{MemoryComponent::DEPACKETIZER};
+};
+
+} // namespace jpegxs
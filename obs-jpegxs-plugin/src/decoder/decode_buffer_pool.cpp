@@ -0,0 +1,163 @@
+/*
+ * Decode Buffer Pool Implementation
+ */
+
+#include "decode_buffer_pool.h"
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace jpegxs {
+
+static uint8_t *aligned_alloc_64(size_t size)
+{
+#ifdef _WIN32
+    return (uint8_t *)_aligned_malloc(size, 64);
+#else
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, 64, size) != 0) return nullptr;
+    return (uint8_t *)ptr;
+#endif
+}
+
+static void aligned_free_64(uint8_t *ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+DecodeBufferPool::DecodeBufferPool(size_t max_buffers)
+    : max_buffers_(max_buffers > 0 ? max_buffers : 1)
+{
+}
+
+DecodeBufferPool::~DecodeBufferPool()
+{
+    // In-flight buffers must have been released by now
+    for (DecodeBuffer *buffer : idle_) destroy(buffer);
+    memory_.set(0);
+}
+
+DecodeBuffer *DecodeBufferPool::allocate(uint32_t width, uint32_t height, int bit_depth, int format, bool semi_planar)
+{
+    DecodeBuffer *buffer = new DecodeBuffer;
+    buffer->width = width;
+    buffer->height = height;
+    buffer->bit_depth = bit_depth;
+    buffer->format = format;
+    buffer->semi_planar = semi_planar;
+
+    uint32_t bpp = (bit_depth > 8) ? 2 : 1;
+    uint32_t chroma_width = (format == 2 || format == 3) ? (width + 1) / 2 : width;
+    uint32_t chroma_height = (format == 2) ? (height + 1) / 2 : height;
+
+    for (int i = 0; i < 3; i++) {
+        buffer->linesize[i] = ((i == 0) ? width : chroma_width) * bpp;
+        buffer->plane_size[i] = (size_t)buffer->linesize[i] * ((i == 0) ? height : chroma_height);
+        buffer->planes[i] = aligned_alloc_64(buffer->plane_size[i]);
+        if (!buffer->planes[i]) {
+            destroy(buffer);
+            return nullptr;
+        }
+    }
+    
+    if (semi_planar) {
+        buffer->interleaved_linesize = buffer->linesize[1] * 2;
+        buffer->interleaved_size = buffer->plane_size[1] * 2;
+        buffer->interleaved = aligned_alloc_64(buffer->interleaved_size);
+        if (!buffer->interleaved) {
+            destroy(buffer);
+            return nullptr;
+        }
+    }
+    return buffer;
+}
+
+void DecodeBufferPool::destroy(DecodeBuffer *buffer)
+{
+    for (int i = 0; i < 3; i++) {
+        if (buffer->planes[i]) aligned_free_64(buffer->planes[i]);
+    }
+    if (buffer->interleaved) aligned_free_64(buffer->interleaved);
+    delete buffer;
+}
+
+size_t DecodeBufferPool::buffer_bytes(const DecodeBuffer *buffer)
+{
+    return buffer->plane_size[0] + buffer->plane_size[1] + buffer->plane_size[2] + buffer->interleaved_size;
+}
+
+bool DecodeBufferPool::matches(const DecodeBuffer *buffer, uint32_t width, uint32_t height, int bit_depth, int format,
+                               bool semi_planar) const
+{
+    return buffer->width == width && buffer->height == height &&
+           buffer->bit_depth == bit_depth && buffer->format == format &&
+           buffer->semi_planar == semi_planar;
+}
+
+DecodeBuffer *DecodeBufferPool::acquire(uint32_t width, uint32_t height, int bit_depth, int format, bool semi_planar)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (width != width_ || height != height_ || bit_depth != bit_depth_ || format != format_ ||
+        semi_planar != semi_planar_) {
+        for (DecodeBuffer *buffer : idle_) {
+            allocated_bytes_ -= buffer_bytes(buffer);
+            destroy(buffer);
+        }
+        idle_.clear();
+        memory_.set(allocated_bytes_);
+        width_ = width;
+        height_ = height;
+        bit_depth_ = bit_depth;
+        format_ = format;
+        semi_planar_ = semi_planar;
+    }
+
+    DecodeBuffer *buffer = nullptr;
+    if (!idle_.empty()) {
+        buffer = idle_.back();
+        idle_.pop_back();
+    } else if (in_flight_ < max_buffers_) {
+        buffer = allocate(width, height, bit_depth, format, semi_planar);
+        if (!buffer) return nullptr;
+        allocated_bytes_ += buffer_bytes(buffer);
+        memory_.set(allocated_bytes_);
+    } else {
+        return nullptr;
+    }
+
+    in_flight_++;
+    return buffer;
+}
+
+void DecodeBufferPool::release(DecodeBuffer *buffer)
+{
+    if (!buffer) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_flight_--;
+
+    if (matches(buffer, width_, height_, bit_depth_, format_, semi_planar_)) {
+        idle_.push_back(buffer);
+        return;
+    }
+
+    // Stale geometry: the stream changed while this picture was in flight
+    allocated_bytes_ -= buffer_bytes(buffer);
+    destroy(buffer);
+    memory_.set(allocated_bytes_);
+}
+
+size_t DecodeBufferPool::in_flight() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_flight_;
+}
+
+} // namespace jpegxs
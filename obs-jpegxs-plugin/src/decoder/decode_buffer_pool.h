@@ -0,0 +1,90 @@
+/*
+ * Decode Buffer Pool
+ * Recycled picture buffers the decoder writes into and OBS reads from
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "../network/memory_accounting.h"
+
+namespace jpegxs {
+
+/**
+ * One decoded picture: three 64-byte aligned planes, tightly strided
+ * (SVT-JPEG-XS's decoder ignores image.stride, so a row is exactly
+ * width samples). linesize is in bytes, as obs_source_frame expects.
+ */
+struct DecodeBuffer {
+    uint8_t *planes[3] = { nullptr, nullptr, nullptr };
+    uint32_t linesize[3] = { 0, 0, 0 };
+    size_t plane_size[3] = { 0, 0, 0 };
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int bit_depth = 8;
+    int format = 2; // ColourFormat_t
+    
+    // Semi-planar output: U and V interleaved here (two samples per chroma
+    // position, so twice linesize[1]); see SemiPlanarConverter
+    bool semi_planar = false;
+    uint8_t *interleaved = nullptr;
+    uint32_t interleaved_linesize = 0;
+    size_t interleaved_size = 0;
+};
+
+/**
+ * Decode Buffer Pool
+ * Hands out buffers for the current geometry and takes them back once the
+ * picture has been consumed, so steady-state decoding allocates nothing. A
+ * geometry change frees idle buffers immediately and in-flight ones when
+ * they are released.
+ */
+class DecodeBufferPool {
+public:
+    explicit DecodeBufferPool(size_t max_buffers = 3);
+    ~DecodeBufferPool();
+
+    DecodeBufferPool(const DecodeBufferPool &) = delete;
+    DecodeBufferPool &operator=(const DecodeBufferPool &) = delete;
+
+    /**
+     * @param format ColourFormat_t (2 = 4:2:0, 3 = 4:2:2, 4 = 4:4:4)
+     * @param semi_planar Also allocate the interleaved chroma plane
+     * @return nullptr if max_buffers are already in flight or allocation failed
+     */
+    DecodeBuffer *acquire(uint32_t width, uint32_t height, int bit_depth, int format, bool semi_planar = false);
+    void release(DecodeBuffer *buffer);
+
+    size_t in_flight() const;
+
+    // Bytes held in idle and in-flight buffers (counted under MemoryComponent::DECODER)
+    size_t get_memory_usage() const { return memory_.bytes(); }
+
+private:
+    static DecodeBuffer *allocate(uint32_t width, uint32_t height, int bit_depth, int format, bool semi_planar);
+    static void destroy(DecodeBuffer *buffer);
+    static size_t buffer_bytes(const DecodeBuffer *buffer);
+    bool matches(const DecodeBuffer *buffer, uint32_t width, uint32_t height, int bit_depth, int format,
+                 bool semi_planar) const;
+
+    size_t max_buffers_;
+    mutable std::mutex mutex_;
+    std::vector<DecodeBuffer *> idle_;
+    size_t in_flight_ = 0;
+    size_t allocated_bytes_ = 0;
+
+    // Geometry of the most recent acquire; released buffers that differ are freed
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    int bit_depth_ = 0;
+    int format_ = 0;
+    bool semi_planar_ = false;
+
+    MemoryAccounting::Tracker memory_{MemoryComponent::DECODER};
+};
+
+} // namespace jpegxs
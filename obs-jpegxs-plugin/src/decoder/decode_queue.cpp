@@ -0,0 +1,98 @@
+/*
+ * Decode Queue Implementation
+ */
+
+#include "decode_queue.h"
+
+namespace jpegxs {
+
+DecodeQueue::DecodeQueue(size_t depth)
+    : depth_(depth > 0 ? depth : 1)
+{
+}
+
+EncodedFrame *DecodeQueue::acquire()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    EncodedFrame *frame = nullptr;
+    if (!idle_.empty()) {
+        frame = idle_.back();
+        idle_.pop_back();
+    } else {
+        frames_.push_back(std::make_unique<EncodedFrame>());
+        frame = frames_.back().get();
+    }
+    frame->data.clear();
+    frame->slices.clear();
+    return frame;
+}
+
+void DecodeQueue::push(EncodedFrame *frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            idle_.push_back(frame);
+            return;
+        }
+
+        if (queued_.size() >= depth_) {
+            idle_.push_back(queued_.front());
+            queued_.pop_front();
+            stats_.skipped++;
+        }
+        queued_.push_back(frame);
+        stats_.queued++;
+        stats_.depth = queued_.size();
+        if (stats_.depth > stats_.max_depth) stats_.max_depth = stats_.depth;
+        update_memory_usage();
+    }
+    cv_.notify_one();
+}
+
+EncodedFrame *DecodeQueue::pop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return stopping_ || !queued_.empty(); });
+    if (stopping_) return nullptr;
+
+    EncodedFrame *frame = queued_.front();
+    queued_.pop_front();
+    stats_.depth = queued_.size();
+    return frame;
+}
+
+void DecodeQueue::recycle(EncodedFrame *frame)
+{
+    if (!frame) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.push_back(frame);
+}
+
+void DecodeQueue::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (EncodedFrame *frame : queued_) idle_.push_back(frame);
+        queued_.clear();
+        stats_.depth = 0;
+    }
+    cv_.notify_all();
+}
+
+DecodeQueue::Stats DecodeQueue::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void DecodeQueue::update_memory_usage()
+{
+    size_t bytes = 0;
+    for (const auto &frame : frames_) bytes += frame->data.capacity();
+    memory_.set(bytes);
+}
+
+} // namespace jpegxs
@@ -0,0 +1,81 @@
+/*
+ * Decode Queue
+ * Hands assembled codestreams from the receive thread to the decode thread
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../network/codestream_slices.h"
+#include "../network/memory_accounting.h"
+
+namespace jpegxs {
+
+// One assembled frame as it came off the wire
+struct EncodedFrame {
+    std::vector<uint8_t> data;
+    std::vector<SliceSpan> slices;  // From slice-mode senders, see RTPDepacketizer
+    uint32_t rtp_timestamp = 0;
+};
+
+/**
+ * Decode Queue
+ * Bounded and newest-wins: pushing onto a full queue recycles the oldest
+ * waiting frame, so the receive thread never blocks on a slow decode and
+ * the decoder always works on the most recent picture. Frames are recycled
+ * (at most depth + 2 exist: queued, being decoded, being filled), so their
+ * buffers keep their capacity and steady state allocates nothing.
+ */
+class DecodeQueue {
+public:
+    explicit DecodeQueue(size_t depth = 2);
+
+    DecodeQueue(const DecodeQueue &) = delete;
+    DecodeQueue &operator=(const DecodeQueue &) = delete;
+
+    // Receive side: an empty frame to fill, then queue it
+    EncodedFrame *acquire();
+    void push(EncodedFrame *frame);
+
+    // Decode side: blocks until a frame is queued; nullptr once stopped
+    EncodedFrame *pop();
+    void recycle(EncodedFrame *frame);
+
+    // Wakes pop() for good; queued frames are discarded
+    void stop();
+
+    struct Stats {
+        size_t depth = 0;        // Frames waiting right now
+        size_t max_depth = 0;    // Most frames seen waiting
+        uint64_t queued = 0;
+        uint64_t skipped = 0;    // Replaced by a newer frame before being decoded
+    };
+
+    Stats get_stats() const;
+
+    // Bytes held by all frames (counted under MemoryComponent::DEPACKETIZER)
+    size_t get_memory_usage() const { return memory_.bytes(); }
+
+private:
+    void update_memory_usage();
+
+    size_t depth_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<EncodedFrame>> frames_;  // Owns every frame
+    std::vector<EncodedFrame *> idle_;
+    std::deque<EncodedFrame *> queued_;
+    bool stopping_ = false;
+    Stats stats_;
+
+    MemoryAccounting::Tracker memory_{MemoryComponent::DEPACKETIZER};
+};
+
+} // namespace jpegxs
@@ -0,0 +1,129 @@
+/*
+ * Decode Thread Budget Implementation
+ */
+
+#include "decode_thread_budget.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jpegxs {
+
+static std::mutex g_mutex;
+static std::vector<DecodeThreadBudget::Share *> g_members;
+
+// Load changes smaller than this don't move threads around
+static const double LOAD_HYSTERESIS = 0.1;
+
+uint32_t DecodeThreadBudget::Share::join(uint32_t fixed_threads)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    fixed_ = fixed_threads;
+    if (!joined_) {
+        joined_ = true;
+        load_ = 0;
+        g_members.push_back(this);
+    }
+    rebalance();
+    changed_ = false;  // The caller sizes its decoders from the return value
+    return threads_;
+}
+
+void DecodeThreadBudget::Share::leave()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!joined_) return;
+    joined_ = false;
+    g_members.erase(std::remove(g_members.begin(), g_members.end(), this), g_members.end());
+    rebalance();
+}
+
+void DecodeThreadBudget::Share::set_load(uint64_t pixels_per_second)
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!joined_) return;
+    double previous = (double)load_;
+    double delta = (double)pixels_per_second - previous;
+    if (load_ != 0 && std::abs(delta) < previous * LOAD_HYSTERESIS) return;
+    load_ = pixels_per_second;
+    rebalance();
+}
+
+bool DecodeThreadBudget::Share::take_change(uint32_t &threads)
+{
+    if (!changed_.exchange(false)) return false;
+    threads = threads_;
+    return true;
+}
+
+uint32_t DecodeThreadBudget::total_threads()
+{
+    unsigned int cores = std::thread::hardware_concurrency();
+    return (cores > 0) ? cores : 8;
+}
+
+size_t DecodeThreadBudget::members()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return g_members.size();
+}
+
+void DecodeThreadBudget::rebalance()
+{
+    // Fixed shares first; the weighted ones split what is left
+    uint32_t available = total_threads();
+    std::vector<Share *> weighted;
+    uint64_t known_load = 0;
+    size_t known = 0;
+    for (Share *share : g_members) {
+        if (share->fixed_ > 0) {
+            available -= std::min(available, share->fixed_);
+            if (share->threads_ != share->fixed_) {
+                share->threads_ = share->fixed_;
+                share->changed_ = true;
+            }
+            continue;
+        }
+        weighted.push_back(share);
+        if (share->load_ > 0) {
+            known_load += share->load_;
+            known++;
+        }
+    }
+    if (weighted.empty()) return;
+
+    double average = known ? (double)known_load / known : 1.0;
+    double total_weight = 0.0;
+    for (Share *share : weighted) {
+        total_weight += share->load_ ? (double)share->load_ : average;
+    }
+
+    // Largest remainder: floor every share (at least one thread each), then
+    // hand leftover threads to the biggest fractional parts
+    std::vector<std::pair<double, size_t>> remainders;
+    std::vector<uint32_t> threads(weighted.size());
+    uint32_t given = 0;
+    for (size_t i = 0; i < weighted.size(); i++) {
+        double weight = weighted[i]->load_ ? (double)weighted[i]->load_ : average;
+        double exact = available * weight / total_weight;
+        threads[i] = std::max(1u, (uint32_t)exact);
+        given += threads[i];
+        remainders.push_back({ exact - (uint32_t)exact, i });
+    }
+    std::sort(remainders.begin(), remainders.end(),
+              [](const std::pair<double, size_t> &a, const std::pair<double, size_t> &b) { return a.first > b.first; });
+    for (size_t i = 0; given < available && i < remainders.size(); i++, given++) {
+        threads[remainders[i].second]++;
+    }
+
+    for (size_t i = 0; i < weighted.size(); i++) {
+        if (weighted[i]->threads_ != threads[i]) {
+            weighted[i]->threads_ = threads[i];
+            weighted[i]->changed_ = true;
+        }
+    }
+}
+
+} // namespace jpegxs
@@ -0,0 +1,70 @@
+/*
+ * Decode Thread Budget
+ * One pool of SVT decoder threads shared by every source in the process
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace jpegxs {
+
+/**
+ * Decode Thread Budget
+ * Sizing each decoder for the whole machine oversubscribes it as soon as
+ * several sources decode at once. Instead the machine's threads are split
+ * between the shown sources in proportion to the pixels per second each
+ * decodes, and re-split whenever a source shows, hides or its stream
+ * changes. Sources with a fixed thread count take theirs off the top.
+ */
+class DecodeThreadBudget {
+public:
+    /**
+     * A source's membership (one per source, like MemoryAccounting::Tracker).
+     * threads() is what its decoders should be created with; take_change()
+     * tells the decode thread when to rebuild them, between frames.
+     */
+    class Share {
+    public:
+        Share() = default;
+        ~Share() { leave(); }
+
+        Share(const Share &) = delete;
+        Share &operator=(const Share &) = delete;
+
+        // @param fixed_threads > 0 opts out of the weighted split
+        // @return this share's threads after the rebalance
+        uint32_t join(uint32_t fixed_threads = 0);
+        void leave();
+
+        // Pixels per second this source decodes; until known it weighs as the average source
+        void set_load(uint64_t pixels_per_second);
+
+        uint32_t threads() const { return threads_.load(std::memory_order_relaxed); }
+
+        // True once after a rebalance changed threads()
+        bool take_change(uint32_t &threads);
+
+    private:
+        friend class DecodeThreadBudget;
+
+        // Guarded by the budget's lock
+        bool joined_ = false;
+        uint32_t fixed_ = 0;
+        uint64_t load_ = 0;
+
+        std::atomic<uint32_t> threads_{0};
+        std::atomic<bool> changed_{false};
+    };
+
+    // Threads shared out (the machine's hardware threads)
+    static uint32_t total_threads();
+    static size_t members();
+
+private:
+    static void rebalance();
+};
+
+} // namespace jpegxs
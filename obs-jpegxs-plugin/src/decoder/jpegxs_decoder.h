@@ -5,11 +5,31 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <vector>
 
+#include "../network/thread_placement.h"
+#include "../network/memory_accounting.h"
+
+struct svt_jpeg_xs_decoder_api;
+
 namespace jpegxs {
 
+/**
+ * Decode resolution; a proxy decode skips the finest wavelet levels, so a
+ * half (quarter) picture costs roughly a quarter (sixteenth) of a full one
+ */
+enum class ProxyMode {
+    FULL = 0,
+    HALF = 1,
+    QUARTER = 2
+};
+
 /**
  * JPEG XS Decoder
  * Manages SVT-JPEG-XS decoder instance
@@ -39,7 +59,54 @@ public:
     bool decode_frame(const uint8_t* input_data, size_t input_size,
                      uint8_t *yuv_planes[3] = nullptr, uint32_t linesize[3] = nullptr);
     
-    // Access to internal buffers (valid until next decode)
+    /**
+     * Parse the codestream header if the decoder has not been initialized
+     * yet (first frame or after a config change), so the getters below are
+     * valid before an output buffer is chosen. send_frame() calls this too.
+     */
+    bool prepare(const uint8_t* input_data, size_t input_size);
+    
+    /**
+     * The two halves of decode_frame(). Sending returns once SVT has queued
+     * the frame, so several decoders can be fed before waiting on any
+     * (used to decode the stripes of a striped frame concurrently).
+     *
+     * Planes with tight linesizes (width samples per row, as DecodeBuffer
+     * has) are decoded into directly; other linesizes are decoded into the
+     * internal buffers and copied out by receive_frame(). The planes must
+     * stay valid until receive_frame() returns.
+     *
+     * Several frames may be sent before receiving (pipelined decoding);
+     * they complete in send order and receive_frame() hands back the
+     * user_ctx given here. Only frames with their own planes can overlap,
+     * the internal buffers hold one picture.
+     */
+    bool send_frame(const uint8_t* input_data, size_t input_size,
+                    uint8_t *yuv_planes[3] = nullptr, const uint32_t linesize[3] = nullptr,
+                    void *user_ctx = nullptr);
+    
+    // Blocks until the oldest pending frame is done; false if it failed to decode
+    bool receive_frame(void **user_ctx = nullptr);
+    
+    enum class ReceiveStatus {
+        FRAME,   // The oldest pending frame decoded
+        EMPTY,   // Nothing finished yet
+        FAILED   // The oldest pending frame (user_ctx set) or the decoder failed
+    };
+    
+    // Non-blocking receive_frame(), for use with set_frame_ready_callback()
+    ReceiveStatus poll_frame(void **user_ctx = nullptr);
+    
+    /**
+     * Called on an SVT thread whenever a frame finishes (set before
+     * initialize()). It should only wake the thread that calls poll_frame().
+     */
+    void set_frame_ready_callback(std::function<void()> callback) { frame_ready_callback_ = std::move(callback); }
+    
+    size_t frames_in_flight() const;
+    
+    // Access to internal buffers (valid until next decode; only filled when
+    // the caller passed no planes)
     const uint8_t* get_y_buffer() const { return buffer_y_; }
     const uint8_t* get_u_buffer() const { return buffer_u_; }
     const uint8_t* get_v_buffer() const { return buffer_v_; }
@@ -69,6 +136,26 @@ public:
     
     Stats get_stats() const { return stats_; }
     
+    /**
+     * Bytes held in the internal picture buffers (also counted under
+     * MemoryComponent::DECODER); caller-supplied planes and SVT's own
+     * allocations are not included
+     */
+    size_t get_memory_usage() const { return memory_.bytes(); }
+    
+    /**
+     * CPU/NUMA placement for the SVT decoder threads, which are created on the
+     * first frame and inherit the DECODE placement from the calling thread
+     */
+    void set_placement(const PlacementPlan &plan) { placement_ = plan; }
+    
+    /**
+     * Decode resolution, applied by initialize(); the getters then report
+     * the reduced picture size
+     */
+    void set_proxy_mode(ProxyMode mode) { proxy_mode_ = mode; }
+    ProxyMode get_proxy_mode() const { return proxy_mode_; }
+    
 private:
     // SVT-JPEG-XS decoder handle (opaque pointer)
     void *decoder_handle_;
@@ -78,10 +165,14 @@ private:
     uint32_t height_;
     uint8_t bit_depth_;
     int format_; // ColourFormat_t
+    uint32_t component_width_[3] = { 0, 0, 0 };
+    uint32_t component_height_[3] = { 0, 0, 0 };
+    ProxyMode proxy_mode_ = ProxyMode::FULL;
     bool first_frame_;
+    std::atomic<bool> reinit_pending_{false}; // Config change seen; prepare() re-initializes once pending_ drains
     
-    // Internal persistent buffers to avoid use-after-free in threaded decoder
-    // We manage these manually to ensure 64-byte alignment for SVT-JPEG-XS
+    // Internal buffers for callers without their own planes, allocated on
+    // first use. We manage these manually to ensure 64-byte alignment for SVT-JPEG-XS
     uint8_t* buffer_y_ = nullptr;
     uint8_t* buffer_u_ = nullptr;
     uint8_t* buffer_v_ = nullptr;
@@ -89,8 +180,33 @@ private:
     size_t buffer_u_size_ = 0;
     size_t buffer_v_size_ = 0;
     
+    // A sent frame: where it is being decoded, and where the caller wants it
+    struct PendingFrame {
+        uint8_t *decode_planes[3] = { nullptr, nullptr, nullptr };
+        uint8_t *target_planes[3] = { nullptr, nullptr, nullptr };
+        uint32_t target_linesize[3] = { 0, 0, 0 };
+        size_t input_size = 0;
+        void *user_ctx = nullptr;
+    };
+    
+    mutable std::mutex pending_mutex_;
+    std::deque<PendingFrame> pending_;
+    std::function<void()> frame_ready_callback_;
+    
+    PlacementPlan placement_;
+    
+    ReceiveStatus get_frame(bool blocking, void **user_ctx);
+    static void on_frame_ready(svt_jpeg_xs_decoder_api *dec_api, void *context);
+    
+    // Tight per-plane linesize (bytes) and size for the current geometry
+    void plane_layout(uint32_t linesize[3], size_t plane_size[3]) const;
+    bool ensure_internal_buffers();
+    void free_internal_buffers();
+    
     // Statistics
     Stats stats_;
+    
+    MemoryAccounting::Tracker memory_{MemoryComponent::DECODER};
 };
 
 } // namespace jpegxs
@@ -0,0 +1,140 @@
+/*
+ * Media Clock Implementation
+ */
+
+#include "media_clock.h"
+#include "../network/ptp_clock.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace jpegxs {
+
+static const int64_t NS_PER_SECOND = 1000000000LL;
+
+// Fastest-arrival tracking window (FIRST_PACKET follows drift per window)
+static const uint64_t TRACK_WINDOW_NS = 10000000000ULL;
+
+// Further than this from the mapping is a different epoch, not network delay
+static const int64_t EPOCH_TOLERANCE_NS = NS_PER_SECOND;
+
+void MediaClock::reset(Reference reference, uint32_t video_rate, uint32_t audio_rate)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    reference_ = reference;
+    for (StreamState &stream : streams_) stream = StreamState();
+    streams_[VIDEO].rate = video_rate ? video_rate : 90000;
+    streams_[AUDIO].rate = audio_rate ? audio_rate : 48000;
+    anchored_ = false;
+    offset_ns_ = 0;
+    epoch_ns_ = 0;
+    window_start_ns_ = 0;
+    stats_ = Stats();
+}
+
+int64_t MediaClock::media_time_ns(const StreamState &stream, uint32_t rtp_timestamp, int64_t wall_now_ns) const
+{
+    // Ticks since the epoch now, split so the multiply can't overflow
+    int64_t rate = stream.rate;
+    int64_t now_ticks = (wall_now_ns / NS_PER_SECOND) * rate + (wall_now_ns % NS_PER_SECOND) * rate / NS_PER_SECOND;
+
+    // The timestamp is the nearest instant with those low 32 bits
+    int64_t ticks = now_ticks + (int32_t)(rtp_timestamp - (uint32_t)now_ticks);
+    return (ticks / rate) * NS_PER_SECOND + (ticks % rate) * NS_PER_SECOND / rate;
+}
+
+int64_t MediaClock::local_offset_ns(uint64_t local_now_ns, int64_t wall_now_ns) const
+{
+    if (reference_ == Reference::PTP) {
+        return (int64_t)local_now_ns - wall_now_ns + epoch_ns_;
+    }
+    return offset_ns_;
+}
+
+void MediaClock::observe(Stream stream, uint32_t rtp_timestamp, uint64_t arrival_ns)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t wall = (int64_t)PTPClock::now_ns();
+    StreamState &state = streams_[stream];
+    int64_t media = media_time_ns(state, rtp_timestamp, wall);
+
+    if (!anchored_) {
+        anchored_ = true;
+        window_start_ns_ = arrival_ns;
+        if (reference_ == Reference::FIRST_PACKET) {
+            offset_ns_ = (int64_t)arrival_ns - media;
+        } else {
+            // Whole seconds off is an epoch difference; the rest is transit
+            int64_t transit = (int64_t)arrival_ns - (media + local_offset_ns(arrival_ns, wall));
+            int64_t seconds = (transit + (transit >= 0 ? NS_PER_SECOND / 2 : -NS_PER_SECOND / 2)) / NS_PER_SECOND;
+            epoch_ns_ = seconds * NS_PER_SECOND;
+            stats_.epoch_offset_s = -seconds;
+        }
+    }
+
+    int64_t transit = (int64_t)arrival_ns - (media + local_offset_ns(arrival_ns, wall) + state.correction_ns);
+    if (!state.anchored) {
+        state.anchored = true;
+        if (std::llabs(transit) > EPOCH_TOLERANCE_NS) {
+            state.correction_ns = transit;
+            stats_.own_epoch[stream] = true;
+            transit = 0;
+        }
+    } else if (std::llabs(transit) > EPOCH_TOLERANCE_NS) {
+        // Sender restarted or a clock stepped: start over from this packet
+        state.correction_ns += transit;
+        state.window_seen = false;
+        stats_.reanchors++;
+        transit = 0;
+    }
+
+    if (!state.window_seen || transit < state.window_min_ns) {
+        state.window_min_ns = transit;
+        state.window_seen = true;
+    }
+
+    if (arrival_ns - window_start_ns_ < TRACK_WINDOW_NS) return;
+    window_start_ns_ = arrival_ns;
+
+    // Move the shared offset so the fastest shared-epoch arrival has no transit
+    int64_t shift = 0;
+    bool have_shift = false;
+    if (reference_ == Reference::FIRST_PACKET) {
+        for (int i = 0; i < STREAM_COUNT; i++) {
+            if (!streams_[i].window_seen || stats_.own_epoch[i]) continue;
+            shift = have_shift ? std::min(shift, streams_[i].window_min_ns) : streams_[i].window_min_ns;
+            have_shift = true;
+        }
+        offset_ns_ += shift;
+    }
+    for (int i = 0; i < STREAM_COUNT; i++) {
+        StreamState &s = streams_[i];
+        if (!s.window_seen) continue;
+        s.last_min_ns = s.window_min_ns - shift;
+        if (reference_ == Reference::FIRST_PACKET && stats_.own_epoch[i]) {
+            s.correction_ns += s.last_min_ns;
+            s.last_min_ns = 0;
+        }
+        stats_.transit_ms[i] = s.last_min_ns / 1e6;
+        s.window_seen = false;
+    }
+}
+
+bool MediaClock::to_local(Stream stream, uint32_t rtp_timestamp, uint64_t local_now_ns, uint64_t &local_ns)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const StreamState &state = streams_[stream];
+    if (!state.anchored) return false;
+
+    int64_t wall = (int64_t)PTPClock::now_ns();
+    int64_t local = media_time_ns(state, rtp_timestamp, wall) + local_offset_ns(local_now_ns, wall) + state.correction_ns;
+    local_ns = (uint64_t)std::max<int64_t>(local, 0);
+    return true;
+}
+
+MediaClock::Stats MediaClock::get_stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace jpegxs
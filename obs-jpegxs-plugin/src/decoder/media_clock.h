@@ -0,0 +1,91 @@
+/*
+ * Media Clock
+ * Maps the RTP timestamps of a source's video and audio onto the local clock
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+namespace jpegxs {
+
+/**
+ * Media Clock
+ * ST 2110 senders derive every stream's RTP timestamps from one media
+ * clock (PTP time since the epoch, at each stream's rate), so a timestamp
+ * names the same instant whatever stream it came from. The wall clock
+ * resolves the 32-bit wrap (13 h at 90 kHz) and gives the full media
+ * time; the reference then places that on the local monotonic clock:
+ *   - PTP: this machine's system clock is PTP-disciplined as well, and
+ *     media time is read against it directly (a whole-second difference,
+ *     as between a TAI sender and a UTC system clock, is taken off)
+ *   - FIRST_PACKET: the first packet of either stream anchors media time
+ *     to its arrival. Later the offset follows the fastest arrival of
+ *     every 10 s window, so clock drift doesn't build up
+ * A stream whose first packet lands more than a second away from the
+ * shared mapping doesn't share the sender's epoch (RFC 3550 random
+ * offsets); it gets an anchor of its own and syncs by arrival only.
+ *
+ * Observed from the receive threads, mapped from the output threads.
+ */
+class MediaClock {
+public:
+    enum class Reference {
+        PTP,
+        FIRST_PACKET
+    };
+
+    enum Stream {
+        VIDEO = 0,
+        AUDIO = 1,
+        STREAM_COUNT
+    };
+
+    // Forget all anchors; clock_rate is each stream's RTP rate
+    void reset(Reference reference, uint32_t video_rate, uint32_t audio_rate);
+
+    // A packet (audio) or completed frame (video) arrived
+    void observe(Stream stream, uint32_t rtp_timestamp, uint64_t arrival_ns);
+
+    /**
+     * Local time (os_gettime_ns() domain) the sample stamped rtp_timestamp
+     * was taken at the sender
+     * @param local_now_ns os_gettime_ns() read just before the call
+     * @return false until the stream's first packet has been observed
+     */
+    bool to_local(Stream stream, uint32_t rtp_timestamp, uint64_t local_now_ns, uint64_t &local_ns);
+
+    struct Stats {
+        double transit_ms[STREAM_COUNT] = {};  // Fastest arrival after its media time, last window
+        int64_t epoch_offset_s = 0;            // PTP: whole seconds the sender is ahead of the system clock (37 for TAI against UTC)
+        uint64_t reanchors = 0;                // Sender restarts or clock steps
+        bool own_epoch[STREAM_COUNT] = {};     // Stream anchored apart from the shared mapping
+    };
+
+    Stats get_stats();
+
+private:
+    struct StreamState {
+        uint32_t rate = 90000;
+        bool anchored = false;
+        int64_t correction_ns = 0;      // Own-epoch streams: added to the shared offset
+        int64_t window_min_ns = 0;
+        int64_t last_min_ns = 0;
+        bool window_seen = false;
+    };
+
+    int64_t media_time_ns(const StreamState &stream, uint32_t rtp_timestamp, int64_t wall_now_ns) const;
+    int64_t local_offset_ns(uint64_t local_now_ns, int64_t wall_now_ns) const;
+
+    std::mutex mutex_;
+    Reference reference_ = Reference::FIRST_PACKET;
+    StreamState streams_[STREAM_COUNT];
+    bool anchored_ = false;
+    int64_t offset_ns_ = 0;     // local = media + offset (FIRST_PACKET)
+    int64_t epoch_ns_ = 0;      // Added to media time (PTP)
+    uint64_t window_start_ns_ = 0;
+    Stats stats_;
+};
+
+} // namespace jpegxs
@@ -6,40 +6,119 @@
 #include <memory>
 #include <atomic>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include <vector>
 #include <cstring>
 #include <chrono>
 #include <algorithm>
+#include <cmath>
 
 #include "obs_jpegxs_source.h"
 #include "jpegxs_decoder.h"
+#include "decode_buffer_pool.h"
+#include "decode_queue.h"
+#include "slice_concealment.h"
+#include "decode_thread_budget.h"
+#include "semi_planar.h"
+#include "audio_receiver.h"
+#include "audio_jitter_buffer.h"
+#include "media_clock.h"
 #include "../network/rtp_packet.h"
 #include "../network/srt_transport.h"
+#include "../network/srt_message.h"
 #include "../network/udp_socket.h"
+#include "../network/thread_placement.h"
+#include "../network/stripe_framing.h"
+#include "../network/memory_accounting.h"
 
 #include <obs-module.h>
+#include <graphics/vec2.h>
 #include <util/platform.h>
 #include <util/threading.h>
 
 using jpegxs::RTPDepacketizer;
+using jpegxs::SRTMessageDepacketizer;
+using jpegxs::SRTMessage;
 using jpegxs::SRTTransport;
 using jpegxs::JpegXSDecoder;
+using jpegxs::DecodeBuffer;
+using jpegxs::DecodeBufferPool;
+using jpegxs::ProxyMode;
+using jpegxs::DecodeQueue;
+using jpegxs::EncodedFrame;
+using jpegxs::SliceConcealer;
+using jpegxs::DecodeThreadBudget;
+using jpegxs::SemiPlanarConverter;
+using jpegxs::AudioReceiver;
+using jpegxs::AudioJitterBuffer;
+using jpegxs::MediaClock;
+using jpegxs::PixelRepacker;
 using jpegxs::UDPSocket;
+using jpegxs::PlacementPlan;
+using jpegxs::ThreadPlacement;
+using jpegxs::ThreadRole;
+using jpegxs::StripeFraming;
+using jpegxs::MemoryAccounting;
 
 enum TransportMode {
     MODE_SRT = 0,
     MODE_ST2110 = 1
 };
 
+// Pixel layout handed to OBS
+enum OutputFormat {
+    OUTPUT_PLANAR = 0,       // I420/I010/I210/I412, as decoded
+    OUTPUT_SEMI_PLANAR = 1   // NV12/P010/P216/P416 where one exists
+};
+
+// A/V sync setting
+enum SyncMode {
+    SYNC_OFF = 0,           // Unbuffered: everything stamped on arrival
+    SYNC_PTP = 1,           // RTP timestamps read against a PTP-disciplined system clock
+    SYNC_FIRST_PACKET = 2   // RTP timestamps anchored to the first arrival
+};
+
+// Decode resolution setting; the fixed choices share ProxyMode's values
+enum DecodeResolution {
+    DECODE_FULL = 0,
+    DECODE_HALF = 1,
+    DECODE_QUARTER = 2,
+    DECODE_AUTO = 3   // Follow the size the source is drawn at in the scenes
+};
+
+// A decoded picture, from the single decoder or composed from stripes;
+// owns a frame_pool buffer until released
+struct DecodedPicture {
+    DecodeBuffer *buffer = nullptr;
+};
+
+// A frame inside SVT in pipelined mode; its codestream must outlive the decode
+struct InFlightFrame {
+    EncodedFrame *encoded = nullptr;
+    DecodedPicture picture;
+    JpegXSDecoder *decoder = nullptr;
+    uint64_t sent_ns = 0;
+};
+
 struct jpegxs_source {
     obs_source_t *source;
     
     // JPEG XS decoder
     std::unique_ptr<JpegXSDecoder> decoder;
     
+    // Pictures are decoded into these and handed to OBS without a copy of our own
+    std::unique_ptr<DecodeBufferPool> frame_pool;
+    
+    // Semi-planar output (setting read per frame)
+    std::atomic<int> output_format{OUTPUT_SEMI_PLANAR};
+    SemiPlanarConverter semi_planar;
+    
     // Network transport
     TransportMode mode;
     std::unique_ptr<RTPDepacketizer> rtp_depacketizer;
+    std::unique_ptr<SRTMessageDepacketizer> srt_depacketizer;  // Senders with native SRT framing
     
     // SRT
     std::unique_ptr<SRTTransport> srt_transport;
@@ -48,6 +127,31 @@ struct jpegxs_source {
     std::unique_ptr<UDPSocket> udp_socket;
     std::unique_ptr<UDPSocket> audio_udp_socket;
     
+    // AES67 / ST 2110-30 audio, from the SDP or the manual settings.
+    // The receiver and silence plane are only touched by the audio thread
+    AudioReceiver::Format audio_format;
+    uint32_t audio_batch_ms = 1;
+    std::unique_ptr<AudioReceiver> audio_receiver;
+    std::vector<float> audio_silence;  // Fills 7.1's eighth plane for 7-channel streams
+    
+    // Jitter buffer: packets are placed by RTP timestamp and played out every
+    // audio_batch_ms on the local clock. Without it each batch goes to OBS
+    // stamped with its arrival time
+    bool audio_jitter_enabled = true;
+    uint32_t audio_min_depth_ms = 5;
+    std::unique_ptr<AudioJitterBuffer> audio_jitter;
+    uint64_t audio_playout_base_ns = 0;
+    uint64_t audio_playout_count = 0;
+    uint64_t audio_stats_log_ns = 0;
+    
+    // A/V sync: both streams' RTP timestamps mapped onto the local clock and
+    // presented sync_delay_ms later, buffered by OBS. Mode taken on show
+    int sync_setting = SYNC_OFF;
+    int sync_mode = SYNC_OFF;
+    uint32_t sync_delay_ms = 150;
+    MediaClock media_clock;
+    std::atomic<uint64_t> sync_late_frames{0};  // Presented after their time had passed
+    
     // Configuration
     uint32_t width;
     uint32_t height;
@@ -67,16 +171,70 @@ struct jpegxs_source {
     
     uint32_t threads_num;
     
+    // Thread placement (CPU lists in "0-3,8" form, empty = unpinned)
+    std::string placement_receive_cpus;
+    std::string placement_decode_cpus;
+    int placement_numa_node;  // -1 = NIC local, -2 = off
+    bool placement_realtime;
+    PlacementPlan placement;  // Resolved on show
+    
     // Receive thread
     std::thread receive_thread;
     std::thread audio_thread;
+    
+    // Decode thread, fed assembled frames by the receive thread
+    std::unique_ptr<DecodeQueue> decode_queue;
+    std::thread decode_thread;
+    
+    // Fills slices lost on the network from the previous frame (decode thread only)
+    std::unique_ptr<SliceConcealer> concealer;
+    
+    // Pipelined decoding: the decode thread keeps up to pipeline_depth frames
+    // in SVT and the output thread completes them in order as SVT signals them
+    uint32_t pipeline_depth = 2;
+    std::thread output_thread;
+    std::mutex pipeline_mutex;
+    std::condition_variable pipeline_cv;
+    std::deque<InFlightFrame> in_flight;  // Send order; references stay valid at the ends
+    bool frame_ready = false;
+    bool pipeline_stopping = false;
     std::atomic<bool> active;
     
+    // Striped streams: one decoder per stripe, each writing its band of one pooled frame.
+    // decode_threads is this source's part of the process-wide budget unless
+    // the threads setting fixes it
+    DecodeThreadBudget::Share thread_share;
+    uint32_t decode_threads = 0;
+    std::vector<std::unique_ptr<JpegXSDecoder>> stripe_decoders;
+    std::vector<StripeFraming::Stripe> stripes;
+    
+    // Proxy decoding. The setting and the auto pick are written off the
+    // decode thread, which applies them between frames
+    std::atomic<int> decode_resolution{DECODE_FULL};
+    std::atomic<int> auto_proxy{(int)ProxyMode::FULL};
+    ProxyMode proxy_mode = ProxyMode::FULL;  // What the decoders are running at
+    uint32_t coded_width = 0;   // Full-resolution stream size, for the auto pick
+    uint32_t coded_height = 0;
+    int auto_candidate = (int)ProxyMode::FULL;
+    int auto_candidate_scans = 0;
+    float auto_scan_elapsed = 0.0f;
+    
     // Statistics
     uint64_t total_frames;
-    uint64_t dropped_frames;
+    std::atomic<uint64_t> dropped_frames;
+    
+    // Once-a-second decode stats (written where pictures are output)
+    uint64_t stats_log_ns = 0;
+    uint64_t stats_decode_ns = 0;
+    uint64_t stats_frames = 0;
+    uint64_t stats_late = 0;
+    uint64_t stats_convert_ns = 0;
+    const char *output_format_name = "none";  // Last format handed to OBS
+    uint64_t stats_queued = 0;
+    uint64_t frame_interval_ns = 0;  // From the incoming frame rate; 0 until measured
 };
 
+
 // Forward declarations
 static const char *jpegxs_source_getname(void *unused);
 static void *jpegxs_source_create(obs_data_t *settings, obs_source_t *source);
@@ -88,42 +246,216 @@ static uint32_t jpegxs_source_get_width(void *data);
 static uint32_t jpegxs_source_get_height(void *data);
 static obs_properties_t *jpegxs_source_properties(void *unused);
 static void jpegxs_source_get_defaults(obs_data_t *settings);
+static void jpegxs_source_tick(void *data, float seconds);
+static void apply_placement(jpegxs_source *context, ThreadRole role, const char *name);
 
-static void process_frame_data(jpegxs_source *context, const uint8_t* bitstream, size_t bitstream_size, uint32_t rtp_timestamp)
+static ProxyMode wanted_proxy_mode(const jpegxs_source *context)
 {
-    if (!context->decoder) return;
+    int setting = context->decode_resolution;
+    return (ProxyMode)(setting == DECODE_AUTO ? context->auto_proxy.load() : setting);
+}
+
+// A pooled picture, with the interleaved chroma plane if it will go out semi-planar
+static DecodeBuffer *acquire_picture(jpegxs_source *context, uint32_t width, uint32_t height,
+                                     int bit_depth, int format)
+{
+    bool semi_planar = context->output_format == OUTPUT_SEMI_PLANAR &&
+                       SemiPlanarConverter::supported(bit_depth, format);
+    return context->frame_pool->acquire(width, height, bit_depth, format, semi_planar);
+}
+
+// notify_ready: wake the output thread when a frame finishes (pipelined decoder)
+static std::unique_ptr<JpegXSDecoder> create_decoder(jpegxs_source *context, uint32_t threads, bool notify_ready = false)
+{
+    auto decoder = std::make_unique<JpegXSDecoder>();
+    decoder->set_placement(context->placement);
+    decoder->set_proxy_mode(context->proxy_mode);
+    if (notify_ready) {
+        decoder->set_frame_ready_callback([context]() {
+            {
+                std::lock_guard<std::mutex> lock(context->pipeline_mutex);
+                context->frame_ready = true;
+            }
+            context->pipeline_cv.notify_all();
+        });
+    }
+    decoder->initialize(0, 0, threads);
+    return decoder;
+}
 
-    static uint64_t last_log_time = 0;
-    static uint64_t accumulated_decode_time_ns = 0;
-    static uint64_t frame_count_log = 0;
+// Wait until every pipelined frame has been completed by the output thread
+static void wait_pipeline_idle(jpegxs_source *context)
+{
+    std::unique_lock<std::mutex> lock(context->pipeline_mutex);
+    context->pipeline_cv.wait(lock, [context] { return context->in_flight.empty(); });
+}
+
+/**
+ * Switch decode resolution between frames. JPEG XS frames are all intra, so
+ * fresh decoders pick the stream up with the next frame and nothing is dropped.
+ */
+static void apply_decode_resolution(jpegxs_source *context)
+{
+    ProxyMode wanted = wanted_proxy_mode(context);
+    if (wanted == context->proxy_mode) return;
+    
+    blog(LOG_INFO, "[JPEG XS Source] Decode resolution 1/%d -> 1/%d",
+         1 << (int)context->proxy_mode, 1 << (int)wanted);
+    wait_pipeline_idle(context);
+    context->proxy_mode = wanted;
+    context->decoder = create_decoder(context, context->decode_threads, true);
+    context->stripe_decoders.clear();
+}
+
+/**
+ * Resize the decoders after the shared thread budget was rebalanced (another
+ * source showed or hid, or a stream's load changed). Between frames, as above.
+ */
+static void apply_thread_budget(jpegxs_source *context)
+{
+    uint32_t threads;
+    if (!context->thread_share.take_change(threads) || threads == context->decode_threads) return;
+    
+    blog(LOG_INFO, "[JPEG XS Source] Decoder threads %u -> %u (budget of %u shared by %zu sources)",
+         context->decode_threads, threads, DecodeThreadBudget::total_threads(), DecodeThreadBudget::members());
+    wait_pipeline_idle(context);
+    context->decode_threads = threads;
+    context->decoder = create_decoder(context, threads, true);
+    context->stripe_decoders.clear();
+}
+
+/**
+ * Decode a StripeFraming payload: every stripe is sent to its own decoder
+ * before any result is collected, so the SVT instances run concurrently,
+ * and each writes straight into its band of the full-frame planes. Band
+ * positions come from the decoded stripe heights, so proxy decoding works
+ * the same way.
+ */
+static bool decode_striped(jpegxs_source *context, const uint8_t *data, size_t size, DecodedPicture &picture)
+{
+    uint32_t width = 0, height = 0;
+    if (!StripeFraming::parse(data, size, width, height, context->stripes)) {
+        blog(LOG_WARNING, "[JPEG XS] Malformed striped frame (%zu bytes)", size);
+        return false;
+    }
     
-    uint64_t start_decode = os_gettime_ns();
+    size_t count = context->stripes.size();
+    if (context->stripe_decoders.size() != count) {
+        context->stripe_decoders.clear();
+        uint32_t threads = std::max(1u, context->decode_threads / (uint32_t)count);
+        for (size_t i = 0; i < count; i++) {
+            context->stripe_decoders.push_back(create_decoder(context, threads));
+        }
+        blog(LOG_INFO, "[JPEG XS] Striped stream: %zu stripes, %u decoder threads each", count, threads);
+    }
+    
+    // Geometry comes from the stripes' codestream headers
+    uint32_t decoded_height = 0;
+    for (size_t s = 0; s < count; s++) {
+        if (!context->stripe_decoders[s]->prepare(context->stripes[s].data, context->stripes[s].size)) {
+            return false;
+        }
+        decoded_height += context->stripe_decoders[s]->getHeight();
+    }
+    
+    JpegXSDecoder *first = context->stripe_decoders[0].get();
+    picture.buffer = acquire_picture(context, first->getWidth(), decoded_height,
+                                     first->getBitDepth(), first->getFormat());
+    if (!picture.buffer) {
+        return false;
+    }
+    context->coded_width = width;
+    context->coded_height = height;
+    
+    // Stripes are full width, so a band of the frame is tightly strided for its decoder
+    uint32_t chroma_shift_y = (picture.buffer->format == 2) ? 1 : 0;
+    uint32_t first_row = 0;
+    size_t sent = 0;
+    while (sent < count) {
+        const StripeFraming::Stripe &stripe = context->stripes[sent];
+        uint8_t *dst[3];
+        for (int i = 0; i < 3; i++) {
+            uint32_t row = (i == 0) ? first_row : (first_row >> chroma_shift_y);
+            dst[i] = picture.buffer->planes[i] + (size_t)row * picture.buffer->linesize[i];
+        }
+        if (!context->stripe_decoders[sent]->send_frame(stripe.data, stripe.size, dst, picture.buffer->linesize)) break;
+        first_row += context->stripe_decoders[sent]->getHeight();
+        sent++;
+    }
+    
+    // Collect every stripe that was sent, even after a failure, so no decoder keeps a frame queued
+    bool ok = (sent == count);
+    for (size_t s = 0; s < sent; s++) {
+        ok = context->stripe_decoders[s]->receive_frame() && ok;
+    }
+    return ok;
+}
 
-    // Decode using internal buffers
-    if (context->decoder->decode_frame(bitstream, bitstream_size, nullptr, nullptr)) {
+/**
+ * Hand a decoded picture to OBS (or count the drop) and release its buffer.
+ * Runs on the decode thread, or on the output thread when pipelined; never
+ * on both at once.
+ */
+static void output_picture(jpegxs_source *context, DecodedPicture &picture, bool decoded,
+                           uint64_t decode_ns, uint32_t rtp_timestamp)
+{
+    if (decoded) {
         
-        uint64_t end_decode = os_gettime_ns();
-        accumulated_decode_time_ns += (end_decode - start_decode);
-        frame_count_log++;
+        // A frame may take as long as the frames in flight with it allow
+        uint64_t deadline_ns = context->frame_interval_ns * std::max(1u, context->pipeline_depth);
+        context->stats_decode_ns += decode_ns;
+        context->stats_frames++;
+        if (deadline_ns && decode_ns > deadline_ns) context->stats_late++;
         
         uint64_t current_time = os_gettime_ns();
-        if (current_time - last_log_time >= 1000000000ULL) {
-            double avg_decode = (double)accumulated_decode_time_ns / frame_count_log / 1000000.0;
-            blog(LOG_INFO, "[JPEG XS Source] Stats (1s): Frames=%llu, Avg Decode=%.2fms, Dropped=%llu",
-                 frame_count_log, avg_decode, context->dropped_frames);
+        uint64_t elapsed = current_time - context->stats_log_ns;
+        if (elapsed >= 1000000000ULL) {
+            double avg_decode = (double)context->stats_decode_ns / context->stats_frames / 1000000.0;
+            DecodeQueue::Stats queue = context->decode_queue->get_stats();
+            SliceConcealer::Stats concealment = context->concealer->get_stats();
+            
+            // Incoming rate sets the deadline, and with the decoded size this
+            // source's weight in the thread budget
+            if (context->stats_log_ns != 0 && queue.queued > context->stats_queued) {
+                double fps = (double)(queue.queued - context->stats_queued) * 1e9 / elapsed;
+                context->frame_interval_ns = (uint64_t)(1e9 / fps);
+                context->thread_share.set_load((uint64_t)(picture.buffer->width * (double)picture.buffer->height * fps));
+            }
+            double deadline_ms = context->frame_interval_ns * std::max(1u, context->pipeline_depth) / 1000000.0;
             
-            last_log_time = current_time;
-            accumulated_decode_time_ns = 0;
-            frame_count_log = 0;
+            // Conversion cost here against OBS's own render-thread frame time,
+            // to compare output formats on the machine at hand
+            blog(LOG_INFO, "[JPEG XS Source] '%s' Stats (1s): Frames=%llu, Avg Decode=%.2fms of %.2fms deadline (%.0f%%), Late=%llu, Threads=%u, Output=%s (convert %.2fms, render thread %.2fms), Dropped=%llu, Queue=%zu (max %zu), Decode Skips=%llu, Concealed=%llu slices in %llu frames, Mem=%.1f MB",
+                 obs_source_get_name(context->source),
+                 (unsigned long long)context->stats_frames, avg_decode, deadline_ms,
+                 deadline_ms > 0 ? avg_decode * 100.0 / deadline_ms : 0.0,
+                 (unsigned long long)context->stats_late, context->decode_threads,
+                 context->output_format_name, (double)context->stats_convert_ns / context->stats_frames / 1000000.0,
+                 obs_get_average_frame_time_ns() / 1000000.0,
+                 (unsigned long long)context->dropped_frames.load(), queue.depth, queue.max_depth,
+                 (unsigned long long)queue.skipped,
+                 (unsigned long long)concealment.concealed_slices, (unsigned long long)concealment.concealed_frames,
+                 (context->decoder->get_memory_usage() + context->frame_pool->get_memory_usage() +
+                  context->decode_queue->get_memory_usage() + context->concealer->get_memory_usage() +
+                  (context->rtp_depacketizer ? context->rtp_depacketizer->memoryUsage() : 0) +
+                  (context->srt_depacketizer ? context->srt_depacketizer->memoryUsage() : 0)) / 1048576.0);
+            
+            context->stats_log_ns = current_time;
+            context->stats_queued = queue.queued;
+            context->stats_decode_ns = 0;
+            context->stats_frames = 0;
+            context->stats_late = 0;
+            context->stats_convert_ns = 0;
         }
 
         struct obs_source_frame frame;
         memset(&frame, 0, sizeof(frame));
         
-        uint32_t width = context->decoder->getWidth();
-        uint32_t height = context->decoder->getHeight();
-        int bit_depth = context->decoder->getBitDepth();
-        int dec_format = context->decoder->getFormat(); 
+        const DecodeBuffer *buffer = picture.buffer;
+        uint32_t width = buffer->width;
+        uint32_t height = buffer->height;
+        int bit_depth = buffer->bit_depth;
+        int dec_format = buffer->format;
         
         if (width != context->width || height != context->height) {
             context->width = width;
@@ -141,25 +473,37 @@ static void process_frame_data(jpegxs_source *context, const uint8_t* bitstream,
             else if (dec_format == 4) obs_fmt = VIDEO_FORMAT_I412; // Use I412 for >8-bit 4:4:4 (16-bit container)
         }
         
-        if (obs_fmt == VIDEO_FORMAT_NONE) return;
+        if (buffer->semi_planar) {
+            // Y plus interleaved UV; >8-bit samples MSB-aligned in 16 bits
+            if (bit_depth == 8) obs_fmt = VIDEO_FORMAT_NV12;
+            else if (dec_format == 2) obs_fmt = VIDEO_FORMAT_P010;
+            else if (dec_format == 3) obs_fmt = VIDEO_FORMAT_P216;
+            else if (dec_format == 4) obs_fmt = VIDEO_FORMAT_P416;
+        }
+        
+        if (obs_fmt == VIDEO_FORMAT_NONE) {
+            context->frame_pool->release(picture.buffer);
+            return;
+        }
         
         frame.format = obs_fmt;
         frame.width = width;
         frame.height = height;
-        frame.data[0] = (uint8_t*)context->decoder->get_y_buffer();
-        frame.data[1] = (uint8_t*)context->decoder->get_u_buffer();
-        frame.data[2] = (uint8_t*)context->decoder->get_v_buffer();
-        
-        uint32_t bpp = (bit_depth > 8) ? 2 : 1;
-        frame.linesize[0] = width * bpp;
-        
-        if (dec_format == 2 || dec_format == 3) {
-            frame.linesize[1] = (width / 2) * bpp;
-            frame.linesize[2] = (width / 2) * bpp;
+        if (buffer->semi_planar) {
+            uint64_t convert_start = os_gettime_ns();
+            context->semi_planar.convert(picture.buffer);
+            context->stats_convert_ns += os_gettime_ns() - convert_start;
+            frame.data[0] = buffer->planes[0];
+            frame.linesize[0] = buffer->linesize[0];
+            frame.data[1] = buffer->interleaved;
+            frame.linesize[1] = buffer->interleaved_linesize;
         } else {
-            frame.linesize[1] = width * bpp;
-            frame.linesize[2] = width * bpp;
+            for (int i = 0; i < 3; i++) {
+                frame.data[i] = buffer->planes[i];
+                frame.linesize[i] = buffer->linesize[i];
+            }
         }
+        context->output_format_name = get_video_format_name(obs_fmt);
         
         // Timestamp handling: Convert RTP (90kHz) to NS
         // We need to handle wrapping and offset relative to system time
@@ -192,6 +536,16 @@ static void process_frame_data(jpegxs_source *context, const uint8_t* bitstream,
         // Since we are unbuffered, this is the correct behavior for <20ms latency.
         frame.timestamp = os_gettime_ns();
         
+        // A/V sync: the frame's media time plus the playout delay, which OBS
+        // waits for; audio is stamped the same way
+        uint64_t media_local = 0;
+        if (context->sync_mode != SYNC_OFF &&
+            context->media_clock.to_local(MediaClock::VIDEO, rtp_timestamp, frame.timestamp, media_local)) {
+            uint64_t presentation = media_local + context->sync_delay_ms * 1000000ULL;
+            if (presentation < frame.timestamp) context->sync_late_frames++;
+            frame.timestamp = presentation;
+        }
+        
         // OBS has a built-in smoothing buffer for async video sources.
         // For true low latency, we need to bypass this as much as possible.
         // Timestamp must be strictly monotonic and close to system time.
@@ -225,113 +579,362 @@ static void process_frame_data(jpegxs_source *context, const uint8_t* bitstream,
         // DRAIN: Check if we have processed a frame too recently to catch up?
         // No, we want to output as fast as possible.
         
+        // OBS copies the planes into its own async frame before returning,
+        // which is the only copy the picture makes; the buffer is free again after
         obs_source_output_video(context->source, &frame);
+        context->frame_pool->release(picture.buffer);
         context->total_frames++;
         
     } else {
+        context->frame_pool->release(picture.buffer);
         context->dropped_frames++;
     }
 }
 
-static void process_audio_packet(jpegxs_source *context, const uint8_t* data, size_t size, uint32_t timestamp)
+static void process_frame_data(jpegxs_source *context, const uint8_t* bitstream, size_t bitstream_size, uint32_t rtp_timestamp)
 {
-    // Expecting L16 Stereo (4 bytes per sample frame)
-    // RTP Header (12 bytes) is already stripped or handled by caller?
-    // Actually this function receives raw packet or payload?
-    // Let's assume payload for now, or check header.
-    
-    // Wait, receive_audio_loop_udp reads raw packet. 
-    // We need to parse RTP header to find payload offset.
-    
-    if (size < 12) return;
+    if (!context->decoder) return;
     
-    // Basic RTP Header Check
-    uint8_t v = (data[0] >> 6) & 0x03;
-    if (v != 2) return;
+    apply_decode_resolution(context);
+    apply_thread_budget(context);
     
-    uint8_t cc = data[0] & 0x0F;
-    size_t header_len = 12 + (cc * 4);
+    uint64_t start_decode = os_gettime_ns();
+
+    DecodedPicture picture;
+    bool decoded = false;
+    if (StripeFraming::isStriped(bitstream, bitstream_size)) {
+        decoded = decode_striped(context, bitstream, bitstream_size, picture);
+    } else if (context->decoder->prepare(bitstream, bitstream_size)) {
+        // Decode straight into a pooled frame
+        JpegXSDecoder *decoder = context->decoder.get();
+        picture.buffer = acquire_picture(context, decoder->getWidth(), decoder->getHeight(),
+                                         decoder->getBitDepth(), decoder->getFormat());
+        decoded = picture.buffer &&
+                  decoder->decode_frame(bitstream, bitstream_size, picture.buffer->planes, picture.buffer->linesize);
+        context->coded_width = decoder->getWidth() << (int)context->proxy_mode;
+        context->coded_height = decoder->getHeight() << (int)context->proxy_mode;
+    }
     
-    if (size <= header_len) return;
+    output_picture(context, picture, decoded, os_gettime_ns() - start_decode, rtp_timestamp);
+}
+
+/**
+ * Pipelined decode: send the frame without waiting for it, once fewer than
+ * pipeline_depth frames are in SVT. The output thread completes it.
+ * @return false if the frame could not be sent (the caller still owns it)
+ */
+static bool submit_pipelined(jpegxs_source *context, EncodedFrame *frame)
+{
+    JpegXSDecoder *decoder = context->decoder.get();
+    const uint8_t *bitstream = frame->data.data();
+    size_t bitstream_size = frame->data.size();
+    if (!decoder->prepare(bitstream, bitstream_size)) return false;
+    
+    {
+        std::unique_lock<std::mutex> lock(context->pipeline_mutex);
+        context->pipeline_cv.wait(lock, [context] { return context->in_flight.size() < context->pipeline_depth; });
+    }
     
-    const uint8_t *payload = data + header_len;
-    size_t payload_len = size - header_len;
+    DecodedPicture picture;
+    picture.buffer = acquire_picture(context, decoder->getWidth(), decoder->getHeight(),
+                                     decoder->getBitDepth(), decoder->getFormat());
+    if (!picture.buffer) return false;
+    context->coded_width = decoder->getWidth() << (int)context->proxy_mode;
+    context->coded_height = decoder->getHeight() << (int)context->proxy_mode;
+    
+    // Queued before sending, as the output thread may see the frame finish
+    // before send_frame() returns. Only this thread appends, so the record
+    // stays at the back until then.
+    InFlightFrame *record;
+    {
+        std::lock_guard<std::mutex> lock(context->pipeline_mutex);
+        context->in_flight.push_back(InFlightFrame{ frame, picture, decoder, os_gettime_ns() });
+        record = &context->in_flight.back();
+    }
     
-    // Assuming L16 Stereo (4 bytes per frame: 2 bytes left, 2 bytes right)
-    uint32_t frames = payload_len / 4;
-    if (frames == 0) return;
+    if (!decoder->send_frame(bitstream, bitstream_size, picture.buffer->planes, picture.buffer->linesize, record)) {
+        {
+            std::lock_guard<std::mutex> lock(context->pipeline_mutex);
+            context->in_flight.pop_back();
+        }
+        context->pipeline_cv.notify_all();
+        context->frame_pool->release(picture.buffer);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Completes pipelined frames in send order: woken by the decoder's
+ * frame-ready callback, it takes every finished frame, outputs it and
+ * frees its pipeline slot. On stop it drains what is still in SVT.
+ */
+static void output_loop(jpegxs_source *context)
+{
+    blog(LOG_INFO, "[JPEG XS] Output thread started");
+    apply_placement(context, ThreadRole::DECODE, "jxs-output");
+    
+    std::unique_lock<std::mutex> lock(context->pipeline_mutex);
+    for (;;) {
+        context->pipeline_cv.wait(lock, [context] {
+            return context->pipeline_stopping || (context->frame_ready && !context->in_flight.empty());
+        });
+        if (context->in_flight.empty()) {
+            if (context->pipeline_stopping) break;
+            continue;
+        }
+        
+        context->frame_ready = false;
+        bool draining = context->pipeline_stopping;
+        JpegXSDecoder *decoder = context->in_flight.front().decoder;
+        InFlightFrame *oldest = &context->in_flight.front();
+        lock.unlock();
+        
+        void *user_ctx = nullptr;
+        JpegXSDecoder::ReceiveStatus status;
+        while ((status = draining ? (decoder->receive_frame(&user_ctx) ? JpegXSDecoder::ReceiveStatus::FRAME
+                                                                       : JpegXSDecoder::ReceiveStatus::FAILED)
+                                  : decoder->poll_frame(&user_ctx)) != JpegXSDecoder::ReceiveStatus::EMPTY) {
+            // A decoder-level failure names no frame; retire the oldest so the pipeline can't stall
+            InFlightFrame *record = user_ctx ? static_cast<InFlightFrame*>(user_ctx) : oldest;
+            if (record != oldest) {
+                blog(LOG_WARNING, "[JPEG XS Source] Pipelined frame completed out of order");
+            }
+            
+            output_picture(context, record->picture, status == JpegXSDecoder::ReceiveStatus::FRAME,
+                           os_gettime_ns() - record->sent_ns, record->encoded->rtp_timestamp);
+            context->decode_queue->recycle(record->encoded);
+            
+            {
+                std::lock_guard<std::mutex> guard(context->pipeline_mutex);
+                context->in_flight.pop_front();
+                if (context->in_flight.empty()) break;
+                oldest = &context->in_flight.front();
+            }
+            context->pipeline_cv.notify_all();
+            if (draining) break;
+        }
+        
+        context->pipeline_cv.notify_all();
+        lock.lock();
+    }
     
+    blog(LOG_INFO, "[JPEG XS] Output thread stopped");
+}
+
+// OBS layout for a channel count; 7 rides in 7.1 with a silent eighth
+// channel and anything above 8 is cut to its first eight
+static speaker_layout audio_speakers(uint32_t channels)
+{
+    switch (channels) {
+    case 1: return SPEAKERS_MONO;
+    case 2: return SPEAKERS_STEREO;
+    case 3: return SPEAKERS_2POINT1;
+    case 4: return SPEAKERS_4POINT0;
+    case 5: return SPEAKERS_4POINT1;
+    case 6: return SPEAKERS_5POINT1;
+    default: return SPEAKERS_7POINT1;
+    }
+}
+
+static void output_audio(jpegxs_source *context, const float *const planes[], uint32_t channels,
+                         uint32_t frames, uint64_t timestamp)
+{
     struct obs_source_audio audio;
     memset(&audio, 0, sizeof(audio));
     
-    audio.speakers = SPEAKERS_STEREO;
-    audio.samples_per_sec = 48000;
-    audio.format = AUDIO_FORMAT_FLOAT_PLANAR; // OBS internal format
+    audio.speakers = audio_speakers(channels);
+    audio.samples_per_sec = context->audio_receiver->format().sample_rate;
+    audio.format = AUDIO_FORMAT_FLOAT_PLANAR;
     audio.frames = frames;
-    audio.timestamp = os_gettime_ns(); // Low latency: use arrival time
-    
-    // Allocate buffers for planar float
-    // obs_source_audio_init doesn't alloc data pointers usually, we need to provide them.
-    // But obs_source_output_audio copies data.
-    // We need separate vectors for L and R.
+    audio.timestamp = timestamp;
     
-    std::vector<float> ch_left(frames);
-    std::vector<float> ch_right(frames);
+    uint32_t count = std::min(channels, 8u);
+    for (uint32_t c = 0; c < count; c++) {
+        audio.data[c] = (const uint8_t*)planes[c];
+    }
+    if (channels == 7) {
+        audio.data[7] = (const uint8_t*)context->audio_silence.data();
+    }
     
-    const int16_t *samples = (const int16_t*)payload;
+    // OBS copies the planes before returning
+    obs_source_output_audio(context->source, &audio);
+}
+
+static void process_audio_packet(jpegxs_source *context, const uint8_t* data, size_t size, uint64_t arrival_ns)
+{
+    AudioReceiver *receiver = context->audio_receiver.get();
+    if (!receiver->push_packet(data, size, arrival_ns)) return;
     
-    for (uint32_t i = 0; i < frames; i++) {
-        // Read Big Endian Int16
-        // Payload is byte stream.
-        uint8_t h1 = payload[i*4 + 0];
-        uint8_t l1 = payload[i*4 + 1];
-        int16_t s1 = (int16_t)((h1 << 8) | l1);
-        
-        uint8_t h2 = payload[i*4 + 2];
-        uint8_t l2 = payload[i*4 + 3];
-        int16_t s2 = (int16_t)((h2 << 8) | l2);
-        
-        // Convert to Float [-1.0, 1.0]
-        ch_left[i] = s1 / 32768.0f;
-        ch_right[i] = s2 / 32768.0f;
+    const AudioReceiver::Batch &batch = receiver->batch();
+    if (context->sync_mode != SYNC_OFF) {
+        context->media_clock.observe(MediaClock::AUDIO, batch.rtp_timestamp, batch.arrival_ns);
+    }
+    if (context->audio_jitter) {
+        context->audio_jitter->push(batch.planes, batch.frames, batch.rtp_timestamp, batch.arrival_ns);
+        return;
     }
     
-    const uint8_t *planes[2];
-    planes[0] = (const uint8_t*)ch_left.data();
-    planes[1] = (const uint8_t*)ch_right.data();
+    uint64_t timestamp = batch.arrival_ns; // Low latency: use arrival time
+    if (context->sync_mode != SYNC_OFF) {
+        uint64_t media_local = 0;
+        if (!context->media_clock.to_local(MediaClock::AUDIO, batch.rtp_timestamp, os_gettime_ns(), media_local)) return;
+        timestamp = media_local + context->sync_delay_ms * 1000000ULL;
+    }
+    output_audio(context, batch.planes, batch.channels, batch.frames, timestamp);
+}
+
+/**
+ * Play the jitter buffer out on the local clock: one pull per audio_batch_ms,
+ * stamped with the ideal time of the pull so OBS sees an even cadence
+ * however late the audio thread gets round to it. With A/V sync the stamp
+ * is the pulled audio's media time plus the playout delay instead, and
+ * silence is not sent (its place on the timeline is simply left empty).
+ */
+static void audio_playout(jpegxs_source *context, uint64_t now)
+{
+    AudioJitterBuffer *jitter = context->audio_jitter.get();
+    const AudioJitterBuffer::Config &config = jitter->config();
+    double interval_ns = config.pull_frames * 1e9 / config.sample_rate;
+    
+    uint64_t next = context->audio_playout_base_ns + (uint64_t)(context->audio_playout_count * interval_ns);
+    // Restart the cadence on the first call and after a stall of the audio thread
+    if (context->audio_playout_base_ns == 0 || now > next + 100000000ULL) {
+        context->audio_playout_base_ns = next = now;
+        context->audio_playout_count = 0;
+    }
     
-    audio.data[0] = (const uint8_t*)ch_left.data();
-    audio.data[1] = (const uint8_t*)ch_right.data();
+    while (now >= next) {
+        const float *planes[AudioJitterBuffer::MAX_CHANNELS];
+        if (jitter->pull(planes)) {
+            uint64_t timestamp = next;
+            uint64_t media_local = 0;
+            if (context->sync_mode == SYNC_OFF) {
+                output_audio(context, planes, config.channels, config.pull_frames, timestamp);
+            } else if (jitter->playing() &&
+                       context->media_clock.to_local(MediaClock::AUDIO, jitter->pull_timestamp(), now, media_local)) {
+                timestamp = media_local + context->sync_delay_ms * 1000000ULL;
+                output_audio(context, planes, config.channels, config.pull_frames, timestamp);
+            }
+        }
+        context->audio_playout_count++;
+        next = context->audio_playout_base_ns + (uint64_t)(context->audio_playout_count * interval_ns);
+    }
     
-    obs_source_output_audio(context->source, &audio);
+    if (now - context->audio_stats_log_ns >= 10000000000ULL) {
+        context->audio_stats_log_ns = now;
+        AudioJitterBuffer::Stats stats = jitter->get_stats();
+        if (stats.target_ms > 0.0) {
+            blog(LOG_INFO, "[JPEG XS Source] '%s' audio: depth %.1f ms (target %.1f), jitter %.1f ms, drift %+.1f ppm, %llu underruns, %llu late, %llu frames skipped",
+                 obs_source_get_name(context->source), stats.depth_ms, stats.target_ms, stats.jitter_ms,
+                 stats.drift_ppm, (unsigned long long)stats.underruns, (unsigned long long)stats.late_packets,
+                 (unsigned long long)stats.skipped_frames);
+        }
+    }
+}
+
+static void apply_placement(jpegxs_source *context, ThreadRole role, const char *name)
+{
+    if (!context->placement.active()) return;
+    std::string error;
+    if (!ThreadPlacement::apply(context->placement, role, name, &error)) {
+        blog(LOG_WARNING, "[JPEG XS] %s thread placement: %s", name, error.c_str());
+    }
+}
+
+static void log_thread_placement()
+{
+    for (const auto &t : ThreadPlacement::snapshot()) {
+        blog(LOG_INFO, "[JPEG XS] Thread %-12s (%s) cpus=[%s] last_cpu=%d cpu=%.1f%% migrations=%llu preempted=%llu%s",
+             t.name.c_str(), ThreadPlacement::roleName(t.role).c_str(),
+             t.cpus.empty() ? "any" : t.cpus.c_str(), t.last_cpu, t.cpu_percent,
+             (unsigned long long)t.migrations, (unsigned long long)t.involuntary_switches,
+             t.realtime ? " RT" : "");
+    }
 }
 
 static void receive_loop_audio(jpegxs_source *context)
 {
     blog(LOG_INFO, "[JPEG XS] Audio Receive thread started");
+    apply_placement(context, ThreadRole::AUDIO, "jxs-audio-rx");
     
-    std::vector<uint8_t> buffer(2048);
+    // Jumbo-frame sized: 16 channels of L24 at 1 ms is 2316 bytes
+    std::vector<uint8_t> buffer(9216);
+    std::string src_ip;
+    uint16_t src_port;
     
     while (context->active) {
-        std::string src_ip;
-        uint16_t src_port;
-        
         if (!context->audio_udp_socket) break;
         
         int received = context->audio_udp_socket->recvFrom(buffer.data(), buffer.size(), src_ip, src_port);
         
+        uint64_t now = os_gettime_ns();
         if (received > 0) {
-             process_audio_packet(context, buffer.data(), received, 0);
-        } else {
+             process_audio_packet(context, buffer.data(), received, now);
+        }
+        if (context->audio_jitter) {
+            audio_playout(context, now);
+        }
+        if (received <= 0) {
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
     }
      blog(LOG_INFO, "[JPEG XS] Audio Receive thread stopped");
 }
 
+/**
+ * Hand the assembled frame to the decode thread. The receive thread only
+ * does I/O and depacketization, so a long decode can't back up the socket.
+ * Either depacketizer swaps its frame buffer with the queued frame's.
+ */
+template <typename Depacketizer>
+static void queue_frame(jpegxs_source *context, Depacketizer &depacketizer)
+{
+    EncodedFrame *frame = context->decode_queue->acquire();
+    frame->rtp_timestamp = depacketizer.getFrameTimestamp();
+    if (context->sync_mode != SYNC_OFF) {
+        context->media_clock.observe(MediaClock::VIDEO, frame->rtp_timestamp, os_gettime_ns());
+    }
+    depacketizer.takeFrame(frame->data, frame->slices);
+    context->decode_queue->push(frame);
+}
+
+static void decode_loop(jpegxs_source *context)
+{
+    blog(LOG_INFO, "[JPEG XS] Decode thread started");
+    apply_placement(context, ThreadRole::DECODE, "jxs-decode");
+    
+    while (EncodedFrame *frame = context->decode_queue->pop()) {
+        // A frame that lost slices decodes with the previous frame's in their place
+        if (!context->concealer->conceal(frame->data, frame->slices)) {
+            context->dropped_frames++;
+            context->decode_queue->recycle(frame);
+            continue;
+        }
+        
+        // Striped frames already decode in parallel across their stripe decoders
+        if (context->pipeline_depth > 1 && !StripeFraming::isStriped(frame->data.data(), frame->data.size())) {
+            apply_decode_resolution(context);
+            apply_thread_budget(context);
+            if (!submit_pipelined(context, frame)) {
+                context->dropped_frames++;
+                context->decode_queue->recycle(frame);
+            }
+            continue;
+        }
+        
+        wait_pipeline_idle(context);
+        process_frame_data(context, frame->data.data(), frame->data.size(), frame->rtp_timestamp);
+        context->decode_queue->recycle(frame);
+    }
+    
+    blog(LOG_INFO, "[JPEG XS] Decode thread stopped");
+}
+
 static void receive_loop_udp(jpegxs_source *context)
 {
     blog(LOG_INFO, "[JPEG XS] UDP Receive thread started");
+    apply_placement(context, ThreadRole::NETWORK, "jxs-udp-rx");
     
     std::vector<uint8_t> buffer(2048); // RTP packets usually < 1500
     
@@ -343,11 +946,8 @@ static void receive_loop_udp(jpegxs_source *context)
         
         if (received > 0) {
             if (context->rtp_depacketizer->processPacket(buffer.data(), received)) {
-                if (context->rtp_depacketizer->isFrameReady()) {
-                    size_t frame_size = 0;
-                    const uint8_t* frame_data = context->rtp_depacketizer->getFrameData(frame_size);
-                    // Pass RTP timestamp
-                    process_frame_data(context, frame_data, frame_size, context->rtp_depacketizer->getCurrentTimestamp());
+                while (context->rtp_depacketizer->isFrameReady()) {
+                    queue_frame(context, *context->rtp_depacketizer);
                 }
             }
         } else {
@@ -362,14 +962,16 @@ static void receive_loop_srt(jpegxs_source *context)
 {
     blog(LOG_INFO, "[JPEG XS] SRT Receive thread started");
     
+    // The sender's framing is told apart per message by its version bits
     context->srt_transport->setDataCallback([context](const uint8_t *data, size_t size) {
         if (!context->active) return;
-        if (context->rtp_depacketizer->processPacket(data, size)) {
-            if (context->rtp_depacketizer->isFrameReady()) {
-                size_t frame_size = 0;
-                const uint8_t* frame_data = context->rtp_depacketizer->getFrameData(frame_size);
-                // Pass RTP timestamp
-                process_frame_data(context, frame_data, frame_size, context->rtp_depacketizer->getCurrentTimestamp());
+        if (SRTMessage::isMessage(data, size)) {
+            if (context->srt_depacketizer->processMessage(data, size) && context->srt_depacketizer->isFrameReady()) {
+                queue_frame(context, *context->srt_depacketizer);
+            }
+        } else if (context->rtp_depacketizer->processPacket(data, size)) {
+            while (context->rtp_depacketizer->isFrameReady()) {
+                queue_frame(context, *context->rtp_depacketizer);
             }
         }
     });
@@ -414,6 +1016,97 @@ void register_jpegxs_source(struct obs_source_info *info)
     info->get_height = jpegxs_source_get_height;
     info->get_properties = jpegxs_source_properties;
     info->get_defaults = jpegxs_source_get_defaults;
+    info->video_tick = jpegxs_source_tick;
+}
+
+// Largest drawn-to-coded scale over the scene items showing a source
+struct DrawnScale {
+    obs_source_t *source = nullptr;
+    float coded_width = 0.0f;
+    float coded_height = 0.0f;
+    float group_scale_x = 1.0f;  // Scale of the enclosing groups
+    float group_scale_y = 1.0f;
+    float max_scale = 0.0f;
+    bool found = false;
+    bool unbounded = false;
+};
+
+static bool find_drawn_items(obs_scene_t *scene, obs_sceneitem_t *item, void *param)
+{
+    UNUSED_PARAMETER(scene);
+    DrawnScale *drawn = static_cast<DrawnScale*>(param);
+    if (!obs_sceneitem_visible(item)) return true;
+    
+    if (obs_sceneitem_is_group(item)) {
+        struct vec2 scale;
+        obs_sceneitem_get_scale(item, &scale);
+        float outer_x = drawn->group_scale_x, outer_y = drawn->group_scale_y;
+        drawn->group_scale_x *= std::fabs(scale.x);
+        drawn->group_scale_y *= std::fabs(scale.y);
+        obs_sceneitem_group_enum_items(item, find_drawn_items, drawn);
+        drawn->group_scale_x = outer_x;
+        drawn->group_scale_y = outer_y;
+        return true;
+    }
+    
+    if (obs_sceneitem_get_source(item) != drawn->source) return true;
+    drawn->found = true;
+    
+    if (obs_sceneitem_get_bounds_type(item) == OBS_BOUNDS_NONE) {
+        drawn->unbounded = true;
+        return true;
+    }
+    
+    struct vec2 bounds;
+    obs_sceneitem_get_bounds(item, &bounds);
+    float scale = std::max(std::fabs(bounds.x) * drawn->group_scale_x / drawn->coded_width,
+                           std::fabs(bounds.y) * drawn->group_scale_y / drawn->coded_height);
+    drawn->max_scale = std::max(drawn->max_scale, scale);
+    return true;
+}
+
+static bool find_drawn_scenes(void *param, obs_source_t *scene_source)
+{
+    obs_scene_t *scene = obs_scene_from_source(scene_source);
+    if (scene) obs_scene_enum_items(scene, find_drawn_items, param);
+    return true;
+}
+
+/**
+ * Auto decode resolution: once a second, pick the smallest proxy that is
+ * still at least as large as every bounded item showing this source
+ */
+static void jpegxs_source_tick(void *data, float seconds)
+{
+    jpegxs_source *context = static_cast<jpegxs_source*>(data);
+    if (context->decode_resolution != DECODE_AUTO || !context->active) return;
+    
+    context->auto_scan_elapsed += seconds;
+    if (context->auto_scan_elapsed < 1.0f) return;
+    context->auto_scan_elapsed = 0.0f;
+    
+    if (context->coded_width == 0 || context->coded_height == 0) return;
+    
+    DrawnScale drawn;
+    drawn.source = context->source;
+    drawn.coded_width = (float)context->coded_width;
+    drawn.coded_height = (float)context->coded_height;
+    obs_enum_scenes(find_drawn_scenes, &drawn);
+    
+    int level = (int)ProxyMode::FULL;
+    if (drawn.found && !drawn.unbounded) {
+        if (drawn.max_scale <= 0.25f) level = (int)ProxyMode::QUARTER;
+        else if (drawn.max_scale <= 0.5f) level = (int)ProxyMode::HALF;
+    }
+    
+    // Two scans in a row must agree, so a transition or a drag doesn't bounce the decoder
+    if (level != context->auto_candidate) {
+        context->auto_candidate = level;
+        context->auto_candidate_scans = 0;
+    }
+    if (++context->auto_candidate_scans >= 2) {
+        context->auto_proxy = level;
+    }
 }
 
 static const char *jpegxs_source_getname(void *unused)
@@ -469,6 +1162,11 @@ struct SDPInfo {
     uint32_t height = 0;
     uint32_t fps_num = 0;
     uint32_t fps_den = 0;
+    
+    // From the audio section's a=rtpmap (L16/L24 only); 0 if absent
+    int audio_bit_depth = 0;
+    uint32_t audio_sample_rate = 0;
+    uint32_t audio_channels = 0;
 };
 
 static SDPInfo parse_sdp_file(const std::string& path) {
@@ -494,6 +1192,24 @@ static SDPInfo parse_sdp_file(const std::string& path) {
             std::stringstream ss(line.substr(8));
             ss >> info.audio_port;
             in_audio = true;
+        } else if (in_audio && line.rfind("a=rtpmap:", 0) == 0) {
+            // a=rtpmap:<pt> L24/48000/8 (channel count optional, defaults to 1)
+            size_t space = line.find(' ');
+            if (space != std::string::npos) {
+                std::string encoding = line.substr(space + 1);
+                encoding.erase(encoding.find_last_not_of(" \n\r\t") + 1);
+                int depth = 0;
+                if (encoding.rfind("L16/", 0) == 0) depth = 16;
+                else if (encoding.rfind("L24/", 0) == 0) depth = 24;
+                if (depth) {
+                    try {
+                        size_t slash = encoding.find('/', 4);
+                        info.audio_sample_rate = (uint32_t)std::stoul(encoding.substr(4, slash == std::string::npos ? std::string::npos : slash - 4));
+                        info.audio_channels = slash == std::string::npos ? 1 : (uint32_t)std::stoul(encoding.substr(slash + 1));
+                        info.audio_bit_depth = depth;
+                    } catch (...) {}
+                }
+            }
         } else if (line.rfind("a=fmtp:", 0) == 0) {
             // Parse fmtp line for width/height/framerate
             if (line.find("width=") != std::string::npos) {
@@ -554,8 +1270,14 @@ static void jpegxs_source_update(void *data, obs_data_t *settings)
                 context->width = sdp.width;
                 context->height = sdp.height;
             }
-            blog(LOG_INFO, "[JPEG XS] Parsed SDP: IP=%s Video=%u Audio=%u %ux%u", 
-                 sdp.dest_ip.c_str(), sdp.port, context->st2110_audio_port, sdp.width, sdp.height);
+            if (sdp.audio_bit_depth > 0) {
+                context->audio_format.bit_depth = sdp.audio_bit_depth;
+                context->audio_format.sample_rate = sdp.audio_sample_rate;
+                context->audio_format.channels = sdp.audio_channels;
+            }
+            blog(LOG_INFO, "[JPEG XS] Parsed SDP: IP=%s Video=%u Audio=%u %ux%u L%d/%u/%u", 
+                 sdp.dest_ip.c_str(), sdp.port, context->st2110_audio_port, sdp.width, sdp.height,
+                 context->audio_format.bit_depth, context->audio_format.sample_rate, context->audio_format.channels);
         }
     } else {
         // Manual override
@@ -571,11 +1293,32 @@ static void jpegxs_source_update(void *data, obs_data_t *settings)
             context->width = manual_w;
             context->height = manual_h;
         }
+        
+        context->audio_format.bit_depth = (int)obs_data_get_int(settings, "audio_bit_depth");
+        context->audio_format.channels = (uint32_t)obs_data_get_int(settings, "audio_channels");
+        context->audio_format.sample_rate = 48000;
     }
+    context->audio_batch_ms = (uint32_t)obs_data_get_int(settings, "audio_batch_ms");
+    context->audio_jitter_enabled = obs_data_get_bool(settings, "audio_jitter_buffer");
+    context->audio_min_depth_ms = (uint32_t)obs_data_get_int(settings, "audio_min_depth_ms");
+    context->sync_setting = (int)obs_data_get_int(settings, "av_sync");
+    context->sync_delay_ms = (uint32_t)obs_data_get_int(settings, "av_sync_delay_ms");
     context->st2110_interface_ip = obs_data_get_string(settings, "st2110_interface_ip");
     
     context->threads_num = (uint32_t)obs_data_get_int(settings, "threads");
     
+    context->placement_receive_cpus = obs_data_get_string(settings, "placement_receive_cpus");
+    context->placement_decode_cpus = obs_data_get_string(settings, "placement_decode_cpus");
+    context->placement_numa_node = (int)obs_data_get_int(settings, "placement_numa_node");
+    context->placement_realtime = obs_data_get_bool(settings, "placement_realtime");
+    
+    context->decode_resolution = (int)obs_data_get_int(settings, "decode_resolution");
+    context->output_format = (int)obs_data_get_int(settings, "output_format");
+    if (!context->active) {
+        // Sizes the frame pool and pipeline, so only taken on show
+        context->pipeline_depth = (uint32_t)std::max(1LL, obs_data_get_int(settings, "decode_pipeline_depth"));
+    }
+    
     // Parse SRT URL if needed (Legacy logic)
     const char* url = context->srt_url.c_str();
     if (url && strncmp(url, "srt://", 6) == 0) {
@@ -599,20 +1342,61 @@ static void jpegxs_source_show(void *data)
     try {
         blog(LOG_INFO, "[JPEG XS] Starting source");
         
-        // Auto-detect threads if 0
-        uint32_t threads = context->threads_num;
-        if (threads == 0) {
-            unsigned int cores = std::thread::hardware_concurrency();
-            threads = (cores > 0) ? cores : 8;
-            blog(LOG_INFO, "[JPEG XS] Auto-detected %u threads for decoder", threads);
+        // 0 threads: a weighted share of the machine, split with the other shown sources
+        uint32_t threads = context->thread_share.join(context->threads_num);
+        blog(LOG_INFO, "[JPEG XS] %u decoder threads (%s, %u shared by %zu sources)", threads,
+             context->threads_num ? "fixed" : "budgeted", DecodeThreadBudget::total_threads(),
+             DecodeThreadBudget::members());
+        context->stats_log_ns = 0;
+        context->frame_interval_ns = 0;
+        
+        // Sync hands OBS future timestamps to wait for; off, OBS shows frames as they come
+        context->sync_mode = context->sync_setting;
+        context->sync_late_frames = 0;
+        context->media_clock.reset(context->sync_mode == SYNC_PTP ? MediaClock::Reference::PTP
+                                                                  : MediaClock::Reference::FIRST_PACKET,
+                                   90000, context->audio_format.sample_rate);
+        obs_source_set_async_unbuffered(context->source, context->sync_mode == SYNC_OFF);
+        if (context->sync_mode != SYNC_OFF) {
+            blog(LOG_INFO, "[JPEG XS] A/V sync on (%s reference), %u ms playout delay",
+                 context->sync_mode == SYNC_PTP ? "PTP" : "first packet", context->sync_delay_ms);
         }
         
-        context->decoder = std::make_unique<JpegXSDecoder>();
-        context->decoder->initialize(0, 0, threads);
+        // Receive-side placement; the NUMA node defaults to the receiving NIC's
+        PlacementPlan plan;
+        plan.cpusFor(ThreadRole::NETWORK) = jpegxs::CpuSet::parse(context->placement_receive_cpus);
+        plan.cpusFor(ThreadRole::AUDIO) = plan.cpusFor(ThreadRole::NETWORK);
+        plan.cpusFor(ThreadRole::DECODE) = jpegxs::CpuSet::parse(context->placement_decode_cpus);
+        plan.realtime = context->placement_realtime;
+        if (context->placement_numa_node >= 0) {
+            plan.numa_node = context->placement_numa_node;
+        } else if (context->placement_numa_node == -1) {
+            plan.numa_node = ThreadPlacement::numaNodeForInterface(context->st2110_interface_ip);
+        }
+        context->placement = plan;
+        if (plan.active()) {
+            blog(LOG_INFO, "[JPEG XS] Thread placement: NUMA node %d, receive [%s], decode [%s]%s",
+                 plan.numa_node, plan.cpusFor(ThreadRole::NETWORK).toString().c_str(),
+                 plan.cpusFor(ThreadRole::DECODE).toString().c_str(), plan.realtime ? ", real-time" : "");
+        }
+        
+        context->decode_threads = threads;
+        context->proxy_mode = wanted_proxy_mode(context);
+        context->decoder = create_decoder(context, threads, true);
+        // One buffer per pipelined frame plus the one being output
+        context->frame_pool = std::make_unique<DecodeBufferPool>(context->pipeline_depth + 1);
         
         context->rtp_depacketizer = std::make_unique<RTPDepacketizer>();
+        context->srt_depacketizer = std::make_unique<SRTMessageDepacketizer>();
         context->active = true;
         
+        context->decode_queue = std::make_unique<DecodeQueue>();
+        context->concealer = std::make_unique<SliceConcealer>();
+        context->pipeline_stopping = false;
+        context->frame_ready = false;
+        context->output_thread = std::thread(output_loop, context);
+        context->decode_thread = std::thread(decode_loop, context);
+        
         if (context->mode == MODE_SRT) {
             SRTTransport::Config srt_config;
             srt_config.mode = SRTTransport::Mode::LISTENER;
@@ -621,6 +1405,8 @@ static void jpegxs_source_show(void *data)
             srt_config.address = "0.0.0.0";
             srt_config.latency_ms = context->srt_latency_ms;
             srt_config.passphrase = context->srt_passphrase;
+            srt_config.placement = context->placement;
+            srt_config.accept_groups = true;  // Bonded senders: one stream, duplicates dropped
             
             context->srt_transport = std::make_unique<SRTTransport>(srt_config);
             context->srt_transport->start();
@@ -648,7 +1434,39 @@ static void jpegxs_source_show(void *data)
             }
             
             // Audio UDP Socket
-            if (context->st2110_audio_port > 0) {
+            // With the jitter buffer every packet goes in on its own timestamp
+            // and audio_batch_ms sets the playout block instead
+            context->audio_receiver = std::make_unique<AudioReceiver>();
+            uint32_t receive_batch_ms = context->audio_jitter_enabled ? 0 : context->audio_batch_ms;
+            if (!context->audio_receiver->configure(context->audio_format, receive_batch_ms)) {
+                blog(LOG_ERROR, "[JPEG XS] Unsupported audio format L%d/%u/%u", context->audio_format.bit_depth,
+                     context->audio_format.sample_rate, context->audio_format.channels);
+            } else if (context->st2110_audio_port > 0) {
+                const AudioReceiver::Format &af = context->audio_receiver->format();
+                if (af.channels > 8) {
+                    blog(LOG_WARNING, "[JPEG XS] Audio has %u channels; OBS takes 8, the rest are dropped", af.channels);
+                }
+                context->audio_jitter.reset();
+                if (context->audio_jitter_enabled) {
+                    AudioJitterBuffer::Config jitter_config;
+                    jitter_config.channels = af.channels;
+                    jitter_config.sample_rate = af.sample_rate;
+                    jitter_config.min_depth_ms = context->audio_min_depth_ms;
+                    jitter_config.max_depth_ms = std::max(context->audio_min_depth_ms, jitter_config.max_depth_ms);
+                    jitter_config.pull_frames = std::max(1u, af.sample_rate * std::max(1u, context->audio_batch_ms) / 1000);
+                    context->audio_jitter = std::make_unique<AudioJitterBuffer>();
+                    context->audio_jitter->configure(jitter_config);
+                    context->audio_playout_base_ns = 0;
+                    context->audio_stats_log_ns = os_gettime_ns();
+                }
+                uint32_t max_frames = context->audio_receiver->max_batch_frames();
+                if (context->audio_jitter) max_frames = context->audio_jitter->config().pull_frames;
+                context->audio_silence.assign(max_frames, 0.0f);
+                blog(LOG_INFO, "[JPEG XS] Audio L%d %u Hz, %u channels, %u ms pushes (%s), jitter buffer %s", af.bit_depth,
+                     af.sample_rate, af.channels, context->audio_batch_ms,
+                     PixelRepacker::isa_name(context->audio_receiver->isa()),
+                     context->audio_jitter ? "on" : "off");
+                
                 context->audio_udp_socket = std::make_unique<UDPSocket>();
                 if (context->audio_udp_socket->bind(context->st2110_audio_port, context->st2110_interface_ip.empty() ? "0.0.0.0" : context->st2110_interface_ip)) {
                     blog(LOG_INFO, "[JPEG XS] Bound to Audio UDP port %u", context->st2110_audio_port);
@@ -681,6 +1499,64 @@ static void jpegxs_source_hide(void *data)
     if (context->audio_thread.joinable()) {
         context->audio_thread.join();
     }
+    if (context->audio_receiver) {
+        AudioReceiver::Stats audio = context->audio_receiver->get_stats();
+        blog(LOG_INFO, "[JPEG XS Source] Audio: %llu packets, %llu pushes, %llu malformed",
+             (unsigned long long)audio.packets, (unsigned long long)audio.batches,
+             (unsigned long long)audio.malformed);
+        context->audio_receiver.reset();
+    }
+    if (context->sync_mode != SYNC_OFF) {
+        MediaClock::Stats sync = context->media_clock.get_stats();
+        blog(LOG_INFO, "[JPEG XS Source] A/V sync: transit video %.1f ms, audio %.1f ms%s%s, epoch offset %lld s, %llu re-anchors, %llu frames late",
+             sync.transit_ms[MediaClock::VIDEO], sync.transit_ms[MediaClock::AUDIO],
+             sync.own_epoch[MediaClock::VIDEO] ? " (video on its own epoch)" : "",
+             sync.own_epoch[MediaClock::AUDIO] ? " (audio on its own epoch)" : "",
+             (long long)sync.epoch_offset_s, (unsigned long long)sync.reanchors,
+             (unsigned long long)context->sync_late_frames.load());
+    }
+    if (context->audio_jitter) {
+        AudioJitterBuffer::Stats jitter = context->audio_jitter->get_stats();
+        blog(LOG_INFO, "[JPEG XS Source] Audio jitter buffer: drift %+.1f ppm, %llu underruns, %llu late packets, %llu frames skipped, %llu resyncs",
+             jitter.drift_ppm, (unsigned long long)jitter.underruns, (unsigned long long)jitter.late_packets,
+             (unsigned long long)jitter.skipped_frames, (unsigned long long)jitter.resyncs);
+        context->audio_jitter.reset();
+    }
+    
+    if (context->decode_queue) {
+        DecodeQueue::Stats queue = context->decode_queue->get_stats();
+        blog(LOG_INFO, "[JPEG XS Source] Decode queue: %llu frames queued, %llu skipped, max depth %zu",
+             (unsigned long long)queue.queued, (unsigned long long)queue.skipped, queue.max_depth);
+        context->decode_queue->stop();
+    }
+    if (context->decode_thread.joinable()) {
+        context->decode_thread.join();
+    }
+    context->thread_share.leave();
+    if (context->concealer && context->rtp_depacketizer) {
+        SliceConcealer::Stats concealment = context->concealer->get_stats();
+        const RTPDepacketizer::Stats &network = context->rtp_depacketizer->getStats();
+        blog(LOG_INFO, "[JPEG XS Source] Loss: %u packets, %u damaged frames; concealed %llu slices in %llu frames, %llu frames unrepairable",
+             network.packets_lost, network.frames_damaged,
+             (unsigned long long)concealment.concealed_slices, (unsigned long long)concealment.concealed_frames,
+             (unsigned long long)concealment.unrepairable_frames);
+        if (context->srt_depacketizer && context->srt_depacketizer->getStats().messages_received > 0) {
+            const SRTMessageDepacketizer::Stats &native = context->srt_depacketizer->getStats();
+            blog(LOG_INFO, "[JPEG XS Source] Native SRT framing: %u messages, %u gaps, %u frames (%u damaged, %u slices), %u dropped",
+                 native.messages_received, native.gaps, native.frames_assembled, native.frames_damaged,
+                 native.slices_damaged, native.frames_dropped);
+        }
+    }
+    
+    // The output thread finishes whatever is still in SVT before exiting
+    {
+        std::lock_guard<std::mutex> lock(context->pipeline_mutex);
+        context->pipeline_stopping = true;
+    }
+    context->pipeline_cv.notify_all();
+    if (context->output_thread.joinable()) {
+        context->output_thread.join();
+    }
     
     if (context->srt_transport) {
         context->srt_transport->stop();
@@ -697,8 +1573,22 @@ static void jpegxs_source_hide(void *data)
         context->audio_udp_socket.reset();
     }
     
+    std::string memory = MemoryAccounting::summary();
+    if (!memory.empty()) {
+        blog(LOG_INFO, "[JPEG XS Source] Memory: %s", memory.c_str());
+    }
+    
     context->rtp_depacketizer.reset();
+    context->srt_depacketizer.reset();
+    context->decode_queue.reset();
+    context->concealer.reset();
     context->decoder.reset();
+    context->stripe_decoders.clear();
+    context->frame_pool.reset();
+    
+    if (context->placement.active()) {
+        log_thread_placement();
+    }
     
     blog(LOG_INFO, "[JPEG XS] Source stopped");
 }
@@ -759,12 +1649,61 @@ static obs_properties_t *jpegxs_source_properties(void *unused)
     obs_properties_add_int(fmt_props, "manual_fps_num", "FPS Numerator", 0, 120000, 1);
     obs_properties_add_int(fmt_props, "manual_fps_den", "FPS Denominator", 0, 1001, 1);
     
+    obs_properties_add_int(fmt_props, "audio_channels", "Audio Channels", 1, 16, 1);
+    obs_property_t *p_depth = obs_properties_add_list(fmt_props, "audio_bit_depth", "Audio Format",
+                                                      OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_depth, "L24", 24);
+    obs_property_list_add_int(p_depth, "L16", 16);
+    obs_property_set_long_description(p_depth, "Used without an SDP file; an SDP's audio rtpmap sets the format, rate and channel count.");
+    obs_property_t *p_batch = obs_properties_add_int(fmt_props, "audio_batch_ms", "Audio Push Interval (ms)", 1, 20, 1);
+    obs_property_set_long_description(p_batch, "Audio is handed to OBS in blocks of this length. 1 ms adds no latency; longer pushes cut per-packet overhead in OBS's audio path.");
+    obs_property_t *p_jitter = obs_properties_add_bool(fmt_props, "audio_jitter_buffer", "Audio Jitter Buffer");
+    obs_property_set_long_description(p_jitter, "Orders audio by RTP timestamp and plays it out at a steady depth that follows the network jitter, resampling slightly to track the sender's clock. Off, packets go to OBS as they arrive.");
+    obs_properties_add_int(fmt_props, "audio_min_depth_ms", "Minimum Audio Buffer (ms)", 1, 200, 1);
+    
+    obs_property_t *p_sync = obs_properties_add_list(fmt_props, "av_sync", "A/V Sync",
+                                                     OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_sync, "Off (lowest latency)", SYNC_OFF);
+    obs_property_list_add_int(p_sync, "PTP media clock", SYNC_PTP);
+    obs_property_list_add_int(p_sync, "Anchor on first packet", SYNC_FIRST_PACKET);
+    obs_property_set_long_description(p_sync, "Off, video and audio are shown as they arrive and each keeps its own latency. On, both are placed by their RTP timestamps and presented together after the playout delay. PTP needs this machine's system clock disciplined to the sender's grandmaster (e.g. ptp4l and phc2sys); first-packet anchoring works without it as long as the sender stamps both streams from one clock, as ST 2110 senders do. Takes effect the next time the source is shown.");
+    obs_property_t *p_delay = obs_properties_add_int(fmt_props, "av_sync_delay_ms", "Playout Delay (ms)", 20, 1000, 10);
+    obs_property_set_long_description(p_delay, "Time from capture at the sender to presentation. It must cover network transit, the audio buffer and decoding; frames that miss it are counted as late in the log.");
+    
+    obs_property_t *p_res = obs_properties_add_list(fmt_props, "decode_resolution", "Decode Resolution",
+                                                    OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_res, "Full", DECODE_FULL);
+    obs_property_list_add_int(p_res, "Half (1/4 CPU)", DECODE_HALF);
+    obs_property_list_add_int(p_res, "Quarter (1/16 CPU)", DECODE_QUARTER);
+    obs_property_list_add_int(p_res, "Auto (Match Scene Size)", DECODE_AUTO);
+    obs_property_set_long_description(p_res, "Proxy decoding skips the finest wavelet levels. Auto picks the smallest resolution that still covers every scene item showing this source; items need a bounding box (e.g. Fit to Screen), as an unbounded item would change size with the picture and keeps Auto at Full.");
+    
+    obs_property_t *p_out = obs_properties_add_list(fmt_props, "output_format", "Output Format",
+                                                    OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_out, "Semi-planar (NV12/P010/P216/P416)", OUTPUT_SEMI_PLANAR);
+    obs_property_list_add_int(p_out, "Planar (I420/I010/I210/I412)", OUTPUT_PLANAR);
+    obs_property_set_long_description(p_out, "Semi-planar frames are interleaved on the decode thread and sampled by OBS as is; planar 10-bit frames need an extra conversion pass on the render thread. 8-bit 4:2:2 and 4:4:4 are always planar. The stats log shows the conversion time and OBS's render-thread frame time for comparing the two.");
+    
     obs_properties_add_group(props, "group_format", "Format & Decoding", OBS_GROUP_NORMAL, fmt_props);
 
     // Group: Advanced
     obs_properties_t *adv_props = obs_properties_create();
     obs_property_t *p_thread = obs_properties_add_int(adv_props, "threads", "Decoder Threads", 0, 64, 1);
-    obs_property_set_long_description(p_thread, "Set to 0 for auto-detection based on CPU cores.");
+    obs_property_set_long_description(p_thread, "Set to 0 to share the machine's cores with the other JPEG XS sources, weighted by the resolution and frame rate each decodes. A fixed count is taken off the shared budget.");
+    obs_property_t *p_pipe = obs_properties_add_int(adv_props, "decode_pipeline_depth", "Frames In Flight", 1, 4, 1);
+    obs_property_set_long_description(p_pipe, "Frames handed to the decoder before the oldest is collected. 2 or more keeps all decoder threads busy between frames at 4K60+; 1 decodes one frame at a time. Applied when the source is next shown.");
+    obs_properties_add_text(adv_props, "placement_receive_cpus", "Receive Thread CPUs (e.g. 2-3)", OBS_TEXT_DEFAULT);
+    obs_property_t *p_dec_cpus = obs_properties_add_text(adv_props, "placement_decode_cpus", "Decoder Worker CPUs (e.g. 4-11)", OBS_TEXT_DEFAULT);
+    obs_property_set_long_description(p_dec_cpus, "SVT-JPEG-XS decoder threads inherit this set when they are created on the first frame.");
+    obs_property_t *p_numa = obs_properties_add_list(adv_props, "placement_numa_node", "NUMA Node",
+                                                     OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_numa, "Off", -2);
+    obs_property_list_add_int(p_numa, "Auto (Interface IP's NIC)", -1);
+    for (int node = 0; node < 8; node++) {
+        std::string label = "Node " + std::to_string(node);
+        obs_property_list_add_int(p_numa, label.c_str(), node);
+    }
+    obs_properties_add_bool(adv_props, "placement_realtime", "Real-Time Priority");
     
     obs_properties_add_group(props, "group_advanced", "Advanced", OBS_GROUP_NORMAL, adv_props);
     
@@ -787,6 +1726,20 @@ static void jpegxs_source_get_defaults(obs_data_t *settings)
     obs_data_set_default_int(settings, "manual_height", 1080);
     obs_data_set_default_int(settings, "manual_fps_num", 60000);
     obs_data_set_default_int(settings, "manual_fps_den", 1001);
+    obs_data_set_default_int(settings, "audio_channels", 2);
+    obs_data_set_default_int(settings, "audio_bit_depth", 16);
+    obs_data_set_default_int(settings, "audio_batch_ms", 1);
+    obs_data_set_default_bool(settings, "audio_jitter_buffer", true);
+    obs_data_set_default_int(settings, "audio_min_depth_ms", 5);
+    obs_data_set_default_int(settings, "av_sync", SYNC_OFF);
+    obs_data_set_default_int(settings, "av_sync_delay_ms", 150);
+    obs_data_set_default_int(settings, "decode_resolution", DECODE_FULL);
+    obs_data_set_default_int(settings, "output_format", OUTPUT_SEMI_PLANAR);
 
     obs_data_set_default_int(settings, "threads", 0);
+    obs_data_set_default_int(settings, "decode_pipeline_depth", 2);
+    obs_data_set_default_string(settings, "placement_receive_cpus", "");
+    obs_data_set_default_string(settings, "placement_decode_cpus", "");
+    obs_data_set_default_int(settings, "placement_numa_node", -2);
+    obs_data_set_default_bool(settings, "placement_realtime", false);
 }
@@ -0,0 +1,225 @@
+/*
+ * Semi-Planar Output Implementation
+ */
+
+#include "semi_planar.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define JPEGXS_SEMI_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define JPEGXS_SEMI_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#if defined(JPEGXS_SEMI_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define JPEGXS_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define JPEGXS_TARGET(isa)
+#endif
+
+namespace jpegxs {
+
+namespace {
+
+void interleave8_scalar(const uint8_t *u, const uint8_t *v, uint8_t *dst, size_t samples)
+{
+    for (size_t x = 0; x < samples; x++) {
+        dst[2 * x] = u[x];
+        dst[2 * x + 1] = v[x];
+    }
+}
+
+void interleave16_scalar(const uint16_t *u, const uint16_t *v, uint16_t *dst, size_t samples, int shift)
+{
+    for (size_t x = 0; x < samples; x++) {
+        dst[2 * x] = (uint16_t)(u[x] << shift);
+        dst[2 * x + 1] = (uint16_t)(v[x] << shift);
+    }
+}
+
+void shift16_scalar(uint16_t *samples, size_t count, int shift)
+{
+    for (size_t x = 0; x < count; x++) {
+        samples[x] = (uint16_t)(samples[x] << shift);
+    }
+}
+
+#ifdef JPEGXS_SEMI_X86
+JPEGXS_TARGET("sse4.1")
+void interleave8_sse41(const uint8_t *u, const uint8_t *v, uint8_t *dst, size_t samples)
+{
+    size_t x = 0;
+    for (; x + 16 <= samples; x += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(u + x));
+        __m128i b = _mm_loadu_si128((const __m128i *)(v + x));
+        _mm_storeu_si128((__m128i *)(dst + 2 * x), _mm_unpacklo_epi8(a, b));
+        _mm_storeu_si128((__m128i *)(dst + 2 * x + 16), _mm_unpackhi_epi8(a, b));
+    }
+    interleave8_scalar(u + x, v + x, dst + 2 * x, samples - x);
+}
+
+JPEGXS_TARGET("avx2")
+void interleave8_avx2(const uint8_t *u, const uint8_t *v, uint8_t *dst, size_t samples)
+{
+    size_t x = 0;
+    for (; x + 32 <= samples; x += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(u + x));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(v + x));
+        // unpack works per 128-bit lane; regroup the lanes into sample order
+        __m256i lo = _mm256_unpacklo_epi8(a, b);
+        __m256i hi = _mm256_unpackhi_epi8(a, b);
+        _mm256_storeu_si256((__m256i *)(dst + 2 * x), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * x + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    interleave8_sse41(u + x, v + x, dst + 2 * x, samples - x);
+}
+
+JPEGXS_TARGET("sse4.1")
+void interleave16_sse41(const uint16_t *u, const uint16_t *v, uint16_t *dst, size_t samples, int shift)
+{
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    size_t x = 0;
+    for (; x + 8 <= samples; x += 8) {
+        __m128i a = _mm_sll_epi16(_mm_loadu_si128((const __m128i *)(u + x)), count);
+        __m128i b = _mm_sll_epi16(_mm_loadu_si128((const __m128i *)(v + x)), count);
+        _mm_storeu_si128((__m128i *)(dst + 2 * x), _mm_unpacklo_epi16(a, b));
+        _mm_storeu_si128((__m128i *)(dst + 2 * x + 8), _mm_unpackhi_epi16(a, b));
+    }
+    interleave16_scalar(u + x, v + x, dst + 2 * x, samples - x, shift);
+}
+
+JPEGXS_TARGET("avx2")
+void interleave16_avx2(const uint16_t *u, const uint16_t *v, uint16_t *dst, size_t samples, int shift)
+{
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    size_t x = 0;
+    for (; x + 16 <= samples; x += 16) {
+        __m256i a = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i *)(u + x)), count);
+        __m256i b = _mm256_sll_epi16(_mm256_loadu_si256((const __m256i *)(v + x)), count);
+        __m256i lo = _mm256_unpacklo_epi16(a, b);
+        __m256i hi = _mm256_unpackhi_epi16(a, b);
+        _mm256_storeu_si256((__m256i *)(dst + 2 * x), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * x + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    interleave16_sse41(u + x, v + x, dst + 2 * x, samples - x, shift);
+}
+
+JPEGXS_TARGET("sse4.1")
+void shift16_sse41(uint16_t *samples, size_t count, int shift)
+{
+    const __m128i bits = _mm_cvtsi32_si128(shift);
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(samples + x));
+        _mm_storeu_si128((__m128i *)(samples + x), _mm_sll_epi16(a, bits));
+    }
+    shift16_scalar(samples + x, count - x, shift);
+}
+
+JPEGXS_TARGET("avx2")
+void shift16_avx2(uint16_t *samples, size_t count, int shift)
+{
+    const __m128i bits = _mm_cvtsi32_si128(shift);
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(samples + x));
+        _mm256_storeu_si256((__m256i *)(samples + x), _mm256_sll_epi16(a, bits));
+    }
+    shift16_sse41(samples + x, count - x, shift);
+}
+#endif
+
+#ifdef JPEGXS_SEMI_NEON
+void interleave8_neon(const uint8_t *u, const uint8_t *v, uint8_t *dst, size_t samples)
+{
+    size_t x = 0;
+    for (; x + 16 <= samples; x += 16) {
+        uint8x16x2_t pair = { { vld1q_u8(u + x), vld1q_u8(v + x) } };
+        vst2q_u8(dst + 2 * x, pair);
+    }
+    interleave8_scalar(u + x, v + x, dst + 2 * x, samples - x);
+}
+
+void interleave16_neon(const uint16_t *u, const uint16_t *v, uint16_t *dst, size_t samples, int shift)
+{
+    const int16x8_t bits = vdupq_n_s16((int16_t)shift);
+    size_t x = 0;
+    for (; x + 8 <= samples; x += 8) {
+        uint16x8x2_t pair = { { vshlq_u16(vld1q_u16(u + x), bits), vshlq_u16(vld1q_u16(v + x), bits) } };
+        vst2q_u16(dst + 2 * x, pair);
+    }
+    interleave16_scalar(u + x, v + x, dst + 2 * x, samples - x, shift);
+}
+
+void shift16_neon(uint16_t *samples, size_t count, int shift)
+{
+    const int16x8_t bits = vdupq_n_s16((int16_t)shift);
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        vst1q_u16(samples + x, vshlq_u16(vld1q_u16(samples + x), bits));
+    }
+    shift16_scalar(samples + x, count - x, shift);
+}
+#endif
+
+} // namespace
+
+SemiPlanarConverter::SemiPlanarConverter()
+    : isa_(PixelRepacker::detect_isa())
+    , interleave8_(interleave8_scalar)
+    , interleave16_(interleave16_scalar)
+    , shift16_(shift16_scalar)
+{
+    switch (isa_) {
+#ifdef JPEGXS_SEMI_X86
+    case RepackIsa::AVX512:
+    case RepackIsa::AVX2:
+        interleave8_ = interleave8_avx2;
+        interleave16_ = interleave16_avx2;
+        shift16_ = shift16_avx2;
+        break;
+    case RepackIsa::SSE41:
+        interleave8_ = interleave8_sse41;
+        interleave16_ = interleave16_sse41;
+        shift16_ = shift16_sse41;
+        break;
+#endif
+#ifdef JPEGXS_SEMI_NEON
+    case RepackIsa::NEON:
+        interleave8_ = interleave8_neon;
+        interleave16_ = interleave16_neon;
+        shift16_ = shift16_neon;
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
+bool SemiPlanarConverter::supported(int bit_depth, int format)
+{
+    // NV12, or P010/P216/P416 for 10 and 12 bit; 8-bit 4:2:2/4:4:4 stay planar
+    if (bit_depth == 8) return format == 2;
+    return bit_depth <= 16 && (format == 2 || format == 3 || format == 4);
+}
+
+void SemiPlanarConverter::convert(DecodeBuffer *buffer) const
+{
+    // Tightly strided planes are one run of samples each
+    if (buffer->bit_depth == 8) {
+        interleave8_(buffer->planes[1], buffer->planes[2], buffer->interleaved, buffer->plane_size[1]);
+        return;
+    }
+
+    int shift = 16 - buffer->bit_depth;
+    size_t luma_samples = buffer->plane_size[0] / 2;
+    size_t chroma_samples = buffer->plane_size[1] / 2;
+    if (shift > 0) {
+        shift16_((uint16_t *)buffer->planes[0], luma_samples, shift);
+    }
+    interleave16_((const uint16_t *)buffer->planes[1], (const uint16_t *)buffer->planes[2],
+                  (uint16_t *)buffer->interleaved, chroma_samples, shift);
+}
+
+} // namespace jpegxs
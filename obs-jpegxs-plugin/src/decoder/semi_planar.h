@@ -0,0 +1,51 @@
+/*
+ * Semi-Planar Output
+ * Turns decoded planar pictures into the NV12/P010/P216/P416 layouts OBS renders natively
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "decode_buffer_pool.h"
+#include "../encoder/pixel_repack.h"
+
+namespace jpegxs {
+
+/**
+ * Semi-Planar Converter
+ * SVT-JPEG-XS only writes planar pictures. OBS takes semi-planar frames as
+ * two planes and samples them directly, where planar I010/I210/I412 go
+ * through a conversion pass on the render thread first. Converting here
+ * costs one pass over the chroma (and, above 8 bits, the luma) on the
+ * decode side:
+ *   - U and V are interleaved into DecodeBuffer::interleaved
+ *   - >8-bit samples are moved to the top of their 16-bit container, as
+ *     P010/P216/P416 expect (in place for luma)
+ * Kernels are picked at runtime like PixelRepacker's.
+ */
+class SemiPlanarConverter {
+public:
+    SemiPlanarConverter();
+
+    // Whether a picture of this depth/format has a semi-planar OBS format
+    static bool supported(int bit_depth, int format);
+
+    // buffer must have been acquired with semi_planar and be supported()
+    void convert(DecodeBuffer *buffer) const;
+
+    RepackIsa isa() const { return isa_; }
+
+private:
+    using Interleave8Fn = void (*)(const uint8_t *u, const uint8_t *v, uint8_t *dst, size_t samples);
+    using Interleave16Fn = void (*)(const uint16_t *u, const uint16_t *v, uint16_t *dst, size_t samples, int shift);
+    using Shift16Fn = void (*)(uint16_t *samples, size_t count, int shift);
+
+    RepackIsa isa_;
+    Interleave8Fn interleave8_;
+    Interleave16Fn interleave16_;
+    Shift16Fn shift16_;
+};
+
+} // namespace jpegxs
@@ -0,0 +1,123 @@
+/*
+ * Slice Concealment Implementation
+ */
+
+#include "slice_concealment.h"
+#include <cstring>
+
+namespace jpegxs {
+
+bool SliceConcealer::conceal(std::vector<uint8_t> &codestream, const std::vector<SliceSpan> &slices)
+{
+    if (slices.empty()) return true;
+
+    CodestreamSlices::Layout layout;
+    if (!CodestreamSlices::parseHeader(codestream.data(), codestream.size(), layout) ||
+        slices.front().offset != layout.header_size) {
+        stats_.unrepairable_frames++;
+        return false;
+    }
+
+    slice_lookup_.assign(layout.slice_count, -1);
+    size_t usable = 0;
+    for (size_t i = 0; i < slices.size(); i++) {
+        const SliceSpan &slice = slices[i];
+        if (slice.intact && slice.index < layout.slice_count && slice_lookup_[slice.index] < 0) {
+            slice_lookup_[slice.index] = (int)i;
+            usable++;
+        }
+    }
+
+    if (usable == layout.slice_count) {
+        keep_reference(codestream, layout, slices);
+        return true;
+    }
+
+    if (reference_.empty() || !same_header(codestream, layout)) {
+        stats_.unrepairable_frames++;
+        return false;
+    }
+
+    // Header, then every slice from this frame where it arrived whole and
+    // from the reference where it didn't
+    scratch_.assign(codestream.begin(), codestream.begin() + layout.header_size);
+    for (uint32_t index = 0; index < layout.slice_count; index++) {
+        const uint8_t *src;
+        size_t size;
+        if (slice_lookup_[index] >= 0) {
+            const SliceSpan &slice = slices[slice_lookup_[index]];
+            src = codestream.data() + slice.offset;
+            size = slice.size;
+        } else {
+            const SliceSpan &slice = reference_slices_[index];
+            src = reference_.data() + slice.offset;
+            size = slice.size;
+            stats_.concealed_slices++;
+        }
+        scratch_.insert(scratch_.end(), src, src + size);
+    }
+
+    // Lcod must match the spliced length, or the decoder rejects the frame
+    if (CodestreamSlices::codestreamLength(codestream.data(), layout) != 0) {
+        CodestreamSlices::setCodestreamLength(scratch_.data(), layout, (uint32_t)scratch_.size());
+    }
+    codestream.swap(scratch_);
+    stats_.concealed_frames++;
+
+    // The repaired frame is the next reference, so a slice lost in
+    // consecutive frames keeps its last good content
+    std::vector<SliceSpan> repaired;
+    repaired.swap(reference_slices_);
+    size_t offset = layout.header_size;
+    for (uint32_t index = 0; index < layout.slice_count; index++) {
+        size_t size = (slice_lookup_[index] >= 0) ? slices[slice_lookup_[index]].size : repaired[index].size;
+        repaired[index].offset = offset;
+        repaired[index].size = size;
+        repaired[index].intact = true;
+        offset += size;
+    }
+    reference_slices_.swap(repaired);
+    reference_.assign(codestream.begin(), codestream.end());
+    reference_layout_ = layout;
+    update_memory_usage();
+    return true;
+}
+
+bool SliceConcealer::same_header(const std::vector<uint8_t> &codestream, const CodestreamSlices::Layout &layout) const
+{
+    // Everything but Lcod, which follows the frame's size
+    const CodestreamSlices::Layout &ref = reference_layout_;
+    if (layout.header_size != ref.header_size || layout.lcod_offset != ref.lcod_offset ||
+        layout.slice_count != ref.slice_count) {
+        return false;
+    }
+    size_t lcod_end = layout.lcod_offset + 4;
+    return std::memcmp(codestream.data(), reference_.data(), layout.lcod_offset) == 0 &&
+           std::memcmp(codestream.data() + lcod_end, reference_.data() + lcod_end, layout.header_size - lcod_end) == 0;
+}
+
+void SliceConcealer::keep_reference(const std::vector<uint8_t> &codestream, const CodestreamSlices::Layout &layout,
+                                    const std::vector<SliceSpan> &slices)
+{
+    reference_.assign(codestream.begin(), codestream.end());
+    reference_slices_.resize(layout.slice_count);
+    for (uint32_t index = 0; index < layout.slice_count; index++) {
+        reference_slices_[index] = slices[slice_lookup_[index]];
+    }
+    reference_layout_ = layout;
+    update_memory_usage();
+}
+
+void SliceConcealer::reset()
+{
+    reference_.clear();
+    reference_slices_.clear();
+    stats_ = Stats();
+}
+
+void SliceConcealer::update_memory_usage()
+{
+    memory_.set(reference_.capacity() + scratch_.capacity());
+}
+
+} // namespace jpegxs
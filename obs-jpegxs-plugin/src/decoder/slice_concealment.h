@@ -0,0 +1,73 @@
+/*
+ * Slice Concealment
+ * Rebuilds codestreams that lost slices from the previous frame's slices
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../network/codestream_slices.h"
+#include "../network/memory_accounting.h"
+
+namespace jpegxs {
+
+/**
+ * Slice Concealer
+ * JPEG XS slices decode independently, so a slice the network damaged is
+ * replaced by the same slice of the last whole codestream and decodes to
+ * the previous frame's pixels for those rows. The rest of the frame stays
+ * live. Keeps one codestream as the reference (compressed, so a copy per
+ * frame is cheap next to the decode).
+ */
+class SliceConcealer {
+public:
+    SliceConcealer() = default;
+
+    SliceConcealer(const SliceConcealer &) = delete;
+    SliceConcealer &operator=(const SliceConcealer &) = delete;
+
+    /**
+     * Make `codestream` whole, replacing missing or damaged slices in place.
+     * @param slices As delivered by RTPDepacketizer; empty for senders
+     *               without slice mode, which are passed through untouched
+     * @return false if the frame can't be repaired (no reference yet, or the
+     *         stream's header changed) and should be dropped
+     */
+    bool conceal(std::vector<uint8_t> &codestream, const std::vector<SliceSpan> &slices);
+
+    void reset();
+
+    struct Stats {
+        uint64_t concealed_slices = 0;
+        uint64_t concealed_frames = 0;
+        uint64_t unrepairable_frames = 0;  // Damaged with nothing to conceal from
+    };
+
+    Stats get_stats() const { return stats_; }
+
+    // Bytes held by the reference and scratch codestreams (counted under MemoryComponent::DEPACKETIZER)
+    size_t get_memory_usage() const { return memory_.bytes(); }
+
+private:
+    bool same_header(const std::vector<uint8_t> &codestream, const CodestreamSlices::Layout &layout) const;
+    void keep_reference(const std::vector<uint8_t> &codestream, const CodestreamSlices::Layout &layout,
+                        const std::vector<SliceSpan> &slices);
+    void update_memory_usage();
+
+    // Last whole codestream and where its slices are
+    std::vector<uint8_t> reference_;
+    std::vector<SliceSpan> reference_slices_;
+    CodestreamSlices::Layout reference_layout_;
+
+    std::vector<uint8_t> scratch_;
+    std::vector<int> slice_lookup_;   // Slice index -> entry in the frame's slices, -1 if unusable
+
+    Stats stats_;
+
+    MemoryAccounting::Tracker memory_{MemoryComponent::DEPACKETIZER};
+};
+
+} // namespace jpegxs
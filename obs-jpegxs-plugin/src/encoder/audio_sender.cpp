@@ -0,0 +1,439 @@
+/*
+ * Audio Sender Implementation
+ */
+
+#include "audio_sender.h"
+#include "../network/ptp_clock.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define JPEGXS_AUDIO_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define JPEGXS_AUDIO_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#if defined(JPEGXS_AUDIO_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define JPEGXS_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define JPEGXS_TARGET(isa)
+#endif
+
+namespace jpegxs {
+
+namespace {
+
+const size_t RTP_HEADER_BYTES = 12;
+
+// Full scale; -1.0 maps to -max rather than the type minimum, as before
+const float L16_SCALE = 32767.0f;
+const float L24_SCALE = 8388607.0f;
+
+// Pacing. The first packet goes out after a short preroll so the next OBS
+// block (about 21 ms of audio) arrives before the ring runs dry; gaps
+// shorter than IDLE_RESET_NS keep the cadence
+const uint64_t PREROLL_NS = 5000000ULL;
+const uint64_t IDLE_RESET_NS = 50000000ULL;
+const uint64_t MAX_LATE_NS = 20000000ULL;
+const uint64_t SLEEP_THRESHOLD_NS = 200000ULL;
+const uint64_t SLEEP_MARGIN_NS = 100000ULL;
+
+uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline float clip(float sample)
+{
+    return std::min(std::max(sample, -1.0f), 1.0f);
+}
+
+void convert_l16_scalar(const float *src, uint8_t *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int32_t sample = (int32_t)std::lrintf(clip(src[i]) * L16_SCALE);
+        dst[2 * i] = (uint8_t)(sample >> 8);
+        dst[2 * i + 1] = (uint8_t)sample;
+    }
+}
+
+void convert_l24_scalar(const float *src, uint8_t *dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int32_t sample = (int32_t)std::lrintf(clip(src[i]) * L24_SCALE);
+        uint8_t *p = dst + 3 * i;
+        p[0] = (uint8_t)(sample >> 16);
+        p[1] = (uint8_t)(sample >> 8);
+        p[2] = (uint8_t)sample;
+    }
+}
+
+#ifdef JPEGXS_AUDIO_X86
+JPEGXS_TARGET("sse4.1")
+inline __m128i scale_sse41(const float *src, __m128 scale)
+{
+    __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src), _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+    return _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+}
+
+JPEGXS_TARGET("sse4.1")
+void convert_l16_sse41(const float *src, uint8_t *dst, size_t count)
+{
+    const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m128 scale = _mm_set1_ps(L16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_packs_epi32(scale_sse41(src + i, scale), scale_sse41(src + i + 4, scale));
+        _mm_storeu_si128((__m128i *)(dst + 2 * i), _mm_shuffle_epi8(s, swap));
+    }
+    convert_l16_scalar(src + i, dst + 2 * i, count - i);
+}
+
+JPEGXS_TARGET("sse4.1")
+void convert_l24_sse41(const float *src, uint8_t *dst, size_t count)
+{
+    // Low three bytes of four int32 lanes, most significant first, into 12 bytes
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m128 scale = _mm_set1_ps(L24_SCALE);
+    size_t i = 0;
+    // Each store writes 16 bytes for 12, so stop while 4 spare bytes remain
+    for (; 3 * i + 16 <= 3 * count; i += 4) {
+        __m128i s = _mm_shuffle_epi8(scale_sse41(src + i, scale), pack);
+        _mm_storeu_si128((__m128i *)(dst + 3 * i), s);
+    }
+    convert_l24_scalar(src + i, dst + 3 * i, count - i);
+}
+#endif
+
+#ifdef JPEGXS_AUDIO_NEON
+inline int32x4_t scale_neon(const float *src, float32x4_t scale)
+{
+    float32x4_t v = vminq_f32(vmaxq_f32(vld1q_f32(src), vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+    return vcvtnq_s32_f32(vmulq_f32(v, scale));
+}
+
+void convert_l16_neon(const float *src, uint8_t *dst, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(L16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t s = vcombine_s16(vqmovn_s32(scale_neon(src + i, scale)), vqmovn_s32(scale_neon(src + i + 4, scale)));
+        vst1q_u8(dst + 2 * i, vrev16q_u8(vreinterpretq_u8_s16(s)));
+    }
+    convert_l16_scalar(src + i, dst + 2 * i, count - i);
+}
+
+void convert_l24_neon(const float *src, uint8_t *dst, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(L24_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Eight samples split into their bytes, most significant first
+        uint32x4_t s0 = vreinterpretq_u32_s32(scale_neon(src + i, scale));
+        uint32x4_t s1 = vreinterpretq_u32_s32(scale_neon(src + i + 4, scale));
+        uint8x8x3_t b;
+        b.val[0] = vmovn_u16(vcombine_u16(vshrn_n_u32(s0, 16), vshrn_n_u32(s1, 16)));
+        b.val[1] = vmovn_u16(vcombine_u16(vshrn_n_u32(s0, 8), vshrn_n_u32(s1, 8)));
+        b.val[2] = vmovn_u16(vcombine_u16(vmovn_u32(s0), vmovn_u32(s1)));
+        vst3_u8(dst + 3 * i, b);
+    }
+    convert_l24_scalar(src + i, dst + 3 * i, count - i);
+}
+#endif
+
+AudioSender::ConvertFn select_convert(RepackIsa isa, int bit_depth)
+{
+    bool l24 = bit_depth == 24;
+    switch (isa) {
+#ifdef JPEGXS_AUDIO_X86
+    case RepackIsa::AVX512:
+    case RepackIsa::AVX2:
+    case RepackIsa::SSE41:
+        return l24 ? convert_l24_sse41 : convert_l16_sse41;
+#endif
+#ifdef JPEGXS_AUDIO_NEON
+    case RepackIsa::NEON:
+        return l24 ? convert_l24_neon : convert_l16_neon;
+#endif
+    default:
+        return l24 ? convert_l24_scalar : convert_l16_scalar;
+    }
+}
+
+// Planes to interleaved floats; fixed channel counts let the compiler unroll
+template <uint32_t Channels>
+void interleave_fixed(const float *const src[], float *dst, uint32_t frames)
+{
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t c = 0; c < Channels; c++) {
+            dst[f * Channels + c] = src[c][f];
+        }
+    }
+}
+
+void interleave(const float *const src[], float *dst, uint32_t channels, uint32_t frames)
+{
+    switch (channels) {
+    case 2: interleave_fixed<2>(src, dst, frames); return;
+    case 4: interleave_fixed<4>(src, dst, frames); return;
+    case 6: interleave_fixed<6>(src, dst, frames); return;
+    case 8: interleave_fixed<8>(src, dst, frames); return;
+    case 16: interleave_fixed<16>(src, dst, frames); return;
+    default:
+        for (uint32_t f = 0; f < frames; f++) {
+            for (uint32_t c = 0; c < channels; c++) {
+                dst[f * channels + c] = src[c][f];
+            }
+        }
+    }
+}
+
+// Nanoseconds spanned by a number of frames, split so the multiply can't overflow
+uint64_t frames_to_ns(uint64_t frames, uint32_t rate)
+{
+    return (frames / rate) * 1000000000ULL + (frames % rate) * 1000000000ULL / rate;
+}
+
+} // namespace
+
+AudioSender::AudioSender()
+    : isa_(PixelRepacker::detect_isa())
+{
+    std::random_device random;
+    ssrc_ = random();
+    configure(Config());
+}
+
+AudioSender::~AudioSender()
+{
+    stop();
+}
+
+bool AudioSender::configure(const Config &config)
+{
+    if ((config.bit_depth != 16 && config.bit_depth != 24) || config.channels < 1 ||
+        config.channels > MAX_CHANNELS || config.sample_rate == 0 || config.packet_time_us == 0) {
+        return false;
+    }
+
+    uint32_t packet_frames = (uint32_t)((uint64_t)config.sample_rate * config.packet_time_us / 1000000);
+    uint32_t frame_bytes = config.channels * (config.bit_depth / 8);
+    if (packet_frames == 0 || packet_frames * frame_bytes > MAX_PAYLOAD_BYTES) {
+        return false;
+    }
+
+    config_ = config;
+    convert_ = select_convert(isa_, config.bit_depth);
+    packet_frames_ = packet_frames;
+    frame_bytes_ = frame_bytes;
+    slot_bytes_ = (uint32_t)RTP_HEADER_BYTES + packet_frames * frame_bytes;
+    packet_ns_ = frames_to_ns(packet_frames, config.sample_rate);
+
+    uint64_t wanted = std::max<uint64_t>(2, (uint64_t)config.queue_ms * 1000 / config.packet_time_us);
+    slot_count_ = 1;
+    while (slot_count_ < wanted) slot_count_ <<= 1;
+    mask_ = slot_count_ - 1;
+
+    ring_.assign((size_t)slot_count_ * slot_bytes_, 0);
+    overflow_.assign(slot_bytes_, 0);
+    interleaved_.assign((size_t)packet_frames * config.channels, 0.0f);
+    silence_.assign(packet_frames, 0.0f);
+
+    // Fixed header fields: V=2, no padding/extension/CSRC, marker clear, PT, SSRC
+    for (uint32_t i = 0; i <= slot_count_; i++) {
+        uint8_t *p = i < slot_count_ ? slot(i) : overflow_.data();
+        p[0] = 0x80;
+        p[1] = config.payload_type & 0x7F;
+        p[8] = (uint8_t)(ssrc_ >> 24);
+        p[9] = (uint8_t)(ssrc_ >> 16);
+        p[10] = (uint8_t)(ssrc_ >> 8);
+        p[11] = (uint8_t)ssrc_;
+    }
+
+    memory_.set(ring_.capacity() + overflow_.capacity() +
+                (interleaved_.capacity() + silence_.capacity()) * sizeof(float));
+    return true;
+}
+
+void AudioSender::start()
+{
+    if (running_ || !sender_ || ring_.empty()) return;
+
+    std::random_device random;
+    seq_ = (uint16_t)random();
+    anchored_ = false;
+    fill_ = 0;
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    packets_ = 0;
+    overflows_ = 0;
+    send_errors_ = 0;
+    stalls_ = 0;
+    resyncs_ = 0;
+
+    running_ = true;
+    thread_ = std::thread(&AudioSender::send_loop, this);
+    accepting_ = true;
+}
+
+void AudioSender::stop()
+{
+    // Let a push() already past the accepting_ check finish with the ring
+    accepting_ = false;
+    while (pushing_.load() != 0) std::this_thread::yield();
+
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+}
+
+void AudioSender::push(const float *const planes[], uint32_t channels, uint32_t frames, uint64_t ptp_ns)
+{
+    pushing_.fetch_add(1);
+    if (!accepting_.load()) {
+        pushing_.fetch_sub(1);
+        return;
+    }
+
+    uint32_t stamp = PTPClock::rtp_timestamp(ptp_ns, config_.sample_rate);
+    if (!anchored_) {
+        anchored_ = true;
+        timestamp_ = stamp;
+    } else if ((uint32_t)std::abs((int32_t)(stamp - (timestamp_ + fill_))) > config_.sample_rate / 1000) {
+        if (fill_ > 0) pad_packet();
+        timestamp_ = stamp;
+        resyncs_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const uint32_t out_channels = config_.channels;
+    const float *chunk[MAX_CHANNELS];
+    uint32_t done = 0;
+    while (done < frames) {
+        if (fill_ == 0) {
+            uint32_t head = head_.load(std::memory_order_relaxed);
+            current_dropped_ = head - tail_.load(std::memory_order_acquire) >= slot_count_;
+            current_ = current_dropped_ ? overflow_.data() : slot(head);
+        }
+
+        uint32_t count = std::min(frames - done, packet_frames_ - fill_);
+        for (uint32_t c = 0; c < out_channels; c++) {
+            chunk[c] = c < channels && planes[c] ? planes[c] + done : silence_.data();
+        }
+        interleave(chunk, interleaved_.data(), out_channels, count);
+        convert_(interleaved_.data(), current_ + RTP_HEADER_BYTES + (size_t)fill_ * frame_bytes_,
+                 (size_t)count * out_channels);
+
+        fill_ += count;
+        done += count;
+        if (fill_ == packet_frames_) finish_packet();
+    }
+
+    pushing_.fetch_sub(1);
+}
+
+void AudioSender::finish_packet()
+{
+    uint8_t *p = current_;
+    p[2] = (uint8_t)(seq_ >> 8);
+    p[3] = (uint8_t)seq_;
+    p[4] = (uint8_t)(timestamp_ >> 24);
+    p[5] = (uint8_t)(timestamp_ >> 16);
+    p[6] = (uint8_t)(timestamp_ >> 8);
+    p[7] = (uint8_t)timestamp_;
+    seq_++;
+    timestamp_ += packet_frames_;
+    fill_ = 0;
+
+    if (current_dropped_) {
+        overflows_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
+
+void AudioSender::pad_packet()
+{
+    // Zero is silence in both formats
+    std::memset(current_ + RTP_HEADER_BYTES + (size_t)fill_ * frame_bytes_, 0,
+                (size_t)(packet_frames_ - fill_) * frame_bytes_);
+    finish_packet();
+}
+
+void AudioSender::send_loop()
+{
+    // Failures show up in the output's placement stats log
+    if (placement_.active()) {
+        ThreadPlacement::apply(placement_, ThreadRole::PACER, "jxs-audio");
+    }
+
+    const uint64_t idle_wait_ns = std::min<uint64_t>(packet_ns_ / 2, 500000ULL);
+    bool paced = false;
+    uint64_t anchor_ns = 0;
+    uint64_t sent = 0;  // Packets since anchor_ns
+
+    while (running_) {
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        uint32_t head = head_.load(std::memory_order_acquire);
+        uint64_t now = now_ns();
+
+        if (head == tail) {
+            if (paced && now > anchor_ns + frames_to_ns(sent * packet_frames_, config_.sample_rate) + IDLE_RESET_NS) {
+                paced = false;
+            }
+            std::this_thread::sleep_for(std::chrono::nanoseconds(idle_wait_ns));
+            continue;
+        }
+
+        if (!paced) {
+            paced = true;
+            anchor_ns = now + PREROLL_NS;
+            sent = 0;
+        }
+
+        uint64_t due = anchor_ns + frames_to_ns(sent * packet_frames_, config_.sample_rate);
+        if (due > now) {
+            // Sleep most of the way, then yield for the last stretch
+            uint64_t wait = due - now;
+            if (wait > SLEEP_THRESHOLD_NS) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(wait - SLEEP_MARGIN_NS));
+            } else {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        if (now - due > MAX_LATE_NS) {
+            // Stalled (or the producer was): resume the cadence from here
+            // rather than bursting everything that is overdue
+            stalls_.fetch_add(1, std::memory_order_relaxed);
+            anchor_ns = now;
+            sent = 0;
+        }
+
+        if (!sender_(slot(tail), slot_bytes_)) {
+            send_errors_.fetch_add(1, std::memory_order_relaxed);
+        }
+        tail_.store(tail + 1, std::memory_order_release);
+        packets_.fetch_add(1, std::memory_order_relaxed);
+        sent++;
+    }
+}
+
+AudioSender::Stats AudioSender::get_stats() const
+{
+    Stats stats;
+    stats.packets = packets_.load(std::memory_order_relaxed);
+    stats.overflows = overflows_.load(std::memory_order_relaxed);
+    stats.send_errors = send_errors_.load(std::memory_order_relaxed);
+    stats.stalls = stalls_.load(std::memory_order_relaxed);
+    stats.resyncs = resyncs_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace jpegxs
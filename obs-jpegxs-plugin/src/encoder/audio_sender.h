@@ -0,0 +1,154 @@
+/*
+ * Audio Sender
+ * ST 2110-30 (AES67) packetizer and paced sender for the output's audio
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "pixel_repack.h"
+#include "../network/thread_placement.h"
+#include "../network/memory_accounting.h"
+
+namespace jpegxs {
+
+/**
+ * Audio Sender
+ * The OBS audio thread hands over planar float blocks; they are interleaved,
+ * clipped and converted to big-endian L16 or L24 (SSE4.1 / NEON, scalar
+ * fallback) straight into the payload of a preallocated RTP packet slot.
+ * Completed slots are published on a single-producer, single-consumer ring,
+ * and a sender thread puts them on the wire one packet time apart (1 ms or
+ * 125 us). Every slot carries the RTP header from configure() (random SSRC);
+ * only sequence number and timestamp are written per packet.
+ *
+ * Timestamps are the media clock (PTP time at the sample rate) of each
+ * block's capture, so audio shares its epoch with video. Within a stream
+ * they run on sample by sample: capture times jitter, samples don't. Only
+ * when capture time and the running count part by more than a millisecond
+ * (an audio gap, a clock step) does the stream re-anchor, closing the
+ * packet in progress with silence.
+ *
+ * push() never locks or allocates: it only touches the ring and atomics. A
+ * full ring drops the packet but still advances sequence and timestamp, so
+ * receivers see the loss. configure() and stop() must not race push() from
+ * the same caller; stop() waits for any push() in flight on another thread.
+ */
+class AudioSender {
+public:
+    static constexpr uint32_t MAX_CHANNELS = 16;
+    static constexpr uint32_t MAX_PAYLOAD_BYTES = 1440;  // ST 2110-30 limit
+
+    struct Config {
+        uint32_t channels = 2;
+        int bit_depth = 16;             // 16 (L16) or 24 (L24)
+        uint32_t sample_rate = 48000;
+        uint32_t packet_time_us = 1000; // 1000 (Level A/B) or 125 (Level C)
+        uint8_t payload_type = 97;
+        uint32_t queue_ms = 64;         // Ring capacity
+    };
+
+    using Sender = std::function<bool(const uint8_t *data, size_t size)>;
+
+    AudioSender();
+    ~AudioSender();
+
+    AudioSender(const AudioSender &) = delete;
+    AudioSender &operator=(const AudioSender &) = delete;
+
+    /**
+     * Size the ring and prepare packet headers (stopped senders only)
+     * @return false for unsupported formats or a payload over MAX_PAYLOAD_BYTES
+     */
+    bool configure(const Config &config);
+    const Config &config() const { return config_; }
+
+    void set_sender(Sender sender) { sender_ = std::move(sender); }
+    void set_placement(const PlacementPlan &plan) { placement_ = plan; }
+
+    void start();
+    void stop();
+    bool active() const { return accepting_.load(std::memory_order_relaxed); }
+
+    /**
+     * Queue one block of planar float audio (audio thread)
+     * @param channels Planes supplied; configured channels beyond them are silent
+     * @param ptp_ns PTP time the block's first frame was captured
+     */
+    void push(const float *const planes[], uint32_t channels, uint32_t frames, uint64_t ptp_ns);
+
+    uint32_t ssrc() const { return ssrc_; }
+    uint32_t packet_frames() const { return packet_frames_; }
+    RepackIsa isa() const { return isa_; }
+
+    struct Stats {
+        uint64_t packets = 0;     // Sent
+        uint64_t overflows = 0;   // Dropped: ring full
+        uint64_t send_errors = 0;
+        uint64_t stalls = 0;      // Sender fell behind and restarted its cadence
+        uint64_t resyncs = 0;     // Timestamps re-anchored to capture time
+    };
+
+    Stats get_stats() const;
+
+    // Bytes held by the packet ring and conversion buffers (counted under MemoryComponent::PACER)
+    size_t get_memory_usage() const { return memory_.bytes(); }
+
+    using ConvertFn = void (*)(const float *src, uint8_t *dst, size_t count);
+
+private:
+    void send_loop();
+    uint8_t *slot(uint32_t index) { return &ring_[(size_t)(index & mask_) * slot_bytes_]; }
+    void finish_packet();
+    void pad_packet();
+
+    Config config_;
+    RepackIsa isa_;
+    ConvertFn convert_ = nullptr;
+    uint32_t packet_frames_ = 0;
+    uint32_t frame_bytes_ = 0;
+    uint32_t slot_bytes_ = 0;
+    uint32_t slot_count_ = 0;      // A power of two
+    uint32_t mask_ = 0;
+    uint64_t packet_ns_ = 0;
+    uint32_t ssrc_ = 0;
+
+    std::vector<uint8_t> ring_;         // slot_count_ ready-to-send packets
+    std::vector<uint8_t> overflow_;     // Written instead of a slot when the ring is full
+    std::vector<float> interleaved_;    // One packet of frames
+    std::vector<float> silence_;
+
+    // Producer (audio thread) state
+    uint8_t *current_ = nullptr;
+    bool current_dropped_ = false;
+    uint32_t fill_ = 0;                 // Frames in the current packet
+    uint16_t seq_ = 0;
+    uint32_t timestamp_ = 0;            // Of the current packet's first frame
+    bool anchored_ = false;
+
+    alignas(64) std::atomic<uint32_t> head_{0};  // Next slot the producer publishes
+    alignas(64) std::atomic<uint32_t> tail_{0};  // Next slot the sender sends
+    alignas(64) std::atomic<bool> accepting_{false};
+    std::atomic<uint32_t> pushing_{0};
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    Sender sender_;
+    PlacementPlan placement_;
+
+    std::atomic<uint64_t> packets_{0};
+    std::atomic<uint64_t> overflows_{0};
+    std::atomic<uint64_t> send_errors_{0};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<uint64_t> resyncs_{0};
+
+    MemoryAccounting::Tracker memory_{MemoryComponent::PACER};
+};
+
+} // namespace jpegxs
@@ -0,0 +1,291 @@
+/*
+ * Encoder Calibration Implementation
+ */
+
+#include "encoder_calibration.h"
+
+#include <obs-module.h>
+#include <util/platform.h>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jpegxs {
+
+static const char *CACHE_FILE = "encoder_calibration.json";
+static const uint32_t WARMUP_FRAMES = 2;
+static const uint32_t TIMED_FRAMES = 6;
+static const uint64_t SWEEP_BUDGET_NS = 20000000000ULL; // Give up refining after 20 s
+
+// Serializes cache file access between outputs starting at the same time
+static std::mutex cache_mutex;
+
+bool EncoderCalibrator::calibrate(JpegXSEncoder::Params &params, bool allow_measure, Result *result,
+                                  const std::atomic<bool> *cancel)
+{
+    std::string key = cache_key(params);
+    Result res;
+
+    if (load_cached(key, res)) {
+        res.from_cache = true;
+    } else if (!allow_measure) {
+        return false;
+    } else {
+        blog(LOG_INFO, "[EncoderCalibrator] No cached tuning for %s, measuring...", key.c_str());
+        if (!measure(params, res, cancel)) {
+            blog(LOG_WARNING, "[EncoderCalibrator] Calibration %s, keeping defaults",
+                 cancel && *cancel ? "cancelled" : "failed");
+            return false;
+        }
+        store_cached(key, res);
+    }
+
+    // An explicit thread count from the user always wins
+    if (params.threads_num == 0) {
+        params.threads_num = res.threads_num;
+    }
+    params.ndecomp_v = res.ndecomp_v;
+    params.ndecomp_h = res.ndecomp_h;
+    params.slice_height = res.slice_height;
+
+    blog(LOG_INFO, "[EncoderCalibrator] %s: %u threads, V=%u, H=%u, slice %u (%.2f ms of %.2f ms)%s",
+         key.c_str(), params.threads_num, res.ndecomp_v, res.ndecomp_h, res.slice_height,
+         res.encode_ms, res.deadline_ms, res.from_cache ? " [cached]" : "");
+
+    if (result) *result = res;
+    return true;
+}
+
+double EncoderCalibrator::time_encode(const JpegXSEncoder::Params &params)
+{
+    JpegXSEncoder encoder;
+    if (!encoder.initialize(params)) {
+        return -1.0;
+    }
+
+    // Gradient plus noise: smooth areas and texture so the rate control
+    // does similar work to real content (flat frames encode unrealistically fast)
+    std::vector<uint8_t> packed(encoder.get_packed_frame_size());
+    uint32_t seed = 0x9E3779B9u;
+    if (params.bit_depth > 8) {
+        uint16_t *samples = reinterpret_cast<uint16_t*>(packed.data());
+        size_t count = packed.size() / 2;
+        uint32_t max_value = (1u << params.bit_depth) - 1;
+        for (size_t i = 0; i < count; i++) {
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            uint32_t value = (uint32_t)((i % params.width) * max_value / params.width) + (seed & 0x3F);
+            samples[i] = (uint16_t)std::min(value, max_value);
+        }
+    } else {
+        for (size_t i = 0; i < packed.size(); i++) {
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            uint32_t value = (uint32_t)((i % params.width) * 255 / params.width) + (seed & 0x0F);
+            packed[i] = (uint8_t)std::min(value, 255u);
+        }
+    }
+
+    uint64_t total_ns = 0;
+    for (uint32_t i = 0; i < WARMUP_FRAMES + TIMED_FRAMES; i++) {
+        uint8_t *out = nullptr;
+        size_t out_size = 0;
+
+        uint64_t start = os_gettime_ns();
+        if (!encoder.encode_packed_frame(packed.data(), encoder.get_generation(), &out, &out_size)) {
+            return -1.0;
+        }
+        if (i >= WARMUP_FRAMES) {
+            total_ns += os_gettime_ns() - start;
+        }
+    }
+
+    return (double)total_ns / TIMED_FRAMES / 1000000.0;
+}
+
+bool EncoderCalibrator::measure(const JpegXSEncoder::Params &params, Result &result, const std::atomic<bool> *cancel)
+{
+    double deadline_ms = (params.fps_num > 0) ? 1000.0 * params.fps_den / params.fps_num : 1000.0 / 60.0;
+    double budget_ms = deadline_ms * DEADLINE_HEADROOM;
+    uint64_t sweep_start = os_gettime_ns();
+
+    struct Candidate {
+        JpegXSEncoder::Params params;
+        double encode_ms = -1.0;
+    };
+    Candidate best;
+
+    auto out_of_time = [&]() { return os_gettime_ns() - sweep_start > SWEEP_BUDGET_NS || (cancel && *cancel); };
+
+    auto run = [&](JpegXSEncoder::Params p) -> double {
+        double ms = time_encode(p);
+        blog(LOG_INFO, "[EncoderCalibrator]   threads=%u V=%u H=%u slice=%u: %.2f ms",
+             p.threads_num, p.ndecomp_v, p.ndecomp_h, p.slice_height, ms);
+        return ms;
+    };
+
+    // Keep a candidate only if it is clearly faster (>5%), so near-ties
+    // resolve to fewer threads / the earlier (higher quality) setting.
+    auto consider = [&](const JpegXSEncoder::Params &p) {
+        double ms = run(p);
+        if (ms > 0.0 && (best.encode_ms < 0.0 || ms < best.encode_ms * 0.95)) {
+            best.params = p;
+            best.encode_ms = ms;
+        }
+    };
+
+    // Stage 1: thread count at the default decomposition
+    uint32_t hw = std::thread::hardware_concurrency();
+    if (hw == 0) hw = 8;
+
+    std::vector<uint32_t> thread_counts;
+    if (params.threads_num > 0) {
+        thread_counts.push_back(params.threads_num);
+    } else {
+        for (uint32_t t : {2u, 4u, 6u, 8u, 12u, 16u, 24u, 32u, 48u, 64u}) {
+            if (t < hw) thread_counts.push_back(t);
+        }
+        thread_counts.push_back(hw);
+    }
+
+    JpegXSEncoder::Params base = params;
+    base.ndecomp_v = 2;
+    base.ndecomp_h = 5;
+    base.slice_height = 128;
+
+    for (uint32_t t : thread_counts) {
+        if (out_of_time()) break;
+        JpegXSEncoder::Params p = base;
+        p.threads_num = t;
+        consider(p);
+    }
+
+    if (best.encode_ms < 0.0 || (cancel && *cancel)) {
+        return false;
+    }
+
+    // Stage 2: slice height (more slices = more parallel work, more overhead)
+    JpegXSEncoder::Params tuned = best.params;
+    for (uint32_t slice : {32u, 64u, 256u}) {
+        if (out_of_time() || slice > params.height) break;
+        JpegXSEncoder::Params p = tuned;
+        p.slice_height = slice;
+        consider(p);
+    }
+
+    // Stage 3: shallower decomposition only if the default cannot keep up;
+    // it costs quality, so take the first tier that meets the budget.
+    if (best.encode_ms > budget_ms) {
+        static const uint32_t tiers[][2] = { {2, 4}, {1, 5}, {1, 4} };
+        for (const auto &tier : tiers) {
+            if (out_of_time() || best.encode_ms <= budget_ms) break;
+            for (uint32_t slice : {32u, 64u, 128u}) {
+                if (out_of_time()) break;
+                JpegXSEncoder::Params p = best.params;
+                p.ndecomp_v = tier[0];
+                p.ndecomp_h = tier[1];
+                p.slice_height = slice;
+                consider(p);
+            }
+        }
+    }
+
+    // A cancelled sweep is incomplete; don't cache it as the answer
+    if (cancel && *cancel) {
+        return false;
+    }
+
+    if (best.encode_ms > budget_ms) {
+        blog(LOG_WARNING, "[EncoderCalibrator] Best setting needs %.2f ms, over the %.2f ms budget",
+             best.encode_ms, budget_ms);
+    }
+
+    result.threads_num = best.params.threads_num;
+    result.ndecomp_v = best.params.ndecomp_v;
+    result.ndecomp_h = best.params.ndecomp_h;
+    result.slice_height = best.params.slice_height;
+    result.encode_ms = best.encode_ms;
+    result.deadline_ms = deadline_ms;
+    return true;
+}
+
+std::string EncoderCalibrator::cache_key(const JpegXSEncoder::Params &params)
+{
+    // Encode time follows the bitrate (rate control and entropy coding work),
+    // so it is part of the key, along with the ratio to 16-bit 4:2:2 it implies
+    const char *chroma = params.is_444 ? "444" : (params.is_422 ? "422" : "420");
+    double fps = params.fps_den ? (double)params.fps_num / params.fps_den : 0.0;
+    double ratio = params.bitrate_mbps > 0.0f ? params.width * params.height * fps * 16.0 / 1e6 / params.bitrate_mbps : 0.0;
+    char key[160];
+    snprintf(key, sizeof(key), "%ux%u@%u/%u-%s-%dbit-%.0fMbps-%.1f:1-cpu%dc%dt-thr%u",
+             params.width, params.height, params.fps_num, params.fps_den, chroma, params.bit_depth,
+             params.bitrate_mbps, ratio, os_get_physical_cores(), os_get_logical_cores(), params.threads_num);
+    std::string result = key;
+    if (params.stripes > 1) {
+        result += "-s" + std::to_string(params.stripes);
+    }
+    return result;
+}
+
+bool EncoderCalibrator::load_cached(const std::string &key, Result &result)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    char *path = obs_module_config_path(CACHE_FILE);
+    if (!path) return false;
+    obs_data_t *root = obs_data_create_from_json_file_safe(path, "bak");
+    bfree(path);
+    if (!root) return false;
+
+    bool found = false;
+    obs_data_t *entry = obs_data_get_obj(root, key.c_str());
+    if (entry) {
+        result.threads_num = (uint32_t)obs_data_get_int(entry, "threads");
+        result.ndecomp_v = (uint32_t)obs_data_get_int(entry, "ndecomp_v");
+        result.ndecomp_h = (uint32_t)obs_data_get_int(entry, "ndecomp_h");
+        result.slice_height = (uint32_t)obs_data_get_int(entry, "slice_height");
+        result.encode_ms = obs_data_get_double(entry, "encode_ms");
+        result.deadline_ms = obs_data_get_double(entry, "deadline_ms");
+        found = result.threads_num > 0 && result.slice_height > 0;
+        obs_data_release(entry);
+    }
+
+    obs_data_release(root);
+    return found;
+}
+
+void EncoderCalibrator::store_cached(const std::string &key, const Result &result)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    char *dir = obs_module_config_path("");
+    if (dir) {
+        os_mkdirs(dir);
+        bfree(dir);
+    }
+
+    char *path = obs_module_config_path(CACHE_FILE);
+    if (!path) return;
+
+    obs_data_t *root = obs_data_create_from_json_file_safe(path, "bak");
+    if (!root) root = obs_data_create();
+
+    obs_data_t *entry = obs_data_create();
+    obs_data_set_int(entry, "threads", result.threads_num);
+    obs_data_set_int(entry, "ndecomp_v", result.ndecomp_v);
+    obs_data_set_int(entry, "ndecomp_h", result.ndecomp_h);
+    obs_data_set_int(entry, "slice_height", result.slice_height);
+    obs_data_set_double(entry, "encode_ms", result.encode_ms);
+    obs_data_set_double(entry, "deadline_ms", result.deadline_ms);
+    obs_data_set_obj(root, key.c_str(), entry);
+    obs_data_release(entry);
+
+    if (!obs_data_save_json_safe(root, path, "tmp", "bak")) {
+        blog(LOG_WARNING, "[EncoderCalibrator] Failed to save %s", path);
+    }
+
+    obs_data_release(root);
+    bfree(path);
+}
+
+} // namespace jpegxs
@@ -0,0 +1,59 @@
+/*
+ * Encoder Calibration
+ * Picks SVT-JPEG-XS threads / decomposition / slice height per machine
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "jpegxs_encoder.h"
+
+namespace jpegxs {
+
+/**
+ * Encoder Calibrator
+ * Encodes a few synthetic frames across a grid of thread counts, wavelet
+ * decompositions and slice heights, and keeps the lowest-latency setting
+ * that still meets the frame deadline with headroom. Results are cached on
+ * disk per machine, resolution, frame rate, profile and bitrate so only the
+ * first start on a given machine pays for the sweep. The sweep takes seconds;
+ * the output runs it on a background thread and applies the result live.
+ */
+class EncoderCalibrator {
+public:
+    struct Result {
+        uint32_t threads_num = 0;
+        uint32_t ndecomp_v = 2;
+        uint32_t ndecomp_h = 5;
+        uint32_t slice_height = 128;
+        double encode_ms = 0.0;     // Mean encode time of the chosen setting
+        double deadline_ms = 0.0;   // Frame interval it was measured against
+        bool from_cache = false;
+    };
+
+    // Fraction of the frame interval a setting may use to count as real-time
+    static constexpr double DEADLINE_HEADROOM = 0.7;
+
+    /**
+     * Apply cached or freshly measured tuning to params
+     * @param params Session parameters; tuning fields are updated in place
+     * @param allow_measure Run the sweep on a cache miss (otherwise only look up)
+     * @param cancel Stops the sweep before the next candidate once set
+     * @return true if params were tuned
+     */
+    static bool calibrate(JpegXSEncoder::Params &params, bool allow_measure, Result *result = nullptr,
+                          const std::atomic<bool> *cancel = nullptr);
+
+private:
+    static bool measure(const JpegXSEncoder::Params &params, Result &result, const std::atomic<bool> *cancel);
+    static double time_encode(const JpegXSEncoder::Params &params);
+
+    static std::string cache_key(const JpegXSEncoder::Params &params);
+    static bool load_cached(const std::string &key, Result &result);
+    static void store_cached(const std::string &key, const Result &result);
+};
+
+} // namespace jpegxs
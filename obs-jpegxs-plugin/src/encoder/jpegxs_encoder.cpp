@@ -3,41 +3,148 @@
  */
 
 #include "jpegxs_encoder.h"
+#include "../network/stripe_framing.h"
+#include <algorithm>
 #include <cstring>
 #include <thread>
 #include <cstdlib> // For posix_memalign/free
 #include <obs-module.h>
 
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
 // SVT-JPEG-XS encoder API
 #include <svt-jpegxs/SvtJpegxsEnc.h>
 
+/**
+ * One encoder session: an SVT instance per horizontal stripe.
+ * With a single stripe the output is the plain codestream.
+ */
+struct EncoderSession {
+    struct Stripe {
+        svt_jpeg_xs_encoder_api_t *api = nullptr;
+        uint32_t first_row = 0;
+        uint32_t rows = 0;
+        std::vector<uint8_t> bitstream;   // SVT writes the codestream here
+        std::vector<uint8_t> codestream;  // Gathered packets (striped sessions only)
+    };
+    std::vector<Stripe> stripes;
+};
+
+static uint8_t *aligned_alloc_64(size_t size)
+{
+#ifdef _WIN32
+    return (uint8_t *)_aligned_malloc(size, 64);
+#else
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, 64, size) != 0) return nullptr;
+    return (uint8_t *)ptr;
+#endif
+}
+
+static void aligned_free_64(uint8_t *ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+// Send one stripe's picture; SVT starts encoding it on its own workers
+static bool send_stripe(EncoderSession::Stripe &stripe, svt_jpeg_xs_frame_t *input_frame)
+{
+    input_frame->user_prv_ctx_ptr = nullptr;
+    input_frame->bitstream.buffer = stripe.bitstream.data();
+    input_frame->bitstream.allocation_size = (uint32_t)stripe.bitstream.size();
+    input_frame->bitstream.used_size = 0;
+    
+    SvtJxsErrorType_t ret = svt_jpeg_xs_encoder_send_picture(stripe.api, input_frame, 1);
+    if (ret != SvtJxsErrorNone && ret != SvtJxsErrorNoErrorEmptyQueue) {
+        blog(LOG_ERROR, "[JpegXSEncoder] send_picture failed: 0x%x", ret);
+        return false;
+    }
+    return true;
+}
+
+// Wait for one stripe's packets and stream them via callback
+static bool receive_stripe(EncoderSession::Stripe &stripe, const JpegXSEncoder::PacketCallback &on_packet,
+                           uint64_t *bytes)
+{
+    bool finished_frame = false;
+    int packet_count = 0;
+    
+    while (!finished_frame) {
+        svt_jpeg_xs_frame_t output_frame;
+        memset(&output_frame, 0, sizeof(output_frame));
+        
+        // Blocking wait for packet
+        SvtJxsErrorType_t ret = svt_jpeg_xs_encoder_get_packet(stripe.api, &output_frame, 1);
+        
+        if (ret == SvtJxsErrorNone) {
+            if (output_frame.bitstream.used_size > 0) {
+                // Check for overflow
+                if (output_frame.bitstream.used_size > stripe.bitstream.size()) {
+                    blog(LOG_ERROR, "[JpegXSEncoder] Packet overflow");
+                    return false;
+                }
+                
+                // STREAM PACKET IMMEDIATELY
+                on_packet(output_frame.bitstream.buffer, output_frame.bitstream.used_size);
+                *bytes += output_frame.bitstream.used_size;
+            }
+            
+            if (output_frame.bitstream.last_packet_in_frame) {
+                finished_frame = true;
+            }
+            
+            packet_count++;
+            if (packet_count > 10000) { // Sanity limit
+                blog(LOG_ERROR, "[JpegXSEncoder] Too many packets >10000");
+                break;
+            }
+        } else if (ret == SvtJxsErrorNoErrorEmptyQueue) {
+            if (packet_count > 0) finished_frame = true;
+            else {
+                // Shouldn't happen if blocking get_packet is used correctly for valid frame
+                // But return false just in case
+                return false; 
+            }
+        } else {
+            blog(LOG_ERROR, "[JpegXSEncoder] get_packet failed: %d", ret);
+            return false;
+        }
+    }
+    
+    return packet_count > 0;
+}
+
 JpegXSEncoder::JpegXSEncoder()
     : encoder_handle_(nullptr)
-    , width_(0)
-    , height_(0)
-    , fps_num_(0)
-    , fps_den_(0)
-    , bitrate_mbps_(0.0f)
-    , bit_depth_(8)
-    , is_444_(false)
-    , is_422_(false)
 {
     memset(&stats_, 0, sizeof(stats_));
 }
 
 JpegXSEncoder::~JpegXSEncoder()
 {
-    // Cleanup SVT-JPEG-XS encoder
-    if (encoder_handle_) {
-        svt_jpeg_xs_encoder_api_t *enc_api = static_cast<svt_jpeg_xs_encoder_api_t*>(encoder_handle_);
-        svt_jpeg_xs_encoder_close(enc_api);
-        delete enc_api;
-        encoder_handle_ = nullptr;
+    // Wait for any in-flight reconfiguration or retirement before tearing down
+    if (builder_.joinable()) {
+        builder_.join();
     }
+    if (retirer_.joinable()) {
+        retirer_.join();
+    }
+    destroy_instance(pending_handle_);
+    pending_handle_ = nullptr;
+    
+    // Cleanup SVT-JPEG-XS encoder
+    destroy_instance(encoder_handle_);
+    encoder_handle_ = nullptr;
     
     // Free aligned buffer if used
     if (aligned_input_buffer_) {
-        free(aligned_input_buffer_);
+        aligned_free_64(aligned_input_buffer_);
         aligned_input_buffer_ = nullptr;
         aligned_input_size_ = 0;
     }
@@ -49,21 +156,136 @@ bool JpegXSEncoder::initialize(uint32_t width, uint32_t height,
                                int bit_depth, bool is_444, bool is_422,
                                int input_bit_depth)
 {
-    width_ = width;
-    height_ = height;
-    fps_num_ = fps_num;
-    fps_den_ = fps_den;
-    bitrate_mbps_ = bitrate_mbps;
-    threads_num_ = threads_num;
-    bit_depth_ = bit_depth;
-    is_444_ = is_444;
-    is_422_ = is_422;
-    input_bit_depth_ = (input_bit_depth > 0) ? input_bit_depth : bit_depth;
+    Params params;
+    params.width = width;
+    params.height = height;
+    params.fps_num = fps_num;
+    params.fps_den = fps_den;
+    params.bitrate_mbps = bitrate_mbps;
+    params.threads_num = threads_num;
+    params.bit_depth = bit_depth;
+    params.is_444 = is_444;
+    params.is_422 = is_422;
+    params.input_bit_depth = (input_bit_depth > 0) ? input_bit_depth : bit_depth;
+    return initialize(params);
+}
+
+bool JpegXSEncoder::initialize(const Params &params)
+{
+    params_ = params;
     
     // Initialize SVT-JPEG-XS encoder
     blog(LOG_INFO, "[JpegXSEncoder] Initializing encoder: %ux%u @ %u/%u fps, %d-bit (input %d), 444=%d, 422=%d", 
-         width, height, fps_num, fps_den, bit_depth, input_bit_depth_, is_444, is_422);
+         params_.width, params_.height, params_.fps_num, params_.fps_den, params_.bit_depth,
+         params_.input_bit_depth, params_.is_444, params_.is_422);
+
+    if (!configure_repacker(repacker_, params_)) {
+        return false;
+    }
+
+    void *handle = nullptr;
+    {
+        jpegxs::ThreadPlacement::ScopedInherit inherit(placement_, jpegxs::ThreadRole::CODEC);
+        handle = create_instance(params_);
+    }
+    if (!handle) {
+        return false;
+    }
+    blog(LOG_INFO, "[JpegXSEncoder] Encoder initialized successfully");
+    
+    encoder_handle_ = handle;
+    requested_params_ = params_;
+    update_memory_usage();
+    
+    return true;
+}
+
+bool JpegXSEncoder::configure_repacker(jpegxs::PixelRepacker &repacker, const Params &params)
+{
+    jpegxs::RepackChroma chroma = params.is_444 ? jpegxs::RepackChroma::CHROMA_444
+                                : (params.is_422 ? jpegxs::RepackChroma::CHROMA_422 : jpegxs::RepackChroma::CHROMA_420);
+    if (!repacker.configure(params.width, params.height, chroma, params.input_bit_depth, params.bit_depth)) {
+        blog(LOG_ERROR, "[JpegXSEncoder] No repack kernel for %d-bit input -> %d-bit",
+             params.input_bit_depth, params.bit_depth);
+        return false;
+    }
+    blog(LOG_INFO, "[JpegXSEncoder] Repack kernel: %s (%s)", repacker.kernel_name(),
+         jpegxs::PixelRepacker::isa_name(repacker.isa()));
+    return true;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> JpegXSEncoder::stripe_layout(const Params &params)
+{
+    std::vector<std::pair<uint32_t, uint32_t>> layout;
+    uint32_t align = std::max(params.slice_height, 2u);
+    uint32_t slices = (params.height + align - 1) / align;
+    uint32_t count = std::min({params.stripes, slices, (uint32_t)jpegxs::StripeFraming::MAX_STRIPES});
+    count = std::max(1u, count);
+    
+    // Every stripe but the last is a whole number of slices, so striping
+    // does not add partial slices (or odd chroma rows) at the seams
+    uint32_t rows_per_stripe = ((slices + count - 1) / count) * align;
+    for (uint32_t row = 0; row < params.height; row += rows_per_stripe) {
+        layout.emplace_back(row, std::min(rows_per_stripe, params.height - row));
+    }
+    return layout;
+}
+
+void *JpegXSEncoder::create_instance(const Params &params)
+{
+    std::vector<std::pair<uint32_t, uint32_t>> layout = stripe_layout(params);
+    uint32_t threads = resolve_threads(params.threads_num);
+    
+    // Striping exists to go past one instance's scaling, so in auto mode
+    // the instances share the whole machine rather than the single-instance cap
+    if (params.threads_num == 0 && layout.size() > 1) {
+        threads = std::max(threads, std::thread::hardware_concurrency());
+    }
+    
+    EncoderSession *session = new EncoderSession;
+    session->stripes.resize(layout.size());
+    
+    for (size_t i = 0; i < layout.size(); i++) {
+        EncoderSession::Stripe &stripe = session->stripes[i];
+        stripe.first_row = layout[i].first;
+        stripe.rows = layout[i].second;
+        
+        // Same bpp everywhere: each stripe gets its share of the bitrate,
+        // and the thread budget is split between the instances
+        Params stripe_params = params;
+        stripe_params.height = stripe.rows;
+        stripe_params.bitrate_mbps = params.bitrate_mbps * stripe.rows / params.height;
+        stripe_params.threads_num = std::max(1u, threads / (uint32_t)layout.size());
+        
+        uint32_t bytes_per_frame = 0;
+        stripe.api = static_cast<svt_jpeg_xs_encoder_api_t*>(create_svt(stripe_params, &bytes_per_frame));
+        if (!stripe.api) {
+            destroy_instance(session);
+            return nullptr;
+        }
+        
+        // Rate control keeps every codestream within SVT's per-frame budget;
+        // the margin covers marker segments and rounding. Without a budget,
+        // fall back to a size no codestream can exceed.
+        size_t worst_case = (size_t)params.width * stripe.rows * 8;
+        size_t budget = bytes_per_frame ? (size_t)bytes_per_frame + bytes_per_frame / 8 + 4096 : worst_case;
+        stripe.bitstream.resize(std::min(budget, worst_case));
+        
+        if (i == 0) {
+            blog(LOG_INFO, "[JpegXSEncoder] Bitstream buffer: %zu KB (budget %u bytes/frame)",
+                 stripe.bitstream.size() / 1024, bytes_per_frame);
+        }
+    }
+    
+    if (layout.size() > 1) {
+        blog(LOG_INFO, "[JpegXSEncoder] Striped session: %zu instances of ~%u rows, %u threads each",
+             layout.size(), layout[0].second, std::max(1u, threads / (uint32_t)layout.size()));
+    }
+    return session;
+}
 
+void *JpegXSEncoder::create_svt(const Params &params, uint32_t *bytes_per_frame)
+{
     svt_jpeg_xs_encoder_api_t *enc_api = new svt_jpeg_xs_encoder_api_t;
     memset(enc_api, 0, sizeof(*enc_api));
     
@@ -75,26 +297,26 @@ bool JpegXSEncoder::initialize(uint32_t width, uint32_t height,
     if (ret != SvtJxsErrorNone) {
         blog(LOG_ERROR, "[JpegXSEncoder] Failed to load default parameters: %d", ret);
         delete enc_api;
-        return false;
+        return nullptr;
     }
     
     // Set video format
-    enc_api->source_width = width;
-    enc_api->source_height = height;
-    enc_api->input_bit_depth = bit_depth;
-    if (is_444) {
+    enc_api->source_width = params.width;
+    enc_api->source_height = params.height;
+    enc_api->input_bit_depth = params.bit_depth;
+    if (params.is_444) {
         enc_api->colour_format = COLOUR_FORMAT_PLANAR_YUV444_OR_RGB;
-    } else if (is_422) {
+    } else if (params.is_422) {
         enc_api->colour_format = COLOUR_FORMAT_PLANAR_YUV422;
     } else {
         enc_api->colour_format = COLOUR_FORMAT_PLANAR_YUV420;
     }
     
     // Calculate bits per pixel from bitrate
-    float fps = (float)fps_num / fps_den;
+    float fps = params.fps_den ? (float)params.fps_num / params.fps_den : 0.0f;
     if (fps <= 0.0f) fps = 60.0f; // Safety
-    float total_pixels = width * height * fps;
-    float bpp = (bitrate_mbps * 1e6f) / total_pixels;
+    float total_pixels = params.width * params.height * fps;
+    float bpp = (params.bitrate_mbps * 1e6f) / total_pixels;
     
     enc_api->bpp_numerator = (uint32_t)(bpp * 100.0f);  // Store as fixed point
     enc_api->bpp_denominator = 100;
@@ -104,15 +326,14 @@ bool JpegXSEncoder::initialize(uint32_t width, uint32_t height,
     // Set low-latency parameters
     enc_api->cpu_profile = 0;  // 0 = Low latency
     
-    // Restore V=2 to fix grainy noise artifacts (V=1 compresses poorly at 10:1)
-    // H=4 offers a good balance of speed and quality (Standard is H=5)
-    enc_api->ndecomp_v = 2;    
-    enc_api->ndecomp_h = 5;    
+    // Defaults: V=2 avoids grainy noise artifacts (V=1 compresses poorly at 10:1),
+    // H=5 is the standard horizontal depth. EncoderCalibrator may pick others.
+    enc_api->ndecomp_v = params.ndecomp_v;
+    enc_api->ndecomp_h = params.ndecomp_h;
     
-    // Optimize for M2 Max (8 Performance Cores)
-    // Using 8 threads maps perfectly to the P-cores.
-    enc_api->threads_num = 8;
-    blog(LOG_INFO, "[JpegXSEncoder] 8-Thread Optimized Mode (V=2, H=5)");
+    enc_api->threads_num = resolve_threads(params.threads_num);
+    blog(LOG_INFO, "[JpegXSEncoder] %u threads (V=%u, H=%u, slice height %u)",
+         enc_api->threads_num, params.ndecomp_v, params.ndecomp_h, params.slice_height);
     
     enc_api->use_cpu_flags = CPU_FLAGS_ALL;
     
@@ -129,10 +350,18 @@ bool JpegXSEncoder::initialize(uint32_t width, uint32_t height,
     // Enable Fast Sign Handling for better efficiency
     enc_api->coding_signs_handling = 1;
     
-    // Slice height = 128 (1080 / 128 = ~8.4 slices)
-    // This ensures enough work units for all 8 threads to run in parallel.
+    // Default slice height = 128 (1080 / 128 = ~8.4 slices)
+    // This ensures enough work units for 8 threads to run in parallel.
     // 128 is a multiple of 32 (safe for V=2).
-    enc_api->slice_height = 128;
+    enc_api->slice_height = params.slice_height;
+    
+    // Codestream size implied by the bpp budget, for sizing the bitstream buffer
+    svt_jpeg_xs_image_config_t image_config;
+    *bytes_per_frame = 0;
+    if (svt_jpeg_xs_encoder_get_image_config(SVT_JPEGXS_API_VER_MAJOR, SVT_JPEGXS_API_VER_MINOR,
+                                             enc_api, &image_config, bytes_per_frame) != SvtJxsErrorNone) {
+        *bytes_per_frame = 0;
+    }
     
     // Initialize encoder instance
     blog(LOG_INFO, "[JpegXSEncoder] Calling svt_jpeg_xs_encoder_init...");
@@ -141,20 +370,190 @@ bool JpegXSEncoder::initialize(uint32_t width, uint32_t height,
     if (ret != SvtJxsErrorNone) {
         blog(LOG_ERROR, "[JpegXSEncoder] svt_jpeg_xs_encoder_init failed: %d", ret);
         delete enc_api;
+        return nullptr;
+    }
+    
+    return enc_api;
+}
+
+uint32_t JpegXSEncoder::resolve_threads(uint32_t threads_num)
+{
+    if (threads_num > 0) {
+        return threads_num;
+    }
+    
+    // Auto: 8 threads was tuned on an 8 P-core machine; never oversubscribe smaller ones
+    uint32_t hw = std::thread::hardware_concurrency();
+    return (hw > 0 && hw < 8) ? hw : 8;
+}
+
+size_t JpegXSEncoder::session_bytes(void *handle)
+{
+    size_t bytes = 0;
+    if (handle) {
+        for (const EncoderSession::Stripe &stripe : static_cast<EncoderSession*>(handle)->stripes) {
+            bytes += stripe.bitstream.capacity() + stripe.codestream.capacity();
+        }
+    }
+    return bytes;
+}
+
+void JpegXSEncoder::update_memory_usage()
+{
+    size_t bytes = aligned_input_size_ + output_buffer_.capacity();
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        bytes += session_bytes(encoder_handle_) + session_bytes(pending_handle_);
+    }
+    memory_.set(bytes);
+}
+
+void JpegXSEncoder::destroy_instance(void *handle)
+{
+    if (handle) {
+        EncoderSession *session = static_cast<EncoderSession*>(handle);
+        for (EncoderSession::Stripe &stripe : session->stripes) {
+            if (stripe.api) {
+                svt_jpeg_xs_encoder_close(stripe.api);
+                delete stripe.api;
+            }
+        }
+        delete session;
+    }
+}
+
+bool JpegXSEncoder::reconfigure(const Params &params)
+{
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    
+    if (!encoder_handle_) {
         return false;
     }
-    blog(LOG_INFO, "[JpegXSEncoder] Encoder initialized successfully");
+    requested_params_ = params;
+    
+    // The builder picks this up when it finishes the session in hand
+    if (building_) {
+        queued_ = true;
+        queued_params_ = params;
+        return true;
+    }
+    
+    if (builder_.joinable()) {
+        builder_.join();
+    }
+    
+    // A ready session that never received a frame is simply superseded; the
+    // builder closes it, as closing joins its threads
+    void *superseded = pending_handle_;
+    pending_handle_ = nullptr;
+    
+    pending_generation_ = next_generation_++;
+    building_ = true;
+    builder_ = std::thread(&JpegXSEncoder::build_pending, this, params, superseded);
+    return true;
+}
+
+bool JpegXSEncoder::reconfigure_pending() const
+{
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    return building_ || pending_handle_ != nullptr;
+}
+
+void JpegXSEncoder::build_pending(Params params, void *superseded)
+{
+    destroy_instance(superseded);
     
-    encoder_handle_ = enc_api;
+    for (;;) {
+        blog(LOG_INFO, "[JpegXSEncoder] Reconfiguring: %ux%u, %d-bit (input %d), 444=%d, 422=%d, %.1f Mbps",
+             params.width, params.height, params.bit_depth, params.input_bit_depth,
+             params.is_444, params.is_422, params.bitrate_mbps);
+        
+        jpegxs::PixelRepacker repacker;
+        void *handle = nullptr;
+        if (configure_repacker(repacker, params)) {
+            jpegxs::ThreadPlacement::ScopedInherit inherit(placement_, jpegxs::ThreadRole::CODEC);
+            handle = create_instance(params);
+        }
+        if (!handle) {
+            blog(LOG_WARNING, "[JpegXSEncoder] Reconfiguration failed, keeping current session");
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(session_mutex_);
+            if (!queued_) {
+                pending_handle_ = handle;
+                pending_repacker_ = repacker;
+                pending_params_ = params;
+                building_ = false;
+                break;
+            }
+            // Newer parameters arrived meanwhile: this session never runs
+            params = queued_params_;
+            queued_ = false;
+            pending_generation_ = next_generation_++;
+        }
+        destroy_instance(handle);
+    }
+    update_memory_usage();
+}
+
+bool JpegXSEncoder::commit_pending(uint32_t generation)
+{
+    void *old_handle = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        if (!pending_handle_ || generation != pending_generation_) {
+            return false;
+        }
+        
+        old_handle = encoder_handle_;
+        encoder_handle_ = pending_handle_;
+        repacker_ = pending_repacker_;
+        params_ = pending_params_;
+        generation_ = pending_generation_;
+        pending_handle_ = nullptr;
+    }
     
-    // Pre-allocate bitstream buffer (estimate 2x uncompressed size to be safe)
-    // RGB equivalent size is usually enough, but allow for 10-bit/4:4:4
-    size_t buffer_size = width_ * height_ * 8;
-    bitstream_buffer_.resize(buffer_size);
+    // Closing the old instance joins its worker threads, which would hold up
+    // the switch-over frame; do it on the side. The previous retirement
+    // finished long ago unless sessions are swapping faster than they close.
+    if (retirer_.joinable()) {
+        retirer_.join();
+    }
+    retirer_ = std::thread(&JpegXSEncoder::destroy_instance, old_handle);
+    update_memory_usage();
     
+    blog(LOG_INFO, "[JpegXSEncoder] Switched to session %u (%ux%u, %.1f Mbps)",
+         generation_, params_.width, params_.height, params_.bitrate_mbps);
     return true;
 }
 
+JpegXSEncoder::Params JpegXSEncoder::get_params() const
+{
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    return params_;
+}
+
+JpegXSEncoder::Params JpegXSEncoder::get_requested_params() const
+{
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    return requested_params_;
+}
+
+bool JpegXSEncoder::is_stale(uint32_t generation) const
+{
+    std::lock_guard<std::mutex> lock(session_mutex_);
+    return generation != generation_ && !(pending_handle_ && generation == pending_generation_);
+}
+
+bool JpegXSEncoder::set_bitrate(float bitrate_mbps)
+{
+    // On top of any layout change still being built, not in place of it
+    Params params = get_requested_params();
+    params.bitrate_mbps = bitrate_mbps;
+    return reconfigure(params);
+}
+
 bool JpegXSEncoder::encode_frame(uint8_t *yuv_planes[3], uint32_t linesize[3],
                                  uint64_t timestamp,
                                  PacketCallback on_packet)
@@ -163,209 +562,217 @@ bool JpegXSEncoder::encode_frame(uint8_t *yuv_planes[3], uint32_t linesize[3],
         return false;
     }
     
-    svt_jpeg_xs_encoder_api_t *enc_api = static_cast<svt_jpeg_xs_encoder_api_t*>(encoder_handle_);
-    
     // Prepare input frame
     svt_jpeg_xs_frame_t input_frame;
     memset(&input_frame, 0, sizeof(input_frame));
     
-    // Avoid memory copy if possible
-    // If 8-bit and not 10-bit, use pointers directly if strides match constraints.
-    // SVT-JPEG-XS expects specific buffer layout or pointers.
-    // OBS provides planes with padding (linesize).
-    
     // For 8-bit, we can pass pointers directly
     // However, if 10-bit requires packing or specific layout, we copy.
     
-    if (bit_depth_ > 8) {
-        // 10-bit handling (existing logic)
-        // Calculate tightly packed sizes (Stride = Width * 2 bytes)
-        uint32_t tight_stride_y = width_ * 2;
-        uint32_t tight_stride_uv = tight_stride_y; 
-        if (!is_444_) tight_stride_uv = width_; // 422/420 chroma width is half -> stride = width bytes
-        else tight_stride_uv = width_ * 2; // 444 is full width -> stride = width*2 bytes
-
-        size_t size_y = tight_stride_y * height_;
-        size_t size_uv = tight_stride_uv * height_;
-        if (!is_444_ && !is_422_) size_uv = tight_stride_uv * (height_ / 2); // 420
-
-        size_t required_buffer_size = size_y + size_uv * 2;
+    // Striped sessions address rows of the packed layout, so they take the repack path too
+    bool striped = static_cast<EncoderSession*>(encoder_handle_)->stripes.size() > 1;
+    if (params_.bit_depth > 8 || striped) {
+        size_t required_buffer_size = repacker_.packed_size();
         
         if (!aligned_input_buffer_ || aligned_input_size_ < required_buffer_size) {
-            if (aligned_input_buffer_) free(aligned_input_buffer_);
-            #ifdef _WIN32
-            aligned_input_buffer_ = (uint8_t*)_aligned_malloc(required_buffer_size, 64);
-            #else
-            posix_memalign((void**)&aligned_input_buffer_, 64, required_buffer_size);
-            #endif
-            aligned_input_size_ = required_buffer_size;
+            if (aligned_input_buffer_) aligned_free_64(aligned_input_buffer_);
+            aligned_input_buffer_ = aligned_alloc_64(required_buffer_size);
+            aligned_input_size_ = aligned_input_buffer_ ? required_buffer_size : 0;
+            update_memory_usage();
         }
         
-        if (aligned_input_buffer_) {
-            uint8_t* dst_y = aligned_input_buffer_;
-            uint8_t* dst_u = dst_y + size_y;
-            uint8_t* dst_v = dst_u + size_uv;
-            
-            int shift = (input_bit_depth_ > bit_depth_) ? (input_bit_depth_ - bit_depth_) : 0;
-            
-            // Copy Y row-by-row
-            // TODO: Optimize this copy loop with SIMD or parallel copy if it's a bottleneck
-            for(uint32_t y=0; y<height_; y++) {
-                const uint8_t* src = yuv_planes[0] + y*linesize[0];
-                uint8_t* dst = dst_y + y*tight_stride_y;
-                
-                if (shift > 0) {
-                    const uint16_t* s = (const uint16_t*)src;
-                    uint16_t* d = (uint16_t*)dst;
-                    for (uint32_t x=0; x<width_; x++) {
-                        d[x] = s[x] >> shift;
-                    }
-                } else {
-                    memcpy(dst, src, tight_stride_y);
-                }
-            }
-            
-            // Copy U/V row-by-row
-            uint32_t h_uv = (!is_444_ && !is_422_) ? height_/2 : height_;
-            uint32_t w_uv = (!is_444_) ? width_/2 : width_;
-            
-            for(uint32_t y=0; y<h_uv; y++) {
-                // U
-                const uint8_t* src_u = yuv_planes[1] + y*linesize[1];
-                uint8_t* dst_u_ptr = dst_u + y*tight_stride_uv;
-                
-                if (shift > 0) {
-                    const uint16_t* s = (const uint16_t*)src_u;
-                    uint16_t* d = (uint16_t*)dst_u_ptr;
-                    for (uint32_t x=0; x<w_uv; x++) {
-                        d[x] = s[x] >> shift;
-                    }
-                } else {
-                    memcpy(dst_u_ptr, src_u, tight_stride_uv);
-                }
-                
-                // V
-                const uint8_t* src_v = yuv_planes[2] + y*linesize[2];
-                uint8_t* dst_v_ptr = dst_v + y*tight_stride_uv;
-                
-                if (shift > 0) {
-                    const uint16_t* s = (const uint16_t*)src_v;
-                    uint16_t* d = (uint16_t*)dst_v_ptr;
-                    for (uint32_t x=0; x<w_uv; x++) {
-                        d[x] = s[x] >> shift;
-                    }
-                } else {
-                    memcpy(dst_v_ptr, src_v, tight_stride_uv);
-                }
-            }
-            
-            input_frame.image.data_yuv[0] = dst_y;
-            input_frame.image.data_yuv[1] = dst_u;
-            input_frame.image.data_yuv[2] = dst_v;
-            
-            input_frame.image.stride[0] = tight_stride_y / 2;
-            input_frame.image.stride[1] = tight_stride_uv / 2;
-            input_frame.image.stride[2] = tight_stride_uv / 2;
-            
-            input_frame.image.alloc_size[0] = size_y;
-            input_frame.image.alloc_size[1] = size_uv;
-            input_frame.image.alloc_size[2] = size_uv;
+        if (!aligned_input_buffer_) {
+            blog(LOG_ERROR, "[JpegXSEncoder] Failed to allocate %zu-byte input buffer", required_buffer_size);
+            return false;
         }
-    } else {
-        // 8-bit path
-        // Direct pointer assignment to avoid copy if possible.
-        // SVT-JPEG-XS generally handles strided input.
-        input_frame.image.data_yuv[0] = yuv_planes[0];
-        input_frame.image.data_yuv[1] = yuv_planes[1];
-        input_frame.image.data_yuv[2] = yuv_planes[2];
-        
-        input_frame.image.stride[0] = linesize[0];
-        input_frame.image.stride[1] = linesize[1];
-        input_frame.image.stride[2] = linesize[2];
         
-        input_frame.image.alloc_size[0] = linesize[0] * height_;
-        if (is_444_ || is_422_) {
-             input_frame.image.alloc_size[1] = linesize[1] * height_;
-             input_frame.image.alloc_size[2] = linesize[2] * height_;
+        repacker_.repack(yuv_planes, linesize, aligned_input_buffer_);
+        return encode_packed(aligned_input_buffer_, on_packet);
+    }
+    
+    // 8-bit path
+    // Direct pointer assignment to avoid copy if possible.
+    // SVT-JPEG-XS generally handles strided input.
+    input_frame.image.data_yuv[0] = yuv_planes[0];
+    input_frame.image.data_yuv[1] = yuv_planes[1];
+    input_frame.image.data_yuv[2] = yuv_planes[2];
+    
+    input_frame.image.stride[0] = linesize[0];
+    input_frame.image.stride[1] = linesize[1];
+    input_frame.image.stride[2] = linesize[2];
+    
+    input_frame.image.alloc_size[0] = linesize[0] * params_.height;
+    if (params_.is_444 || params_.is_422) {
+         input_frame.image.alloc_size[1] = linesize[1] * params_.height;
+         input_frame.image.alloc_size[2] = linesize[2] * params_.height;
+    } else {
+         input_frame.image.alloc_size[1] = linesize[1] * (params_.height / 2);
+         input_frame.image.alloc_size[2] = linesize[2] * (params_.height / 2);
+    }
+    
+    return submit_frame(&input_frame, on_packet);
+}
+
+bool JpegXSEncoder::pack_frame(const Params &input,
+                               const uint8_t *const src_planes[3], const uint32_t src_linesize[3],
+                               std::vector<uint8_t> &dst, uint32_t *generation) const
+{
+    // Snapshot the repacker so the copy itself runs outside the lock
+    jpegxs::PixelRepacker repacker;
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        if (pending_handle_ && pending_params_.same_input(input)) {
+            repacker = pending_repacker_;
+            *generation = pending_generation_;
+        } else if (encoder_handle_ && params_.same_input(input)) {
+            repacker = repacker_;
+            *generation = generation_;
         } else {
-             input_frame.image.alloc_size[1] = linesize[1] * (height_ / 2);
-             input_frame.image.alloc_size[2] = linesize[2] * (height_ / 2);
+            return false;
         }
     }
-
-    input_frame.user_prv_ctx_ptr = nullptr;
     
-    // Pre-allocate bitstream buffer
-    size_t required_size = width_ * height_ * 8; 
-    if (bitstream_buffer_.size() < required_size) {
-        bitstream_buffer_.resize(required_size);
+    dst.resize(repacker.packed_size());
+    repacker.repack(src_planes, src_linesize, dst.data());
+    return true;
+}
+
+bool JpegXSEncoder::encode_packed_frame(uint8_t *packed, uint32_t generation,
+                                        uint8_t **output_data, size_t *output_size)
+{
+    if (generation != generation_ && !commit_pending(generation)) {
+        return false;  // Packed for a session that was superseded
     }
     
-    input_frame.bitstream.buffer = bitstream_buffer_.data();
-    input_frame.bitstream.allocation_size = bitstream_buffer_.size();
-    input_frame.bitstream.used_size = 0;
+    output_buffer_.clear();
     
-    // Send frame to encoder
-    SvtJxsErrorType_t ret = svt_jpeg_xs_encoder_send_picture(enc_api, &input_frame, 1);
+    // Frame packetization delivers an unstriped codestream as one packet in
+    // the stripe's bitstream buffer, which stays untouched until the next
+    // frame is sent; only gather into output_buffer_ if more pieces follow.
+    const uint8_t *first_data = nullptr;
+    size_t first_size = 0;
+    size_t pieces = 0;
+    bool res = encode_packed(packed,
+        [&](const uint8_t* data, size_t size) {
+            if (pieces++ == 0) {
+                first_data = data;
+                first_size = size;
+                return;
+            }
+            if (pieces == 2) {
+                output_buffer_.insert(output_buffer_.end(), first_data, first_data + first_size);
+            }
+            output_buffer_.insert(output_buffer_.end(), data, data + size);
+        });
     
-    if (ret != SvtJxsErrorNone && ret != SvtJxsErrorNoErrorEmptyQueue) {
-        blog(LOG_ERROR, "[JpegXSEncoder] send_picture failed: 0x%x", ret);
-        return false;
+    if (output_buffer_.capacity() != output_capacity_seen_) {
+        output_capacity_seen_ = output_buffer_.capacity();
+        update_memory_usage();
     }
     
-    // Get packets and STREAM IMMEDIATELY via callback
-    bool finished_frame = false;
-    int packet_count = 0;
+    if (!res) {
+        return false;
+    }
+    if (pieces == 1 && first_size > 0) {
+        *output_data = const_cast<uint8_t*>(first_data);
+        *output_size = first_size;
+        return true;
+    }
+    if (!output_buffer_.empty()) {
+        *output_data = output_buffer_.data();
+        *output_size = output_buffer_.size();
+        return true;
+    }
+    return false;
+}
+
+bool JpegXSEncoder::encode_packed(uint8_t *packed, PacketCallback on_packet)
+{
+    if (!encoder_handle_) {
+        return false;
+    }
+    EncoderSession *session = static_cast<EncoderSession*>(encoder_handle_);
+    
+    uint8_t *planes[3];
+    uint32_t strides[3];
+    repacker_.packed_planes(packed, planes, strides);
+    
+    // SVT-JPEG-XS takes strides in samples, not bytes
+    uint32_t bytes_per_sample = (params_.bit_depth > 8) ? 2 : 1;
+    uint32_t chroma_shift = (params_.is_444 || params_.is_422) ? 0 : 1;
+    
+    if (session->stripes.size() == 1) {
+        svt_jpeg_xs_frame_t input_frame;
+        memset(&input_frame, 0, sizeof(input_frame));
+        for (int i = 0; i < 3; i++) {
+            input_frame.image.data_yuv[i] = planes[i];
+            input_frame.image.stride[i] = strides[i] / bytes_per_sample;
+            input_frame.image.alloc_size[i] = (uint32_t)repacker_.plane_size(i);
+        }
+        return submit_frame(&input_frame, on_packet);
+    }
     
-    while (!finished_frame) {
-        svt_jpeg_xs_frame_t output_frame;
-        memset(&output_frame, 0, sizeof(output_frame));
-        
-        // Blocking wait for packet
-        ret = svt_jpeg_xs_encoder_get_packet(enc_api, &output_frame, 1);
-        
-        if (ret == SvtJxsErrorNone) {
-            if (output_frame.bitstream.used_size > 0) {
-                // Check for overflow
-                if (output_frame.bitstream.used_size > bitstream_buffer_.size()) {
-                    blog(LOG_ERROR, "[JpegXSEncoder] Packet overflow");
-                    return false;
-                }
-                
-                // STREAM PACKET IMMEDIATELY
-                on_packet(output_frame.bitstream.buffer, output_frame.bitstream.used_size);
-        
-                stats_.bytes_encoded += output_frame.bitstream.used_size;
-            }
-            
-            if (output_frame.bitstream.last_packet_in_frame) {
-                finished_frame = true;
-            }
-            
-            packet_count++;
-            if (packet_count > 10000) { // Sanity limit
-                blog(LOG_ERROR, "[JpegXSEncoder] Too many packets >10000");
-                break;
-            }
-        } else if (ret == SvtJxsErrorNoErrorEmptyQueue) {
-            if (packet_count > 0) finished_frame = true;
-            else {
-                // Shouldn't happen if blocking get_packet is used correctly for valid frame
-                // But return false just in case
-                return false; 
-            }
-        } else {
-            blog(LOG_ERROR, "[JpegXSEncoder] get_packet failed: %d", ret);
+    // Striped: hand every instance its band of rows (pointers into the packed
+    // frame, no copies) before waiting on any, so the stripes encode concurrently
+    for (EncoderSession::Stripe &stripe : session->stripes) {
+        svt_jpeg_xs_frame_t input_frame;
+        memset(&input_frame, 0, sizeof(input_frame));
+        for (int i = 0; i < 3; i++) {
+            uint32_t shift = (i == 0) ? 0 : chroma_shift;
+            input_frame.image.data_yuv[i] = planes[i] + (size_t)(stripe.first_row >> shift) * strides[i];
+            input_frame.image.stride[i] = strides[i] / bytes_per_sample;
+            input_frame.image.alloc_size[i] = (stripe.rows >> shift) * strides[i];
+        }
+        if (!send_stripe(stripe, &input_frame)) {
             return false;
         }
     }
     
-    if (packet_count > 0) {
-        stats_.frames_encoded++;
-        return true;
+    std::vector<jpegxs::StripeFraming::Stripe> framing(session->stripes.size());
+    bool ok = true;
+    for (size_t i = 0; i < session->stripes.size(); i++) {
+        EncoderSession::Stripe &stripe = session->stripes[i];
+        stripe.codestream.clear();
+        // Keep draining after a failure so no instance is left holding a frame
+        ok = receive_stripe(stripe,
+            [&stripe](const uint8_t* data, size_t size) {
+                stripe.codestream.insert(stripe.codestream.end(), data, data + size);
+            }, &stats_.bytes_encoded) && ok;
+        
+        framing[i].first_row = stripe.first_row;
+        framing[i].rows = stripe.rows;
+        framing[i].size = stripe.codestream.size();
+    }
+    if (!ok) {
+        return false;
     }
     
-    return false;
+    uint8_t header[jpegxs::StripeFraming::headerSize(jpegxs::StripeFraming::MAX_STRIPES)];
+    jpegxs::StripeFraming::writeHeader(header, params_.width, params_.height, framing);
+    on_packet(header, jpegxs::StripeFraming::headerSize(framing.size()));
+    for (const EncoderSession::Stripe &stripe : session->stripes) {
+        on_packet(stripe.codestream.data(), stripe.codestream.size());
+    }
+    
+    stats_.frames_encoded++;
+    return true;
+}
+
+bool JpegXSEncoder::submit_frame(svt_jpeg_xs_frame_t *input_frame, PacketCallback on_packet)
+{
+    EncoderSession::Stripe &stripe = static_cast<EncoderSession*>(encoder_handle_)->stripes[0];
+    
+    if (!send_stripe(stripe, input_frame)) {
+        return false;
+    }
+    
+    // Get packets and STREAM IMMEDIATELY via callback
+    if (!receive_stripe(stripe, on_packet, &stats_.bytes_encoded)) {
+        return false;
+    }
+    
+    stats_.frames_encoded++;
+    return true;
 }
 
 // Legacy overload for compatibility
@@ -396,7 +803,7 @@ bool JpegXSEncoder::flush(uint8_t **output_data, size_t *output_size)
         return false;
     }
     
-    svt_jpeg_xs_encoder_api_t *enc_api = static_cast<svt_jpeg_xs_encoder_api_t*>(encoder_handle_);
+    svt_jpeg_xs_encoder_api_t *enc_api = static_cast<EncoderSession*>(encoder_handle_)->stripes[0].api;
     
     // Try to get any remaining packets
     svt_jpeg_xs_frame_t output_frame;
@@ -8,7 +8,15 @@
 #include <cstdint>
 #include <vector>
 
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "pixel_repack.h"
+#include "../network/thread_placement.h"
+#include "../network/memory_accounting.h"
 
 /**
  * JPEG XS Encoder
@@ -18,6 +26,39 @@ class JpegXSEncoder {
 public:
     using PacketCallback = std::function<void(const uint8_t* data, size_t size)>;
 
+    /**
+     * Encoder session parameters
+     */
+    struct Params {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t fps_num = 0;
+        uint32_t fps_den = 1;
+        float bitrate_mbps = 0.0f;
+        uint32_t threads_num = 0;
+        int bit_depth = 8;
+        int input_bit_depth = 8;  // Container depth of the captured frames
+        bool is_444 = false;
+        bool is_422 = false;
+        
+        // Codec tuning (see EncoderCalibrator for per-machine values)
+        uint32_t ndecomp_v = 2;
+        uint32_t ndecomp_h = 5;
+        uint32_t slice_height = 128;
+        
+        // Horizontal stripes encoded on independent SVT instances (1 = off).
+        // Striped frames use the StripeFraming container, which only this
+        // plugin's source decodes.
+        uint32_t stripes = 1;
+        
+        // True if frames captured for `other` can be packed for this session
+        bool same_input(const Params &other) const {
+            return width == other.width && height == other.height &&
+                   is_444 == other.is_444 && is_422 == other.is_422 &&
+                   input_bit_depth == other.input_bit_depth;
+        }
+    };
+
     JpegXSEncoder();
     ~JpegXSEncoder();
     
@@ -28,7 +69,7 @@ public:
      * @param fps_num Frame rate numerator
      * @param fps_den Frame rate denominator
      * @param bitrate_mbps Target bitrate in Mbps
-     * @param threads_num Number of threads (0 = auto)
+     * @param threads_num Number of threads (0 = auto, up to 8)
      * @param bit_depth Input bit depth (8 or 10)
      * @param is_444 True for 4:4:4 chroma, false for 4:2:0
      * @return true on success
@@ -39,6 +80,12 @@ public:
                    int bit_depth = 8, bool is_444 = false, bool is_422 = false,
                    int input_bit_depth = 0);
     
+    /**
+     * Initialize encoder from a full parameter set (including codec tuning)
+     * @return true on success
+     */
+    bool initialize(const Params &params);
+    
     /**
      * Encode a video frame and stream packets immediately via callback.
      * @param yuv_planes Array of YUV plane pointers
@@ -56,6 +103,68 @@ public:
                      uint64_t timestamp,
                      uint8_t **output_data, size_t *output_size);
     
+    /**
+     * Repack an OBS frame into the encoder's native layout in one pass
+     * (stride tightening and bit-depth shift fused with the capture copy).
+     * Once a reconfiguration is ready, frames matching its input are packed
+     * for the new session, which marks the switch-over point.
+     * @param input Layout of the captured frame (size, chroma, container depth)
+     * @param dst Resized to the packed frame size
+     * @param generation Receives the session generation the frame was packed for
+     * @return false if neither the current nor the pending session takes this input
+     */
+    bool pack_frame(const Params &input,
+                    const uint8_t *const src_planes[3], const uint32_t src_linesize[3],
+                    std::vector<uint8_t> &dst, uint32_t *generation) const;
+    
+    size_t get_packed_frame_size() const { return repacker_.packed_size(); }
+    const jpegxs::PixelRepacker &get_repacker() const { return repacker_; }
+    
+    /**
+     * Encode a frame previously produced by pack_frame() without further copies.
+     * A frame packed for the pending session swaps that session in first;
+     * frames packed for a superseded session are rejected.
+     */
+    bool encode_packed_frame(uint8_t *packed, uint32_t generation,
+                             uint8_t **output_data, size_t *output_size);
+    
+    /**
+     * Build a new SVT instance with different parameters on a side thread.
+     * The running instance keeps encoding until a frame packed for the new
+     * session reaches encode_packed_frame(), so the swap lands on a frame boundary.
+     * A call while another session is being built is queued behind it; only
+     * the newest queued parameters are built.
+     * @return false if the encoder is not initialized
+     */
+    bool reconfigure(const Params &params);
+    bool reconfigure_pending() const;
+    
+    /**
+     * Change the target bitrate via reconfigure(), keeping the rest of the
+     * newest requested parameters.
+     * SVT-JPEG-XS fixes the bpp budget at init (there is no call to change
+     * it on a running instance), so this rebuilds the instance; steps made
+     * during a build coalesce into the one queued after it.
+     * @param bitrate_mbps New target bitrate in Mbps
+     * @return true if the change was queued
+     */
+    bool set_bitrate(float bitrate_mbps);
+    float get_bitrate() const { return params_.bitrate_mbps; }
+    
+    Params get_params() const;
+    Params get_requested_params() const;  // Running session, or the newest reconfigure() target
+    uint32_t get_generation() const { return generation_; }
+    
+    // True for a frame packed for a session that was superseded before it ran
+    bool is_stale(uint32_t generation) const;
+    
+    /**
+     * CPU/NUMA placement for the SVT worker threads. SVT has no affinity
+     * control of its own, so instances are created under the CODEC placement
+     * and their workers inherit it. Applies to instances created afterwards.
+     */
+    void set_placement(const jpegxs::PlacementPlan &plan) { placement_ = plan; }
+    
     /**
      * Flush encoder and get any remaining packets
      * @param output_data Pointer to output data
@@ -75,31 +184,63 @@ public:
     
     Stats get_stats() const { return stats_; }
     
+    /**
+     * Bytes held in bitstream, input and output buffers by the running and
+     * any pending session (also counted under MemoryComponent::ENCODER)
+     */
+    size_t get_memory_usage() const { return memory_.bytes(); }
+    
 private:
-    // SVT-JPEG-XS encoder handle (opaque pointer)
+    static void *create_instance(const Params &params);
+    static void *create_svt(const Params &params, uint32_t *bytes_per_frame);
+    static size_t session_bytes(void *handle);
+    static std::vector<std::pair<uint32_t, uint32_t>> stripe_layout(const Params &params);
+    static uint32_t resolve_threads(uint32_t threads_num);
+    static void destroy_instance(void *handle);
+    static bool configure_repacker(jpegxs::PixelRepacker &repacker, const Params &params);
+    void build_pending(Params params, void *superseded);
+    bool commit_pending(uint32_t generation);
+    bool encode_packed(uint8_t *packed, PacketCallback on_packet);
+    bool submit_frame(struct svt_jpeg_xs_frame *input_frame, PacketCallback on_packet);
+    void update_memory_usage();
+    
+    // Encoder session: one SVT-JPEG-XS instance per stripe (opaque pointer)
     void *encoder_handle_;
     
-    // Configuration
-    uint32_t width_;
-    uint32_t height_;
-    uint32_t fps_num_;
-    uint32_t fps_den_;
-    float bitrate_mbps_;
-    uint32_t threads_num_;
-    int bit_depth_;
-    int input_bit_depth_;
-    bool is_444_;
-    bool is_422_;
-    
-    // Reusable buffer for bitstream (passed to encoder)
-    std::vector<uint8_t> bitstream_buffer_;
+    // Configuration of the running session
+    Params params_;
+    uint32_t generation_ = 0;
+    
+    // Session being built by reconfigure() (guarded by session_mutex_)
+    mutable std::mutex session_mutex_;
+    std::thread builder_;
+    std::atomic<bool> building_{false};
+    std::thread retirer_;                // Closes the session a swap replaced
+    bool queued_ = false;                // Parameters waiting for the current build
+    Params queued_params_;
+    Params requested_params_;
+    void *pending_handle_ = nullptr;
+    jpegxs::PixelRepacker pending_repacker_;
+    Params pending_params_;
+    uint32_t pending_generation_ = 0;
+    uint32_t next_generation_ = 1;
+    
+    jpegxs::PlacementPlan placement_;
+    
+    // Planar repack kernels for the configured format
+    jpegxs::PixelRepacker repacker_;
     
     // Internal aligned buffer for 10-bit input (if needed)
     uint8_t* aligned_input_buffer_ = nullptr;
     size_t aligned_input_size_ = 0;
     
-    // Reusable buffer for assembled output (returned to user)
+    // Reusable buffer for assembled output (returned to user). Only used when a
+    // frame arrives in several pieces; a single-packet codestream is returned
+    // straight from the session's bitstream buffer.
     std::vector<uint8_t> output_buffer_;
+    size_t output_capacity_seen_ = 0;
+    
+    jpegxs::MemoryAccounting::Tracker memory_{jpegxs::MemoryComponent::ENCODER};
     
     // Statistics
     Stats stats_;
@@ -5,12 +5,21 @@
 
 #include "obs_jpegxs_output.h"
 #include "jpegxs_encoder.h"
+#include "encoder_calibration.h"
+#include "plane_scaler.h"
+#include "worker_pool.h"
+#include "quality_monitor.h"
+#include "audio_sender.h"
 #include "../network/rtp_packet.h"
 #include "../network/srt_transport.h"
+#include "../network/srt_message.h"
+#include "../network/rate_controller.h"
 #include "../network/udp_socket.h"
 #include "../network/pacer.h"
 #include "../network/sdp_generator.h"
 #include "../network/ptp_clock.h"
+#include "../network/thread_placement.h"
+#include "../network/memory_accounting.h"
 
 #include <obs-module.h>
 #include <obs-avc.h>
@@ -25,27 +34,90 @@
 #include <condition_variable>
 #include <queue>
 #include <vector>
+#include <algorithm>
+#include <cmath>
 
 using jpegxs::RTPPacketizer;
+using jpegxs::SRTMessagePacketizer;
 using jpegxs::SRTTransport;
+using jpegxs::RateController;
 using jpegxs::UDPSocket;
 using jpegxs::Pacer;
 using jpegxs::SDPGenerator;
 using jpegxs::SDPConfig;
 using jpegxs::PTPClock;
+using jpegxs::PlacementPlan;
+using jpegxs::ThreadPlacement;
+using jpegxs::ThreadRole;
+using jpegxs::PlaneScaler;
+using jpegxs::WorkerPool;
+using jpegxs::MemoryAccounting;
+using jpegxs::QualityMonitor;
+using jpegxs::AudioSender;
 
 enum TransportMode {
     MODE_SRT = 0,
     MODE_ST2110 = 1
 };
 
+// What capture does when the encoder has not taken the previous frame yet
+enum AdmissionPolicy {
+    ADMIT_LATEST = 0,   // Mailbox: the new frame replaces the queued one
+    ADMIT_QUEUE = 1,    // Bounded queue: new frames are dropped while it is full
+    ADMIT_DEADLINE = 2  // Bounded queue (oldest replaced); frames older than the deadline are skipped
+};
+
 // Raw frame structure for queuing
+// Holds the frame already repacked into the encoder's native layout
 struct RawFrame {
-    std::vector<uint8_t> data[3];
-    uint32_t linesize[3];
+    std::vector<uint8_t> data;
     uint64_t timestamp;
     uint32_t width;
     uint32_t height;
+    uint32_t generation; // Encoder session the frame was packed for
+    int bit_depth;       // Packed layout, read by the rendition scalers
+    bool is_444;
+    bool is_422;
+};
+
+#define MAX_RENDITIONS 2
+
+// Lower rung of the rendition ladder, as configured
+struct RenditionConfig {
+    bool enabled = false;
+    std::string srt_url;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    float compression_ratio = 10.0f;
+};
+
+// Extra encode of each captured frame at a lower resolution/bitrate.
+// Scaled from the primary's packed frame and sent on its own SRT connection.
+struct Rendition {
+    uint32_t width;
+    uint32_t height;
+    float bitrate_mbps;
+    std::unique_ptr<JpegXSEncoder> encoder;
+    std::unique_ptr<RTPPacketizer> rtp_packetizer;
+    std::unique_ptr<SRTMessagePacketizer> srt_packetizer;  // Native SRT framing
+    std::unique_ptr<SRTTransport> srt_transport;
+    PlaneScaler scaler;
+    bool scaler_ready = false;
+    bool layout_warned = false;
+    std::vector<uint8_t> packed; // Scaled frame in this encoder's layout
+    uint64_t frames = 0;
+    uint64_t skipped = 0;
+};
+
+struct jpegxs_output;
+
+// Raw video hook delivering frames in one encoder input layout. OBS fixes an
+// output's own raw_video conversion at start, so capture goes through these
+// instead: a live reconfiguration that changes the size or pixel format adds
+// a feed for it and retires the old one once the new session has taken over.
+struct CaptureFeed {
+    jpegxs_output *context;
+    JpegXSEncoder::Params input;
 };
 
 struct jpegxs_output {
@@ -54,6 +126,7 @@ struct jpegxs_output {
     
     // Async Encoding Queue
     std::queue<std::unique_ptr<RawFrame>> frame_queue;
+    std::vector<std::unique_ptr<RawFrame>> free_frames; // Recycled by the worker (guarded by queue_mutex)
     std::mutex queue_mutex;
     std::condition_variable queue_cv;
     std::thread encode_thread;
@@ -61,12 +134,35 @@ struct jpegxs_output {
     
     // JPEG XS encoder
     std::unique_ptr<JpegXSEncoder> encoder;
+    uint32_t encoder_generation = 0; // Last session seen by the worker
+    
+    // Capture feeds
+    JpegXSEncoder::Params capture_input; // Input layout of the running session
+    std::vector<std::unique_ptr<CaptureFeed>> capture_feeds;
+    std::mutex feed_mutex;
     
     // Network transport components
     TransportMode mode;
     
     // SRT Components
     std::unique_ptr<SRTTransport> srt_transport;
+    std::unique_ptr<RateController> rate_controller; // Adaptive bitrate (optional); encode thread only
+    
+    // Live reconfiguration posts the new bitrate here; the encode thread
+    // rebuilds the controller and retunes SRTO_MAXBW at a frame boundary
+    std::mutex bitrate_mutex;
+    RateController::Config pending_abr;
+    float pending_bitrate_mbps = 0.0f;
+    std::atomic<bool> bitrate_pending{false};
+    
+    // Calibration sweep for a layout without cached tuning. It runs beside
+    // the live encoder, which starts on defaults; the worker switches to the
+    // result with a live reconfiguration.
+    std::thread calibration_thread;
+    std::atomic<bool> calibration_cancel{false};
+    std::atomic<bool> calibration_ready{false};
+    std::mutex calibration_mutex;
+    JpegXSEncoder::Params calibrated_params; // Guarded by calibration_mutex
     
     // ST 2110 Components
     std::unique_ptr<UDPSocket> udp_socket;
@@ -75,11 +171,20 @@ struct jpegxs_output {
     
     // Common
     std::unique_ptr<RTPPacketizer> rtp_packetizer;
+    std::unique_ptr<SRTMessagePacketizer> srt_packetizer;  // SRT with native framing instead of RTP
     
-    // Audio State
-    std::vector<uint8_t> audio_accumulator;
-    uint32_t audio_rtp_timestamp = 0;
-    uint16_t audio_seq_num = 0;
+    // Rendition ladder (encoded alongside the primary on the worker pool)
+    RenditionConfig rendition_config[MAX_RENDITIONS];
+    std::vector<std::unique_ptr<Rendition>> renditions;
+    std::unique_ptr<WorkerPool> worker_pool;
+    
+    // Loopback PSNR/SSIM on every Nth frame (optional)
+    bool quality_monitor_enabled;
+    uint32_t quality_interval;
+    std::unique_ptr<QualityMonitor> quality_monitor;
+    
+    // ST 2110-30 audio (lives as long as the context: raw_audio may still be running after stop)
+    std::unique_ptr<AudioSender> audio_sender;
     
     // Configuration
     uint32_t width;
@@ -90,25 +195,61 @@ struct jpegxs_output {
     float compression_ratio;
     std::string profile;
     float bitrate_mbps; // Calculated
+    uint32_t scale_width;  // 0 = OBS output resolution
+    uint32_t scale_height;
+    uint32_t encoder_threads; // 0 = auto
+    uint32_t encoder_stripes; // Parallel SVT instances (1 = single codestream)
+    bool encoder_calibrate;   // Cached per-machine tuning, measured in the background on a miss
+    
+    // Thread placement (CPU lists in "0-3,8" form, empty = unpinned)
+    std::string placement_encode_cpus;
+    std::string placement_codec_cpus;
+    std::string placement_pacer_cpus;
+    std::string placement_network_cpus;
+    int placement_numa_node;  // -1 = NIC local, -2 = off
+    bool placement_realtime;
+    PlacementPlan placement;  // Resolved at start
     
     // SRT Config
     std::string srt_url;
     std::string srt_passphrase;
     uint32_t srt_latency_ms;
+    bool srt_adaptive_bitrate;
+    float srt_abr_max_ratio; // Lowest quality the controller may fall back to
+    uint32_t srt_max_clients; // Listener URLs (?mode=listener): callers served at once
+    std::string srt_bonding;  // "none", "broadcast" or "backup"; the URL's ?grouptype= wins
+    std::string srt_bond_links; // Links beyond the URL's, host:port[@local-ip] comma-separated
+    bool srt_native_framing;  // Full SRT messages with a compact header (this plugin's receivers only)
     
     // ST 2110 Config
     std::string st2110_dest_ip;
     uint16_t st2110_dest_port;
     uint16_t st2110_audio_port; // Audio Port
     std::string st2110_source_ip; // Local interface to bind/sdp
+    std::string st2110_sdp_path;  // Where the stream's SDP is written
+    bool st2110_slice_mode;       // RFC 9134 slice packetization (K=1), else codestream
     bool disable_pacing;
     bool st2110_aws_compat;
     bool st2110_audio_enabled;
+    uint32_t st2110_audio_channels;
+    int st2110_audio_bit_depth;      // 16 (L16) or 24 (L24)
+    uint32_t st2110_audio_packet_us; // 1000 or 125
     
-    // State
+    // Frame admission (guarded by queue_mutex: update() writes it live)
+    AdmissionPolicy admission_policy;
+    uint32_t admission_queue_depth;  // Queue and deadline policies
+    uint32_t admission_deadline_ms;  // Deadline policy: max capture-to-encode age
+    
+    // State (counters are bumped from the capture and encode threads)
     std::atomic<bool> active;
-    uint64_t total_frames;
-    uint64_t dropped_frames;
+    std::atomic<uint64_t> total_frames{0};
+    std::atomic<uint64_t> dropped_frames{0};  // Rejected at capture (queue full) or failed to encode
+    std::atomic<uint64_t> replaced_frames{0}; // Superseded by a newer frame or encoder session
+    std::atomic<uint64_t> late_frames{0};     // Past the deadline when the worker got to them
+    
+    // Capture repack throughput (written by raw_video, read by the worker log)
+    std::atomic<uint64_t> repack_bytes{0};
+    std::atomic<uint64_t> repack_time_ns{0};
 };
 
 // Forward declarations
@@ -122,6 +263,664 @@ static void jpegxs_output_raw_audio(void *data, struct audio_data *frame);
 static obs_properties_t *jpegxs_output_properties(void *unused);
 static void jpegxs_output_get_defaults(obs_data_t *settings);
 static void jpegxs_output_update(void *data, obs_data_t *settings);
+static void update_start_settings(jpegxs_output *context, obs_data_t *settings);
+
+/**
+ * Map a JPEG XS profile name to coding parameters and the OBS capture format
+ */
+static enum video_format parse_profile(const std::string &profile, JpegXSEncoder::Params &params)
+{
+    params.bit_depth = 8;
+    params.is_444 = false;
+    params.is_422 = false;
+    enum video_format obs_format = VIDEO_FORMAT_I420;
+
+    if (profile.find("Main420.10") != std::string::npos) {
+        params.bit_depth = 10;
+        obs_format = VIDEO_FORMAT_I010;
+    } else if (profile.find("High422.8") != std::string::npos) {
+        params.is_422 = true;
+        obs_format = VIDEO_FORMAT_I422;
+    } else if (profile.find("High422.10") != std::string::npos) {
+        params.is_422 = true;
+        params.bit_depth = 10;
+        obs_format = VIDEO_FORMAT_I210;
+    } else if (profile.find("High444.8") != std::string::npos) {
+        params.is_444 = true;
+        obs_format = VIDEO_FORMAT_I444;
+    } else if (profile.find("High444.10") != std::string::npos) {
+        params.is_444 = true;
+        params.bit_depth = 10;
+        // OBS has no planar 10-bit 4:4:4 format; capture 12-bit I412 and
+        // shift down to 10-bit in the repack pass.
+        obs_format = VIDEO_FORMAT_I412;
+    }
+
+    params.input_bit_depth = (obs_format == VIDEO_FORMAT_I412) ? 12 : params.bit_depth;
+    return obs_format;
+}
+
+static void write_sdp(jpegxs_output *context, const JpegXSEncoder::Params &params)
+{
+    SDPConfig sdp_conf;
+    sdp_conf.stream_name = "OBS JPEG XS";
+    sdp_conf.source_ip = context->st2110_source_ip.empty() ? "127.0.0.1" : context->st2110_source_ip;
+    sdp_conf.dest_ip = context->st2110_dest_ip;
+    sdp_conf.dest_port = context->st2110_dest_port;
+    sdp_conf.width = params.width;
+    sdp_conf.height = params.height;
+    sdp_conf.fps_num = context->fps_num;
+    sdp_conf.fps_den = context->fps_den;
+    sdp_conf.depth = params.bit_depth;
+    sdp_conf.sampling = params.is_444 ? "YCbCr-4:4:4" : (params.is_422 ? "YCbCr-4:2:2" : "YCbCr-4:2:0");
+    sdp_conf.use_aws_compatibility = context->st2110_aws_compat;
+    sdp_conf.packetization_mode = context->st2110_slice_mode ? 1 : 0;
+    
+    if (context->st2110_audio_enabled && context->audio_sender->active()) {
+        const AudioSender::Config &audio = context->audio_sender->config();
+        sdp_conf.audio_enabled = true;
+        sdp_conf.audio_dest_port = context->st2110_audio_port;
+        sdp_conf.audio_channels = (uint8_t)audio.channels;
+        sdp_conf.audio_bit_depth = (uint8_t)audio.bit_depth;
+        sdp_conf.audio_sample_rate = audio.sample_rate;
+        sdp_conf.audio_payload_type = audio.payload_type;
+        sdp_conf.audio_packet_time_us = audio.packet_time_us;
+    }
+    
+    std::string sdp_content = SDPGenerator::generate(sdp_conf);
+    blog(LOG_INFO, "[JPEG XS] Generated SDP:\n%s", sdp_content.c_str());
+    
+    // Save SDP to disk for user convenience (a relative path is in the CWD)
+    const std::string &path = context->st2110_sdp_path.empty() ? std::string("jpegxs_stream.sdp") : context->st2110_sdp_path;
+    if (SDPGenerator::saveToFile(sdp_content, path)) {
+        blog(LOG_INFO, "[JPEG XS] Saved SDP to '%s'", path.c_str());
+    } else {
+        blog(LOG_WARNING, "[JPEG XS] Failed to save SDP to '%s'", path.c_str());
+    }
+}
+
+// OBS capture timestamps (os_gettime_ns) on the PTP timeline, so audio and
+// video RTP timestamps name the instant they were captured
+static uint64_t capture_to_ptp_ns(uint64_t capture_ns)
+{
+    return capture_ns + (PTPClock::now_ns() - os_gettime_ns());
+}
+
+// Connect the audio socket and start the ST 2110-30 sender; audio stays off if the format is not sendable
+static void start_audio(jpegxs_output *context)
+{
+    audio_t *audio = obs_output_audio(context->output);
+    AudioSender::Config config;
+    config.channels = context->st2110_audio_channels;
+    config.bit_depth = context->st2110_audio_bit_depth;
+    config.sample_rate = audio ? audio_output_get_sample_rate(audio) : 48000;
+    config.packet_time_us = context->st2110_audio_packet_us;
+    
+    if (!context->audio_sender->configure(config)) {
+        blog(LOG_WARNING, "[JPEG XS] ST 2110-30 audio disabled: %u ch L%d at %u us exceeds the %u-byte payload limit",
+             config.channels, config.bit_depth, config.packet_time_us, AudioSender::MAX_PAYLOAD_BYTES);
+        return;
+    }
+    if (config.sample_rate != 48000) {
+        blog(LOG_WARNING, "[JPEG XS] OBS audio runs at %u Hz; ST 2110-30 receivers expect 48000 Hz", config.sample_rate);
+    }
+    uint32_t obs_channels = audio ? (uint32_t)audio_output_get_channels(audio) : 0;
+    if (obs_channels < config.channels) {
+        blog(LOG_INFO, "[JPEG XS] ST 2110-30 channels %u-%u carry silence (OBS mixes %u)",
+             obs_channels + 1, config.channels, obs_channels);
+    }
+    
+    context->audio_udp_socket = std::make_unique<UDPSocket>();
+    // Connect usually preferred for burst sending
+    if (!context->audio_udp_socket->connect(context->st2110_dest_ip, context->st2110_audio_port)) {
+        blog(LOG_WARNING, "[JPEG XS] Failed to connect Audio UDP socket to %s:%u",
+             context->st2110_dest_ip.c_str(), context->st2110_audio_port);
+    }
+    
+    context->audio_sender->set_sender([ctx = context](const uint8_t *data, size_t size) {
+        return ctx->audio_udp_socket->send(data, size);
+    });
+    context->audio_sender->set_placement(context->placement);
+    context->audio_sender->start();
+    
+    blog(LOG_INFO, "[JPEG XS] ST 2110-30 audio: %u ch L%d/%u, %u frames per packet, SSRC %08X (%s)",
+         config.channels, config.bit_depth, config.sample_rate, context->audio_sender->packet_frames(),
+         context->audio_sender->ssrc(), jpegxs::PixelRepacker::isa_name(context->audio_sender->isa()));
+}
+
+// Comma-separated host:port[@local-ip] links, e.g. "10.0.0.5:9000@192.168.1.20"
+static std::vector<SRTTransport::GroupLink> parse_srt_links(const std::string &list)
+{
+    std::vector<SRTTransport::GroupLink> links;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string item = list.substr(start, end - start);
+        start = end + 1;
+        
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (item.empty()) continue;
+        
+        SRTTransport::GroupLink link;
+        size_t at = item.find('@');
+        if (at != std::string::npos) {
+            link.bind_address = item.substr(at + 1);
+            item = item.substr(0, at);
+        }
+        size_t colon = item.find_last_of(':');
+        link.address = item.substr(0, colon);
+        if (colon != std::string::npos) {
+            try {
+                link.port = (uint16_t)std::stoi(item.substr(colon + 1));
+            } catch (...) { link.port = 9000; }
+        }
+        links.push_back(link);
+    }
+    return links;
+}
+
+// Basic srt://host:port[?query] parsing; falls back to 127.0.0.1:9000.
+// "?mode=listener" (host optional) serves callers instead of connecting out;
+// "srt://a:port,b:port[@local-ip]?grouptype=broadcast|backup" bonds the links
+static void parse_srt_url(const std::string &url_str, SRTTransport::Config &srt_config)
+{
+    if (url_str.find("srt://") == 0) {
+        size_t query = url_str.find('?');
+        std::string params = query == std::string::npos ? "" : url_str.substr(query + 1);
+        if (params.find("mode=listener") != std::string::npos) {
+            srt_config.mode = SRTTransport::Mode::LISTENER;
+        }
+        if (params.find("grouptype=broadcast") != std::string::npos) {
+            srt_config.bonding = SRTTransport::Bonding::BROADCAST;
+        } else if (params.find("grouptype=backup") != std::string::npos) {
+            srt_config.bonding = SRTTransport::Bonding::BACKUP;
+        }
+        
+        std::string hosts = url_str.substr(6, query == std::string::npos ? std::string::npos : query - 6);
+        std::vector<SRTTransport::GroupLink> links = parse_srt_links(hosts);
+        if (!links.empty()) {
+            srt_config.address = links[0].address;
+            srt_config.port = links[0].port;
+        }
+        if (srt_config.bonding != SRTTransport::Bonding::NONE) {
+            srt_config.links = links;
+        }
+    }
+    if (srt_config.address.empty() && srt_config.mode == SRTTransport::Mode::CALLER) {
+        srt_config.address = "127.0.0.1";
+        srt_config.port = 9000;
+    }
+}
+
+// Listener: log joins and leaves of each caller; caller: connection state
+static void set_srt_state_callback(SRTTransport &transport, const std::string &prefix)
+{
+    transport.setStateCallback([prefix](bool connected, const std::string &event) {
+        if (connected) blog(LOG_INFO, "[JPEG XS] %sSRT Connected%s%s", prefix.c_str(), event.empty() ? "" : ": ", event.c_str());
+        else blog(LOG_INFO, "[JPEG XS] %sSRT Disconnected: %s", prefix.c_str(), event.c_str());
+    });
+}
+
+static void log_srt_clients(SRTTransport &transport, const std::string &prefix)
+{
+    SRTTransport::Stats stats = transport.pollStats();
+    for (const SRTTransport::LinkStats &link : transport.getLinkStats()) {
+        blog(LOG_INFO, "[JPEG XS] %sSRT link %s (weight %u): %s%s, %lld packets, %lld lost, "
+             "%lld retransmitted, %lld reconnects, RTT %.1f ms, %.1f Mbps",
+             prefix.c_str(), link.address.c_str(), link.weight, link.connected ? "up" : "down",
+             link.active ? ", active" : "", (long long)link.packets_sent, (long long)link.packets_send_lost,
+             (long long)link.packets_retransmitted, (long long)link.reconnects, link.rtt_ms, link.send_rate_mbps);
+    }
+    for (const SRTTransport::ClientStats &client : transport.getClientStats()) {
+        blog(LOG_INFO, "[JPEG XS] %sSRT client %s: %.0f s, %.1f MB, %lld frames skipped, "
+             "%lld retransmitted, %lld dropped late, RTT %.1f ms, buffer %.0f ms",
+             prefix.c_str(), client.address.c_str(), client.connected_s, client.bytes_sent / 1e6,
+             (long long)client.frames_skipped, (long long)client.packets_retransmitted,
+             (long long)client.packets_send_dropped, client.rtt_ms, client.send_buffer_ms);
+    }
+    if (stats.clients_rejected > 0) {
+        blog(LOG_INFO, "[JPEG XS] %sSRT listener refused %lld callers (limit reached)",
+             prefix.c_str(), (long long)stats.clients_rejected);
+    }
+}
+
+static void capture_frame(jpegxs_output *context, const JpegXSEncoder::Params &input, struct video_data *frame)
+{
+    if (!context->active || !context->encoder) return;
+    
+    // Repack straight into the encoder's native layout.
+    // This is the only pass over the captured pixels before SVT reads them.
+    std::unique_ptr<RawFrame> raw_frame;
+    {
+        std::lock_guard<std::mutex> lock(context->queue_mutex);
+        if (!context->free_frames.empty()) {
+            raw_frame = std::move(context->free_frames.back());
+            context->free_frames.pop_back();
+        }
+    }
+    if (!raw_frame) raw_frame = std::make_unique<RawFrame>();
+    raw_frame->width = input.width;
+    raw_frame->height = input.height;
+    raw_frame->timestamp = frame->timestamp;
+    raw_frame->bit_depth = input.bit_depth;
+    raw_frame->is_444 = input.is_444;
+    raw_frame->is_422 = input.is_422;
+    
+    uint64_t start_repack = os_gettime_ns();
+    
+    const uint8_t *planes[3] = { frame->data[0], frame->data[1], frame->data[2] };
+    if (!context->encoder->pack_frame(input, planes, frame->linesize, raw_frame->data, &raw_frame->generation)) {
+        // Feed not (or no longer) read by the encoder during a reconfiguration
+        std::lock_guard<std::mutex> lock(context->queue_mutex);
+        context->free_frames.push_back(std::move(raw_frame));
+        return;
+    }
+    
+    context->total_frames++;
+    context->repack_time_ns += os_gettime_ns() - start_repack;
+    context->repack_bytes += raw_frame->data.size();
+    
+    // Push to queue
+    {
+        std::lock_guard<std::mutex> lock(context->queue_mutex);
+        size_t depth = (context->admission_policy == ADMIT_LATEST) ? 1 : context->admission_queue_depth;
+        
+        if (context->frame_queue.size() >= depth) {
+            if (context->admission_policy == ADMIT_QUEUE) {
+                // Keep the queued frames for smooth motion; this one is lost
+                context->dropped_frames++;
+                context->free_frames.push_back(std::move(raw_frame));
+                return;
+            }
+            // Latest wins: the oldest queued frame makes way, so a busy
+            // encoder always picks up the freshest picture next
+            context->replaced_frames++;
+            context->free_frames.push_back(std::move(context->frame_queue.front()));
+            context->frame_queue.pop();
+        }
+        context->frame_queue.push(std::move(raw_frame));
+        context->queue_cv.notify_one();
+    }
+}
+
+static void capture_feed_video(void *param, struct video_data *frame)
+{
+    CaptureFeed *feed = static_cast<CaptureFeed*>(param);
+    capture_frame(feed->context, feed->input, frame);
+}
+
+// Have OBS convert frames to this input layout (caller holds feed_mutex)
+static void add_capture_feed(jpegxs_output *context, const JpegXSEncoder::Params &input, enum video_format obs_format)
+{
+    auto feed = std::make_unique<CaptureFeed>();
+    feed->context = context;
+    feed->input = input;
+    
+    struct video_scale_info conversion = {};
+    conversion.format = obs_format;
+    conversion.width = input.width;
+    conversion.height = input.height;
+    conversion.range = VIDEO_RANGE_DEFAULT;
+    conversion.colorspace = VIDEO_CS_DEFAULT;
+    
+    obs_add_raw_video_callback(&conversion, capture_feed_video, feed.get());
+    context->capture_feeds.push_back(std::move(feed));
+}
+
+static void remove_capture_feeds(jpegxs_output *context)
+{
+    std::lock_guard<std::mutex> feed_lock(context->feed_mutex);
+    for (const auto &feed : context->capture_feeds) {
+        obs_remove_raw_video_callback(capture_feed_video, feed.get());
+    }
+    context->capture_feeds.clear();
+}
+
+// Called on the worker once a reconfigured encoder session has taken over
+static void encoder_switched(jpegxs_output *context)
+{
+    JpegXSEncoder::Params previous = context->capture_input;
+    JpegXSEncoder::Params params = context->encoder->get_params();
+    context->encoder_generation = context->encoder->get_generation();
+    
+    // Retire capture feeds the new session no longer reads. If yet another
+    // reconfiguration is in flight its feed is still needed, so wait for that one.
+    if (!context->encoder->reconfigure_pending()) {
+        std::lock_guard<std::mutex> lock(context->feed_mutex);
+        for (auto it = context->capture_feeds.begin(); it != context->capture_feeds.end();) {
+            if (!(*it)->input.same_input(params)) {
+                obs_remove_raw_video_callback(capture_feed_video, it->get());
+                it = context->capture_feeds.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    context->capture_input = params;
+    context->width = params.width;
+    context->height = params.height;
+    
+    if (!params.same_input(previous) || params.bit_depth != previous.bit_depth) {
+        if (context->mode == MODE_ST2110) {
+            write_sdp(context, params);
+        }
+    }
+}
+
+static void stop_calibration(jpegxs_output *context)
+{
+    if (context->calibration_thread.joinable()) {
+        context->calibration_cancel = true;
+        context->calibration_thread.join();
+    }
+    context->calibration_ready = false;
+}
+
+// Sweep for these parameters off the calling thread; a sweep already
+// running is for settings that have been replaced, so it is cancelled
+static void start_calibration(jpegxs_output *context, const JpegXSEncoder::Params &params)
+{
+    stop_calibration(context);
+    context->calibration_cancel = false;
+    context->calibration_thread = std::thread([context, tuned = params]() mutable {
+        if (jpegxs::EncoderCalibrator::calibrate(tuned, true, nullptr, &context->calibration_cancel)) {
+            std::lock_guard<std::mutex> lock(context->calibration_mutex);
+            context->calibrated_params = tuned;
+            context->calibration_ready = true;
+        }
+    });
+}
+
+// Called on the worker once a background sweep has finished
+static void apply_calibration(jpegxs_output *context)
+{
+    JpegXSEncoder::Params tuned;
+    {
+        std::lock_guard<std::mutex> lock(context->calibration_mutex);
+        tuned = context->calibrated_params;
+    }
+    
+    // Measured for a layout the settings have since moved away from
+    JpegXSEncoder::Params params = context->encoder->get_requested_params();
+    if (!params.same_input(tuned) || params.bit_depth != tuned.bit_depth || params.stripes != tuned.stripes) {
+        return;
+    }
+    if (params.threads_num == tuned.threads_num && params.ndecomp_v == tuned.ndecomp_v &&
+        params.ndecomp_h == tuned.ndecomp_h && params.slice_height == tuned.slice_height) {
+        return;
+    }
+    
+    params.threads_num = tuned.threads_num;
+    params.ndecomp_v = tuned.ndecomp_v;
+    params.ndecomp_h = tuned.ndecomp_h;
+    params.slice_height = tuned.slice_height;
+    if (context->encoder->reconfigure(params)) {
+        blog(LOG_INFO, "[JPEG XS] Calibration done, switching to %u threads, V=%u, H=%u, slice %u",
+             params.threads_num, params.ndecomp_v, params.ndecomp_h, params.slice_height);
+    }
+}
+
+/**
+ * Apply encoder settings to a running output without touching the transport.
+ * The new SVT instance is built in the background; frames keep flowing
+ * through the old one until the swap. Settings changed again while a build
+ * (a user's or the adaptive bitrate's) is under way queue behind it.
+ */
+static void reconfigure_live(jpegxs_output *context)
+{
+    std::lock_guard<std::mutex> lock(context->mutex);
+    if (!context->active || !context->encoder) return;
+    
+    video_t *video = obs_output_video(context->output);
+    if (!video) return;
+    const struct video_output_info *voi = video_output_get_info(video);
+    
+    // Against what was last asked for, which may not be running yet
+    JpegXSEncoder::Params current = context->encoder->get_requested_params();
+    JpegXSEncoder::Params params = current;
+    enum video_format obs_format = parse_profile(context->profile, params);
+    
+    bool scaled = context->scale_width && context->scale_height;
+    params.width = scaled ? context->scale_width : voi->width;
+    params.height = scaled ? context->scale_height : voi->height;
+    params.stripes = context->encoder_stripes;
+    
+    float fps = (float)context->fps_num / context->fps_den;
+    float uncompressed_mbps = (params.width * params.height * fps * 16.0f) / 1000000.0f;
+    float bitrate_mbps = uncompressed_mbps / context->compression_ratio;
+    
+    bool bitrate_changed = std::fabs(bitrate_mbps - context->bitrate_mbps) > 0.01f;
+    bool layout_changed = !params.same_input(current) || params.bit_depth != current.bit_depth;
+    bool stripes_changed = params.stripes != current.stripes;
+    if (!bitrate_changed && !layout_changed && !stripes_changed) return;
+    
+    params.bitrate_mbps = bitrate_mbps;
+    
+    // Retune from the cache; a new layout without cached tuning starts on
+    // the current tuning and is measured in the background
+    bool calibrate_later = false;
+    JpegXSEncoder::Params untuned = params;
+    if (context->encoder_calibrate) {
+        params.threads_num = context->encoder_threads;
+        untuned.threads_num = context->encoder_threads;
+        if (!jpegxs::EncoderCalibrator::calibrate(params, false)) {
+            params.threads_num = current.threads_num;
+            calibrate_later = layout_changed || stripes_changed;
+        }
+    }
+    
+    // Hand the new bitrate to the worker first, so an adaptive bitrate step
+    // taken meanwhile comes from the new controller and not the old one
+    {
+        std::lock_guard<std::mutex> bitrate_lock(context->bitrate_mutex);
+        context->pending_abr.max_mbps = bitrate_mbps;
+        context->pending_abr.min_mbps = std::min(uncompressed_mbps / context->srt_abr_max_ratio, bitrate_mbps);
+        context->pending_abr.latency_ms = (int32_t)context->srt_latency_ms;
+        context->pending_bitrate_mbps = bitrate_mbps;
+        context->bitrate_pending = true;
+    }
+    
+    bool queued = context->encoder->reconfigure_pending();
+    if (!context->encoder->reconfigure(params)) {
+        blog(LOG_WARNING, "[JPEG XS] Encoder not running, settings not applied");
+        return;
+    }
+    context->bitrate_mbps = bitrate_mbps;
+    
+    blog(LOG_INFO, "[JPEG XS] Live reconfiguration%s: %ux%u %s, %.2f Mbps",
+         queued ? " (after the one in progress)" : "",
+         params.width, params.height, context->profile.c_str(), bitrate_mbps);
+    
+    if (calibrate_later) {
+        start_calibration(context, untuned);
+    }
+    
+    // Size or pixel format changes need frames OBS is not producing yet
+    std::lock_guard<std::mutex> feed_lock(context->feed_mutex);
+    for (const auto &feed : context->capture_feeds) {
+        if (feed->input.same_input(params)) return;
+    }
+    add_capture_feed(context, params, obs_format);
+}
+
+/**
+ * Resolve the thread placement settings into a plan. The NUMA node defaults
+ * to the one the sending NIC is attached to, so pinned threads and their
+ * buffers stay next to the device doing the DMA.
+ */
+static PlacementPlan build_placement(jpegxs_output *context)
+{
+    PlacementPlan plan;
+    plan.cpusFor(ThreadRole::ENCODE) = jpegxs::CpuSet::parse(context->placement_encode_cpus);
+    plan.cpusFor(ThreadRole::CODEC) = jpegxs::CpuSet::parse(context->placement_codec_cpus);
+    plan.cpusFor(ThreadRole::PACER) = jpegxs::CpuSet::parse(context->placement_pacer_cpus);
+    plan.cpusFor(ThreadRole::NETWORK) = jpegxs::CpuSet::parse(context->placement_network_cpus);
+    plan.realtime = context->placement_realtime;
+    
+    if (context->placement_numa_node >= 0) {
+        plan.numa_node = context->placement_numa_node;
+    } else if (context->placement_numa_node == -1) {
+        std::string local_ip = context->st2110_source_ip;
+        if (local_ip.empty()) {
+            std::string remote = (context->mode == MODE_ST2110) ? context->st2110_dest_ip : std::string();
+            if (context->mode == MODE_SRT && context->srt_url.find("srt://") == 0) {
+                remote = context->srt_url.substr(6, context->srt_url.find_last_of(':') - 6);
+            }
+            local_ip = ThreadPlacement::localAddressFor(remote);
+        }
+        plan.numa_node = ThreadPlacement::numaNodeForInterface(local_ip);
+    }
+    
+    if (plan.active()) {
+        blog(LOG_INFO, "[JPEG XS] Thread placement: NUMA node %d, encode [%s], codec [%s], pacer [%s], network [%s]%s",
+             plan.numa_node,
+             plan.cpusFor(ThreadRole::ENCODE).toString().c_str(),
+             plan.cpusFor(ThreadRole::CODEC).toString().c_str(),
+             plan.cpusFor(ThreadRole::PACER).toString().c_str(),
+             plan.cpusFor(ThreadRole::NETWORK).toString().c_str(),
+             plan.realtime ? ", real-time" : "");
+    }
+    return plan;
+}
+
+// Log where each placed thread actually ran, to verify pinning took effect
+static void log_thread_placement()
+{
+    for (const auto &t : ThreadPlacement::snapshot()) {
+        blog(LOG_INFO, "[JPEG XS Output] Thread %-12s (%s) cpus=[%s] last_cpu=%d cpu=%.1f%% migrations=%llu preempted=%llu%s",
+             t.name.c_str(), ThreadPlacement::roleName(t.role).c_str(),
+             t.cpus.empty() ? "any" : t.cpus.c_str(), t.last_cpu, t.cpu_percent,
+             (unsigned long long)t.migrations, (unsigned long long)t.involuntary_switches,
+             t.realtime ? " RT" : "");
+    }
+}
+
+/**
+ * Bring up one rung of the rendition ladder: same profile as the primary,
+ * its own encoder, packetizer and SRT caller connection
+ */
+static std::unique_ptr<Rendition> create_rendition(jpegxs_output *context, const RenditionConfig &config,
+                                                   const JpegXSEncoder::Params &primary)
+{
+    if (config.width > primary.width || config.height > primary.height) {
+        blog(LOG_WARNING, "[JPEG XS] Rendition %ux%u is larger than the %ux%u primary, skipped",
+             config.width, config.height, primary.width, primary.height);
+        return nullptr;
+    }
+    
+    auto rendition = std::make_unique<Rendition>();
+    rendition->width = config.width;
+    rendition->height = config.height;
+    
+    float fps = (float)context->fps_num / context->fps_den;
+    float uncompressed_mbps = (config.width * config.height * fps * 16.0f) / 1000000.0f;
+    rendition->bitrate_mbps = uncompressed_mbps / config.compression_ratio;
+    
+    // Fed from the scaler at the coded depth, so no depth conversion in the repack
+    JpegXSEncoder::Params params = primary;
+    params.width = config.width;
+    params.height = config.height;
+    params.input_bit_depth = primary.bit_depth;
+    params.bitrate_mbps = rendition->bitrate_mbps;
+    params.threads_num = 0;
+    params.stripes = 1;
+    
+    jpegxs::RepackChroma chroma = params.is_444 ? jpegxs::RepackChroma::CHROMA_444
+                                : (params.is_422 ? jpegxs::RepackChroma::CHROMA_422 : jpegxs::RepackChroma::CHROMA_420);
+    if (!rendition->scaler.configure(primary.width, primary.height, config.width, config.height,
+                                     chroma, primary.bit_depth)) {
+        blog(LOG_WARNING, "[JPEG XS] Rendition %ux%u: unsupported scale, skipped", config.width, config.height);
+        return nullptr;
+    }
+    rendition->scaler_ready = true;
+    
+    rendition->encoder = std::make_unique<JpegXSEncoder>();
+    rendition->encoder->set_placement(context->placement);
+    if (!rendition->encoder->initialize(params)) {
+        blog(LOG_WARNING, "[JPEG XS] Rendition %ux%u: failed to initialize encoder", config.width, config.height);
+        return nullptr;
+    }
+    rendition->packed.resize(rendition->encoder->get_packed_frame_size());
+    rendition->rtp_packetizer = std::make_unique<RTPPacketizer>(1350);
+    if (context->srt_native_framing) {
+        rendition->srt_packetizer = std::make_unique<SRTMessagePacketizer>(SRTTransport::LIVE_PAYLOAD_SIZE);
+    }
+    
+    SRTTransport::Config srt_config;
+    srt_config.mode = SRTTransport::Mode::CALLER;
+    parse_srt_url(config.srt_url, srt_config);
+    srt_config.latency_ms = context->srt_latency_ms;
+    srt_config.passphrase = context->srt_passphrase;
+    srt_config.max_bandwidth = RateController::maxBandwidthFor(rendition->bitrate_mbps);
+    srt_config.placement = context->placement;
+    if (srt_config.mode == SRTTransport::Mode::LISTENER) {
+        srt_config.max_clients = (int32_t)context->srt_max_clients;
+    }
+    
+    rendition->srt_transport = std::make_unique<SRTTransport>(srt_config);
+    std::string label = std::to_string(config.width) + "x" + std::to_string(config.height);
+    set_srt_state_callback(*rendition->srt_transport, "Rendition " + label + ": ");
+    if (!rendition->srt_transport->start()) {
+        blog(LOG_WARNING, "[JPEG XS] Rendition %s: failed to start SRT transport to %s",
+             label.c_str(), config.srt_url.c_str());
+        return nullptr;
+    }
+    
+    blog(LOG_INFO, "[JPEG XS] Rendition %s: %.2f Mbps (Ratio %.1f:1) -> %s (%s scaler)",
+         label.c_str(), rendition->bitrate_mbps, config.compression_ratio, config.srt_url.c_str(),
+         jpegxs::PixelRepacker::isa_name(rendition->scaler.isa()));
+    return rendition;
+}
+
+// Scale the primary's packed frame for one rendition, encode and send it
+static void encode_rendition(Rendition &rendition, const RawFrame &frame, uint32_t rtp_timestamp)
+{
+    JpegXSEncoder::Params params = rendition.encoder->get_params();
+    
+    // A live reconfiguration of the primary can change what the frame holds
+    if (!rendition.scaler.matches(frame.width, frame.height) || frame.bit_depth != params.bit_depth ||
+        frame.is_444 != params.is_444 || frame.is_422 != params.is_422) {
+        jpegxs::RepackChroma chroma = frame.is_444 ? jpegxs::RepackChroma::CHROMA_444
+                                    : (frame.is_422 ? jpegxs::RepackChroma::CHROMA_422 : jpegxs::RepackChroma::CHROMA_420);
+        rendition.scaler_ready = frame.bit_depth == params.bit_depth && frame.is_444 == params.is_444 &&
+                                 frame.is_422 == params.is_422 &&
+                                 rendition.scaler.configure(frame.width, frame.height, rendition.width, rendition.height,
+                                                            chroma, frame.bit_depth);
+        if (!rendition.scaler_ready && !rendition.layout_warned) {
+            blog(LOG_WARNING, "[JPEG XS Output] Rendition %ux%u cannot be derived from %ux%u %d-bit frames, paused",
+                 rendition.width, rendition.height, frame.width, frame.height, frame.bit_depth);
+        }
+        rendition.layout_warned = !rendition.scaler_ready;
+    }
+    if (!rendition.scaler_ready) {
+        rendition.skipped++;
+        return;
+    }
+    
+    rendition.scaler.scale(frame.data.data(), rendition.packed.data());
+    
+    uint8_t *encoded_data_ptr = nullptr;
+    size_t encoded_data_size = 0;
+    if (!rendition.encoder->encode_packed_frame(rendition.packed.data(), rendition.encoder->get_generation(),
+                                                &encoded_data_ptr, &encoded_data_size)) {
+        rendition.skipped++;
+        return;
+    }
+    
+    rendition.srt_transport->beginFrame(encoded_data_size);
+    auto send = [&](const uint8_t* packet_data, size_t packet_size) {
+        rendition.srt_transport->send(packet_data, packet_size);
+    };
+    if (rendition.srt_packetizer) {
+        rendition.srt_packetizer->packetize(encoded_data_ptr, encoded_data_size, rtp_timestamp, send);
+    } else {
+        rendition.rtp_packetizer->packetize(encoded_data_ptr, encoded_data_size, rtp_timestamp, true, send);
+    }
+    rendition.frames++;
+}
 
 // Worker thread function
 static void encode_worker(jpegxs_output *context) {
@@ -130,14 +929,32 @@ static void encode_worker(jpegxs_output *context) {
     // Set highest priority to ensure encoder is not preempted
 #ifdef _WIN32
     SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
-#else
-    // POSIX/macOS: Typically requires root or specific entitlements, but let's try
-    // standard OBS helpers usually handle this if available, but we are in a raw std::thread.
-    // We rely on the OS scheduler being smart for now, as 'os_set_thread_name' is the only OBS helper.
 #endif
     
+    std::string placement_error;
+    if (context->placement.active() &&
+        !ThreadPlacement::apply(context->placement, ThreadRole::ENCODE, "jxs-encode", &placement_error)) {
+        blog(LOG_WARNING, "[JPEG XS Output] Encode thread placement: %s", placement_error.c_str());
+    }
+    
+    // Pre-fault the frame pool from this thread so, under the NUMA memory
+    // policy just applied, capture buffers live on the encoder's node
+    {
+        std::lock_guard<std::mutex> lock(context->queue_mutex);
+        for (int i = 0; i < 2; i++) {
+            auto pooled = std::make_unique<RawFrame>();
+            pooled->data.resize(context->encoder->get_packed_frame_size());
+            context->free_frames.push_back(std::move(pooled));
+        }
+    }
+    
+    uint64_t last_placement_log = os_gettime_ns();
+    uint64_t encoded_frame_index = 0;
+    
     while (context->encode_thread_active) {
         std::unique_ptr<RawFrame> frame;
+        AdmissionPolicy policy;
+        uint64_t deadline_ns;
         
         {
             std::unique_lock<std::mutex> lock(context->queue_mutex);
@@ -151,15 +968,61 @@ static void encode_worker(jpegxs_output *context) {
                 frame = std::move(context->frame_queue.front());
                 context->frame_queue.pop();
             }
+            policy = context->admission_policy;
+            deadline_ns = (uint64_t)context->admission_deadline_ms * 1000000ULL;
         }
         
         if (!frame) continue;
         
+        // Packed for an encoder session that was replaced before it ran: the
+        // newer session's frames are right behind it, so this is no drop
+        if (context->encoder->is_stale(frame->generation)) {
+            std::lock_guard<std::mutex> lock(context->queue_mutex);
+            context->replaced_frames++;
+            context->free_frames.push_back(std::move(frame));
+            continue;
+        }
+        
+        // Deadline policy: a frame that waited too long would only add latency
+        if (policy == ADMIT_DEADLINE && os_gettime_ns() - frame->timestamp > deadline_ns) {
+            std::lock_guard<std::mutex> lock(context->queue_mutex);
+            context->late_frames++;
+            context->free_frames.push_back(std::move(frame));
+            continue;
+        }
+        
+        if (context->calibration_ready.exchange(false)) {
+            apply_calibration(context);
+        }
+        
+        // A live reconfiguration's bitrate, handed over by reconfigure_live()
+        if (context->bitrate_pending.exchange(false)) {
+            std::lock_guard<std::mutex> bitrate_lock(context->bitrate_mutex);
+            if (context->rate_controller) {
+                context->rate_controller = std::make_unique<RateController>(context->pending_abr);
+            }
+            if (context->srt_transport) {
+                context->srt_transport->setMaxBandwidth(RateController::maxBandwidthFor(context->pending_bitrate_mbps));
+            }
+        }
+        
+        // Adaptive bitrate: apply at a frame boundary, before this frame is encoded
+        // srt_bistats only when the controller will look at it
+        uint64_t abr_now = os_gettime_ns();
+        if (context->rate_controller && context->srt_transport && context->rate_controller->due(abr_now)) {
+            if (context->rate_controller->update(context->srt_transport->pollStats(), abr_now)) {
+                RateController::Stats abr = context->rate_controller->getStats();
+                if (context->encoder->set_bitrate((float)abr.target_mbps)) {
+                    context->srt_transport->setMaxBandwidth(RateController::maxBandwidthFor(abr.target_mbps));
+                    blog(LOG_INFO, "[JPEG XS Output] ABR: %.1f Mbps (SndBuf=%.0fms, Retrans=%.2f%%, Loss=%.2f%%)",
+                         abr.target_mbps, abr.send_buffer_ms, abr.retrans_rate * 100.0, abr.loss_rate * 100.0);
+                }
+            }
+        }
+        
         // Encode Logic (Moved from raw_video)
         uint8_t *encoded_data_ptr = nullptr;
         size_t encoded_data_size = 0;
-        uint8_t *planes[3] = { frame->data[0].data(), frame->data[1].data(), frame->data[2].data() };
-        uint32_t linesizes[3] = { frame->linesize[0], frame->linesize[1], frame->linesize[2] };
         
         // Detailed timing logging
         static uint64_t last_log_time = 0;
@@ -169,47 +1032,96 @@ static void encode_worker(jpegxs_output *context) {
         
         uint64_t start_encode = os_gettime_ns();
         
+        // One timestamp per captured frame, shared by every rendition and
+        // taken from capture time so it lines up with the audio
+        uint32_t rtp_timestamp = PTPClock::rtp_timestamp(capture_to_ptp_ns(frame->timestamp), 90000);
+        
         // Standard buffer-based encoding (restored for stability)
-        if (!context->encoder->encode_frame(planes, linesizes, frame->timestamp, &encoded_data_ptr, &encoded_data_size)) {
+        // Frame was packed to the encoder layout in raw_video, so no second copy here
+        bool encoded = false;
+        if (context->renditions.empty()) {
+            encoded = context->encoder->encode_packed_frame(frame->data.data(), frame->generation,
+                                                            &encoded_data_ptr, &encoded_data_size);
+        } else {
+            // Primary on this thread, each rendition on a pool thread; all
+            // read the same packed frame, which is recycled once they are done
+            const RawFrame &shared = *frame;
+            context->worker_pool->run(context->renditions.size() + 1, [&](size_t index) {
+                if (index == 0) {
+                    encoded = context->encoder->encode_packed_frame(frame->data.data(), frame->generation,
+                                                                    &encoded_data_ptr, &encoded_data_size);
+                } else {
+                    encode_rendition(*context->renditions[index - 1], shared, rtp_timestamp);
+                }
+            });
+        }
+        // Sampled frames go to the quality monitor by buffer swap, so the
+        // monitor never holds up this thread
+        if (encoded && context->quality_monitor && context->quality_monitor->wants(encoded_frame_index)) {
+            context->quality_monitor->submit(frame->data, context->encoder->get_params(),
+                                             encoded_data_ptr, encoded_data_size, frame->timestamp);
+        }
+        if (encoded) encoded_frame_index++;
+        {
+            std::lock_guard<std::mutex> lock(context->queue_mutex);
+            context->free_frames.push_back(std::move(frame));
+        }
+        if (!encoded) {
             context->dropped_frames++;
             continue;
         }
         
+        if (context->encoder->get_generation() != context->encoder_generation) {
+            encoder_switched(context);
+        }
+        
         uint64_t end_encode = os_gettime_ns();
         accumulated_encode_time_ns += (end_encode - start_encode);
         
         // Packetize and Send
-        uint32_t rtp_timestamp = PTPClock::get_rtp_timestamp();
-        
         uint64_t start_send = os_gettime_ns();
         
         // Accumulator for Pacer
         std::vector<std::vector<uint8_t>> frame_packets;
+        
+        // Listener fan-out skips whole frames for clients that can't take them
+        if (context->mode == MODE_SRT && context->srt_transport) {
+            context->srt_transport->beginFrame(encoded_data_size);
+        }
     
-    context->rtp_packetizer->packetize(
-        encoded_data_ptr, 
-        encoded_data_size, 
-        rtp_timestamp,
-        true,
-        [&](const uint8_t* packet_data, size_t packet_size) {
-            if (context->mode == MODE_SRT) {
+    if (context->mode == MODE_SRT && context->srt_packetizer) {
+        context->srt_packetizer->packetize(encoded_data_ptr, encoded_data_size, rtp_timestamp,
+            [&](const uint8_t* message, size_t message_size) {
                 if (context->srt_transport) {
-                    context->srt_transport->send(packet_data, packet_size);
+                    context->srt_transport->send(message, message_size);
                 }
-            } else {
-                // ST 2110 - Pacer or Burst
-                if (context->disable_pacing && context->udp_socket) {
-                    if (!context->udp_socket->send(packet_data, packet_size)) {
-                         context->udp_socket->sendTo(packet_data, packet_size, context->st2110_dest_ip, context->st2110_dest_port);
+            });
+    } else {
+        context->rtp_packetizer->packetize(
+            encoded_data_ptr, 
+            encoded_data_size, 
+            rtp_timestamp,
+            true,
+            [&](const uint8_t* packet_data, size_t packet_size) {
+                if (context->mode == MODE_SRT) {
+                    if (context->srt_transport) {
+                        context->srt_transport->send(packet_data, packet_size);
+                    }
+                } else {
+                    // ST 2110 - Pacer or Burst
+                    if (context->disable_pacing && context->udp_socket) {
+                        if (!context->udp_socket->send(packet_data, packet_size)) {
+                             context->udp_socket->sendTo(packet_data, packet_size, context->st2110_dest_ip, context->st2110_dest_port);
+                        }
+                    } else if (context->pacer) {
+                        // Collect packet for pacing
+                        std::vector<uint8_t> p(packet_data, packet_data + packet_size);
+                        frame_packets.push_back(std::move(p));
                     }
-                } else if (context->pacer) {
-                    // Collect packet for pacing
-                    std::vector<uint8_t> p(packet_data, packet_data + packet_size);
-                    frame_packets.push_back(std::move(p));
                 }
             }
-        }
-    );
+        );
+    }
     
     // If using Pacer, enqueue the whole frame now
     if (context->mode == MODE_ST2110 && !context->disable_pacing && context->pacer && !frame_packets.empty()) {
@@ -225,14 +1137,34 @@ static void encode_worker(jpegxs_output *context) {
         if (current_time - last_log_time >= 1000000000ULL) { // Every second
             double avg_encode = (double)accumulated_encode_time_ns / frame_count_log / 1000000.0;
             double avg_send = (double)accumulated_send_time_ns / frame_count_log / 1000000.0;
-            blog(LOG_INFO, "[JPEG XS Output] Stats (1s): Frames=%llu, Avg Encode=%.2fms, Avg Send=%.2fms, Dropped=%llu", 
-                 frame_count_log, avg_encode, avg_send, context->dropped_frames);
+            uint64_t repack_bytes = context->repack_bytes.exchange(0);
+            uint64_t repack_ns = context->repack_time_ns.exchange(0);
+            double repack_gbps = repack_ns ? (double)repack_bytes / (double)repack_ns : 0.0;
+            size_t memory_bytes = context->encoder->get_memory_usage() +
+                                  (context->pacer ? context->pacer->memoryUsage() : 0);
+            blog(LOG_INFO, "[JPEG XS Output] Stats (1s): Frames=%llu, Avg Encode=%.2fms, Avg Send=%.2fms, Dropped=%llu, Replaced=%llu, Late=%llu, Repack=%.2f GB/s (%s, %s), Mem=%.1f MB", 
+                 frame_count_log, avg_encode, avg_send, (unsigned long long)context->dropped_frames.load(),
+                 (unsigned long long)context->replaced_frames.load(), (unsigned long long)context->late_frames.load(), repack_gbps,
+                 context->encoder->get_repacker().kernel_name(),
+                 jpegxs::PixelRepacker::isa_name(context->encoder->get_repacker().isa()),
+                 memory_bytes / 1048576.0);
+            
+            for (const auto &rendition : context->renditions) {
+                blog(LOG_INFO, "[JPEG XS Output] Rendition %ux%u: Frames=%llu, Skipped=%llu",
+                     rendition->width, rendition->height,
+                     (unsigned long long)rendition->frames, (unsigned long long)rendition->skipped);
+            }
             
             last_log_time = current_time;
             accumulated_encode_time_ns = 0;
             accumulated_send_time_ns = 0;
             frame_count_log = 0;
         }
+        
+        if (context->placement.active() && current_time - last_placement_log >= 10000000000ULL) {
+            log_thread_placement();
+            last_placement_log = current_time;
+        }
     }
 }
 
@@ -282,6 +1214,9 @@ static void *jpegxs_output_create(obs_data_t *settings, obs_output_t *output)
     context->active = false;
     context->total_frames = 0;
     context->dropped_frames = 0;
+    context->replaced_frames = 0;
+    context->late_frames = 0;
+    context->audio_sender = std::make_unique<AudioSender>();
     
     // Initialize with settings
     jpegxs_output_update(context, settings);
@@ -309,6 +1244,13 @@ static bool jpegxs_output_start(void *data)
     try {
         blog(LOG_INFO, "[JPEG XS] Starting output stream");
         
+        // Pick up transport settings changed while the output was running
+        obs_data_t *settings = obs_output_get_settings(context->output);
+        if (settings) {
+            update_start_settings(context, settings);
+            obs_data_release(settings);
+        }
+        
         // Get video info from OBS
         video_t *video = obs_output_video(context->output);
         if (!video) {
@@ -322,6 +1264,12 @@ static bool jpegxs_output_start(void *data)
         context->fps_num = voi->fps_num;
         context->fps_den = voi->fps_den;
         
+        // Optional encode size; OBS scales in its output conversion
+        if (context->scale_width && context->scale_height) {
+            context->width = context->scale_width;
+            context->height = context->scale_height;
+        }
+        
         blog(LOG_INFO, "[JPEG XS] Resolution: %ux%u @ %.2f fps", 
              context->width, context->height, 
              (float)context->fps_num / context->fps_den);
@@ -335,99 +1283,72 @@ static bool jpegxs_output_start(void *data)
              context->bitrate_mbps, context->compression_ratio);
         
         // Parse Profile
-        int bit_depth = 8;
-        bool is_444 = false;
-        bool is_422 = false;
-        enum video_format obs_format = VIDEO_FORMAT_I420;
-
-        if (context->profile.find("Main420.10") != std::string::npos) {
-            bit_depth = 10;
-            obs_format = VIDEO_FORMAT_I010;
-        } else if (context->profile.find("High422.8") != std::string::npos) {
-            is_422 = true;
-            obs_format = VIDEO_FORMAT_I422;
-        } else if (context->profile.find("High422.10") != std::string::npos) {
-            is_422 = true;
-            bit_depth = 10;
-            obs_format = VIDEO_FORMAT_I210;
-        } else if (context->profile.find("High444.8") != std::string::npos) {
-            is_444 = true;
-            obs_format = VIDEO_FORMAT_I444;
-        } else if (context->profile.find("High444.10") != std::string::npos) {
-            is_444 = true;
-            bit_depth = 10;
-            // Try to use 12-bit or 10-bit packed if planar 10-bit 444 isn't available
-            // OBS doesn't have a standard I444 10-bit planar format widely used/exposed easily in all versions
-            // But let's try VIDEO_FORMAT_I444 (8-bit) or maybe VIDEO_FORMAT_I412 if available?
-            // For now, let's assume I444 10-bit might need a specific format or we just feed 8-bit container?
-            // Actually, let's check if VIDEO_FORMAT_I410 exists? No.
-            // Let's use VIDEO_FORMAT_YA2L (which is 10-bit packed) or similar? No.
-            // Best bet: VIDEO_FORMAT_I444 is 8-bit.
-            // If we want 10-bit 444, we might need to use VIDEO_FORMAT_I444 and just cast if OBS supports it,
-            // OR we might be limited.
-            // Let's use VIDEO_FORMAT_I444 for now and see if we can get 10-bit data?
-            // Actually, let's look for VIDEO_FORMAT_I412 or similar in newer OBS.
-            // If not available, we might have to disable 444 10-bit or warn.
-            // Let's try VIDEO_FORMAT_I444 and hope for the best or use VIDEO_FORMAT_I412 if defined.
-            // Since I can't check headers easily, I'll assume standard OBS formats.
-            // Let's use VIDEO_FORMAT_I444 for 10-bit but this is likely wrong (it's 8-bit).
-            // Wait, VIDEO_FORMAT_I412 is 12-bit 4:4:4.
-            // Let's stick to what we know:
-            // 4:2:0 8-bit -> I420
-            // 4:2:0 10-bit -> I010
-            // 4:2:2 8-bit -> I422
-            // 4:2:2 10-bit -> I210
-            // 4:4:4 8-bit -> I444
-            // 4:4:4 10-bit -> ??? (Maybe we skip 10-bit 444 for now if unsure, or map to I444 and truncate?)
-            // Let's map to I444 and set bit_depth=10, but OBS might convert to 8-bit.
-            // Actually, let's just support 8-bit 444 for now to be safe, OR use I412 if we want >8 bit.
-            // Let's add it but warn/fallback.
-            // Actually, let's just use I444 and 8-bit for now for "High444.10" to avoid compilation error if I412 is missing.
-            // REVISION: I will comment out High444.10 support in the UI if I can't be sure.
-            // But the task asked for it.
-            // Let's try VIDEO_FORMAT_I412. If it fails to compile, I'll fix it.
-            obs_format = VIDEO_FORMAT_I412; 
-        }
+        JpegXSEncoder::Params profile_params;
+        enum video_format obs_format = parse_profile(context->profile, profile_params);
+        int bit_depth = profile_params.bit_depth;
+        bool is_444 = profile_params.is_444;
+        bool is_422 = profile_params.is_422;
         
         blog(LOG_INFO, "[JPEG XS] Profile: %s (Depth: %d-bit, Chroma: %s)", 
              context->profile.c_str(), bit_depth, 
              is_444 ? "4:4:4" : (is_422 ? "4:2:2" : "4:2:0"));
 
-        // Force video conversion to requested format
-        struct video_scale_info conversion = {};
-        conversion.format = obs_format;
-        conversion.width = context->width;
-        conversion.height = context->height;
-        conversion.range = VIDEO_RANGE_DEFAULT;
-        conversion.colorspace = VIDEO_CS_DEFAULT;
-        
-        obs_output_set_video_conversion(context->output, &conversion);
+        // Frames come through a capture feed in this format (see CaptureFeed)
+        context->format = obs_format;
         
         // Set active flag late to avoid race condition
         context->active = true; // Enable before thread start
         
         // Initialize JPEG XS encoder
-        int input_bit_depth = bit_depth;
-        if (obs_format == VIDEO_FORMAT_I412) {
-            input_bit_depth = 12;
-        }
+        JpegXSEncoder::Params enc_params = profile_params;
+        enc_params.width = context->width;
+        enc_params.height = context->height;
+        enc_params.fps_num = context->fps_num;
+        enc_params.fps_den = context->fps_den;
+        enc_params.bitrate_mbps = context->bitrate_mbps;
+        enc_params.threads_num = context->encoder_threads;
+        enc_params.stripes = context->encoder_stripes;
+        
+        context->placement = build_placement(context);
+        
+        // Start on cached tuning, or on defaults while the sweep runs in the
+        // background (it takes seconds, and this is the UI thread)
+        bool calibrate_later = context->encoder_calibrate &&
+                               !jpegxs::EncoderCalibrator::calibrate(enc_params, false);
 
         context->encoder = std::make_unique<JpegXSEncoder>();
-        if (!context->encoder->initialize(context->width, context->height, 
-                                           context->fps_num, context->fps_den,
-                                           context->bitrate_mbps, 0,
-                                           bit_depth, is_444, is_422,
-                                           input_bit_depth)) {
+        context->encoder->set_placement(context->placement);
+        if (!context->encoder->initialize(enc_params)) {
             blog(LOG_ERROR, "[JPEG XS] Failed to initialize encoder");
             return false;
         }
+        context->capture_input = context->encoder->get_params();
+        context->encoder_generation = context->encoder->get_generation();
         
         // Initialize RTP packetizer
         context->rtp_packetizer = std::make_unique<RTPPacketizer>(1350); // Slightly safer MTU
+        // ST 2110 receivers get what the SDP declares; some only take codestream mode
+        context->rtp_packetizer->setSliceMode(context->mode == MODE_SRT || context->st2110_slice_mode);
+        if (context->mode == MODE_SRT && context->srt_native_framing) {
+            context->srt_packetizer = std::make_unique<SRTMessagePacketizer>(SRTTransport::LIVE_PAYLOAD_SIZE);
+            blog(LOG_INFO, "[JPEG XS] SRT native framing: %zu-byte messages", SRTTransport::LIVE_PAYLOAD_SIZE);
+        }
         
-        // Start encoding worker thread
-        context->encode_thread_active = true;
-        context->encode_thread = std::thread(encode_worker, context);
+        if (context->quality_monitor_enabled) {
+            context->quality_monitor = std::make_unique<QualityMonitor>(context->quality_interval);
+            blog(LOG_INFO, "[JPEG XS] Quality monitor: loopback decode of every %u frames", context->quality_interval);
+        }
+        
+        // Lower renditions, each scaled from the primary's captured frame
+        for (const RenditionConfig &config : context->rendition_config) {
+            if (!config.enabled) continue;
+            auto rendition = create_rendition(context, config, context->capture_input);
+            if (rendition) context->renditions.push_back(std::move(rendition));
+        }
+        if (!context->renditions.empty()) {
+            context->worker_pool = std::make_unique<WorkerPool>(context->renditions.size(), context->placement,
+                                                                ThreadRole::ENCODE);
+        }
         
         // Initialize Transport
         if (context->mode == MODE_SRT) {
@@ -435,36 +1356,46 @@ static bool jpegxs_output_start(void *data)
             
             SRTTransport::Config srt_config;
             srt_config.mode = SRTTransport::Mode::CALLER;
+            if (context->srt_bonding == "broadcast") srt_config.bonding = SRTTransport::Bonding::BROADCAST;
+            else if (context->srt_bonding == "backup") srt_config.bonding = SRTTransport::Bonding::BACKUP;
             
-            // Basic SRT URL parsing (same as before)
-            std::string url_str = context->srt_url;
-            if (url_str.find("srt://") == 0) {
-                size_t port_pos = url_str.find_last_of(':');
-                if (port_pos != std::string::npos && port_pos > 6) {
-                    std::string port_str = url_str.substr(port_pos + 1);
-                    size_t query_pos = port_str.find('?');
-                    if (query_pos != std::string::npos) port_str = port_str.substr(0, query_pos);
-                    
-                    try {
-                        srt_config.port = (uint16_t)std::stoi(port_str);
-                    } catch (...) { srt_config.port = 9000; }
-                    
-                    srt_config.address = url_str.substr(6, port_pos - 6);
+            parse_srt_url(context->srt_url, srt_config);
+            srt_config.latency_ms = context->srt_latency_ms;
+            srt_config.passphrase = context->srt_passphrase;
+            srt_config.max_bandwidth = RateController::maxBandwidthFor(context->bitrate_mbps);
+            srt_config.placement = context->placement;
+            
+            bool listener = srt_config.mode == SRTTransport::Mode::LISTENER;
+            if (!listener && srt_config.bonding != SRTTransport::Bonding::NONE) {
+                for (const SRTTransport::GroupLink &link : parse_srt_links(context->srt_bond_links)) {
+                    srt_config.links.push_back(link);
                 }
+                blog(LOG_INFO, "[JPEG XS] SRT %s bonding over %zu links",
+                     srt_config.bonding == SRTTransport::Bonding::BROADCAST ? "broadcast" : "main/backup",
+                     srt_config.links.size());
             }
-            if (srt_config.address.empty()) {
-                srt_config.address = "127.0.0.1";
-                srt_config.port = 9000;
+            if (listener) {
+                srt_config.max_clients = (int32_t)context->srt_max_clients;
+                blog(LOG_INFO, "[JPEG XS] SRT listener on port %u for up to %u callers",
+                     srt_config.port, context->srt_max_clients);
             }
             
-            srt_config.latency_ms = context->srt_latency_ms;
-            srt_config.passphrase = context->srt_passphrase;
+            if (context->srt_adaptive_bitrate && listener) {
+                // One bitrate for every viewer: a slow one skips frames instead
+                blog(LOG_INFO, "[JPEG XS] Adaptive bitrate is not used in listener mode");
+            } else if (context->srt_adaptive_bitrate) {
+                RateController::Config abr_config;
+                abr_config.max_mbps = context->bitrate_mbps;
+                abr_config.min_mbps = std::min(uncompressed_mbps / context->srt_abr_max_ratio, context->bitrate_mbps);
+                abr_config.latency_ms = (int32_t)context->srt_latency_ms;
+                context->rate_controller = std::make_unique<RateController>(abr_config);
+                
+                blog(LOG_INFO, "[JPEG XS] Adaptive bitrate enabled: %.1f - %.1f Mbps",
+                     abr_config.min_mbps, abr_config.max_mbps);
+            }
             
             context->srt_transport = std::make_unique<SRTTransport>(srt_config);
-            context->srt_transport->setStateCallback([](bool connected, const std::string& error) {
-                if (connected) blog(LOG_INFO, "[JPEG XS] SRT Connected");
-                else blog(LOG_INFO, "[JPEG XS] SRT Disconnected: %s", error.c_str());
-            });
+            set_srt_state_callback(*context->srt_transport, "");
             
             if (!context->srt_transport->start()) {
                 blog(LOG_ERROR, "[JPEG XS] Failed to start SRT transport");
@@ -488,21 +1419,15 @@ static bool jpegxs_output_start(void *data)
                 }
             }
             
-            // Init Audio UDP Socket
+            // Init Audio UDP Socket and sender
             if (context->st2110_audio_enabled) {
-                context->audio_udp_socket = std::make_unique<UDPSocket>();
-                // Connect usually preferred for burst sending
-                if (!context->audio_udp_socket->connect(context->st2110_dest_ip, context->st2110_audio_port)) {
-                     blog(LOG_WARNING, "[JPEG XS] Failed to connect Audio UDP socket to %s:%u",
-                         context->st2110_dest_ip.c_str(), context->st2110_audio_port);
-                }
-                context->audio_seq_num = 0;
-                context->audio_rtp_timestamp = 0; // Should sync with PTP really
+                start_audio(context);
             }
             
             // 2. Init Pacer (only if needed, but good to have ready or just skip)
             if (!context->disable_pacing) {
                 context->pacer = std::make_unique<Pacer>();
+                context->pacer->setPlacement(context->placement);
                 
                 // Link Pacer to UDP Socket
                 // Capture dest_ip/port by value
@@ -522,52 +1447,46 @@ static bool jpegxs_output_start(void *data)
             }
             
             // 3. Generate SDP
-            SDPConfig sdp_conf;
-            sdp_conf.stream_name = "OBS JPEG XS";
-            sdp_conf.source_ip = context->st2110_source_ip.empty() ? "127.0.0.1" : context->st2110_source_ip;
-            sdp_conf.dest_ip = context->st2110_dest_ip;
-            sdp_conf.dest_port = context->st2110_dest_port;
-            sdp_conf.width = context->width;
-            sdp_conf.height = context->height;
-            sdp_conf.fps_num = context->fps_num;
-            sdp_conf.fps_den = context->fps_den;
-            sdp_conf.depth = bit_depth;
-            sdp_conf.sampling = is_444 ? "YCbCr-4:4:4" : (is_422 ? "YCbCr-4:2:2" : "YCbCr-4:2:0");
-            sdp_conf.use_aws_compatibility = context->st2110_aws_compat;
-            
-            if (context->st2110_audio_enabled) {
-                sdp_conf.audio_enabled = true;
-                sdp_conf.audio_dest_port = context->st2110_audio_port;
-                sdp_conf.audio_channels = 2; // Fixed to Stereo for now
-                sdp_conf.audio_bit_depth = 16;
-                sdp_conf.audio_sample_rate = 48000;
-            }
-            
-            std::string sdp_content = SDPGenerator::generate(sdp_conf);
-            blog(LOG_INFO, "[JPEG XS] Generated SDP:\n%s", sdp_content.c_str());
-            
-            // Save SDP to disk for user convenience
-            // TODO: Maybe expose path in settings? For now, save to CWD/stream.sdp
-            SDPGenerator::saveToFile(sdp_content, "jpegxs_stream.sdp");
-            blog(LOG_INFO, "[JPEG XS] Saved SDP to 'jpegxs_stream.sdp'");
+            write_sdp(context, context->capture_input);
         }
         
+        // Start encoding worker thread once everything it reads is in place
+        context->bitrate_pending = false;
+        context->encode_thread_active = true;
+        context->encode_thread = std::thread(encode_worker, context);
+        
         context->total_frames = 0;
         context->dropped_frames = 0;
+        context->replaced_frames = 0;
+        context->late_frames = 0;
+        
+        {
+            std::lock_guard<std::mutex> feed_lock(context->feed_mutex);
+            add_capture_feed(context, context->capture_input, obs_format);
+        }
         
         if (!obs_output_begin_data_capture(context->output, 0)) {
             blog(LOG_ERROR, "[JPEG XS] Failed to begin data capture");
+            remove_capture_feeds(context);
             if (context->srt_transport) context->srt_transport->stop();
             if (context->pacer) context->pacer->stop();
+            context->audio_sender->stop();
             context->encode_thread_active = false;
             context->queue_cv.notify_all();
             if (context->encode_thread.joinable()) context->encode_thread.join();
+            context->worker_pool.reset();
+            context->renditions.clear();
+            context->quality_monitor.reset();
             return false;
         }
         
         // Now that everything is ready, enable processing
         context->active = true;
         
+        if (calibrate_later) {
+            start_calibration(context, enc_params);
+        }
+        
         return true;
 
     } catch (const std::exception& e) {
@@ -593,6 +1512,9 @@ static void jpegxs_output_stop(void *data, uint64_t ts)
         obs_output_end_data_capture(context->output);
         
         context->active = false;
+        stop_calibration(context);
+        
+        remove_capture_feeds(context);
         
         // Stop worker thread first
         if (context->encode_thread.joinable()) {
@@ -605,12 +1527,47 @@ static void jpegxs_output_stop(void *data, uint64_t ts)
         {
             std::lock_guard<std::mutex> lock(context->queue_mutex);
             while(!context->frame_queue.empty()) context->frame_queue.pop();
+            context->free_frames.clear();
         }
         
+        std::string memory = MemoryAccounting::summary();
+        if (!memory.empty()) {
+            blog(LOG_INFO, "[JPEG XS Output] Memory: %s", memory.c_str());
+        }
+        
+        if (context->quality_monitor) {
+            std::vector<QualityMonitor::Sample> samples = context->quality_monitor->history();
+            if (!samples.empty()) {
+                double psnr = 0.0, ssim = 0.0, mbps = 0.0;
+                for (const auto &sample : samples) {
+                    psnr += sample.psnr[0];
+                    ssim += sample.ssim_y;
+                    mbps += sample.mbps;
+                }
+                blog(LOG_INFO, "[JPEG XS Output] Quality (%zu samples): PSNR-Y=%.2f dB, SSIM-Y=%.4f @ %.1f Mbps",
+                     samples.size(), psnr / samples.size(), ssim / samples.size(), mbps / samples.size());
+            }
+            context->quality_monitor.reset();
+        }
+        
+        if (context->placement.active()) {
+            log_thread_placement();
+        }
+        
+        context->worker_pool.reset();
+        for (auto &rendition : context->renditions) {
+            log_srt_clients(*rendition->srt_transport,
+                            "Rendition " + std::to_string(rendition->width) + "x" + std::to_string(rendition->height) + ": ");
+            rendition->srt_transport->stop();
+        }
+        context->renditions.clear();
+        
         if (context->srt_transport) {
+            log_srt_clients(*context->srt_transport, "");
             context->srt_transport->stop();
             context->srt_transport.reset();
         }
+        context->rate_controller.reset();
         
         if (context->pacer) {
             context->pacer->stop();
@@ -622,15 +1579,27 @@ static void jpegxs_output_stop(void *data, uint64_t ts)
             context->udp_socket.reset();
         }
         
+        if (context->audio_sender->active()) {
+            context->audio_sender->stop();
+            AudioSender::Stats audio = context->audio_sender->get_stats();
+            blog(LOG_INFO, "[JPEG XS] Audio: %llu packets, %llu dropped (queue full), %llu send errors, %llu stalls, %llu resyncs",
+                 (unsigned long long)audio.packets, (unsigned long long)audio.overflows,
+                 (unsigned long long)audio.send_errors, (unsigned long long)audio.stalls,
+                 (unsigned long long)audio.resyncs);
+        }
+        
         if (context->audio_udp_socket) {
             context->audio_udp_socket->close();
             context->audio_udp_socket.reset();
         }
         
         context->rtp_packetizer.reset();
+        context->srt_packetizer.reset();
         context->encoder.reset();
         
-        blog(LOG_INFO, "[JPEG XS] Output stream stopped");
+        blog(LOG_INFO, "[JPEG XS] Output stream stopped: Frames=%llu, Dropped=%llu, Replaced=%llu, Late=%llu",
+             (unsigned long long)context->total_frames.load(), (unsigned long long)context->dropped_frames.load(),
+             (unsigned long long)context->replaced_frames.load(), (unsigned long long)context->late_frames.load());
 
     } catch (const std::exception& e) {
         blog(LOG_ERROR, "[JPEG XS] Exception in output_stop: %s", e.what());
@@ -639,144 +1608,20 @@ static void jpegxs_output_stop(void *data, uint64_t ts)
 
 static void jpegxs_output_raw_video(void *data, struct video_data *frame)
 {
-    jpegxs_output *context = static_cast<jpegxs_output*>(data);
-    
-    // Only lock queue mutex when pushing
-    // No longer need main mutex for the whole block as encoding is async
-    
-    if (!context->active) return;
-    
-    context->total_frames++;
-    
-    // Create raw frame copy
-    auto raw_frame = std::make_unique<RawFrame>();
-    raw_frame->width = context->width;
-    raw_frame->height = context->height;
-    raw_frame->timestamp = frame->timestamp;
-    
-    // Calculate sizes
-    // We assume 3 planes for YUV
-    for (int i = 0; i < 3; i++) {
-        uint32_t linesize = frame->linesize[i];
-        uint32_t height = (i == 0) ? context->height : (context->format == VIDEO_FORMAT_I420 ? context->height/2 : context->height);
-        // Adjust for 4:2:2 if needed, but using simple logic for now based on likely formats
-        if (context->format == VIDEO_FORMAT_I422 && i > 0) height = context->height;
-        if (context->format == VIDEO_FORMAT_I444 && i > 0) height = context->height;
-        
-        size_t size = linesize * height;
-        raw_frame->data[i].resize(size);
-        memcpy(raw_frame->data[i].data(), frame->data[i], size);
-        raw_frame->linesize[i] = linesize;
-    }
-    
-        // Push to queue
-    {
-        std::lock_guard<std::mutex> lock(context->queue_mutex);
-        // Drop if queue has ANY backlog. This enforces strict real-time latency.
-        // If the encoder can't keep up, we drop the frame immediately rather than buffering it.
-        // This restores the low-latency behavior (glass-to-glass < 50ms) at the cost of smoothness if encoding is slow.
-        if (context->frame_queue.size() >= 1) {
-            context->dropped_frames++;
-            // Optional: Log if dropping too many?
-        } else {
-            context->frame_queue.push(std::move(raw_frame));
-            context->queue_cv.notify_one();
-        }
-    }
+    // Video arrives through the capture feeds, which can follow a live
+    // format change; these frames are OBS's own, unconverted, and unused
+    UNUSED_PARAMETER(data);
+    UNUSED_PARAMETER(frame);
 }
 
 static void jpegxs_output_raw_audio(void *data, struct audio_data *frame)
 {
     jpegxs_output *context = static_cast<jpegxs_output*>(data);
     
-    if (!context->active || context->mode != MODE_ST2110 || !context->st2110_audio_enabled || !context->audio_udp_socket) {
-        return;
-    }
-    
-    // ST 2110-30 L16 Implementation
-    // Incoming: Planar Float (usually), 48kHz, 2 channels (OBS Default)
-    // Outgoing: Interleaved Int16 Big Endian, 48kHz, 2 channels
-    // Packet size: 1ms = 48 samples
-    
-    // 1. Convert Planar Float to Interleaved Int16 BE
-    // OBS audio is planar. frame->data[0] = FL, frame->data[1] = FR...
-    // We assume Stereo for simplicity (TODO: Support more channels)
-    uint32_t channels = 2; // audio_output_get_channels(obs_output_audio(context->output));
-    uint32_t frames = frame->frames;
-    
-    // Intermediate buffer for this callback's data (Interleaved Int16 BE)
-    std::vector<uint8_t> chunk_data;
-    chunk_data.reserve(frames * channels * 2);
-    
-    float **planar_data = (float**)frame->data;
-    
-    for (uint32_t i = 0; i < frames; i++) {
-        for (uint32_t c = 0; c < channels; c++) {
-            float sample = planar_data[c][i];
-            // Clip -1.0 to 1.0
-            if (sample > 1.0f) sample = 1.0f;
-            if (sample < -1.0f) sample = -1.0f;
-            
-            // Convert to Int16
-            int16_t pcm = (int16_t)(sample * 32767.0f);
-            
-            // Convert to Big Endian
-            uint8_t hi = (uint8_t)((pcm >> 8) & 0xFF);
-            uint8_t lo = (uint8_t)(pcm & 0xFF);
-            
-            chunk_data.push_back(hi);
-            chunk_data.push_back(lo);
-        }
-    }
-    
-    // 2. Accumulate
-    std::lock_guard<std::mutex> lock(context->mutex); // reuse mutex for audio safety
-    context->audio_accumulator.insert(context->audio_accumulator.end(), chunk_data.begin(), chunk_data.end());
-    
-    // 3. Packetize (1ms chunks = 48 samples = 48 * 2 * 2 = 192 bytes)
-    // ST 2110-30 recommends 1ms (Type A/B) or 125us (Type C)
-    // We use 1ms = 48 samples at 48kHz
-    const uint32_t samples_per_packet = 48;
-    const uint32_t bytes_per_sample = 2 * 2; // 2 channels * 16-bit
-    const uint32_t payload_size = samples_per_packet * bytes_per_sample; // 192 bytes
-    
-    while (context->audio_accumulator.size() >= payload_size) {
-        // Create RTP Packet
-        std::vector<uint8_t> packet(12 + payload_size);
-        uint8_t *p = packet.data();
-        
-        // RTP Header
-        p[0] = 0x80; // V=2, P=0, X=0, CC=0
-        p[1] = 97;   // Payload Type (Dynamic) - match SDP
-        
-        // Sequence Number
-        p[2] = (context->audio_seq_num >> 8) & 0xFF;
-        p[3] = context->audio_seq_num & 0xFF;
-        context->audio_seq_num++;
-        
-        // Timestamp
-        // For ST 2110, this should be derived from PTP
-        // For now, we increment by samples
-        p[4] = (context->audio_rtp_timestamp >> 24) & 0xFF;
-        p[5] = (context->audio_rtp_timestamp >> 16) & 0xFF;
-        p[6] = (context->audio_rtp_timestamp >> 8) & 0xFF;
-        p[7] = context->audio_rtp_timestamp & 0xFF;
-        
-        // SSRC (Random)
-        p[8] = 0x12; p[9] = 0x34; p[10] = 0x56; p[11] = 0x78; 
-        
-        // Payload
-        memcpy(p + 12, context->audio_accumulator.data(), payload_size);
-        
-        // Send
-        if (context->audio_udp_socket) {
-             context->audio_udp_socket->send(p, packet.size());
-        }
-        
-        // Advance state
-        context->audio_rtp_timestamp += samples_per_packet;
-        context->audio_accumulator.erase(context->audio_accumulator.begin(), context->audio_accumulator.begin() + payload_size);
-    }
+    // No-op unless the ST 2110-30 sender is running; never blocks the audio thread
+    uint32_t channels = (uint32_t)audio_output_get_channels(obs_output_audio(context->output));
+    context->audio_sender->push((const float *const *)frame->data, std::min<uint32_t>(channels, MAX_AV_PLANES),
+                                frame->frames, capture_to_ptp_ns(frame->timestamp));
 }
 
 static obs_properties_t *jpegxs_output_properties(void *unused)
@@ -798,6 +1643,16 @@ static obs_properties_t *jpegxs_output_properties(void *unused)
     obs_properties_add_text(srt_props, "srt_url", "Destination URL", OBS_TEXT_DEFAULT);
     obs_properties_add_int(srt_props, "srt_latency", "Latency (ms)", 20, 8000, 10);
     obs_properties_add_text(srt_props, "srt_passphrase", "Passphrase", OBS_TEXT_PASSWORD);
+    obs_properties_add_bool(srt_props, "srt_adaptive_bitrate", "Adaptive Bitrate (back off on congestion)");
+    obs_properties_add_float(srt_props, "srt_abr_max_ratio", "Adaptive Bitrate Floor (max ratio x:1)", 2.0, 100.0, 0.5);
+    obs_properties_add_int(srt_props, "srt_max_clients", "Listener Max Clients (srt://:port?mode=listener)", 1, 64, 1);
+    obs_property_t *p_bonding = obs_properties_add_list(srt_props, "srt_bonding", "Link Bonding",
+                                                        OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+    obs_property_list_add_string(p_bonding, "Off", "none");
+    obs_property_list_add_string(p_bonding, "Broadcast (every packet on every link)", "broadcast");
+    obs_property_list_add_string(p_bonding, "Main/Backup (switch on failure)", "backup");
+    obs_properties_add_text(srt_props, "srt_bond_links", "Additional Links (host:port[@local-ip], ...)", OBS_TEXT_DEFAULT);
+    obs_properties_add_bool(srt_props, "srt_native_framing", "Native SRT Framing (smaller headers; JPEG XS plugin receivers only)");
     
     obs_properties_add_group(props, "group_srt", "SRT Configuration", OBS_GROUP_NORMAL, srt_props);
     
@@ -807,8 +1662,19 @@ static obs_properties_t *jpegxs_output_properties(void *unused)
     obs_properties_add_int(st2110_props, "st2110_dest_port", "Destination Port", 1024, 65535, 1);
     obs_properties_add_int(st2110_props, "st2110_audio_port", "Audio Dest Port", 1024, 65535, 1);
     obs_properties_add_text(st2110_props, "st2110_source_ip", "Source Interface IP (Optional)", OBS_TEXT_DEFAULT);
+    obs_properties_add_path(st2110_props, "st2110_sdp_path", "SDP File", OBS_PATH_FILE_SAVE, "SDP Files (*.sdp)", NULL);
+    obs_properties_add_bool(st2110_props, "st2110_slice_mode", "Slice Packetization (RFC 9134 K=1; off for codestream-only receivers)");
     obs_properties_add_bool(st2110_props, "disable_pacing", "Disable Pacing (Burst Mode) - Low Latency");
     obs_properties_add_bool(st2110_props, "st2110_audio_enabled", "Enable ST 2110-30 Audio");
+    obs_properties_add_int(st2110_props, "st2110_audio_channels", "Audio Channels (beyond the OBS mix are silent)", 2, 16, 1);
+    obs_property_t *p_audio_depth = obs_properties_add_list(st2110_props, "st2110_audio_bit_depth", "Audio Format",
+                                                            OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_audio_depth, "L16 (16-bit)", 16);
+    obs_property_list_add_int(p_audio_depth, "L24 (24-bit)", 24);
+    obs_property_t *p_audio_ptime = obs_properties_add_list(st2110_props, "st2110_audio_packet_us", "Audio Packet Time",
+                                                            OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_audio_ptime, "1 ms (Level A/B)", 1000);
+    obs_property_list_add_int(p_audio_ptime, "125 us (Level C)", 125);
     
     obs_properties_add_group(props, "group_st2110", "ST 2110 / UDP Configuration", OBS_GROUP_NORMAL, st2110_props);
 
@@ -825,9 +1691,85 @@ static obs_properties_t *jpegxs_output_properties(void *unused)
     obs_property_list_add_string(p_profile, "High 4:4:4 10-bit", "High444.10");
     
     obs_properties_add_float(enc_props, "compression_ratio", "Compression Ratio (x:1)", 2.0, 100.0, 0.5);
+    obs_properties_add_int(enc_props, "scale_width", "Output Width (0 = Canvas)", 0, 8192, 2);
+    obs_properties_add_int(enc_props, "scale_height", "Output Height (0 = Canvas)", 0, 8192, 2);
+    obs_properties_add_int(enc_props, "encoder_threads", "Encoder Threads (0 = Auto)", 0, 256, 1);
+    obs_property_t *p_stripes = obs_properties_add_int(enc_props, "encoder_stripes", "Parallel Stripes (1 = Off)", 1, 16, 1);
+    obs_property_set_long_description(p_stripes,
+        "Splits the frame into horizontal bands aligned to the slice height and encodes each on its own "
+        "SVT-JPEG-XS instance, sharing the encoder threads between them. Use for 8K or 4K120 when one "
+        "instance cannot keep up. Striped streams can only be decoded by the JPEG XS Source of this plugin.");
+    obs_property_t *p_calib = obs_properties_add_bool(enc_props, "encoder_calibrate", "Auto-Calibrate Encoder (cached per machine)");
+    obs_property_set_long_description(p_calib,
+        "The first time a resolution, profile and bitrate are used, streams on default settings while "
+        "encoding test frames in the background across thread counts, decomposition depths and slice "
+        "heights, then switches to the fastest setting that meets the frame deadline.");
+    
+    obs_property_t *p_admit = obs_properties_add_list(enc_props, "frame_admission", "When the Encoder Falls Behind",
+                                                      OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_admit, "Send Newest Frame (lowest latency)", ADMIT_LATEST);
+    obs_property_list_add_int(p_admit, "Queue Frames (smoothest)", ADMIT_QUEUE);
+    obs_property_list_add_int(p_admit, "Queue, Skip Frames Past Deadline", ADMIT_DEADLINE);
+    obs_property_set_long_description(p_admit,
+        "Newest: a frame still waiting for the encoder is replaced by the next capture. "
+        "Queue: up to the queue depth frames wait; further captures are dropped. "
+        "Deadline: like Queue, but the oldest frame is replaced when full and frames older than the deadline are skipped.");
+    obs_properties_add_int(enc_props, "frame_queue_depth", "Frame Queue Depth", 1, 8, 1);
+    obs_properties_add_int(enc_props, "frame_deadline_ms", "Frame Deadline (ms)", 1, 1000, 1);
+    
+    obs_property_t *p_quality = obs_properties_add_bool(enc_props, "quality_monitor", "Quality Monitor (PSNR/SSIM)");
+    obs_property_set_long_description(p_quality,
+        "Decodes a sample of the encoded frames on a low-priority thread and logs PSNR and SSIM against the "
+        "captured frame alongside the frame's bitrate. Sampling never delays encoding; striped streams are not measured.");
+    obs_properties_add_int(enc_props, "quality_interval", "Quality Sample Interval (frames)", 1, 3600, 1);
     
     obs_properties_add_group(props, "group_encoder", "Encoder Settings", OBS_GROUP_NORMAL, enc_props);
     
+    // Group: Thread Placement
+    obs_properties_t *place_props = obs_properties_create();
+    obs_properties_add_text(place_props, "placement_encode_cpus", "Encode Thread CPUs (e.g. 2-3)", OBS_TEXT_DEFAULT);
+    obs_property_t *p_codec = obs_properties_add_text(place_props, "placement_codec_cpus", "Codec Worker CPUs (e.g. 4-11)", OBS_TEXT_DEFAULT);
+    obs_property_set_long_description(p_codec,
+        "SVT-JPEG-XS worker threads inherit this set when the encoder is created. "
+        "Keep it disjoint from the pacer and network CPUs.");
+    obs_properties_add_text(place_props, "placement_pacer_cpus", "Pacer CPUs (ST 2110)", OBS_TEXT_DEFAULT);
+    obs_properties_add_text(place_props, "placement_network_cpus", "Network Thread CPUs", OBS_TEXT_DEFAULT);
+    obs_property_t *p_numa = obs_properties_add_list(place_props, "placement_numa_node", "NUMA Node",
+                                                     OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(p_numa, "Off", -2);
+    obs_property_list_add_int(p_numa, "Auto (NIC local)", -1);
+    for (int node = 0; node < 8; node++) {
+        std::string label = "Node " + std::to_string(node);
+        obs_property_list_add_int(p_numa, label.c_str(), node);
+    }
+    obs_property_t *p_rt = obs_properties_add_bool(place_props, "placement_realtime", "Real-Time Priority");
+    obs_property_set_long_description(p_rt,
+        "On Linux, runs the pacer and network threads under SCHED_FIFO and the encode and codec threads "
+        "at nice -10. Both need CAP_SYS_NICE (or rtprio/nice limits); without it the log says what was "
+        "not applied and the threads keep normal priority. Elevated thread priority on Windows.");
+    
+    obs_properties_add_group(props, "group_placement", "Thread Placement", OBS_GROUP_NORMAL, place_props);
+    
+    // Group: Renditions
+    obs_properties_t *rend_props = obs_properties_create();
+    for (int i = 0; i < MAX_RENDITIONS; i++) {
+        std::string prefix = "rendition" + std::to_string(i + 1) + "_";
+        std::string label = "Rendition " + std::to_string(i + 1);
+        obs_property_t *p_enabled = obs_properties_add_bool(rend_props, (prefix + "enabled").c_str(), ("Enable " + label).c_str());
+        if (i == 0) {
+            obs_property_set_long_description(p_enabled,
+                "Encodes a lower resolution/bitrate copy of every frame with the same profile, scaled from the "
+                "frame already captured for the main stream, and sends it to its own SRT destination.");
+        }
+        obs_properties_add_text(rend_props, (prefix + "srt_url").c_str(), (label + " SRT URL").c_str(), OBS_TEXT_DEFAULT);
+        obs_properties_add_int(rend_props, (prefix + "width").c_str(), (label + " Width").c_str(), 16, 8192, 2);
+        obs_properties_add_int(rend_props, (prefix + "height").c_str(), (label + " Height").c_str(), 16, 8192, 2);
+        obs_properties_add_float(rend_props, (prefix + "compression_ratio").c_str(),
+                                 (label + " Compression Ratio (x:1)").c_str(), 2.0, 100.0, 0.5);
+    }
+    
+    obs_properties_add_group(props, "group_renditions", "Renditions", OBS_GROUP_NORMAL, rend_props);
+    
     return props;
 }
 
@@ -838,23 +1780,62 @@ static void jpegxs_output_get_defaults(obs_data_t *settings)
     obs_data_set_default_string(settings, "srt_url", "srt://127.0.0.1:9000");
     obs_data_set_default_int(settings, "srt_latency", 20);
     obs_data_set_default_string(settings, "srt_passphrase", "");
+    obs_data_set_default_bool(settings, "srt_adaptive_bitrate", false);
+    obs_data_set_default_double(settings, "srt_abr_max_ratio", 30.0);
+    obs_data_set_default_int(settings, "srt_max_clients", 4);
+    obs_data_set_default_string(settings, "srt_bonding", "none");
+    obs_data_set_default_string(settings, "srt_bond_links", "");
+    obs_data_set_default_bool(settings, "srt_native_framing", false);
     
     obs_data_set_default_double(settings, "compression_ratio", 10.0);
     obs_data_set_default_string(settings, "profile", "Main420.8");
+    obs_data_set_default_int(settings, "scale_width", 0);
+    obs_data_set_default_int(settings, "scale_height", 0);
+    obs_data_set_default_int(settings, "encoder_threads", 0);
+    obs_data_set_default_int(settings, "encoder_stripes", 1);
+    obs_data_set_default_bool(settings, "encoder_calibrate", false);
+    obs_data_set_default_int(settings, "frame_admission", ADMIT_LATEST);
+    obs_data_set_default_int(settings, "frame_queue_depth", 2);
+    obs_data_set_default_int(settings, "frame_deadline_ms", 33);
+    obs_data_set_default_bool(settings, "quality_monitor", false);
+    obs_data_set_default_int(settings, "quality_interval", 60);
+    
+    obs_data_set_default_string(settings, "placement_encode_cpus", "");
+    obs_data_set_default_string(settings, "placement_codec_cpus", "");
+    obs_data_set_default_string(settings, "placement_pacer_cpus", "");
+    obs_data_set_default_string(settings, "placement_network_cpus", "");
+    obs_data_set_default_int(settings, "placement_numa_node", -2);
+    obs_data_set_default_bool(settings, "placement_realtime", false);
+    
+    obs_data_set_default_bool(settings, "rendition1_enabled", false);
+    obs_data_set_default_string(settings, "rendition1_srt_url", "srt://127.0.0.1:9001");
+    obs_data_set_default_int(settings, "rendition1_width", 1280);
+    obs_data_set_default_int(settings, "rendition1_height", 720);
+    obs_data_set_default_double(settings, "rendition1_compression_ratio", 10.0);
+    obs_data_set_default_bool(settings, "rendition2_enabled", false);
+    obs_data_set_default_string(settings, "rendition2_srt_url", "srt://127.0.0.1:9002");
+    obs_data_set_default_int(settings, "rendition2_width", 640);
+    obs_data_set_default_int(settings, "rendition2_height", 360);
+    obs_data_set_default_double(settings, "rendition2_compression_ratio", 10.0);
     
     obs_data_set_default_string(settings, "st2110_dest_ip", "239.1.1.1"); // Multicast example
     obs_data_set_default_int(settings, "st2110_dest_port", 5000);
     obs_data_set_default_int(settings, "st2110_audio_port", 5002);
     obs_data_set_default_string(settings, "st2110_source_ip", "");
+    obs_data_set_default_string(settings, "st2110_sdp_path", "jpegxs_stream.sdp");
+    obs_data_set_default_bool(settings, "st2110_slice_mode", true);
     obs_data_set_default_bool(settings, "disable_pacing", true);
     obs_data_set_default_bool(settings, "st2110_aws_compat", false);
     obs_data_set_default_bool(settings, "st2110_audio_enabled", true);
+    obs_data_set_default_int(settings, "st2110_audio_channels", 2);
+    obs_data_set_default_int(settings, "st2110_audio_bit_depth", 16);
+    obs_data_set_default_int(settings, "st2110_audio_packet_us", 1000);
 }
 
-static void jpegxs_output_update(void *data, obs_data_t *settings)
+// Settings a running output only picks up at its next start: the transport,
+// thread placement, renditions and the quality monitor
+static void update_start_settings(jpegxs_output *context, obs_data_t *settings)
 {
-    jpegxs_output *context = static_cast<jpegxs_output*>(data);
-    
     const char *mode_str = obs_data_get_string(settings, "transport_mode");
     if (strcmp(mode_str, "ST 2110-22 (UDP/Multicast)") == 0) {
         context->mode = MODE_ST2110;
@@ -865,17 +1846,77 @@ static void jpegxs_output_update(void *data, obs_data_t *settings)
     context->srt_url = obs_data_get_string(settings, "srt_url");
     context->srt_latency_ms = (uint32_t)obs_data_get_int(settings, "srt_latency");
     context->srt_passphrase = obs_data_get_string(settings, "srt_passphrase");
-    context->compression_ratio = (float)obs_data_get_double(settings, "compression_ratio");
-    context->profile = obs_data_get_string(settings, "profile");
-    if (context->profile.empty()) context->profile = "Main420.8";
+    context->srt_adaptive_bitrate = obs_data_get_bool(settings, "srt_adaptive_bitrate");
+    context->srt_abr_max_ratio = (float)obs_data_get_double(settings, "srt_abr_max_ratio");
+    if (context->srt_abr_max_ratio < 2.0f) context->srt_abr_max_ratio = 2.0f;
+    context->srt_max_clients = (uint32_t)std::max<long long>(1, obs_data_get_int(settings, "srt_max_clients"));
+    context->srt_bonding = obs_data_get_string(settings, "srt_bonding");
+    if (context->srt_bonding.empty()) context->srt_bonding = "none";
+    context->srt_bond_links = obs_data_get_string(settings, "srt_bond_links");
+    context->srt_native_framing = obs_data_get_bool(settings, "srt_native_framing");
+    context->quality_monitor_enabled = obs_data_get_bool(settings, "quality_monitor");
+    context->quality_interval = (uint32_t)std::max(1LL, (long long)obs_data_get_int(settings, "quality_interval"));
+    
+    context->placement_encode_cpus = obs_data_get_string(settings, "placement_encode_cpus");
+    context->placement_codec_cpus = obs_data_get_string(settings, "placement_codec_cpus");
+    context->placement_pacer_cpus = obs_data_get_string(settings, "placement_pacer_cpus");
+    context->placement_network_cpus = obs_data_get_string(settings, "placement_network_cpus");
+    context->placement_numa_node = (int)obs_data_get_int(settings, "placement_numa_node");
+    context->placement_realtime = obs_data_get_bool(settings, "placement_realtime");
+    
+    for (int i = 0; i < MAX_RENDITIONS; i++) {
+        std::string prefix = "rendition" + std::to_string(i + 1) + "_";
+        RenditionConfig &config = context->rendition_config[i];
+        config.enabled = obs_data_get_bool(settings, (prefix + "enabled").c_str());
+        config.srt_url = obs_data_get_string(settings, (prefix + "srt_url").c_str());
+        config.width = (uint32_t)obs_data_get_int(settings, (prefix + "width").c_str()) & ~1u;
+        config.height = (uint32_t)obs_data_get_int(settings, (prefix + "height").c_str()) & ~1u;
+        config.compression_ratio = std::max(2.0f, (float)obs_data_get_double(settings, (prefix + "compression_ratio").c_str()));
+    }
     
     context->st2110_dest_ip = obs_data_get_string(settings, "st2110_dest_ip");
     context->st2110_dest_port = (uint16_t)obs_data_get_int(settings, "st2110_dest_port");
     context->st2110_audio_port = (uint16_t)obs_data_get_int(settings, "st2110_audio_port");
     context->st2110_source_ip = obs_data_get_string(settings, "st2110_source_ip");
+    context->st2110_sdp_path = obs_data_get_string(settings, "st2110_sdp_path");
+    context->st2110_slice_mode = obs_data_get_bool(settings, "st2110_slice_mode");
     context->disable_pacing = obs_data_get_bool(settings, "disable_pacing");
     context->st2110_aws_compat = obs_data_get_bool(settings, "st2110_aws_compat");
     context->st2110_audio_enabled = obs_data_get_bool(settings, "st2110_audio_enabled");
+    context->st2110_audio_channels = (uint32_t)obs_data_get_int(settings, "st2110_audio_channels");
+    context->st2110_audio_bit_depth = obs_data_get_int(settings, "st2110_audio_bit_depth") == 24 ? 24 : 16;
+    context->st2110_audio_packet_us = obs_data_get_int(settings, "st2110_audio_packet_us") == 125 ? 125 : 1000;
+}
+
+static void jpegxs_output_update(void *data, obs_data_t *settings)
+{
+    jpegxs_output *context = static_cast<jpegxs_output*>(data);
+    
+    context->compression_ratio = (float)obs_data_get_double(settings, "compression_ratio");
+    context->profile = obs_data_get_string(settings, "profile");
+    if (context->profile.empty()) context->profile = "Main420.8";
+    context->scale_width = (uint32_t)obs_data_get_int(settings, "scale_width") & ~1u;
+    context->scale_height = (uint32_t)obs_data_get_int(settings, "scale_height") & ~1u;
+    context->encoder_threads = (uint32_t)obs_data_get_int(settings, "encoder_threads");
+    context->encoder_stripes = (uint32_t)std::max(1LL, (long long)obs_data_get_int(settings, "encoder_stripes"));
+    context->encoder_calibrate = obs_data_get_bool(settings, "encoder_calibrate");
+    {
+        std::lock_guard<std::mutex> lock(context->queue_mutex);
+        long long policy = obs_data_get_int(settings, "frame_admission");
+        context->admission_policy = (policy == ADMIT_QUEUE || policy == ADMIT_DEADLINE) ? (AdmissionPolicy)policy : ADMIT_LATEST;
+        context->admission_queue_depth = (uint32_t)std::min(8LL, std::max(1LL, (long long)obs_data_get_int(settings, "frame_queue_depth")));
+        context->admission_deadline_ms = (uint32_t)std::max(1LL, (long long)obs_data_get_int(settings, "frame_deadline_ms"));
+    }
+    
+    // Encoder settings apply live; the rest is read again by the next start
+    // (the worker and transport threads read it without locks meanwhile)
+    if (context->active) {
+        blog(LOG_INFO, "[JPEG XS] Settings updated while running: encoder settings applied, "
+             "transport settings wait for the next start");
+        reconfigure_live(context);
+        return;
+    }
     
-    blog(LOG_INFO, "[JPEG XS] Settings updated: Mode %s", mode_str);
+    update_start_settings(context, settings);
+    blog(LOG_INFO, "[JPEG XS] Settings updated: Mode %s", obs_data_get_string(settings, "transport_mode"));
 }
@@ -0,0 +1,314 @@
+/*
+ * Pixel Repack Kernels Implementation
+ */
+
+#include "pixel_repack.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define JPEGXS_REPACK_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define JPEGXS_REPACK_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// GCC/Clang need per-function target attributes to emit wider ISAs without
+// raising the baseline of the whole plugin. MSVC accepts the intrinsics as-is.
+#if defined(JPEGXS_REPACK_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define JPEGXS_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define JPEGXS_TARGET(isa)
+#endif
+
+namespace jpegxs {
+
+namespace {
+
+using RowFn = void (*)(const uint8_t *src, uint8_t *dst, uint32_t samples);
+
+// Passthrough rows (8-bit, or 16-bit containers already at the coded depth).
+// memcpy is already vectorized by every C runtime we ship against.
+template <int BytesPerSample>
+void copy_row(const uint8_t *src, uint8_t *dst, uint32_t samples)
+{
+    std::memcpy(dst, src, (size_t)samples * BytesPerSample);
+}
+
+template <int Shift>
+void shift_row_scalar(const uint8_t *src, uint8_t *dst, uint32_t samples)
+{
+    const uint16_t *s = reinterpret_cast<const uint16_t *>(src);
+    uint16_t *d = reinterpret_cast<uint16_t *>(dst);
+    for (uint32_t x = 0; x < samples; x++) {
+        d[x] = s[x] >> Shift;
+    }
+}
+
+#ifdef JPEGXS_REPACK_X86
+template <int Shift>
+JPEGXS_TARGET("sse4.1")
+void shift_row_sse41(const uint8_t *src, uint8_t *dst, uint32_t samples)
+{
+    uint32_t x = 0;
+    for (; x + 8 <= samples; x += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x * 2), _mm_srli_epi16(v, Shift));
+    }
+    shift_row_scalar<Shift>(src + x * 2, dst + x * 2, samples - x);
+}
+
+template <int Shift>
+JPEGXS_TARGET("avx2")
+void shift_row_avx2(const uint8_t *src, uint8_t *dst, uint32_t samples)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= samples; x += 32) {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2 + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 2), _mm256_srli_epi16(v0, Shift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 2 + 32), _mm256_srli_epi16(v1, Shift));
+    }
+    for (; x + 16 <= samples; x += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x * 2), _mm256_srli_epi16(v, Shift));
+    }
+    shift_row_scalar<Shift>(src + x * 2, dst + x * 2, samples - x);
+}
+
+template <int Shift>
+JPEGXS_TARGET("avx512f,avx512bw")
+void shift_row_avx512(const uint8_t *src, uint8_t *dst, uint32_t samples)
+{
+    uint32_t x = 0;
+    for (; x + 32 <= samples; x += 32) {
+        __m512i v = _mm512_loadu_si512(reinterpret_cast<const void *>(src + x * 2));
+        _mm512_storeu_si512(reinterpret_cast<void *>(dst + x * 2), _mm512_srli_epi16(v, Shift));
+    }
+    shift_row_scalar<Shift>(src + x * 2, dst + x * 2, samples - x);
+}
+#endif
+
+#ifdef JPEGXS_REPACK_NEON
+template <int Shift>
+void shift_row_neon(const uint8_t *src, uint8_t *dst, uint32_t samples)
+{
+    const uint16_t *s = reinterpret_cast<const uint16_t *>(src);
+    uint16_t *d = reinterpret_cast<uint16_t *>(dst);
+    uint32_t x = 0;
+    for (; x + 16 <= samples; x += 16) {
+        uint16x8_t v0 = vld1q_u16(s + x);
+        uint16x8_t v1 = vld1q_u16(s + x + 8);
+        vst1q_u16(d + x, vshrq_n_u16(v0, Shift));
+        vst1q_u16(d + x + 8, vshrq_n_u16(v1, Shift));
+    }
+    shift_row_scalar<Shift>(src + x * 2, dst + x * 2, samples - x);
+}
+#endif
+
+template <int Shift>
+RowFn select_shift_row(RepackIsa isa)
+{
+    switch (isa) {
+#ifdef JPEGXS_REPACK_X86
+    case RepackIsa::AVX512: return shift_row_avx512<Shift>;
+    case RepackIsa::AVX2:   return shift_row_avx2<Shift>;
+    case RepackIsa::SSE41:  return shift_row_sse41<Shift>;
+#endif
+#ifdef JPEGXS_REPACK_NEON
+    case RepackIsa::NEON:   return shift_row_neon<Shift>;
+#endif
+    default:                return shift_row_scalar<Shift>;
+    }
+}
+
+template <RowFn Row, int BytesPerSample>
+inline void repack_plane(const uint8_t *src, uint32_t src_linesize, uint8_t *dst,
+                         uint32_t samples, uint32_t rows)
+{
+    const size_t dst_stride = (size_t)samples * BytesPerSample;
+    if (src_linesize == dst_stride && Row == copy_row<BytesPerSample>) {
+        std::memcpy(dst, src, dst_stride * rows);
+        return;
+    }
+    for (uint32_t y = 0; y < rows; y++) {
+        Row(src + (size_t)y * src_linesize, dst + y * dst_stride, samples);
+    }
+}
+
+// One instantiation per (row kernel, container size, chroma subsampling)
+template <RowFn Row, int BytesPerSample, int ChromaShiftX, int ChromaShiftY>
+void repack_frame(const uint8_t *const src[3], const uint32_t src_linesize[3],
+                  uint8_t *dst, uint32_t width, uint32_t height)
+{
+    const uint32_t w_uv = width >> ChromaShiftX;
+    const uint32_t h_uv = height >> ChromaShiftY;
+
+    repack_plane<Row, BytesPerSample>(src[0], src_linesize[0], dst, width, height);
+    dst += (size_t)width * BytesPerSample * height;
+
+    repack_plane<Row, BytesPerSample>(src[1], src_linesize[1], dst, w_uv, h_uv);
+    dst += (size_t)w_uv * BytesPerSample * h_uv;
+
+    repack_plane<Row, BytesPerSample>(src[2], src_linesize[2], dst, w_uv, h_uv);
+}
+
+template <RowFn Row, int BytesPerSample>
+PixelRepacker::FrameFn select_frame(RepackChroma chroma)
+{
+    switch (chroma) {
+    case RepackChroma::CHROMA_444: return repack_frame<Row, BytesPerSample, 0, 0>;
+    case RepackChroma::CHROMA_422: return repack_frame<Row, BytesPerSample, 1, 0>;
+    default:                       return repack_frame<Row, BytesPerSample, 1, 1>;
+    }
+}
+
+template <int Shift>
+PixelRepacker::FrameFn select_shift_frame(RepackIsa isa, RepackChroma chroma)
+{
+    switch (isa) {
+#ifdef JPEGXS_REPACK_X86
+    case RepackIsa::AVX512: return select_frame<shift_row_avx512<Shift>, 2>(chroma);
+    case RepackIsa::AVX2:   return select_frame<shift_row_avx2<Shift>, 2>(chroma);
+    case RepackIsa::SSE41:  return select_frame<shift_row_sse41<Shift>, 2>(chroma);
+#endif
+#ifdef JPEGXS_REPACK_NEON
+    case RepackIsa::NEON:   return select_frame<shift_row_neon<Shift>, 2>(chroma);
+#endif
+    default:                return select_frame<shift_row_scalar<Shift>, 2>(chroma);
+    }
+}
+
+} // namespace
+
+PixelRepacker::PixelRepacker()
+    : isa_(detect_isa())
+{
+}
+
+RepackIsa PixelRepacker::detect_isa()
+{
+#if defined(JPEGXS_REPACK_X86)
+  #if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool ymm_enabled = (xcr0 & 0x6) == 0x6;
+    bool zmm_enabled = (xcr0 & 0xE6) == 0xE6;
+
+    bool avx2 = false, avx512 = false;
+    if (max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0; // F + BW
+    }
+
+    if (avx512 && zmm_enabled) return RepackIsa::AVX512;
+    if (avx2 && avx && ymm_enabled) return RepackIsa::AVX2;
+    if (sse41) return RepackIsa::SSE41;
+    return RepackIsa::SCALAR;
+  #else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return RepackIsa::AVX512;
+    if (__builtin_cpu_supports("avx2")) return RepackIsa::AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return RepackIsa::SSE41;
+    return RepackIsa::SCALAR;
+  #endif
+#elif defined(JPEGXS_REPACK_NEON)
+    return RepackIsa::NEON;
+#else
+    return RepackIsa::SCALAR;
+#endif
+}
+
+RepackIsa PixelRepacker::supported_isa(RepackIsa isa)
+{
+    // SSE4.1 < AVX2 < AVX-512 each imply the ones before; NEON stands alone
+    RepackIsa detected = detect_isa();
+    bool x86_subset = isa != RepackIsa::NEON && detected != RepackIsa::NEON && isa <= detected;
+    return (isa == RepackIsa::SCALAR || isa == detected || x86_subset) ? isa : detected;
+}
+
+RepackIsa PixelRepacker::set_isa(RepackIsa isa)
+{
+    isa_ = supported_isa(isa);
+    return isa_;
+}
+
+const char *PixelRepacker::isa_name(RepackIsa isa)
+{
+    switch (isa) {
+    case RepackIsa::SSE41:  return "SSE4.1";
+    case RepackIsa::AVX2:   return "AVX2";
+    case RepackIsa::AVX512: return "AVX-512";
+    case RepackIsa::NEON:   return "NEON";
+    default:                return "Scalar";
+    }
+}
+
+bool PixelRepacker::configure(uint32_t width, uint32_t height, RepackChroma chroma,
+                              int input_bit_depth, int output_bit_depth)
+{
+    frame_fn_ = nullptr;
+    kernel_name_ = "none";
+
+    width_ = width;
+    height_ = height;
+
+    uint32_t w_uv = (chroma == RepackChroma::CHROMA_444) ? width : width / 2;
+    uint32_t h_uv = (chroma == RepackChroma::CHROMA_420) ? height / 2 : height;
+    uint32_t bytes_per_sample = (output_bit_depth > 8) ? 2 : 1;
+
+    stride_[0] = width * bytes_per_sample;
+    stride_[1] = w_uv * bytes_per_sample;
+    stride_[2] = stride_[1];
+
+    plane_size_[0] = (size_t)stride_[0] * height;
+    plane_size_[1] = (size_t)stride_[1] * h_uv;
+    plane_size_[2] = plane_size_[1];
+
+    if (input_bit_depth == 8 && output_bit_depth == 8) {
+        frame_fn_ = select_frame<copy_row<1>, 1>(chroma);
+        kernel_name_ = "8-bit passthrough";
+    } else if (input_bit_depth == output_bit_depth && output_bit_depth > 8) {
+        // I010/I210: samples already LSB-aligned at the coded depth, only tighten strides
+        frame_fn_ = select_frame<copy_row<2>, 2>(chroma);
+        kernel_name_ = "16-bit stride tighten";
+    } else if (input_bit_depth == 12 && output_bit_depth == 10) {
+        // I412 -> 10-bit
+        frame_fn_ = select_shift_frame<2>(isa_, chroma);
+        kernel_name_ = "12->10-bit shift";
+    }
+
+    return frame_fn_ != nullptr;
+}
+
+void PixelRepacker::packed_planes(uint8_t *base, uint8_t *planes[3], uint32_t strides[3]) const
+{
+    planes[0] = base;
+    planes[1] = planes[0] + plane_size_[0];
+    planes[2] = planes[1] + plane_size_[1];
+
+    strides[0] = stride_[0];
+    strides[1] = stride_[1];
+    strides[2] = stride_[2];
+}
+
+void PixelRepacker::repack(const uint8_t *const src[3], const uint32_t src_linesize[3], uint8_t *dst) const
+{
+    if (frame_fn_) {
+        frame_fn_(src, src_linesize, dst, width_, height_);
+    }
+}
+
+} // namespace jpegxs
@@ -0,0 +1,85 @@
+/*
+ * Pixel Repack Kernels
+ * Converts OBS planar frames into the tightly packed layout SVT-JPEG-XS expects
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace jpegxs {
+
+enum class RepackIsa {
+    SCALAR,
+    SSE41,
+    AVX2,
+    AVX512,
+    NEON
+};
+
+enum class RepackChroma {
+    CHROMA_420,
+    CHROMA_422,
+    CHROMA_444
+};
+
+/**
+ * Pixel Repacker
+ * Repacks the three OBS planes into one contiguous encoder-native buffer in a
+ * single pass: strides are tightened and >8-bit containers are shifted down to
+ * the coded bit depth (e.g. I412 -> 10-bit). Frame kernels are instantiated at
+ * compile time per chroma format and bit-depth pair; the row kernel inside is
+ * picked at runtime from the widest instruction set the CPU supports.
+ */
+class PixelRepacker {
+public:
+    using FrameFn = void (*)(const uint8_t *const src[3], const uint32_t src_linesize[3],
+                             uint8_t *dst, uint32_t width, uint32_t height);
+
+    PixelRepacker();
+
+    /**
+     * Select kernels for a frame layout
+     * @param input_bit_depth Bit depth of the OBS container (8, 10 or 12)
+     * @param output_bit_depth Bit depth the encoder codes at (8 or 10)
+     * @return false if the combination has no kernel
+     */
+    bool configure(uint32_t width, uint32_t height, RepackChroma chroma,
+                   int input_bit_depth, int output_bit_depth);
+
+    // Size of one packed frame in bytes
+    size_t packed_size() const { return plane_size_[0] + plane_size_[1] + plane_size_[2]; }
+
+    // Plane pointers/strides (in bytes) inside a packed buffer starting at base
+    void packed_planes(uint8_t *base, uint8_t *planes[3], uint32_t strides[3]) const;
+    size_t plane_size(int plane) const { return plane_size_[plane]; }
+
+    // Repack a strided OBS frame into dst (packed_size() bytes)
+    void repack(const uint8_t *const src[3], const uint32_t src_linesize[3], uint8_t *dst) const;
+
+    RepackIsa isa() const { return isa_; }
+    const char *kernel_name() const { return kernel_name_; }
+
+    // Narrow the kernels to this instruction set (for comparing them) from the
+    // next configure() on; one the CPU lacks leaves the detected set in place.
+    // Returns the set in use
+    RepackIsa set_isa(RepackIsa isa);
+
+    static RepackIsa detect_isa();
+    // isa if this CPU can run it, otherwise the detected set
+    static RepackIsa supported_isa(RepackIsa isa);
+    static const char *isa_name(RepackIsa isa);
+
+private:
+    FrameFn frame_fn_ = nullptr;
+    RepackIsa isa_ = RepackIsa::SCALAR;
+    const char *kernel_name_ = "none";
+
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    uint32_t stride_[3] = {0, 0, 0};
+    size_t plane_size_[3] = {0, 0, 0};
+};
+
+} // namespace jpegxs
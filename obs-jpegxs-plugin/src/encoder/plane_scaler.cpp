@@ -0,0 +1,310 @@
+/*
+ * Plane Scaler Implementation
+ */
+
+#include "plane_scaler.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define JPEGXS_SCALE_X86 1
+    #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define JPEGXS_SCALE_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#if defined(JPEGXS_SCALE_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define JPEGXS_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define JPEGXS_TARGET(isa)
+#endif
+
+namespace jpegxs {
+
+namespace {
+
+// 2x2 box: dst[x] = average of a[2x], a[2x+1], b[2x], b[2x+1] (rounded)
+using HalveRowFn = void (*)(const uint8_t *a, const uint8_t *b, uint8_t *dst, uint32_t dst_samples);
+
+template <typename T>
+void halve_row_scalar(const uint8_t *a8, const uint8_t *b8, uint8_t *dst8, uint32_t dst_samples)
+{
+    const T *a = reinterpret_cast<const T *>(a8);
+    const T *b = reinterpret_cast<const T *>(b8);
+    T *d = reinterpret_cast<T *>(dst8);
+    for (uint32_t x = 0; x < dst_samples; x++) {
+        d[x] = (T)((a[2 * x] + a[2 * x + 1] + b[2 * x] + b[2 * x + 1] + 2) >> 2);
+    }
+}
+
+#ifdef JPEGXS_SCALE_X86
+JPEGXS_TARGET("sse4.1")
+void halve_row8_sse41(const uint8_t *a, const uint8_t *b, uint8_t *dst, uint32_t dst_samples)
+{
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi16(2);
+    uint32_t x = 0;
+    for (; x + 16 <= dst_samples; x += 16) {
+        const uint8_t *pa = a + 2 * x, *pb = b + 2 * x;
+        __m128i lo = _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128((const __m128i *)pa), ones),
+                                   _mm_maddubs_epi16(_mm_loadu_si128((const __m128i *)pb), ones));
+        __m128i hi = _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128((const __m128i *)(pa + 16)), ones),
+                                   _mm_maddubs_epi16(_mm_loadu_si128((const __m128i *)(pb + 16)), ones));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+        _mm_storeu_si128((__m128i *)(dst + x), _mm_packus_epi16(lo, hi));
+    }
+    halve_row_scalar<uint8_t>(a + 2 * x, b + 2 * x, dst + x, dst_samples - x);
+}
+
+JPEGXS_TARGET("avx2")
+void halve_row8_avx2(const uint8_t *a, const uint8_t *b, uint8_t *dst, uint32_t dst_samples)
+{
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi16(2);
+    uint32_t x = 0;
+    for (; x + 32 <= dst_samples; x += 32) {
+        const uint8_t *pa = a + 2 * x, *pb = b + 2 * x;
+        __m256i lo = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)pa), ones),
+                                      _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)pb), ones));
+        __m256i hi = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(pa + 32)), ones),
+                                      _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i *)(pb + 32)), ones));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, two), 2);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2);
+        // packus works per 128-bit lane; restore sample order across lanes
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i *)(dst + x), packed);
+    }
+    halve_row8_sse41(a + 2 * x, b + 2 * x, dst + x, dst_samples - x);
+}
+
+JPEGXS_TARGET("sse4.1")
+void halve_row16_sse41(const uint8_t *a8, const uint8_t *b8, uint8_t *dst8, uint32_t dst_samples)
+{
+    const uint16_t *a = reinterpret_cast<const uint16_t *>(a8);
+    const uint16_t *b = reinterpret_cast<const uint16_t *>(b8);
+    uint16_t *d = reinterpret_cast<uint16_t *>(dst8);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i two = _mm_set1_epi32(2);
+    uint32_t x = 0;
+    // Samples are at most 12-bit, so signed 16-bit multiply-add is exact
+    for (; x + 8 <= dst_samples; x += 8) {
+        const uint16_t *pa = a + 2 * x, *pb = b + 2 * x;
+        __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_loadu_si128((const __m128i *)pa), ones),
+                                   _mm_madd_epi16(_mm_loadu_si128((const __m128i *)pb), ones));
+        __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_loadu_si128((const __m128i *)(pa + 8)), ones),
+                                   _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(pb + 8)), ones));
+        lo = _mm_srli_epi32(_mm_add_epi32(lo, two), 2);
+        hi = _mm_srli_epi32(_mm_add_epi32(hi, two), 2);
+        _mm_storeu_si128((__m128i *)(d + x), _mm_packus_epi32(lo, hi));
+    }
+    halve_row_scalar<uint16_t>(a8 + 4 * x, b8 + 4 * x, dst8 + 2 * x, dst_samples - x);
+}
+
+JPEGXS_TARGET("avx2")
+void halve_row16_avx2(const uint8_t *a8, const uint8_t *b8, uint8_t *dst8, uint32_t dst_samples)
+{
+    const uint16_t *a = reinterpret_cast<const uint16_t *>(a8);
+    const uint16_t *b = reinterpret_cast<const uint16_t *>(b8);
+    uint16_t *d = reinterpret_cast<uint16_t *>(dst8);
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    uint32_t x = 0;
+    for (; x + 16 <= dst_samples; x += 16) {
+        const uint16_t *pa = a + 2 * x, *pb = b + 2 * x;
+        __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)pa), ones),
+                                      _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)pb), ones));
+        __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(pa + 16)), ones),
+                                      _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)(pb + 16)), ones));
+        lo = _mm256_srli_epi32(_mm256_add_epi32(lo, two), 2);
+        hi = _mm256_srli_epi32(_mm256_add_epi32(hi, two), 2);
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i *)(d + x), packed);
+    }
+    halve_row16_sse41(a8 + 4 * x, b8 + 4 * x, dst8 + 2 * x, dst_samples - x);
+}
+#endif
+
+#ifdef JPEGXS_SCALE_NEON
+void halve_row8_neon(const uint8_t *a, const uint8_t *b, uint8_t *dst, uint32_t dst_samples)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= dst_samples; x += 16) {
+        const uint8_t *pa = a + 2 * x, *pb = b + 2 * x;
+        uint16x8_t lo = vaddq_u16(vpaddlq_u8(vld1q_u8(pa)), vpaddlq_u8(vld1q_u8(pb)));
+        uint16x8_t hi = vaddq_u16(vpaddlq_u8(vld1q_u8(pa + 16)), vpaddlq_u8(vld1q_u8(pb + 16)));
+        vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+    }
+    halve_row_scalar<uint8_t>(a + 2 * x, b + 2 * x, dst + x, dst_samples - x);
+}
+
+void halve_row16_neon(const uint8_t *a8, const uint8_t *b8, uint8_t *dst8, uint32_t dst_samples)
+{
+    const uint16_t *a = reinterpret_cast<const uint16_t *>(a8);
+    const uint16_t *b = reinterpret_cast<const uint16_t *>(b8);
+    uint16_t *d = reinterpret_cast<uint16_t *>(dst8);
+    uint32_t x = 0;
+    for (; x + 8 <= dst_samples; x += 8) {
+        const uint16_t *pa = a + 2 * x, *pb = b + 2 * x;
+        uint32x4_t lo = vaddq_u32(vpaddlq_u16(vld1q_u16(pa)), vpaddlq_u16(vld1q_u16(pb)));
+        uint32x4_t hi = vaddq_u32(vpaddlq_u16(vld1q_u16(pa + 8)), vpaddlq_u16(vld1q_u16(pb + 8)));
+        vst1q_u16(d + x, vcombine_u16(vrshrn_n_u32(lo, 2), vrshrn_n_u32(hi, 2)));
+    }
+    halve_row_scalar<uint16_t>(a8 + 4 * x, b8 + 4 * x, dst8 + 2 * x, dst_samples - x);
+}
+#endif
+
+HalveRowFn select_halve_row(RepackIsa isa, uint32_t bytes_per_sample)
+{
+    bool wide = bytes_per_sample > 1;
+    switch (isa) {
+#ifdef JPEGXS_SCALE_X86
+    case RepackIsa::AVX512:
+    case RepackIsa::AVX2:  return wide ? halve_row16_avx2 : halve_row8_avx2;
+    case RepackIsa::SSE41: return wide ? halve_row16_sse41 : halve_row8_sse41;
+#endif
+#ifdef JPEGXS_SCALE_NEON
+    case RepackIsa::NEON:  return wide ? halve_row16_neon : halve_row8_neon;
+#endif
+    default:               return wide ? halve_row_scalar<uint16_t> : halve_row_scalar<uint8_t>;
+    }
+}
+
+// Separable bilinear with pixel-centre alignment, 8-bit fixed-point weights
+template <typename T>
+void bilinear_plane(const T *src, uint32_t sw, uint32_t sh, T *dst, uint32_t dw, uint32_t dh,
+                    std::vector<uint32_t> &row)
+{
+    std::vector<uint32_t> x0(dw), fx(dw);
+    for (uint32_t x = 0; x < dw; x++) {
+        double sx = std::max(0.0, (x + 0.5) * sw / dw - 0.5);
+        x0[x] = std::min((uint32_t)sx, sw - 1);
+        fx[x] = (x0[x] + 1 < sw) ? (uint32_t)((sx - x0[x]) * 256.0) : 0;
+    }
+
+    row.resize(sw);
+    for (uint32_t y = 0; y < dh; y++) {
+        double sy = std::max(0.0, (y + 0.5) * sh / dh - 0.5);
+        uint32_t y0 = std::min((uint32_t)sy, sh - 1);
+        uint32_t y1 = std::min(y0 + 1, sh - 1);
+        uint32_t fy = (uint32_t)((sy - y0) * 256.0);
+
+        // Vertical pass over whole rows (the compiler vectorizes this loop)
+        const T *r0 = src + (size_t)y0 * sw;
+        const T *r1 = src + (size_t)y1 * sw;
+        for (uint32_t x = 0; x < sw; x++) {
+            row[x] = r0[x] * (256 - fy) + r1[x] * fy;
+        }
+
+        T *out = dst + (size_t)y * dw;
+        for (uint32_t x = 0; x < dw; x++) {
+            uint32_t a = row[x0[x]];
+            uint32_t b = row[std::min(x0[x] + 1, sw - 1)];
+            out[x] = (T)((a * (256 - fx[x]) + b * fx[x] + 32768) >> 16);
+        }
+    }
+}
+
+} // namespace
+
+PlaneScaler::PlaneScaler()
+    : isa_(PixelRepacker::detect_isa())
+{
+}
+
+RepackIsa PlaneScaler::set_isa(RepackIsa isa)
+{
+    isa_ = PixelRepacker::supported_isa(isa);
+    return isa_;
+}
+
+bool PlaneScaler::configure(uint32_t src_width, uint32_t src_height, uint32_t dst_width, uint32_t dst_height,
+                            RepackChroma chroma, int bit_depth)
+{
+    if (dst_width == 0 || dst_height == 0 || dst_width > src_width || dst_height > src_height) {
+        return false;
+    }
+    if (!src_layout_.configure(src_width, src_height, chroma, bit_depth, bit_depth) ||
+        !dst_layout_.configure(dst_width, dst_height, chroma, bit_depth, bit_depth)) {
+        return false;
+    }
+
+    chroma_ = chroma;
+    bytes_per_sample_ = (bit_depth > 8) ? 2 : 1;
+    src_width_ = src_width;
+    src_height_ = src_height;
+    dst_width_ = dst_width;
+    dst_height_ = dst_height;
+
+    // Box-halve while both axes stay at or above the target
+    halvings_ = 0;
+    while ((src_width >> (halvings_ + 1)) >= dst_width && (src_height >> (halvings_ + 1)) >= dst_height) {
+        halvings_++;
+    }
+    return true;
+}
+
+void PlaneScaler::scale(const uint8_t *src_packed, uint8_t *dst_packed)
+{
+    uint8_t *src_planes[3], *dst_planes[3];
+    uint32_t src_strides[3], dst_strides[3];
+    src_layout_.packed_planes(const_cast<uint8_t *>(src_packed), src_planes, src_strides);
+    dst_layout_.packed_planes(dst_packed, dst_planes, dst_strides);
+
+    uint32_t sub_x = (chroma_ == RepackChroma::CHROMA_444) ? 0 : 1;
+    uint32_t sub_y = (chroma_ == RepackChroma::CHROMA_420) ? 1 : 0;
+
+    for (int p = 0; p < 3; p++) {
+        uint32_t sx = (p == 0) ? 0 : sub_x;
+        uint32_t sy = (p == 0) ? 0 : sub_y;
+        scale_plane(src_planes[p], { src_width_ >> sx, src_height_ >> sy },
+                    dst_planes[p], { dst_width_ >> sx, dst_height_ >> sy });
+    }
+}
+
+void PlaneScaler::scale_plane(const uint8_t *src, PlaneGeometry src_geo, uint8_t *dst, PlaneGeometry dst_geo)
+{
+    HalveRowFn halve_row = select_halve_row(isa_, bytes_per_sample_);
+    const uint8_t *cur = src;
+    PlaneGeometry geo = src_geo;
+
+    for (uint32_t step = 0; step < halvings_; step++) {
+        PlaneGeometry next = { geo.width / 2, geo.height / 2 };
+        bool last = (step + 1 == halvings_) && next.width == dst_geo.width && next.height == dst_geo.height;
+
+        uint8_t *out = dst;
+        if (!last) {
+            std::vector<uint8_t> &buffer = scratch_[step & 1];
+            buffer.resize((size_t)next.width * next.height * bytes_per_sample_);
+            out = buffer.data();
+        }
+
+        size_t in_stride = (size_t)geo.width * bytes_per_sample_;
+        size_t out_stride = (size_t)next.width * bytes_per_sample_;
+        for (uint32_t y = 0; y < next.height; y++) {
+            const uint8_t *r0 = cur + (2 * y) * in_stride;
+            halve_row(r0, r0 + in_stride, out + y * out_stride, next.width);
+        }
+
+        cur = out;
+        geo = next;
+    }
+
+    if (cur == dst) {
+        return;
+    }
+    if (geo.width == dst_geo.width && geo.height == dst_geo.height) {
+        std::memcpy(dst, cur, (size_t)geo.width * geo.height * bytes_per_sample_);
+        return;
+    }
+
+    if (bytes_per_sample_ > 1) {
+        bilinear_plane(reinterpret_cast<const uint16_t *>(cur), geo.width, geo.height,
+                       reinterpret_cast<uint16_t *>(dst), dst_geo.width, dst_geo.height, row_);
+    } else {
+        bilinear_plane(cur, geo.width, geo.height, dst, dst_geo.width, dst_geo.height, row_);
+    }
+}
+
+} // namespace jpegxs
@@ -0,0 +1,72 @@
+/*
+ * Plane Scaler
+ * Downscales packed planar frames for lower renditions
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "pixel_repack.h"
+
+namespace jpegxs {
+
+/**
+ * Plane Scaler
+ * Downscales a packed planar YUV frame (the PixelRepacker layout) to another
+ * packed planar frame of the same chroma format and bit depth. Each whole 2:1
+ * step runs a 2x2 box kernel picked at runtime from the widest instruction set
+ * available (the common 2160p -> 1080p -> 540p ladder is all box steps); any
+ * remaining ratio is finished with a separable bilinear pass.
+ */
+class PlaneScaler {
+public:
+    PlaneScaler();
+
+    /**
+     * @param bit_depth Coded bit depth; 8 = one byte per sample, otherwise two
+     * @return false if the destination is larger than the source
+     */
+    bool configure(uint32_t src_width, uint32_t src_height, uint32_t dst_width, uint32_t dst_height,
+                   RepackChroma chroma, int bit_depth);
+
+    bool matches(uint32_t src_width, uint32_t src_height) const {
+        return src_width == src_width_ && src_height == src_height_;
+    }
+
+    // Scale src_packed (source PixelRepacker layout) into dst_packed (destination layout)
+    void scale(const uint8_t *src_packed, uint8_t *dst_packed);
+
+    RepackIsa isa() const { return isa_; }
+
+    // Narrow the kernels to this instruction set (for comparing them) from the
+    // next configure() on; one the CPU lacks leaves the detected set in place.
+    // Returns the set in use
+    RepackIsa set_isa(RepackIsa isa);
+
+private:
+    struct PlaneGeometry {
+        uint32_t width;
+        uint32_t height;
+    };
+
+    RepackIsa isa_;
+    RepackChroma chroma_ = RepackChroma::CHROMA_420;
+    uint32_t bytes_per_sample_ = 1;
+    uint32_t src_width_ = 0, src_height_ = 0;
+    uint32_t dst_width_ = 0, dst_height_ = 0;
+    uint32_t halvings_ = 0;  // Box 2:1 steps before the bilinear pass
+
+    PixelRepacker src_layout_;
+    PixelRepacker dst_layout_;
+
+    // Scratch for intermediate halvings and the bilinear vertical pass
+    std::vector<uint8_t> scratch_[2];
+    std::vector<uint32_t> row_;
+
+    void scale_plane(const uint8_t *src, PlaneGeometry src_geo, uint8_t *dst, PlaneGeometry dst_geo);
+};
+
+} // namespace jpegxs
@@ -0,0 +1,315 @@
+/*
+ * Quality Monitor Implementation
+ */
+
+#include "quality_monitor.h"
+#include "pixel_repack.h"
+#include "../decoder/jpegxs_decoder.h"
+#include "../network/stripe_framing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <obs-module.h>
+#include <util/platform.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define JPEGXS_QUALITY_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define JPEGXS_QUALITY_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#ifdef _WIN32
+    #include <windows.h>
+#elif defined(__APPLE__)
+    #include <pthread.h>
+    #include <sys/qos.h>
+#else
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace jpegxs {
+
+namespace {
+
+// Sum of squared differences. SSE2/NEON are baseline on the 64-bit targets,
+// so no runtime dispatch; partial sums are flushed to 64 bits per block.
+template <typename T>
+uint64_t squared_error_scalar(const T *a, const T *b, size_t count)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        int64_t d = (int64_t)a[i] - (int64_t)b[i];
+        sum += (uint64_t)(d * d);
+    }
+    return sum;
+}
+
+uint64_t squared_error8(const uint8_t *a, const uint8_t *b, size_t count)
+{
+    uint64_t sum = 0;
+    size_t i = 0;
+#if defined(JPEGXS_QUALITY_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    while (i + 16 <= count) {
+        __m128i acc = _mm_setzero_si128();
+        size_t block_end = std::min(count & ~(size_t)15, i + 4096);
+        for (; i < block_end; i += 16) {
+            __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+            __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+            __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+            acc = _mm_add_epi32(acc, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+        }
+        uint32_t lanes[4];
+        _mm_storeu_si128((__m128i *)lanes, acc);
+        sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#elif defined(JPEGXS_QUALITY_NEON)
+    while (i + 16 <= count) {
+        uint32x4_t acc = vdupq_n_u32(0);
+        size_t block_end = std::min(count & ~(size_t)15, i + 4096);
+        for (; i < block_end; i += 16) {
+            uint8x16_t d = vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i));
+            uint16x8_t lo = vmull_u8(vget_low_u8(d), vget_low_u8(d));
+            uint16x8_t hi = vmull_u8(vget_high_u8(d), vget_high_u8(d));
+            acc = vpadalq_u16(acc, lo);
+            acc = vpadalq_u16(acc, hi);
+        }
+        sum += vaddlvq_u32(acc);
+    }
+#endif
+    return sum + squared_error_scalar(a + i, b + i, count - i);
+}
+
+uint64_t squared_error16(const uint16_t *a, const uint16_t *b, size_t count)
+{
+    uint64_t sum = 0;
+    size_t i = 0;
+#if defined(JPEGXS_QUALITY_SSE2)
+    // Samples are at most 12-bit, so differences fit in int16
+    while (i + 8 <= count) {
+        __m128i acc = _mm_setzero_si128();
+        size_t block_end = std::min(count & ~(size_t)7, i + 1024);
+        for (; i < block_end; i += 8) {
+            __m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(a + i)),
+                                      _mm_loadu_si128((const __m128i *)(b + i)));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(d, d));
+        }
+        uint32_t lanes[4];
+        _mm_storeu_si128((__m128i *)lanes, acc);
+        sum += (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#elif defined(JPEGXS_QUALITY_NEON)
+    while (i + 8 <= count) {
+        uint32x4_t acc = vdupq_n_u32(0);
+        size_t block_end = std::min(count & ~(size_t)7, i + 1024);
+        for (; i < block_end; i += 8) {
+            uint16x8_t d = vabdq_u16(vld1q_u16(a + i), vld1q_u16(b + i));
+            acc = vmlal_u16(acc, vget_low_u16(d), vget_low_u16(d));
+            acc = vmlal_u16(acc, vget_high_u16(d), vget_high_u16(d));
+        }
+        sum += vaddlvq_u32(acc);
+    }
+#endif
+    return sum + squared_error_scalar(a + i, b + i, count - i);
+}
+
+double psnr_from_sse(uint64_t sse, size_t count, double peak)
+{
+    if (sse == 0 || count == 0) return 99.0;
+    double mse = (double)sse / (double)count;
+    return std::min(99.0, 10.0 * std::log10(peak * peak / mse));
+}
+
+// Mean SSIM over non-overlapping 8x8 blocks (the inner sums vectorize)
+template <typename T>
+double ssim_plane(const T *a, const T *b, uint32_t width, uint32_t height, double peak)
+{
+    const double c1 = (0.01 * peak) * (0.01 * peak);
+    const double c2 = (0.03 * peak) * (0.03 * peak);
+    double total = 0.0;
+    uint64_t blocks = 0;
+
+    for (uint32_t by = 0; by + 8 <= height; by += 8) {
+        for (uint32_t bx = 0; bx + 8 <= width; bx += 8) {
+            uint64_t sa = 0, sb = 0, saa = 0, sbb = 0, sab = 0;
+            for (uint32_t y = 0; y < 8; y++) {
+                const T *ra = a + (size_t)(by + y) * width + bx;
+                const T *rb = b + (size_t)(by + y) * width + bx;
+                for (uint32_t x = 0; x < 8; x++) {
+                    uint32_t va = ra[x], vb = rb[x];
+                    sa += va;
+                    sb += vb;
+                    saa += va * va;
+                    sbb += vb * vb;
+                    sab += va * vb;
+                }
+            }
+            double ma = sa / 64.0, mb = sb / 64.0;
+            double va = saa / 64.0 - ma * ma;
+            double vb = sbb / 64.0 - mb * mb;
+            double cov = sab / 64.0 - ma * mb;
+            total += ((2 * ma * mb + c1) * (2 * cov + c2)) / ((ma * ma + mb * mb + c1) * (va + vb + c2));
+            blocks++;
+        }
+    }
+    return blocks ? total / blocks : 1.0;
+}
+
+void lower_thread_priority()
+{
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#elif defined(__linux__)
+    // Per-thread nice value; SVT decoder threads created from here inherit it
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+#endif
+}
+
+} // namespace
+
+QualityMonitor::QualityMonitor(uint32_t interval, size_t history_size)
+    : interval_(std::max(1u, interval)), history_size_(std::max<size_t>(1, history_size))
+{
+    thread_ = std::thread(&QualityMonitor::monitor_loop, this);
+}
+
+QualityMonitor::~QualityMonitor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool QualityMonitor::submit(std::vector<uint8_t> &packed, const JpegXSEncoder::Params &params,
+                            const uint8_t *codestream, size_t codestream_size, uint64_t timestamp)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (busy_.load(std::memory_order_relaxed) || stopping_) {
+            return false;
+        }
+        source_.swap(packed);
+        codestream_.assign(codestream, codestream + codestream_size);
+        params_ = params;
+        timestamp_ = timestamp;
+        busy_.store(true, std::memory_order_release);
+    }
+    cv_.notify_one();
+    return true;
+}
+
+std::vector<QualityMonitor::Sample> QualityMonitor::history() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<Sample>(history_.begin(), history_.end());
+}
+
+bool QualityMonitor::latest(Sample &sample) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (history_.empty()) return false;
+    sample = history_.back();
+    return true;
+}
+
+void QualityMonitor::monitor_loop()
+{
+    os_set_thread_name("jpegxs-quality");
+    lower_thread_priority();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || busy_.load(std::memory_order_relaxed); });
+        if (stopping_) break;
+
+        // The buffers belong to this thread until busy_ is cleared
+        lock.unlock();
+        Sample sample;
+        bool measured = measure(sample);
+        lock.lock();
+
+        if (measured) {
+            history_.push_back(sample);
+            if (history_.size() > history_size_) history_.pop_front();
+            blog(LOG_INFO, "[QualityMonitor] PSNR Y/U/V=%.2f/%.2f/%.2f dB (%.2f), SSIM-Y=%.4f @ %.1f Mbps",
+                 sample.psnr[0], sample.psnr[1], sample.psnr[2], sample.psnr_yuv, sample.ssim_y, sample.mbps);
+        } else {
+            skipped_++;
+        }
+        busy_.store(false, std::memory_order_release);
+    }
+    decoder_.reset();
+}
+
+bool QualityMonitor::measure(Sample &sample)
+{
+    // Striped frames carry several codestreams; the loopback covers plain ones only
+    if (StripeFraming::isStriped(codestream_.data(), codestream_.size())) {
+        return false;
+    }
+
+    if (!decoder_ || !decoder_params_.same_input(params_) || decoder_params_.bit_depth != params_.bit_depth) {
+        decoder_ = std::make_unique<JpegXSDecoder>();
+        decoder_->initialize(0, 0, 2);
+        decoder_params_ = params_;
+    }
+    if (!decoder_->decode_frame(codestream_.data(), codestream_.size(), nullptr, nullptr)) {
+        return false;
+    }
+    if (decoder_->getWidth() != params_.width || decoder_->getHeight() != params_.height ||
+        decoder_->getBitDepth() != params_.bit_depth) {
+        return false;
+    }
+
+    RepackChroma chroma = params_.is_444 ? RepackChroma::CHROMA_444
+                        : (params_.is_422 ? RepackChroma::CHROMA_422 : RepackChroma::CHROMA_420);
+    PixelRepacker layout;
+    if (!layout.configure(params_.width, params_.height, chroma, params_.bit_depth, params_.bit_depth) ||
+        source_.size() < layout.packed_size()) {
+        return false;
+    }
+    uint8_t *src_planes[3];
+    uint32_t strides[3];
+    layout.packed_planes(source_.data(), src_planes, strides);
+    const uint8_t *dec_planes[3] = { decoder_->get_y_buffer(), decoder_->get_u_buffer(), decoder_->get_v_buffer() };
+
+    bool wide = params_.bit_depth > 8;
+    double peak = (double)((1 << params_.bit_depth) - 1);
+    uint64_t total_sse = 0;
+    size_t total_count = 0;
+
+    for (int p = 0; p < 3; p++) {
+        size_t samples = layout.plane_size(p) / (wide ? 2 : 1);
+        uint64_t sse = wide
+            ? squared_error16(reinterpret_cast<const uint16_t *>(src_planes[p]),
+                              reinterpret_cast<const uint16_t *>(dec_planes[p]), samples)
+            : squared_error8(src_planes[p], dec_planes[p], samples);
+        sample.psnr[p] = psnr_from_sse(sse, samples, peak);
+        total_sse += sse;
+        total_count += samples;
+    }
+    sample.psnr_yuv = psnr_from_sse(total_sse, total_count, peak);
+    sample.ssim_y = wide
+        ? ssim_plane(reinterpret_cast<const uint16_t *>(src_planes[0]),
+                     reinterpret_cast<const uint16_t *>(dec_planes[0]), params_.width, params_.height, peak)
+        : ssim_plane(src_planes[0], dec_planes[0], params_.width, params_.height, peak);
+
+    double fps = params_.fps_den ? (double)params_.fps_num / params_.fps_den : 0.0;
+    sample.mbps = codestream_.size() * 8.0 * fps / 1e6;
+    sample.timestamp = timestamp_;
+    return true;
+}
+
+} // namespace jpegxs
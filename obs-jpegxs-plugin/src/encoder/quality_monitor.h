@@ -0,0 +1,95 @@
+/*
+ * Quality Monitor
+ * Off-path loopback decode for sampled PSNR/SSIM telemetry
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "jpegxs_encoder.h"
+
+namespace jpegxs {
+
+class JpegXSDecoder;
+
+/**
+ * Quality Monitor
+ * Decodes every Nth encoded frame on its own low-priority thread and compares
+ * it with the packed source frame the encoder consumed. The encode worker only
+ * swaps its packed buffer with the monitor's spare one and copies the
+ * codestream; a frame offered while the previous one is still being measured
+ * is simply not sampled.
+ */
+class QualityMonitor {
+public:
+    struct Sample {
+        uint64_t timestamp = 0;  // Capture timestamp of the measured frame
+        double psnr[3] = {};     // Per plane, dB (capped at 99 for identical planes)
+        double psnr_yuv = 0.0;   // Weighted over all samples
+        double ssim_y = 0.0;     // Mean luma SSIM over 8x8 blocks
+        double mbps = 0.0;       // This frame's size at the stream frame rate
+    };
+
+    /**
+     * @param interval Sample every interval-th frame offered
+     * @param history_size Number of samples kept for history()
+     */
+    explicit QualityMonitor(uint32_t interval, size_t history_size = 600);
+    ~QualityMonitor();
+
+    QualityMonitor(const QualityMonitor &) = delete;
+    QualityMonitor &operator=(const QualityMonitor &) = delete;
+
+    // Cheap check for the encode worker, so it can skip building the offer
+    bool wants(uint64_t frame_index) const {
+        return frame_index % interval_ == 0 && !busy_.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Hand over a frame for measurement. On success `packed` is swapped with
+     * a spare buffer (it may come back empty or with stale contents).
+     * @param params Layout the frame was packed and encoded with
+     */
+    bool submit(std::vector<uint8_t> &packed, const JpegXSEncoder::Params &params,
+                const uint8_t *codestream, size_t codestream_size, uint64_t timestamp);
+
+    std::vector<Sample> history() const;
+    bool latest(Sample &sample) const;
+
+    uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+
+private:
+    void monitor_loop();
+    bool measure(Sample &sample);
+
+    uint32_t interval_;
+    size_t history_size_;
+
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::atomic<bool> busy_{false};
+    std::atomic<uint64_t> skipped_{0};  // Sampled frames that could not be measured
+
+    // Frame under measurement (owned by the monitor thread while busy_)
+    std::vector<uint8_t> source_;
+    std::vector<uint8_t> codestream_;
+    JpegXSEncoder::Params params_;
+    uint64_t timestamp_ = 0;
+
+    std::unique_ptr<JpegXSDecoder> decoder_;
+    JpegXSEncoder::Params decoder_params_;  // Layout the decoder was set up for
+    std::deque<Sample> history_;
+};
+
+} // namespace jpegxs
@@ -0,0 +1,80 @@
+/*
+ * Worker Pool Implementation
+ */
+
+#include "worker_pool.h"
+#include <string>
+
+namespace jpegxs {
+
+WorkerPool::WorkerPool(size_t threads, const PlacementPlan &plan, ThreadRole role)
+    : placement_(plan), role_(role)
+{
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; i++) {
+        threads_.emplace_back(&WorkerPool::worker_loop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto &thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+void WorkerPool::run(size_t count, const std::function<void(size_t index)> &job)
+{
+    if (count == 0) return;
+
+    if (count > 1 && !threads_.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        next_index_ = 1;
+        count_ = count;
+        remaining_ = count - 1;
+    }
+    work_cv_.notify_all();
+
+    job(0);
+
+    if (count > 1 && threads_.empty()) {
+        for (size_t i = 1; i < count; i++) job(i);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return remaining_ == 0; });
+    job_ = nullptr;
+}
+
+void WorkerPool::worker_loop(size_t index)
+{
+    if (placement_.active()) {
+        std::string name = "jxs-pool-" + std::to_string(index);
+        ThreadPlacement::apply(placement_, role_, name.c_str(), nullptr);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this] { return stopping_ || (job_ && next_index_ < count_); });
+        if (stopping_) return;
+
+        size_t job_index = next_index_++;
+        const std::function<void(size_t)> *job = job_;
+        lock.unlock();
+        (*job)(job_index);
+        lock.lock();
+
+        if (--remaining_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+} // namespace jpegxs
@@ -0,0 +1,55 @@
+/*
+ * Worker Pool
+ * Fixed set of threads for running per-frame jobs in parallel
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../network/thread_placement.h"
+
+namespace jpegxs {
+
+/**
+ * Worker Pool
+ * run() hands out job indices 1..count-1 to the pool threads, runs index 0
+ * on the calling thread and returns once every index has finished. The
+ * threads are created once and placed like the encode thread, so a frame's
+ * jobs start without thread creation or migration.
+ */
+class WorkerPool {
+public:
+    WorkerPool(size_t threads, const PlacementPlan &plan, ThreadRole role);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    void run(size_t count, const std::function<void(size_t index)> &job);
+
+    size_t size() const { return threads_.size(); }
+
+private:
+    void worker_loop(size_t index);
+
+    PlacementPlan placement_;
+    ThreadRole role_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(size_t)> *job_ = nullptr;
+    size_t next_index_ = 0;
+    size_t count_ = 0;
+    size_t remaining_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace jpegxs
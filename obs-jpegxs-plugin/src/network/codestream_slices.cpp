@@ -0,0 +1,111 @@
+#include "codestream_slices.h"
+#include <cstring>
+
+namespace jpegxs {
+
+static const uint8_t MARKER_SOC = 0x10;
+static const uint8_t MARKER_EOC = 0x11;
+static const uint8_t MARKER_PIH = 0x12;
+static const uint8_t MARKER_SLH = 0x20;
+static const size_t SLH_SIZE = 6;     // Marker, Lslh = 4, Yslh
+static const size_t PIH_LENGTH = 26;  // Lpih
+
+static uint16_t get_u16(const uint8_t* src) {
+    return (uint16_t)((src[0] << 8) | src[1]);
+}
+
+static uint32_t get_u32(const uint8_t* src) {
+    return ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | src[3];
+}
+
+static bool is_slice_header(const uint8_t* p, uint32_t index) {
+    return p[0] == 0xFF && p[1] == MARKER_SLH && p[2] == 0x00 && p[3] == 0x04 &&
+           get_u16(p + 4) == (uint16_t)index;
+}
+
+bool CodestreamSlices::parseHeader(const uint8_t* data, size_t size, Layout& layout) {
+    if (size < 2 || data[0] != 0xFF || data[1] != MARKER_SOC) return false;
+
+    bool have_pih = false;
+    size_t pos = 2;
+    while (pos + 4 <= size && data[pos] == 0xFF) {
+        uint8_t marker = data[pos + 1];
+        if (marker == MARKER_SLH) {
+            layout.header_size = pos;
+            return have_pih;
+        }
+
+        // Every header segment carries its length (excluding the marker)
+        size_t length = get_u16(data + pos + 2);
+        if (length < 2 || pos + 2 + length > size) return false;
+
+        if (marker == MARKER_PIH) {
+            if (length < PIH_LENGTH) return false;
+            const uint8_t* pih = data + pos;
+            uint32_t hsl = get_u16(pih + 18);
+            uint32_t nly = pih[26] & 0x0F;
+            layout.lcod_offset = pos + 4;
+            layout.height = get_u16(pih + 14);
+            layout.slice_lines = (nly < 16) ? (hsl << nly) : 0;
+            if (layout.height == 0 || layout.slice_lines == 0) return false;
+            layout.slice_count = (layout.height + layout.slice_lines - 1) / layout.slice_lines;
+            have_pih = true;
+        }
+        pos += 2 + length;
+    }
+    return false;
+}
+
+bool CodestreamSlices::findSlices(const uint8_t* data, size_t size, const Layout& layout, std::vector<SliceSpan>& slices) {
+    slices.clear();
+    size_t start = layout.header_size;
+    if (layout.slice_count == 0 || start + SLH_SIZE > size || !is_slice_header(data + start, 0)) return false;
+
+    for (uint32_t index = 1; index < layout.slice_count; index++) {
+        // Next SLH with the following index; slice data is unescaped, but a
+        // six-byte match that also carries the right index does not occur by chance
+        size_t pos = start + SLH_SIZE;
+        bool found = false;
+        while (pos + SLH_SIZE <= size) {
+            const void* hit = std::memchr(data + pos, 0xFF, size - SLH_SIZE + 1 - pos);
+            if (!hit) break;
+            pos = (const uint8_t*)hit - data;
+            if (is_slice_header(data + pos, index)) {
+                found = true;
+                break;
+            }
+            pos++;
+        }
+        if (!found) return false;
+
+        SliceSpan span;
+        span.index = index - 1;
+        span.offset = start;
+        span.size = pos - start;
+        slices.push_back(span);
+        start = pos;
+    }
+
+    // The last slice runs to the end and takes the EOC marker with it
+    if (size < start + SLH_SIZE + 2 || data[size - 2] != 0xFF || data[size - 1] != MARKER_EOC) return false;
+    SliceSpan last;
+    last.index = layout.slice_count - 1;
+    last.offset = start;
+    last.size = size - start;
+    slices.push_back(last);
+    return true;
+}
+
+uint32_t CodestreamSlices::codestreamLength(const uint8_t* data, const Layout& layout) {
+    return get_u32(data + layout.lcod_offset);
+}
+
+void CodestreamSlices::setCodestreamLength(uint8_t* data, const Layout& layout, uint32_t length) {
+    uint8_t* dst = data + layout.lcod_offset;
+    dst[0] = (uint8_t)(length >> 24);
+    dst[1] = (uint8_t)(length >> 16);
+    dst[2] = (uint8_t)(length >> 8);
+    dst[3] = (uint8_t)length;
+}
+
+} // namespace jpegxs
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace jpegxs {
+
+/**
+ * One slice of a JPEG XS codestream: the SLH marker segment and the
+ * precincts after it. The last slice also carries the EOC marker.
+ */
+struct SliceSpan {
+    uint32_t index = 0;
+    size_t offset = 0;
+    size_t size = 0;
+    bool intact = true;   // Every packet of the slice arrived
+};
+
+/**
+ * Slice structure of a plain (unstriped) JPEG XS codestream.
+ *
+ * A codestream is SOC, the header marker segments (CAP, PIH, CDT, WGT, ...),
+ * then one SLH-led slice per Hsl precinct rows, then EOC. Slices are coded
+ * independently, so a slice from an earlier frame of the same stream decodes
+ * in place of a lost one.
+ *
+ * The header is walked by its segment lengths. Slice data has no length
+ * field and no marker escaping, so slice boundaries are found by scanning
+ * for the next SLH segment with the expected slice index.
+ */
+class CodestreamSlices {
+public:
+    struct Layout {
+        size_t header_size = 0;     // SOC up to the first SLH
+        size_t lcod_offset = 0;     // PIH Lcod, the codestream length in bytes
+        uint32_t height = 0;        // Hf
+        uint32_t slice_lines = 0;   // Hsl precinct rows of 2^NLy lines
+        uint32_t slice_count = 0;
+    };
+
+    static bool parseHeader(const uint8_t* data, size_t size, Layout& layout);
+
+    // All layout.slice_count slices in order; false if any is not where expected
+    static bool findSlices(const uint8_t* data, size_t size, const Layout& layout, std::vector<SliceSpan>& slices);
+
+    static uint32_t codestreamLength(const uint8_t* data, const Layout& layout);
+    static void setCodestreamLength(uint8_t* data, const Layout& layout, uint32_t length);
+};
+
+} // namespace jpegxs
@@ -0,0 +1,62 @@
+#include "memory_accounting.h"
+
+#include <cstdio>
+
+namespace jpegxs {
+
+static const int COMPONENT_COUNT = static_cast<int>(MemoryComponent::COUNT);
+
+static std::atomic<uint64_t> g_live_bytes[COMPONENT_COUNT];
+static std::atomic<uint64_t> g_peak_bytes[COMPONENT_COUNT];
+
+void MemoryAccounting::Tracker::set(size_t bytes) {
+    size_t previous = bytes_.exchange(bytes, std::memory_order_relaxed);
+    if (previous == bytes) return;
+
+    int index = static_cast<int>(component_);
+    uint64_t live;
+    if (bytes > previous) {
+        live = g_live_bytes[index].fetch_add(bytes - previous, std::memory_order_relaxed) + (bytes - previous);
+    } else {
+        live = g_live_bytes[index].fetch_sub(previous - bytes, std::memory_order_relaxed) - (previous - bytes);
+    }
+
+    uint64_t peak = g_peak_bytes[index].load(std::memory_order_relaxed);
+    while (live > peak && !g_peak_bytes[index].compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t MemoryAccounting::liveBytes(MemoryComponent component) {
+    return g_live_bytes[static_cast<int>(component)].load(std::memory_order_relaxed);
+}
+
+uint64_t MemoryAccounting::peakBytes(MemoryComponent component) {
+    return g_peak_bytes[static_cast<int>(component)].load(std::memory_order_relaxed);
+}
+
+const char* MemoryAccounting::componentName(MemoryComponent component) {
+    switch (component) {
+        case MemoryComponent::ENCODER:      return "encoder";
+        case MemoryComponent::PACER:        return "pacer";
+        case MemoryComponent::DEPACKETIZER: return "depacketizer";
+        case MemoryComponent::DECODER:      return "decoder";
+        default:                            return "unknown";
+    }
+}
+
+std::string MemoryAccounting::summary() {
+    std::string result;
+    for (int i = 0; i < COMPONENT_COUNT; i++) {
+        MemoryComponent component = static_cast<MemoryComponent>(i);
+        uint64_t peak = peakBytes(component);
+        if (peak == 0) continue;
+
+        char entry[96];
+        snprintf(entry, sizeof(entry), "%s%s %.1f MB (peak %.1f MB)", result.empty() ? "" : ", ",
+                 componentName(component), liveBytes(component) / 1048576.0, peak / 1048576.0);
+        result += entry;
+    }
+    return result;
+}
+
+} // namespace jpegxs
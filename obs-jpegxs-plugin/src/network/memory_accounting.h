@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace jpegxs {
+
+/**
+ * Pipeline components whose buffers are accounted
+ */
+enum class MemoryComponent {
+    ENCODER,       // Bitstream/output buffers (SVT's internal allocations are not visible)
+    PACER,         // Packets queued for paced sending
+    DEPACKETIZER,  // RTP reassembly buffers and frames waiting for decode
+    DECODER,       // Decoded picture buffers
+    COUNT
+};
+
+/**
+ * Process-wide live byte counts per component. Every instance of a component
+ * owns a Tracker and reports its current footprint through it, so the totals
+ * cover all outputs and sources in the process.
+ */
+class MemoryAccounting {
+public:
+    class Tracker {
+    public:
+        explicit Tracker(MemoryComponent component) : component_(component) {}
+        ~Tracker() { set(0); }
+
+        Tracker(const Tracker&) = delete;
+        Tracker& operator=(const Tracker&) = delete;
+
+        // Replace this instance's footprint; the process total moves by the difference
+        void set(size_t bytes);
+        size_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+    private:
+        MemoryComponent component_;
+        std::atomic<size_t> bytes_{0};
+    };
+
+    static uint64_t liveBytes(MemoryComponent component);
+    static uint64_t peakBytes(MemoryComponent component);
+    static const char* componentName(MemoryComponent component);
+
+    // "encoder 1.2 MB (peak 3.4 MB), pacer ..." for components in use; empty if none
+    static std::string summary();
+};
+
+} // namespace jpegxs
@@ -40,8 +40,6 @@ void Pacer::start(uint64_t bitrate_bits_per_sec) {
     // TIME_CRITICAL is 15, HIGHEST is 2. Let's try HIGHEST first, TimeCritical might starve system if we spin too much.
     // But since we sleep, TimeCritical is safer for 2110-21.
     SetThreadPriority(handle, THREAD_PRIORITY_TIME_CRITICAL);
-#else
-    // pthread_setschedparam... (Linux/macOS) - can implement if needed
 #endif
 }
 
@@ -60,6 +58,8 @@ void Pacer::stop() {
         std::queue<PacerPacket> empty;
         std::swap(packet_queue_, empty);
         last_packet_end_time_ = 0;
+        queued_bytes_ = 0;
+        memory_.set(0);
     }
 
 #ifdef _WIN32
@@ -98,6 +98,7 @@ void Pacer::enqueueFrame(const std::vector<std::vector<uint8_t>>& packets, uint6
     for (size_t i = 0; i < packets.size(); ++i) {
         PacerPacket p;
         p.data = packets[i];
+        queued_bytes_ += p.data.size();
         
         // Packet N is scheduled at Start + (N * Interval)
         // Update last_packet_end_time_ as we go
@@ -106,11 +107,17 @@ void Pacer::enqueueFrame(const std::vector<std::vector<uint8_t>>& packets, uint6
         packet_queue_.push(std::move(p));
         last_packet_end_time_ = p.target_send_time_ns;
     }
+    memory_.set(queued_bytes_);
     
     cv_.notify_one();
 }
 
 void Pacer::pacerLoop() {
+    // Failures show up in the output's placement stats log
+    if (placement_.active()) {
+        ThreadPlacement::apply(placement_, ThreadRole::PACER, "jxs-pacer");
+    }
+    
     while (running_) {
         PacerPacket packet;
         bool has_packet = false;
@@ -151,6 +158,8 @@ void Pacer::pacerLoop() {
             }
             
             // Time to send (or overdue)
+            queued_bytes_ -= packet_queue_.front().data.size();
+            memory_.set(queued_bytes_);
             packet_queue_.pop();
             has_packet = true;
         }
@@ -9,6 +9,9 @@
 #include <chrono>
 #include <functional>
 
+#include "thread_placement.h"
+#include "memory_accounting.h"
+
 namespace jpegxs {
 
 // Interface for the sender callback
@@ -26,6 +29,9 @@ public:
 
     void setSender(PacketSender sender);
     
+    // CPU/NUMA placement for the pacing thread (applied on start)
+    void setPlacement(const PlacementPlan& plan) { placement_ = plan; }
+    
     // Start the pacing thread
     // bitrate_bits_per_sec: Target bitrate for pacing calculations
     void start(uint64_t bitrate_bits_per_sec);
@@ -36,6 +42,9 @@ public:
     // packets: vector of serialized RTP packets
     // frame_duration_ns: total duration of this frame (e.g., 16666666 for 60fps)
     void enqueueFrame(const std::vector<std::vector<uint8_t>>& packets, uint64_t frame_duration_ns);
+    
+    // Payload bytes currently queued for sending
+    size_t memoryUsage() const { return memory_.bytes(); }
 
 private:
     void pacerLoop();
@@ -47,6 +56,10 @@ private:
     std::mutex mutex_;
     std::condition_variable cv_;
     std::queue<PacerPacket> packet_queue_;
+    size_t queued_bytes_ = 0; // Guarded by mutex_
+    MemoryAccounting::Tracker memory_{MemoryComponent::PACER};
+    
+    PlacementPlan placement_;
     
     uint64_t bitrate_bps_ = 0;
     uint64_t last_packet_end_time_ = 0;
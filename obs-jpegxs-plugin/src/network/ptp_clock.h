@@ -22,12 +22,16 @@ public:
         return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
     }
     
+    // RTP timestamp of a PTP instant: media clock ticks since the epoch at
+    // the stream's rate, low 32 bits (ST 2110-10, mediaclk:direct=0)
+    static uint32_t rtp_timestamp(uint64_t ptp_ns, uint32_t rate) {
+        // Split so the multiply can't overflow (ns * 90 already does past 2^64)
+        return (uint32_t)((ptp_ns / 1000000000ULL) * rate + (ptp_ns % 1000000000ULL) * rate / 1000000000ULL);
+    }
+    
     // Get RTP timestamp (90kHz clock)
     static uint32_t get_rtp_timestamp() {
-        // RTP timestamp is 32-bit, wraps around.
-        // 90000 Hz
-        uint64_t ns = now_ns();
-        return (uint32_t)((ns * 90) / 1000000);
+        return rtp_timestamp(now_ns(), 90000);
     }
 };
 
@@ -0,0 +1,102 @@
+#include "rate_controller.h"
+#include <algorithm>
+
+namespace jpegxs {
+
+// RTP (12) + JPEG XS payload header (4) + SRT/UDP/IP (~44) per ~1350 byte payload,
+// plus headroom so retransmissions are not starved by the pacing cap.
+constexpr double PACKET_OVERHEAD = 1.05;
+constexpr double RETRANSMIT_HEADROOM = 1.25;
+
+RateController::RateController(const Config& config)
+    : config_(config) {
+    reset(config_.max_mbps);
+}
+
+void RateController::reset(double start_mbps) {
+    stats_ = Stats();
+    stats_.target_mbps = std::clamp(start_mbps, config_.min_mbps, config_.max_mbps);
+    has_baseline_ = false;
+    last_update_ns_ = 0;
+    clean_intervals_ = 0;
+}
+
+int64_t RateController::maxBandwidthFor(double mbps) {
+    return static_cast<int64_t>(mbps * 1000000.0 / 8.0 * PACKET_OVERHEAD * RETRANSMIT_HEADROOM);
+}
+
+bool RateController::update(const SRTTransport::Stats& stats, uint64_t now_ns) {
+    if (!stats.connected) {
+        has_baseline_ = false;
+        return false;
+    }
+
+    if (has_baseline_ && now_ns - last_update_ns_ < config_.interval_ns) {
+        return false;
+    }
+
+    // Counters are cumulative since connect; work on per-interval deltas
+    int64_t sent = stats.packets_sent - last_sent_;
+    int64_t retrans = stats.packets_retransmitted - last_retrans_;
+    int64_t lost = stats.packets_send_lost - last_loss_;
+    int64_t dropped = stats.packets_send_dropped - last_dropped_;
+
+    bool first_sample = !has_baseline_;
+
+    last_sent_ = stats.packets_sent;
+    last_retrans_ = stats.packets_retransmitted;
+    last_loss_ = stats.packets_send_lost;
+    last_dropped_ = stats.packets_send_dropped;
+    last_update_ns_ = now_ns;
+    has_baseline_ = true;
+
+    if (first_sample || sent <= 0) {
+        last_buffer_ms_ = stats.send_buffer_ms;
+        return false;
+    }
+
+    stats_.send_buffer_ms = stats.send_buffer_ms;
+    stats_.retrans_rate = static_cast<double>(retrans) / sent;
+    stats_.loss_rate = static_cast<double>(lost) / sent;
+
+    // Back off before the buffered data ages past the latency window,
+    // which is where SRT would start dropping too-late packets.
+    double buffer_limit_ms = config_.latency_ms * config_.buffer_backoff_ratio;
+    bool buffer_growing = stats.send_buffer_ms > last_buffer_ms_ && stats.send_buffer_ms > buffer_limit_ms * 0.5;
+    bool buffer_congested = stats.send_buffer_ms > buffer_limit_ms;
+    last_buffer_ms_ = stats.send_buffer_ms;
+
+    bool lossy = stats_.retrans_rate > config_.retrans_backoff_rate || stats_.loss_rate > config_.retrans_backoff_rate;
+
+    double target = stats_.target_mbps;
+
+    if (dropped > 0) {
+        target *= config_.drop_decrease_factor;
+        clean_intervals_ = 0;
+    } else if (buffer_congested || lossy) {
+        target *= config_.decrease_factor;
+        clean_intervals_ = 0;
+    } else if (buffer_growing) {
+        // Early warning: hold steady, don't probe upwards
+        clean_intervals_ = 0;
+    } else if (++clean_intervals_ >= config_.clean_intervals_to_increase) {
+        target += config_.max_mbps * config_.increase_step;
+        clean_intervals_ = 0;
+    }
+
+    target = std::clamp(target, config_.min_mbps, config_.max_mbps);
+
+    if (target == stats_.target_mbps) {
+        return false;
+    }
+
+    if (target < stats_.target_mbps) {
+        stats_.decreases++;
+    } else {
+        stats_.increases++;
+    }
+    stats_.target_mbps = target;
+    return true;
+}
+
+} // namespace jpegxs
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+#include "srt_transport.h"
+
+namespace jpegxs {
+
+/**
+ * Closed-loop bitrate controller driven by SRT sender telemetry.
+ *
+ * Backs off multiplicatively as soon as the send buffer starts to hold more
+ * than a fraction of the SRT latency budget (i.e. before TLPKTDROP kicks in),
+ * or when loss/retransmits climb. Recovers additively after a run of clean
+ * intervals so capacity is probed gently when the link frees up.
+ */
+class RateController {
+public:
+    struct Config {
+        double min_mbps = 50.0;        // Floor (profile / quality limit)
+        double max_mbps = 500.0;       // Ceiling (configured compression ratio)
+        int32_t latency_ms = 20;       // SRTO_LATENCY of the link
+
+        double buffer_backoff_ratio = 0.5;  // Send buffer delay vs latency that triggers back-off
+        double retrans_backoff_rate = 0.02; // Retransmitted / sent packets per interval
+        double decrease_factor = 0.8;       // Multiplicative decrease on congestion
+        double drop_decrease_factor = 0.6;  // Harder decrease once SRT dropped packets
+        double increase_step = 0.05;        // Additive increase as fraction of max_mbps
+        uint32_t clean_intervals_to_increase = 3;
+        uint64_t interval_ns = 500000000ULL;
+    };
+
+    struct Stats {
+        double target_mbps = 0.0;
+        double send_buffer_ms = 0.0;
+        double retrans_rate = 0.0;
+        double loss_rate = 0.0;
+        uint64_t decreases = 0;
+        uint64_t increases = 0;
+    };
+
+    explicit RateController(const Config& config);
+
+    // Start from a known bitrate (usually max_mbps)
+    void reset(double start_mbps);
+
+    /**
+     * Feed a fresh telemetry sample.
+     * @return true if the target bitrate changed and should be applied
+     */
+    bool update(const SRTTransport::Stats& stats, uint64_t now_ns);
+
+    // Whether update() would act now; lets callers skip polling libsrt in between
+    bool due(uint64_t now_ns) const {
+        return !has_baseline_ || now_ns - last_update_ns_ >= config_.interval_ns;
+    }
+
+    double getTargetMbps() const { return stats_.target_mbps; }
+    Stats getStats() const { return stats_; }
+
+    // SRTO_MAXBW (bytes/sec) for a given video bitrate, including packet and retransmit overhead
+    static int64_t maxBandwidthFor(double mbps);
+
+private:
+    Config config_;
+    Stats stats_;
+
+    bool has_baseline_ = false;
+    uint64_t last_update_ns_ = 0;
+    int64_t last_sent_ = 0;
+    int64_t last_retrans_ = 0;
+    int64_t last_loss_ = 0;
+    int64_t last_dropped_ = 0;
+    double last_buffer_ms_ = 0.0;
+    uint32_t clean_intervals_ = 0;
+};
+
+} // namespace jpegxs
@@ -15,8 +15,8 @@
 namespace jpegxs {
 
 // RTP constants
-constexpr size_t RTP_HEADER_SIZE = 12;
-constexpr size_t JPEGXS_PAYLOAD_HEADER_SIZE = 8;
+constexpr size_t RTP_HEADER_SIZE = RTPPacket::HEADER_SIZE;
+constexpr size_t JPEGXS_PAYLOAD_HEADER_SIZE = RTPPacket::PAYLOAD_HEADER_SIZE;
 constexpr size_t DEFAULT_MAX_PAYLOAD_SIZE = 1280;  // Reduced to be safe for SRT default MSS/Payload limits
 
 // RTPPacket Implementation
@@ -74,23 +74,21 @@ void RTPPacket::serializeHeader(uint8_t* buffer) const {
     std::memcpy(buffer + 8, &ssrc, 4);
 }
 
+// T|K|L|I(2)|F(5)|SEP(11)|P(11), most significant bit first
+static void writePayloadHeader(uint8_t* buffer, const RTPPacket::JPEGXSPayloadHeader& h) {
+    uint32_t word = (h.sequential ? 1u << 31 : 0) |
+                    ((h.packetization_mode & 1u) << 30) |
+                    (h.last ? 1u << 29 : 0) |
+                    ((h.interlace & 0x3u) << 27) |
+                    ((h.frame_counter & 0x1Fu) << 22) |
+                    ((uint32_t)(h.sep_counter & RTPPacket::COUNTER_MASK) << 11) |
+                    (h.packet_counter & RTPPacket::COUNTER_MASK);
+    word = htonl(word);
+    std::memcpy(buffer, &word, 4);
+}
+
 void RTPPacket::serializePayloadHeader(uint8_t* buffer) const {
-    // RFC 9134 JPEG XS Payload Header
-    // Bytes 0-1: Reserved (K field) and packetization mode
-    buffer[0] = 0;  // K field reserved
-    buffer[1] = payload_header_.packetization_mode;
-    
-    // Bytes 2-3: Line number
-    uint16_t line_num = htons(payload_header_.line_number);
-    std::memcpy(buffer + 2, &line_num, 2);
-    
-    // Bytes 4-5: Line offset
-    uint16_t line_off = htons(payload_header_.line_offset);
-    std::memcpy(buffer + 4, &line_off, 2);
-    
-    // Bytes 6-7: Slice height
-    uint16_t slice_h = htons(payload_header_.slice_height);
-    std::memcpy(buffer + 6, &slice_h, 2);
+    writePayloadHeader(buffer, payload_header_);
 }
 
 std::unique_ptr<RTPPacket> RTPPacket::deserialize(const uint8_t* data, size_t size) {
@@ -152,20 +150,17 @@ bool RTPPacket::deserializePayloadHeader(const uint8_t* buffer, size_t size,
                                          JPEGXSPayloadHeader& payload_header) {
     if (size < JPEGXS_PAYLOAD_HEADER_SIZE) return false;
     
-    payload_header.k = buffer[0];
-    payload_header.packetization_mode = buffer[1];
-    
-    uint16_t line_num;
-    std::memcpy(&line_num, buffer + 2, 2);
-    payload_header.line_number = ntohs(line_num);
-    
-    uint16_t line_off;
-    std::memcpy(&line_off, buffer + 4, 2);
-    payload_header.line_offset = ntohs(line_off);
+    uint32_t word;
+    std::memcpy(&word, buffer, 4);
+    word = ntohl(word);
     
-    uint16_t slice_h;
-    std::memcpy(&slice_h, buffer + 6, 2);
-    payload_header.slice_height = ntohs(slice_h);
+    payload_header.sequential = (word >> 31) != 0;
+    payload_header.packetization_mode = (word >> 30) & 1;
+    payload_header.last = ((word >> 29) & 1) != 0;
+    payload_header.interlace = (word >> 27) & 0x3;
+    payload_header.frame_counter = (word >> 22) & 0x1F;
+    payload_header.sep_counter = (word >> 11) & COUNTER_MASK;
+    payload_header.packet_counter = word & COUNTER_MASK;
     
     return true;
 }
@@ -187,7 +182,6 @@ RTPPacketizer::RTPPacketizer(size_t max_payload_size)
     : ssrc_(RTPPacket::generateSSRC())
     , payload_type_(96)
     , sequence_number_(0)
-    , slice_height_(16)
     , max_payload_size_(max_payload_size) {
 }
 
@@ -201,10 +195,6 @@ void RTPPacketizer::setPayloadType(uint8_t pt) {
     payload_type_ = pt;
 }
 
-void RTPPacketizer::setSliceHeight(uint16_t height) {
-    slice_height_ = height;
-}
-
 void RTPPacketizer::setMaxPayloadSize(size_t size) {
     max_payload_size_ = size;
 }
@@ -217,25 +207,59 @@ void RTPPacketizer::packetize(
     PacketCallback callback) {
     
     // Pre-allocate scratch buffer
-    // RTP Header (12) + Payload Header (8) + Max Payload
-    size_t max_packet_size = 12 + 8 + max_payload_size_;
+    size_t max_packet_size = RTP_HEADER_SIZE + JPEGXS_PAYLOAD_HEADER_SIZE + max_payload_size_;
     if (scratch_buffer_.size() < max_packet_size) {
         scratch_buffer_.resize(max_packet_size);
     }
     
+    // Slice mode needs every unit's packets and the units themselves to fit the 11-bit counters
+    CodestreamSlices::Layout layout;
+    bool sliced = slice_mode_ && frame_packets_ == 0 &&
+                  CodestreamSlices::parseHeader(jpegxs_data, data_size, layout) &&
+                  CodestreamSlices::findSlices(jpegxs_data, data_size, layout, slices_) &&
+                  slices_.size() < RTPPacket::COUNTER_MASK;
+    const size_t max_unit_size = max_payload_size_ * (RTPPacket::COUNTER_MASK + 1);
+    for (size_t i = 0; sliced && i < slices_.size(); i++) {
+        sliced = slices_[i].size <= max_unit_size;
+    }
+    
+    if (!sliced) {
+        packetizeUnit(jpegxs_data, data_size, timestamp, is_last_slice_in_frame, false, 0, callback);
+    } else {
+        // The header, then each slice from a packet boundary
+        packetizeUnit(jpegxs_data, layout.header_size, timestamp, false, true, 0, callback);
+        for (size_t i = 0; i < slices_.size(); i++) {
+            const SliceSpan& slice = slices_[i];
+            packetizeUnit(jpegxs_data + slice.offset, slice.size, timestamp,
+                          is_last_slice_in_frame && i + 1 == slices_.size(), true, (uint16_t)(i + 1), callback);
+        }
+    }
+    
+    if (is_last_slice_in_frame) {
+        frame_counter_ = (frame_counter_ + 1) & 0x1F;
+        frame_packets_ = 0;
+    }
+}
+
+void RTPPacketizer::packetizeUnit(const uint8_t* data, size_t size, uint32_t timestamp, bool marker_at_end,
+                                  bool slice_mode, uint16_t sep, PacketCallback& callback) {
     uint8_t* buffer = scratch_buffer_.data();
     
+    RTPPacket::JPEGXSPayloadHeader payload_header;
+    payload_header.packetization_mode = slice_mode ? 1 : 0;
+    payload_header.frame_counter = frame_counter_;
+    
     size_t offset = 0;
-    // uint16_t line_number = 0; // Unused for now
+    uint32_t unit_packet = 0;
     
-    while (offset < data_size) {
+    while (offset < size) {
         // RTP Header (12 bytes)
         // V=2, P=0, X=0, CC=0 -> 0x80
         buffer[0] = 0x80;
         
-        size_t remaining = data_size - offset;
+        size_t remaining = size - offset;
         size_t payload_size = std::min(remaining, max_payload_size_);
-        bool marker = is_last_slice_in_frame && (offset + payload_size >= data_size);
+        bool marker = marker_at_end && (offset + payload_size >= size);
         
         // M=marker, PT=payload_type
         buffer[1] = (marker ? 0x80 : 0x00) | (payload_type_ & 0x7F);
@@ -252,20 +276,25 @@ void RTPPacketizer::packetize(
         uint32_t ss = htonl(ssrc_);
         std::memcpy(buffer + 8, &ss, 4);
         
-        // JPEG XS Payload Header (8 bytes)
-        // K=0, Mode=0 (Codestream)
-        buffer[12] = 0x00; // K
-        buffer[13] = 0x00; // Mode 0
-        
-        // Line Number = 0 (Codestream mode doesn't use it per packet typically unless Slice mode)
-        // Since we are using packetization-mode=0 (Codestream), fields are mostly zero or frame-global
-        std::memset(buffer + 14, 0, 6); // Line num, offset, slice height all 0 for now
+        // JPEG XS Payload Header: slice mode counts packets per unit,
+        // codestream mode per frame with SEP extending P
+        payload_header.last = offset + payload_size >= size && (slice_mode || marker_at_end);
+        if (slice_mode) {
+            payload_header.sep_counter = sep;
+            payload_header.packet_counter = (uint16_t)unit_packet++;
+        } else {
+            payload_header.sep_counter = (uint16_t)((frame_packets_ >> 11) & RTPPacket::COUNTER_MASK);
+            payload_header.packet_counter = (uint16_t)(frame_packets_ & RTPPacket::COUNTER_MASK);
+        }
+        frame_packets_++;
+        writePayloadHeader(buffer + RTP_HEADER_SIZE, payload_header);
         
         // Copy Payload
-        std::memcpy(buffer + 20, jpegxs_data + offset, payload_size);
+        const size_t headers = RTP_HEADER_SIZE + JPEGXS_PAYLOAD_HEADER_SIZE;
+        std::memcpy(buffer + headers, data + offset, payload_size);
         
         // Callback with total packet data
-        callback(buffer, 20 + payload_size);
+        callback(buffer, headers + payload_size);
         
         offset += payload_size;
     }
@@ -273,6 +302,8 @@ void RTPPacketizer::packetize(
 
 void RTPPacketizer::reset() {
     sequence_number_ = 0;
+    frame_counter_ = 0;
+    frame_packets_ = 0;
 }
 
 // RTPDepacketizer Implementation
@@ -283,12 +314,11 @@ RTPDepacketizer::RTPDepacketizer()
     , frame_started_(false)
     , discarding_frame_(false)
     , waiting_for_start_(true) {
-    // Pre-allocate pool
+    // Pre-allocate pool slots; payloads and the frame buffer are sized by
+    // the stream itself, so an idle receiver holds no frame-sized memory
     packet_pool_.resize(8192); // Enough for 4K frame at 1500 MTU
-    for(auto& p : packet_pool_) p.payload.reserve(1500);
-    
     pending_packets_.reserve(8192);
-    frame_buffer_.reserve(1920 * 1080 * 2); // Conservative max
+    updateMemoryUsage();
 }
 
 RTPDepacketizer::~RTPDepacketizer() = default;
@@ -307,50 +337,88 @@ bool RTPDepacketizer::processPacket(const uint8_t* data, size_t size) {
         if (header.marker) {
             waiting_for_start_ = false;
             // The next packet should be the start of a new frame
+            expected_sequence_ = header.sequence_number + 1;
         }
         return false;
     }
     
     // 2. Parse JPEG XS Payload Header
-    // Skip RTP Header (12 bytes)
-    size_t offset = 12;
-    if (size < offset + 8) return false; // Too small for payload header
+    size_t offset = RTP_HEADER_SIZE;
+    RTPPacket::JPEGXSPayloadHeader payload_header;
+    if (!RTPPacket::deserializePayloadHeader(data + offset, size - offset, payload_header)) {
+        return false; // Too small for payload header
+    }
     
-    offset += 8; // Skip payload header
+    offset += JPEGXS_PAYLOAD_HEADER_SIZE;
+    
+    // Slice mode: SEP 0 is the codestream header, SEP n slice n - 1
+    bool slice_packet = payload_header.packetization_mode == 1;
+    int32_t unit = slice_packet ? (int32_t)payload_header.sep_counter - 1 : -1;
+    
+    // A frame deferred by the last packet and never taken: the newer one wins
+    bool completed = false;
+    if (marker_deferred_) {
+        marker_deferred_ = false;
+        completed = assembleFrame(true);
+    }
     
     // Start new frame on timestamp change
     if (!frame_started_ || header.timestamp != current_timestamp_) {
         if (frame_started_) {
-            // Previous frame incomplete, discard
-            pool_used_ = 0;
-            pending_packets_.clear();
+            // Previous frame incomplete. A sliced one only lost its tail and
+            // goes out with the last slices damaged; otherwise discard
+            if (!discarding_frame_ && frame_sliced_ && !pending_packets_.empty()) {
+                completed = assembleFrame(false);
+            } else {
+                pool_used_ = 0;
+                pending_packets_.clear();
+            }
         }
         frame_started_ = true;
         discarding_frame_ = false;
+        frame_sliced_ = slice_packet;
         current_timestamp_ = header.timestamp;
+        
+        if (frame_sliced_) {
+            // Losses before the frame's first packet only matter if they took the header
+            if (header.sequence_number != expected_sequence_) {
+                int16_t diff = static_cast<int16_t>(header.sequence_number - expected_sequence_);
+                if (diff > 0) stats_.packets_lost += diff;
+            }
+            expected_sequence_ = header.sequence_number;
+            if (unit != -1 || payload_header.packet_counter != 0) {
+                discarding_frame_ = true;
+            }
+        }
     }
     
     // If we are discarding this frame due to previous loss, ignore this packet
     if (discarding_frame_) {
         expected_sequence_ = header.sequence_number + 1;
-        return false;
+        return completed;
     }
     
     // Check for lost packets
+    bool after_gap = false;
     if (frame_started_ && header.sequence_number != expected_sequence_) {
         int16_t diff = static_cast<int16_t>(header.sequence_number - expected_sequence_);
         
         if (diff > 0) {
             stats_.packets_lost += diff;
-            // Loss detected within the frame. Discard entire frame.
-            pool_used_ = 0;
-            pending_packets_.clear();
-            discarding_frame_ = true;
-            expected_sequence_ = header.sequence_number + 1;
-            return false; 
+            if (frame_sliced_) {
+                // Only the slices around the gap are damaged; keep collecting
+                after_gap = true;
+            } else {
+                // Loss detected within the frame. Discard entire frame.
+                pool_used_ = 0;
+                pending_packets_.clear();
+                discarding_frame_ = true;
+                expected_sequence_ = header.sequence_number + 1;
+                return completed;
+            }
         } else if (diff < 0) {
              stats_.out_of_order_packets++;
-             return false;
+             return completed;
         }
     }
     
@@ -360,35 +428,42 @@ bool RTPDepacketizer::processPacket(const uint8_t* data, size_t size) {
         if (pool_used_ >= packet_pool_.size()) {
             // Pool exhausted, resize
             // NOTE: Vector resize invalidates pointers, but we use indices now so it's safe!
-            size_t old_size = packet_pool_.size();
-            packet_pool_.resize(old_size * 2);
-            for(size_t i=old_size; i<packet_pool_.size(); ++i) {
-                packet_pool_[i].payload.reserve(1500);
-            }
+            packet_pool_.resize(packet_pool_.size() * 2);
         }
         
         size_t idx = pool_used_++;
         PacketData& pdata = packet_pool_[idx];
         pdata.seq = header.sequence_number;
+        pdata.unit = unit;
+        pdata.unit_packet = payload_header.packet_counter;
+        pdata.unit_last = payload_header.last;
+        pdata.after_gap = after_gap;
         
         // Copy without re-allocation (if capacity sufficient)
+        size_t old_capacity = pdata.payload.capacity();
         pdata.payload.assign(data + offset, data + offset + payload_size);
+        payload_capacity_ += pdata.payload.capacity() - old_capacity;
         
         pending_packets_.push_back(idx);
     }
     
     expected_sequence_ = header.sequence_number + 1;
     
-    // Check if frame is complete (marker bit set)
+    // Check if frame is complete (marker bit set). If this packet already
+    // completed the previous frame, that one goes out first and this one is
+    // assembled when it has been taken
     if (header.marker) {
-        assembleFrame();
-        return true;
+        if (completed) {
+            marker_deferred_ = true;
+            return true;
+        }
+        return assembleFrame(true);
     }
     
-    return false;
+    return completed;
 }
 
-void RTPDepacketizer::assembleFrame() {
+bool RTPDepacketizer::assembleFrame(bool complete) {
     // Sort packets by sequence number using indices
     std::sort(pending_packets_.begin(), pending_packets_.end(),
               [this](size_t a_idx, size_t b_idx) {
@@ -400,30 +475,85 @@ void RTPDepacketizer::assembleFrame() {
               
     // Flatten
     frame_buffer_.clear();
+    frame_slices_.clear();
     size_t total_size = 0;
     for (size_t idx : pending_packets_) {
         total_size += packet_pool_[idx].payload.size();
     }
     
     if (frame_buffer_.capacity() < total_size) {
-        frame_buffer_.reserve(total_size * 2); // Grow aggressively
+        // Rate control keeps frames near the same size; headroom avoids regrowing
+        frame_buffer_.reserve(total_size + total_size / 8);
     }
     
+    // A unit is whole when it starts at packet 0, nothing inside it was
+    // lost, and its last packet (L) arrived
+    bool header_intact = true;
+    bool unit_closed = false;
     for (size_t idx : pending_packets_) {
         const auto& p = packet_pool_[idx];
+        if (frame_sliced_) {
+            if (p.unit < 0) {
+                header_intact = header_intact && !p.after_gap;
+            } else if (frame_slices_.empty() || frame_slices_.back().index != (uint32_t)p.unit) {
+                if (!unit_closed) {
+                    if (frame_slices_.empty()) header_intact = false;
+                    else frame_slices_.back().intact = false;
+                }
+                SliceSpan span;
+                span.index = (uint32_t)p.unit;
+                span.offset = frame_buffer_.size();
+                span.intact = p.unit_packet == 0;
+                frame_slices_.push_back(span);
+            } else if (p.after_gap) {
+                frame_slices_.back().intact = false;
+            }
+            if (!frame_slices_.empty()) frame_slices_.back().size += p.payload.size();
+            unit_closed = p.unit_last;
+        }
         frame_buffer_.insert(frame_buffer_.end(), p.payload.begin(), p.payload.end());
     }
     
     // Reset pool usage
     pool_used_ = 0;
     pending_packets_.clear();
+    frame_started_ = false;
     
+    if (frame_sliced_) {
+        // Without the marker, or its own last packet, the last slice that arrived may be short
+        if ((!complete || !unit_closed) && !frame_slices_.empty()) frame_slices_.back().intact = false;
+        
+        uint32_t damaged = 0;
+        for (const SliceSpan& span : frame_slices_) {
+            if (!span.intact) damaged++;
+        }
+        if (!header_intact) {
+            frame_buffer_.clear();
+            frame_slices_.clear();
+            frame_ready_ = false;
+            updateMemoryUsage();
+            return false;
+        }
+        if (!complete || damaged > 0 || frame_slices_.empty() || frame_slices_.back().index + 1 != frame_slices_.size()) {
+            stats_.frames_damaged++;
+            stats_.slices_damaged += damaged;
+        }
+    }
+    
+    frame_ready_ = true;
+    frame_timestamp_ = current_timestamp_;
     stats_.frames_assembled++;
-    frame_started_ = false;
+    updateMemoryUsage();
+    return true;
+}
+
+void RTPDepacketizer::updateMemoryUsage() {
+    memory_.set(frame_buffer_.capacity() + payload_capacity_ +
+                packet_pool_.capacity() * sizeof(PacketData) + pending_packets_.capacity() * sizeof(size_t));
 }
 
 bool RTPDepacketizer::isFrameReady() const {
-    return !frame_buffer_.empty() && !frame_started_;
+    return frame_ready_ && !frame_buffer_.empty();
 }
 
 const uint8_t* RTPDepacketizer::getFrameData(size_t& size) const {
@@ -431,14 +561,38 @@ const uint8_t* RTPDepacketizer::getFrameData(size_t& size) const {
     return frame_buffer_.data();
 }
 
+void RTPDepacketizer::takeFrame(std::vector<uint8_t>& frame) {
+    frame.clear();
+    frame.swap(frame_buffer_);
+    frame_slices_.clear();
+    frame_ready_ = false;
+    if (marker_deferred_) {
+        marker_deferred_ = false;
+        assembleFrame(true);
+    }
+    updateMemoryUsage();
+}
+
+void RTPDepacketizer::takeFrame(std::vector<uint8_t>& frame, std::vector<SliceSpan>& slices) {
+    // Slices first: taking the frame may assemble a deferred one
+    slices.clear();
+    slices.swap(frame_slices_);
+    takeFrame(frame);
+}
+
 void RTPDepacketizer::reset() {
     pending_packets_.clear();
     frame_buffer_.clear();
+    frame_slices_.clear();
+    frame_ready_ = false;
+    frame_timestamp_ = 0;
     expected_sequence_ = 0;
     current_timestamp_ = 0;
     frame_started_ = false;
+    frame_sliced_ = false;
     discarding_frame_ = false;
     waiting_for_start_ = true;
+    marker_deferred_ = false;
     stats_ = Stats();
 }
 
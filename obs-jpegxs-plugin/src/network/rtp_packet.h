@@ -5,6 +5,9 @@
 #include <memory>
 #include <functional>
 
+#include "memory_accounting.h"
+#include "codestream_slices.h"
+
 namespace jpegxs {
 
 /**
@@ -25,14 +28,23 @@ public:
         uint32_t ssrc = 0;          // Synchronization source identifier
     };
 
-    // JPEG XS specific RTP payload header (RFC 9134)
+    // JPEG XS RTP payload header (RFC 9134 section 4.3), 32 bits:
+    // T(1) K(1) L(1) I(2) F counter(5) SEP counter(11) P counter(11)
+    // A packetization unit is the whole frame in codestream mode; in slice
+    // mode it is the codestream header (SEP 0) or one slice (SEP index + 1)
     struct JPEGXSPayloadHeader {
-        uint8_t k = 0;              // K field (reserved, must be 0)
-        uint8_t packetization_mode = 1;  // 0=codestream, 1=slice
-        uint16_t line_number = 0;   // Line number of first line in packet
-        uint16_t line_offset = 0;   // Byte offset within line
-        uint16_t slice_height = 16; // Height of slice in lines
+        bool sequential = true;          // T: packets sent in order
+        uint8_t packetization_mode = 1;  // K: 0=codestream, 1=slice
+        bool last = false;               // L: last packet of its packetization unit
+        uint8_t interlace = 0;           // I: 0=progressive
+        uint8_t frame_counter = 0;       // F: frame number, mod 32
+        uint16_t sep_counter = 0;        // Slice mode: unit; codestream mode: P counter overflows (mod 2048)
+        uint16_t packet_counter = 0;     // P: packet within the unit (mod 2048)
     };
+    
+    static constexpr size_t HEADER_SIZE = 12;          // RTP, no CSRCs or extension
+    static constexpr size_t PAYLOAD_HEADER_SIZE = 4;
+    static constexpr uint16_t COUNTER_MASK = 0x7FF;    // SEP and P counters
 
     RTPPacket();
     ~RTPPacket();
@@ -84,12 +96,19 @@ public:
     // Configure packetizer
     void setSSRC(uint32_t ssrc);
     void setPayloadType(uint8_t pt);
-    void setSliceHeight(uint16_t height);
     void setMaxPayloadSize(size_t size);  // MTU consideration
     
+    // RFC 9134 packetization mode: slice (default) or codestream, which is
+    // what an SDP with packetization-mode=0 declares
+    void setSliceMode(bool enabled) { slice_mode_ = enabled; }
+    
     using PacketCallback = std::function<void(const uint8_t* data, size_t size)>;
 
-    // Packetize JPEG XS encoded frame/slice with zero-copy callback
+    // Packetize JPEG XS encoded frame/slice with zero-copy callback. In slice
+    // mode a plain codestream goes out as slices, packets starting on slice
+    // boundaries so a receiver can tell which slices a loss touched; anything
+    // else (striped frames, or more slices or packets per slice than the
+    // 11-bit counters hold) in codestream mode.
     void packetize(
         const uint8_t* jpegxs_data,
         size_t data_size,
@@ -105,10 +124,17 @@ private:
     uint32_t ssrc_;
     uint8_t payload_type_;
     uint16_t sequence_number_;
-    uint16_t slice_height_;
     size_t max_payload_size_;
+    bool slice_mode_ = true;
+    uint8_t frame_counter_ = 0;     // F counter of the frame being sent
+    uint32_t frame_packets_ = 0;    // Codestream mode: packets of this frame so far (SEP:P)
     
     std::vector<uint8_t> scratch_buffer_;
+    std::vector<SliceSpan> slices_;
+    
+    // Packets for one packetization unit; sep is the slice-mode unit counter
+    void packetizeUnit(const uint8_t* data, size_t size, uint32_t timestamp, bool marker_at_end,
+                       bool slice_mode, uint16_t sep, PacketCallback& callback);
 };
 
 /**
@@ -122,29 +148,52 @@ public:
     // Process incoming RTP packet
     bool processPacket(const uint8_t* data, size_t size);
     
-    // Check if complete frame is ready
+    // Check if complete frame is ready. One packet can complete two frames
+    // (one whose marker was lost, and its successor when that packet is the
+    // marker); the second is ready once the first is taken, so callers take
+    // frames while this holds
     bool isFrameReady() const;
     
     // Get assembled frame data (zero-copy)
     // Returns pointer to internal buffer and its size
     const uint8_t* getFrameData(size_t& size) const;
     
+    // Move the assembled frame into `frame` and take frame's old buffer as
+    // the next reassembly buffer, so a frame can outlive the next packet
+    // without being copied
+    void takeFrame(std::vector<uint8_t>& frame);
+    
+    // As above, also swapping out the frame's slices (slice-mode senders
+    // only, otherwise empty). A frame that lost packets is still delivered
+    // when its header arrived whole; the slices the loss touched are marked
+    // not intact, and slices nothing arrived for are absent.
+    void takeFrame(std::vector<uint8_t>& frame, std::vector<SliceSpan>& slices);
+    
     // Reset state
     void reset();
     
     // Get current frame timestamp (RTP 90kHz)
     uint32_t getCurrentTimestamp() const { return current_timestamp_; }
     
+    // Timestamp of the assembled frame; differs from the current one when a
+    // frame whose marker was lost is completed by the next frame's first packet
+    uint32_t getFrameTimestamp() const { return frame_timestamp_; }
+    
     // Statistics
     struct Stats {
         uint32_t packets_received = 0;
         uint32_t packets_lost = 0;
         uint32_t frames_assembled = 0;
         uint32_t out_of_order_packets = 0;
+        uint32_t frames_damaged = 0;    // Delivered with slices missing or incomplete
+        uint32_t slices_damaged = 0;    // Incomplete slices in those frames (absent ones not counted)
     };
     
     const Stats& getStats() const { return stats_; }
     
+    // Bytes held by the packet pool and frame buffer
+    size_t memoryUsage() const { return memory_.bytes(); }
+    
 private:
     struct PacketInfo {
         uint16_t sequence_number;
@@ -178,27 +227,40 @@ private:
     
     struct PacketData {
         uint16_t seq;
+        int32_t unit = -1;           // Slice index, -1 for the codestream header
+        uint16_t unit_packet = 0;    // Packet index within the unit
+        bool unit_last = false;      // Last packet of the unit (L)
+        bool after_gap = false;      // Packets were lost just before this one
         std::vector<uint8_t> payload; 
     };
     
     // Packet pool to avoid allocations
     std::vector<PacketData> packet_pool_;
     size_t pool_used_ = 0;
+    size_t payload_capacity_ = 0; // Sum of pool payload capacities
     
     // Indices to packets in pool for sorting (safe against pool resize)
     std::vector<size_t> pending_packets_;
     
     // Frame buffer for output
     mutable std::vector<uint8_t> frame_buffer_;
+    std::vector<SliceSpan> frame_slices_;
+    bool frame_ready_ = false;
+    uint32_t frame_timestamp_ = 0;
     
     uint16_t expected_sequence_;
     uint32_t current_timestamp_;
     bool frame_started_;
+    bool frame_sliced_ = false;   // Sender uses slice mode; losses damage slices, not the frame
     bool discarding_frame_ = false;
     bool waiting_for_start_ = true;
+    bool marker_deferred_ = false; // Current frame has its marker, assembled after the ready one is taken
     Stats stats_;
+    MemoryAccounting::Tracker memory_{MemoryComponent::DEPACKETIZER};
     
-    void assembleFrame();
+    // false if the frame is unusable (sliced frame whose header was hit)
+    bool assembleFrame(bool complete);
+    void updateMemoryUsage();
 };
 
 } // namespace jpegxs
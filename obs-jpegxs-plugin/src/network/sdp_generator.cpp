@@ -24,7 +24,7 @@ std::string SDPGenerator::generate(const SDPConfig& config) {
     
     // fmtp parameters (RFC 9134)
     ss << "a=fmtp:" << (int)config.payload_type << " ";
-    ss << "packetization-mode=0; "; // Codestream
+    ss << "packetization-mode=" << (int)config.packetization_mode << "; ";
     
     // Profile/Level (Simplification: assumes Main 4:2:0 8-bit or 10-bit based on context)
     // Ideally this should come from the encoder configuration.
@@ -73,7 +73,8 @@ std::string SDPGenerator::generate(const SDPConfig& config) {
         ss << "c=IN IP4 " << config.dest_ip << "\r\n"; // Assume same IP for audio
         ss << "a=rtpmap:" << (int)config.audio_payload_type << " " 
            << audio_fmt << "/" << config.audio_sample_rate << "/" << (int)config.audio_channels << "\r\n";
-        ss << "a=ptime:1\r\n"; // 1ms packet time is standard for ST 2110-30 Class A/B/C
+        // ST 2110-30: 1 ms (Level A/B) or 0.125 ms (Level C)
+        ss << "a=ptime:" << config.audio_packet_time_us / 1000.0 << "\r\n";
         ss << "a=ts-refclk:ptp=IEEE1588-2008:00-00-00-00-00-00-00-00\r\n";
         ss << "a=mediaclk:direct=0\r\n";
     }
@@ -81,12 +82,14 @@ std::string SDPGenerator::generate(const SDPConfig& config) {
     return ss.str();
 }
 
-void SDPGenerator::saveToFile(const std::string& content, const std::string& filepath) {
+bool SDPGenerator::saveToFile(const std::string& content, const std::string& filepath) {
     std::ofstream file(filepath);
-    if (file.is_open()) {
-        file << content;
-        file.close();
+    if (!file.is_open()) {
+        return false;
     }
+    file << content;
+    file.close();
+    return !file.fail();
 }
 
 } // namespace jpegxs
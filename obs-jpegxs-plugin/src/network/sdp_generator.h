@@ -21,7 +21,7 @@ struct SDPConfig {
     
     // JPEG XS specifics
     // profile-level-id? 
-    // packetization-mode?
+    uint8_t packetization_mode = 1; // RFC 9134 K: 0=codestream, 1=slice
     std::string sampling = "YCbCr-4:2:0"; // "YCbCr-4:2:0" or "YCbCr-4:4:4"
     uint8_t depth = 8;
     
@@ -34,12 +34,13 @@ struct SDPConfig {
     uint8_t audio_bit_depth = 16; // 16 or 24
     uint32_t audio_sample_rate = 48000;
     uint8_t audio_payload_type = 97;
+    uint32_t audio_packet_time_us = 1000; // 1000 or 125
 };
 
 class SDPGenerator {
 public:
     static std::string generate(const SDPConfig& config);
-    static void saveToFile(const std::string& content, const std::string& filepath);
+    static bool saveToFile(const std::string& content, const std::string& filepath);
 };
 
 } // namespace jpegxs
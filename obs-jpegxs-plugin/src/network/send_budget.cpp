@@ -0,0 +1,21 @@
+#include "send_budget.h"
+
+namespace jpegxs {
+
+double SendBudget::drainMs(const Backlog& backlog, size_t frame_bytes) {
+    if (backlog.drain_bytes_per_sec <= 0.0) {
+        return 0.0;
+    }
+    return static_cast<double>(backlog.bytes + frame_bytes) * 1000.0 / backlog.drain_bytes_per_sec;
+}
+
+bool SendBudget::admit(const Backlog& backlog, size_t frame_bytes) const {
+    // Data already waiting this long will be late whatever is sent next;
+    // this also catches a stalled client whose rate is not known yet
+    if (backlog.span_ms > budgetMs()) {
+        return false;
+    }
+    return drainMs(backlog, frame_bytes) <= budgetMs();
+}
+
+} // namespace jpegxs
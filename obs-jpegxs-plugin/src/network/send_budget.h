@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace jpegxs {
+
+/**
+ * Whole-frame admission for one client of the SRT fan-out listener.
+ *
+ * In live mode a packet is worth sending only if it reaches the receiver
+ * within the SRT latency; later ones are dropped (TLPKTDROP) and leave a
+ * hole in the frame. The send buffer runs out of time long before it runs
+ * out of bytes, so a frame is admitted only if the client's backlog and the
+ * frame itself drain, at the rate the client is taking data, within a
+ * fraction of the latency. A client over budget skips the whole frame and
+ * its backlog shrinks until the next one fits.
+ */
+class SendBudget {
+public:
+    struct Config {
+        int32_t latency_ms = 20;       // SRTO_LATENCY of the link
+        double budget_ratio = 0.5;     // Of the latency; the rest is left for retransmits
+    };
+
+    // What the client's send buffer holds when the frame is offered
+    struct Backlog {
+        size_t bytes = 0;              // Queued or unacknowledged
+        double span_ms = 0.0;          // Between the oldest and newest of it
+        double drain_bytes_per_sec = 0.0;  // Link rate towards the client; 0 = unknown
+    };
+
+    explicit SendBudget(const Config& config) : config_(config) {}
+
+    // Time the client may take to drain its backlog and the frame
+    double budgetMs() const { return config_.latency_ms * config_.budget_ratio; }
+
+    // When the last byte of a frame of this size would leave, counted from now
+    static double drainMs(const Backlog& backlog, size_t frame_bytes);
+
+    bool admit(const Backlog& backlog, size_t frame_bytes) const;
+
+private:
+    Config config_;
+};
+
+} // namespace jpegxs
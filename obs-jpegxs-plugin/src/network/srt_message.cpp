@@ -0,0 +1,290 @@
+#include "srt_message.h"
+#include <algorithm>
+#include <cstring>
+
+namespace jpegxs {
+
+// Larger declared codestreams are treated as corrupt rather than allocated
+static const size_t MAX_CODESTREAM_SIZE = 256u << 20;
+
+static void put_u16(uint8_t* dst, uint16_t value) {
+    dst[0] = (uint8_t)(value >> 8);
+    dst[1] = (uint8_t)value;
+}
+
+static void put_u32(uint8_t* dst, uint32_t value) {
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)value;
+}
+
+static uint16_t get_u16(const uint8_t* src) {
+    return (uint16_t)((src[0] << 8) | src[1]);
+}
+
+static uint32_t get_u32(const uint8_t* src) {
+    return ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | src[3];
+}
+
+// SRTMessagePacketizer Implementation
+
+SRTMessagePacketizer::SRTMessagePacketizer(size_t message_size)
+    : message_size_(std::max(message_size, SRTMessage::HEADER_SIZE + 1)) {
+    message_.resize(message_size_);
+}
+
+void SRTMessagePacketizer::packetize(const uint8_t* codestream, size_t size, uint32_t timestamp,
+                                     MessageCallback callback) {
+    CodestreamSlices::Layout layout;
+    if (!CodestreamSlices::parseHeader(codestream, size, layout) ||
+        !CodestreamSlices::findSlices(codestream, size, layout, slices_) || slices_.size() > 0xFFFF) {
+        slices_.clear();
+    }
+
+    prefix_.resize(SRTMessage::PREFIX_SIZE + slices_.size() * 4);
+    put_u32(&prefix_[0], timestamp);
+    put_u32(&prefix_[4], (uint32_t)size);
+    put_u16(&prefix_[8], (uint16_t)slices_.size());
+    put_u16(&prefix_[10], 0);
+    for (size_t i = 0; i < slices_.size(); i++) {
+        put_u32(&prefix_[SRTMessage::PREFIX_SIZE + i * 4], (uint32_t)slices_[i].offset);
+    }
+
+    size_t prefix_size = prefix_.size();
+    size_t total = prefix_size + size;
+    size_t payload_max = message_size_ - SRTMessage::HEADER_SIZE;
+    uint8_t* message = message_.data();
+    uint8_t* payload = message + SRTMessage::HEADER_SIZE;
+    size_t next_slice = 0;
+
+    for (size_t pos = 0; pos < total;) {
+        size_t count = std::min(payload_max, total - pos);
+        while (next_slice < slices_.size() && prefix_size + slices_[next_slice].offset <= pos) {
+            next_slice++;
+        }
+
+        message[0] = SRTMessage::VERSION_BITS | (pos + count == total ? SRTMessage::END : 0);
+        message[1] = frame_number_;
+        put_u16(message + 2, next_slice == 0 ? SRTMessage::NO_SLICE : (uint16_t)(next_slice - 1));
+        put_u32(message + 4, (uint32_t)pos);
+
+        // The first message starts with the prefix, and usually the codestream follows in it
+        size_t from_prefix = pos < prefix_size ? std::min(count, prefix_size - pos) : 0;
+        if (from_prefix > 0) {
+            std::memcpy(payload, prefix_.data() + pos, from_prefix);
+        }
+        if (from_prefix < count) {
+            std::memcpy(payload + from_prefix, codestream + (pos + from_prefix - prefix_size), count - from_prefix);
+        }
+
+        callback(message, SRTMessage::HEADER_SIZE + count);
+        pos += count;
+    }
+
+    frame_number_++;
+}
+
+// SRTMessageDepacketizer Implementation
+
+SRTMessageDepacketizer::SRTMessageDepacketizer() {
+    updateMemoryUsage();
+}
+
+bool SRTMessageDepacketizer::processMessage(const uint8_t* data, size_t size) {
+    if (!SRTMessage::isMessage(data, size)) {
+        return false;
+    }
+    stats_.messages_received++;
+
+    uint8_t flags = data[0];
+    uint8_t frame_number = data[1];
+    size_t offset = get_u32(data + 4);
+    const uint8_t* payload = data + SRTMessage::HEADER_SIZE;
+    size_t count = size - SRTMessage::HEADER_SIZE;
+
+    // A new frame number with the previous frame open: its last messages were lost
+    bool completed = false;
+    if (in_frame_ && frame_number != frame_number_) {
+        if (!discarding_) {
+            stats_.gaps++;
+            markLost(expected_, stream_size_ ? stream_size_ : expected_ + 1);
+        }
+        completed = finishFrame();
+    }
+    if (!in_frame_) {
+        startFrame(frame_number);
+    }
+    if (discarding_ || offset < expected_) {
+        return completed;
+    }
+
+    if (offset > expected_) {
+        stats_.gaps++;
+        markLost(expected_, offset);
+        if (discarding_) {
+            return completed;
+        }
+    }
+
+    // Prefix bytes first; the slice count in its fixed part gives its full length
+    size_t pos = offset;
+    size_t end = offset + count;
+    while (pos < end && stream_size_ == 0) {
+        size_t take = std::min(end, prefix_size_) - pos;
+        prefix_.insert(prefix_.end(), payload + (pos - offset), payload + (pos - offset) + take);
+        pos += take;
+        if (prefix_.size() == SRTMessage::PREFIX_SIZE) {
+            prefix_size_ = SRTMessage::PREFIX_SIZE + (size_t)get_u16(&prefix_[8]) * 4;
+        }
+        if (prefix_.size() == prefix_size_ && !parsePrefix()) {
+            dropFrame();
+            return completed;
+        }
+    }
+
+    // Codestream bytes go straight to their place in the frame
+    if (pos < end) {
+        if (end > stream_size_) {
+            dropFrame();
+            return completed;
+        }
+        std::memcpy(frame_.data() + (pos - prefix_size_), payload + (pos - offset), end - pos);
+    }
+    expected_ = end;
+
+    if (flags & SRTMessage::END) {
+        if (expected_ != stream_size_) {
+            dropFrame();  // Inconsistent with the prefix
+        }
+        completed = finishFrame() || completed;
+    }
+    return completed;
+}
+
+void SRTMessageDepacketizer::startFrame(uint8_t frame_number) {
+    in_frame_ = true;
+    discarding_ = false;
+    frame_number_ = frame_number;
+    prefix_.clear();
+    prefix_size_ = SRTMessage::PREFIX_SIZE;
+    stream_size_ = 0;
+    expected_ = 0;
+}
+
+bool SRTMessageDepacketizer::parsePrefix() {
+    timestamp_ = get_u32(&prefix_[0]);
+    size_t size = get_u32(&prefix_[4]);
+    size_t count = get_u16(&prefix_[8]);
+    if (size == 0 || size > MAX_CODESTREAM_SIZE) {
+        return false;
+    }
+
+    slices_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        SliceSpan& slice = slices_[i];
+        slice.index = (uint32_t)i;
+        slice.offset = get_u32(&prefix_[SRTMessage::PREFIX_SIZE + i * 4]);
+        slice.intact = true;
+        if (slice.offset >= size || (i > 0 && slice.offset <= slices_[i - 1].offset)) {
+            return false;
+        }
+        if (i > 0) {
+            slices_[i - 1].size = slice.offset - slices_[i - 1].offset;
+        }
+    }
+    if (count > 0) {
+        slices_.back().size = size - slices_.back().offset;
+    }
+
+    // A recycled buffer is usually big enough already, so nothing is cleared
+    frame_.resize(size);
+    stream_size_ = prefix_size_ + size;
+    return true;
+}
+
+void SRTMessageDepacketizer::markLost(size_t from, size_t to) {
+    // Without the prefix there is no layout; without the header, nothing to decode
+    if (stream_size_ == 0 || from < prefix_size_ || slices_.empty()) {
+        dropFrame();
+        return;
+    }
+    size_t first = from - prefix_size_;
+    size_t last = std::min(to, stream_size_) - prefix_size_;
+    if (first >= last) {
+        return;
+    }
+    if (first < slices_.front().offset) {
+        dropFrame();
+        return;
+    }
+
+    auto it = std::upper_bound(slices_.begin(), slices_.end(), first,
+                               [](size_t value, const SliceSpan& slice) { return value < slice.offset; });
+    for (--it; it != slices_.end() && it->offset < last; ++it) {
+        it->intact = false;
+    }
+}
+
+void SRTMessageDepacketizer::dropFrame() {
+    if (!discarding_) {
+        stats_.frames_dropped++;
+        discarding_ = true;
+    }
+}
+
+bool SRTMessageDepacketizer::finishFrame() {
+    in_frame_ = false;
+    if (discarding_) {
+        return false;
+    }
+
+    uint32_t damaged = 0;
+    for (const SliceSpan& slice : slices_) {
+        if (!slice.intact) damaged++;
+    }
+    if (damaged > 0) {
+        stats_.frames_damaged++;
+        stats_.slices_damaged += damaged;
+    }
+
+    // Not taken yet: the newer frame wins
+    if (frame_ready_) {
+        stats_.frames_dropped++;
+    }
+    ready_.swap(frame_);
+    ready_slices_.swap(slices_);
+    frame_ready_ = true;
+    frame_timestamp_ = timestamp_;
+    stats_.frames_assembled++;
+    updateMemoryUsage();
+    return true;
+}
+
+void SRTMessageDepacketizer::takeFrame(std::vector<uint8_t>& frame, std::vector<SliceSpan>& slices) {
+    frame.swap(ready_);
+    slices.clear();
+    slices.swap(ready_slices_);
+    frame_ready_ = false;
+    updateMemoryUsage();
+}
+
+void SRTMessageDepacketizer::reset() {
+    frame_.clear();
+    slices_.clear();
+    ready_.clear();
+    ready_slices_.clear();
+    in_frame_ = false;
+    discarding_ = false;
+    frame_ready_ = false;
+    frame_timestamp_ = 0;
+    stats_ = Stats();
+    updateMemoryUsage();
+}
+
+void SRTMessageDepacketizer::updateMemoryUsage() {
+    memory_.set(frame_.capacity() + ready_.capacity() + prefix_.capacity() +
+                (slices_.capacity() + ready_slices_.capacity()) * sizeof(SliceSpan));
+}
+
+} // namespace jpegxs
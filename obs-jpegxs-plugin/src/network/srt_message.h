@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "memory_accounting.h"
+#include "codestream_slices.h"
+
+namespace jpegxs {
+
+/**
+ * Native SRT framing of JPEG XS frames.
+ *
+ * SRT live mode already numbers, times and delimits every message, so
+ * instead of RTP + RFC 9134 headers (20 bytes on every ~1350-byte packet)
+ * each message carries an 8-byte header and is filled to the socket's
+ * payload size:
+ *
+ *   flags(1) | frame(1) | slice(2) | offset(4)
+ *
+ *   flags   0x40 | END (0x01 on the frame's last message). The top two bits
+ *           are 01 where RTP's version bits are 10, so a receiver tells the
+ *           two framings apart message by message
+ *   frame   Frame counter, mod 256
+ *   slice   Slice holding the first payload byte; 0xFFFF before the first
+ *   offset  Position of the payload in the frame's message stream
+ *
+ * A frame's message stream is a prefix followed by the codestream:
+ *
+ *   timestamp(4) | size(4) | count(2) | reserved(2) | count x slice offset(4)
+ *
+ * timestamp is the 90 kHz media clock an RTP packet would carry, size the
+ * codestream length and the slice offsets point into the codestream (no
+ * slices for codestreams sent whole, such as striped frames). Messages run
+ * across slice boundaries; the table gives the receiver every boundary
+ * without scanning. All fields are big-endian.
+ */
+struct SRTMessage {
+    static constexpr size_t HEADER_SIZE = 8;
+    static constexpr size_t PREFIX_SIZE = 12;
+    static constexpr uint8_t VERSION_BITS = 0x40;
+    static constexpr uint8_t END = 0x01;
+    static constexpr uint16_t NO_SLICE = 0xFFFF;
+
+    static bool isMessage(const uint8_t* data, size_t size) {
+        return size > HEADER_SIZE && (data[0] & 0xC0) == VERSION_BITS;
+    }
+};
+
+/**
+ * Splits encoded frames into full-size native SRT messages
+ */
+class SRTMessagePacketizer {
+public:
+    // message_size: the socket's SRTO_PAYLOADSIZE
+    explicit SRTMessagePacketizer(size_t message_size);
+
+    using MessageCallback = std::function<void(const uint8_t* data, size_t size)>;
+
+    void packetize(const uint8_t* codestream, size_t size, uint32_t timestamp, MessageCallback callback);
+
+private:
+    size_t message_size_;
+    uint8_t frame_number_ = 0;
+    std::vector<uint8_t> prefix_;
+    std::vector<uint8_t> message_;
+    std::vector<SliceSpan> slices_;
+};
+
+/**
+ * Reassembles native SRT messages into codestreams.
+ *
+ * SRT delivers messages in order and only ever drops them, so every payload
+ * is copied once, straight to its offset in the frame buffer, and a jump in
+ * offsets is a loss. The prefix sizes the buffer and lays out the slices: a
+ * loss damages the slices it overlaps and the frame still goes out, unless
+ * it took the prefix or the codestream header (or the frame has no slices).
+ * The frame buffer is swapped with the caller's, as in RTPDepacketizer.
+ */
+class SRTMessageDepacketizer {
+public:
+    SRTMessageDepacketizer();
+
+    // One message as received; true when a frame is ready
+    bool processMessage(const uint8_t* data, size_t size);
+
+    bool isFrameReady() const { return frame_ready_; }
+    uint32_t getFrameTimestamp() const { return frame_timestamp_; }
+
+    // Swap the assembled frame and its slices (all listed; damaged ones not intact)
+    void takeFrame(std::vector<uint8_t>& frame, std::vector<SliceSpan>& slices);
+
+    void reset();
+
+    struct Stats {
+        uint32_t messages_received = 0;
+        uint32_t gaps = 0;              // Runs of lost messages
+        uint32_t frames_assembled = 0;
+        uint32_t frames_damaged = 0;    // Delivered with slices not intact
+        uint32_t slices_damaged = 0;
+        uint32_t frames_dropped = 0;    // Prefix or codestream header lost
+    };
+
+    const Stats& getStats() const { return stats_; }
+
+    // Bytes held by the frame buffers
+    size_t memoryUsage() const { return memory_.bytes(); }
+
+private:
+    void startFrame(uint8_t frame_number);
+    bool parsePrefix();
+    void markLost(size_t from, size_t to);
+    void dropFrame();
+    bool finishFrame();
+    void updateMemoryUsage();
+
+    // Frame being assembled
+    std::vector<uint8_t> frame_;
+    std::vector<SliceSpan> slices_;
+    std::vector<uint8_t> prefix_;
+    size_t prefix_size_ = SRTMessage::PREFIX_SIZE;  // Whole prefix, once the slice count is in
+    size_t stream_size_ = 0;                        // Prefix and codestream; 0 until the prefix is in
+    size_t expected_ = 0;                           // Next stream offset
+    uint32_t timestamp_ = 0;
+    uint8_t frame_number_ = 0;
+    bool in_frame_ = false;
+    bool discarding_ = false;
+
+    // Frame waiting for takeFrame()
+    std::vector<uint8_t> ready_;
+    std::vector<SliceSpan> ready_slices_;
+    bool frame_ready_ = false;
+    uint32_t frame_timestamp_ = 0;
+
+    Stats stats_;
+    MemoryAccounting::Tracker memory_{MemoryComponent::DEPACKETIZER};
+};
+
+} // namespace jpegxs
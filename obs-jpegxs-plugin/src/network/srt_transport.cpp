@@ -1,12 +1,47 @@
 #include "srt_transport.h"
+#include "send_budget.h"
 #include <srt/srt.h>
 #include <cstring>
 #include <chrono>
+#include <cstdio>
+#include <algorithm>
 
 namespace jpegxs {
 
 constexpr size_t SRT_BUFFER_SIZE = 2048;  // Safer MTU size (Jumbo frames support)
 
+// Fan-out: epoll wait, so stop() is noticed promptly
+constexpr int64_t SERVE_POLL_MS = 100;
+
+// How often a fan-out client's link rate is re-read from libsrt
+constexpr int64_t DRAIN_REFRESH_MS = 250;
+
+// Bonded caller: link health check, and the wait before redialling a lost link
+constexpr int GROUP_POLL_MS = 200;
+constexpr int LINK_RETRY_MS = 1000;
+
+static bool resolveIPv4(const std::string& address, uint16_t port, sockaddr_in& sa) {
+    std::memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    return inet_pton(AF_INET, address.c_str(), &sa.sin_addr) == 1;
+}
+
+static std::string formatAddress(const sockaddr_storage& addr) {
+    char host[INET6_ADDRSTRLEN] = "?";
+    uint16_t port = 0;
+    if (addr.ss_family == AF_INET) {
+        const sockaddr_in* sa = reinterpret_cast<const sockaddr_in*>(&addr);
+        inet_ntop(AF_INET, &sa->sin_addr, host, sizeof(host));
+        port = ntohs(sa->sin_port);
+    } else if (addr.ss_family == AF_INET6) {
+        const sockaddr_in6* sa = reinterpret_cast<const sockaddr_in6*>(&addr);
+        inet_ntop(AF_INET6, &sa->sin6_addr, host, sizeof(host));
+        port = ntohs(sa->sin6_port);
+    }
+    return std::string(host) + ":" + std::to_string(port);
+}
+
 SRTTransport::SRTTransport(const Config& cfg)
     : config_(cfg)
     , connection_socket_(SRT_INVALID_SOCK)
@@ -45,7 +80,22 @@ bool SRTTransport::start() {
     
     running_ = true;
     
-    if (config_.mode == Mode::CALLER) {
+    // libsrt spawns its send/receive queue threads on connect/bind; they
+    // inherit the placement of the thread that creates them
+    ThreadPlacement::ScopedInherit inherit(config_.placement, ThreadRole::NETWORK);
+    
+    if (bonded()) {
+        if (!connectGroup()) {
+            running_ = false;
+            cleanupSRT();
+            return false;
+        }
+        
+        // The receive thread notices the whole group failing; the group
+        // thread redials single links while it stays up
+        recv_thread_ = std::make_unique<std::thread>(&SRTTransport::receiveLoop, this);
+        group_thread_ = std::make_unique<std::thread>(&SRTTransport::groupLoop, this);
+    } else if (config_.mode == Mode::CALLER) {
         // Create socket for caller
         connection_socket_ = srt_create_socket();
         if (connection_socket_ == SRT_INVALID_SOCK) {
@@ -87,8 +137,24 @@ bool SRTTransport::start() {
             return false;
         }
         
-        // Start accept thread
-        accept_thread_ = std::make_unique<std::thread>(&SRTTransport::acceptLoop, this);
+        if (fanOut()) {
+            // Accept and watch clients from one epoll loop; the listener
+            // must not block for that
+            bool blocking = false;
+            srt_setsockopt(listener_socket_, 0, SRTO_RCVSYN, &blocking, sizeof(blocking));
+            epoll_id_ = srt_epoll_create();
+            int events = SRT_EPOLL_IN | SRT_EPOLL_ERR;
+            if (epoll_id_ < 0 || srt_epoll_add_usock(epoll_id_, listener_socket_, &events) != 0) {
+                setError(std::string("Failed to set up SRT epoll: ") + srt_getlasterror_str());
+                running_ = false;
+                cleanupSRT();
+                return false;
+            }
+            serve_thread_ = std::make_unique<std::thread>(&SRTTransport::serveLoop, this);
+        } else {
+            // Start accept thread
+            accept_thread_ = std::make_unique<std::thread>(&SRTTransport::acceptLoop, this);
+        }
     }
     
     return true;
@@ -119,8 +185,28 @@ void SRTTransport::stop() {
         }
     }
     
+    if (serve_thread_ && serve_thread_->joinable()) {
+        serve_thread_->join();
+    }
+    
+    if (group_thread_ && group_thread_->joinable()) {
+        group_thread_->join();
+    }
+    
     recv_thread_.reset();
     accept_thread_.reset();
+    serve_thread_.reset();
+    group_thread_.reset();
+    
+    {
+        std::lock_guard<std::mutex> lock(links_mutex_);
+        links_.clear();
+    }
+    closeClients();
+    if (epoll_id_ >= 0) {
+        srt_epoll_release(epoll_id_);
+        epoll_id_ = -1;
+    }
 }
 
 bool SRTTransport::isConnected() const {
@@ -128,6 +214,10 @@ bool SRTTransport::isConnected() const {
 }
 
 bool SRTTransport::send(const uint8_t* data, size_t size) {
+    if (fanOut()) {
+        return sendToClients(data, size);
+    }
+    
     // Atomic read of connection socket
     SRTSOCKET sock = connection_socket_;
     
@@ -165,6 +255,56 @@ SRTTransport::Stats SRTTransport::getStats() const {
     return stats_;
 }
 
+SRTTransport::Stats SRTTransport::pollStats() {
+    updateStats();
+    return getStats();
+}
+
+bool SRTTransport::setMaxBandwidth(int64_t bytes_per_sec) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_.max_bandwidth = bytes_per_sec;
+        stats_.max_bandwidth = bytes_per_sec;
+    }
+    
+    if (fanOut()) {
+        // Every client, and the listener for clients still to come
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        bool applied = true;
+        for (const Client& client : clients_) {
+            applied &= srt_setsockopt(client.sock, 0, SRTO_MAXBW, &bytes_per_sec, sizeof(bytes_per_sec)) == 0;
+        }
+        if (listener_socket_ != SRT_INVALID_SOCK) {
+            srt_setsockopt(listener_socket_, 0, SRTO_MAXBW, &bytes_per_sec, sizeof(bytes_per_sec));
+        }
+        if (!applied) {
+            setError(std::string("Failed to update SRTO_MAXBW: ") + srt_getlasterror_str());
+        }
+        return applied;
+    }
+    
+    if (bonded()) {
+        // Members that joined before the change keep their own value
+        std::lock_guard<std::mutex> lock(links_mutex_);
+        for (const Link& link : links_) {
+            if (link.sock != SRT_INVALID_SOCK) {
+                srt_setsockopt(link.sock, 0, SRTO_MAXBW, &bytes_per_sec, sizeof(bytes_per_sec));
+            }
+        }
+    }
+    
+    SRTSOCKET sock = connection_socket_;
+    if (sock == SRT_INVALID_SOCK) {
+        return true;  // Picked up by configureSRTSocket on (re)connect
+    }
+    
+    if (srt_setsockopt(sock, 0, SRTO_MAXBW, &bytes_per_sec, sizeof(bytes_per_sec)) != 0) {
+        setError(std::string("Failed to update SRTO_MAXBW: ") + srt_getlasterror_str());
+        return false;
+    }
+    return true;
+}
+
 void SRTTransport::resetStats() {
     std::lock_guard<std::mutex> lock(mutex_);
     stats_ = Stats();
@@ -212,7 +352,7 @@ bool SRTTransport::configureSRTSocket(SRTSOCKET sock) {
     }
 
     // Set payload size to be safe (default is 1316, we need slightly more for our RTP packets ~1300+Header)
-    int payload_size = 1456;
+    int payload_size = static_cast<int>(LIVE_PAYLOAD_SIZE);
     if (srt_setsockopt(sock, 0, SRTO_PAYLOADSIZE, &payload_size, sizeof(payload_size)) != 0) {
         setError("Failed to set SRTO_PAYLOADSIZE");
         return false;
@@ -241,6 +381,7 @@ bool SRTTransport::configureSRTSocket(SRTSOCKET sock) {
         setError("Failed to set SRTO_MAXBW");
         return false;
     }
+    stats_.max_bandwidth = config_.max_bandwidth;
     
     // Set too-late packet drop
     int tlpktdrop = config_.too_late_packet_drop ? 1 : 0;
@@ -300,6 +441,250 @@ bool SRTTransport::connectCaller() {
     return true;
 }
 
+static bool prepareEndpoint(const SRTTransport::GroupLink& link, SRT_SOCKGROUPCONFIG& endpoint) {
+    sockaddr_in peer;
+    sockaddr_in local;
+    const sockaddr* source = nullptr;
+    if (!resolveIPv4(link.address, link.port, peer)) {
+        return false;
+    }
+    if (!link.bind_address.empty()) {
+        if (!resolveIPv4(link.bind_address, 0, local)) {
+            return false;
+        }
+        source = reinterpret_cast<const sockaddr*>(&local);
+    }
+    endpoint = srt_prepare_endpoint(source, reinterpret_cast<const sockaddr*>(&peer), sizeof(peer));
+    endpoint.weight = link.weight;
+    return true;
+}
+
+bool SRTTransport::connectGroup() {
+    std::string invalid;
+    {
+        std::lock_guard<std::mutex> lock(links_mutex_);
+        if (links_.empty()) {
+            for (size_t i = 0; i < config_.links.size(); i++) {
+                Link link;
+                link.config = config_.links[i];
+                if (link.config.weight == 0) {
+                    link.config.weight = static_cast<uint16_t>(config_.links.size() - i);  // First listed is main
+                }
+                link.stats.address = link.config.address + ":" + std::to_string(link.config.port);
+                link.stats.weight = link.config.weight;
+                links_.push_back(link);
+            }
+        }
+        for (Link& link : links_) {
+            link.sock = SRT_INVALID_SOCK;
+            link.up = false;
+            link.stats.connected = false;
+        }
+    }
+    if (config_.links.empty()) {
+        setError("SRT bonding needs at least one link");
+        return false;
+    }
+    
+    // The new group is only published once connected; until then the
+    // receive thread and send() see no socket
+    SRTSOCKET old_group = connection_socket_.exchange(SRT_INVALID_SOCK);
+    if (old_group != SRT_INVALID_SOCK) {
+        srt_close(old_group);
+    }
+    int type = config_.bonding == Bonding::BROADCAST ? SRT_GTYPE_BROADCAST : SRT_GTYPE_BACKUP;
+    SRTSOCKET group = srt_create_group(type);
+    if (group == SRT_INVALID_SOCK) {
+        setError(std::string("Failed to create SRT group (libsrt built without bonding?): ") + srt_getlasterror_str());
+        return false;
+    }
+    
+    // Options set on the group apply to every member
+    if (!configureSRTSocket(group)) {
+        srt_close(group);
+        return false;
+    }
+    if (config_.bonding == Bonding::BACKUP && config_.backup_stability_ms > 0) {
+        if (srt_setsockopt(group, 0, SRTO_GROUPMINSTABLETIMEO,
+                           &config_.backup_stability_ms, sizeof(config_.backup_stability_ms)) != 0) {
+            setError(std::string("Failed to set SRTO_GROUPMINSTABLETIMEO: ") + srt_getlasterror_str());
+        }
+    }
+    
+    std::vector<SRT_SOCKGROUPCONFIG> endpoints;
+    {
+        std::lock_guard<std::mutex> lock(links_mutex_);
+        for (const Link& link : links_) {
+            SRT_SOCKGROUPCONFIG endpoint;
+            if (!prepareEndpoint(link.config, endpoint)) {
+                invalid = link.stats.address + (link.config.bind_address.empty() ? "" : "@" + link.config.bind_address);
+                break;
+            }
+            endpoints.push_back(endpoint);
+        }
+    }
+    if (!invalid.empty()) {
+        setError("Invalid link address: " + invalid);
+        srt_close(group);
+        return false;
+    }
+    
+    // Returns once the first link is up; the others finish in the background
+    int result = srt_connect_group(group, endpoints.data(), static_cast<int>(endpoints.size()));
+    {
+        std::lock_guard<std::mutex> lock(links_mutex_);
+        for (size_t i = 0; i < links_.size(); i++) {
+            links_[i].sock = endpoints[i].errorcode == SRT_SUCCESS ? endpoints[i].id : SRT_INVALID_SOCK;
+            links_[i].retry_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(LINK_RETRY_MS);
+        }
+    }
+    if (result == SRT_ERROR) {
+        setError(std::string("Group connect failed: ") + srt_getlasterror_str());
+        srt_close(group);
+        return false;
+    }
+    
+    connection_socket_ = group;
+    connected_ = true;
+    stats_.connected = true;
+    
+    if (state_callback_) {
+        state_callback_(true, "");
+    }
+    
+    return true;
+}
+
+SRTSOCKET SRTTransport::connectLink(SRTSOCKET group, const GroupLink& link) {
+    SRT_SOCKGROUPCONFIG endpoint;
+    if (!prepareEndpoint(link, endpoint)) {
+        return SRT_INVALID_SOCK;
+    }
+    
+    // Joins the running group; blocks this thread up to the connect timeout
+    if (srt_connect_group(group, &endpoint, 1) == SRT_ERROR) {
+        return SRT_INVALID_SOCK;
+    }
+    return endpoint.id;
+}
+
+void SRTTransport::groupLoop() {
+    if (config_.placement.active()) {
+        ThreadPlacement::apply(config_.placement, ThreadRole::NETWORK, "srt-group");
+    }
+    
+    // Only this thread replaces the group, so connectGroup() never races the redials
+    auto regroup_at = std::chrono::steady_clock::now();
+    while (running_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(GROUP_POLL_MS));
+        
+        // The receive thread reports the whole group down; start a new one
+        // a retry interval after it was last seen up
+        if (!connected_) {
+            if (config_.enable_reconnect && std::chrono::steady_clock::now() >= regroup_at) {
+                connectGroup();
+                regroup_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(LINK_RETRY_MS);
+            }
+            continue;
+        }
+        regroup_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(LINK_RETRY_MS);
+        
+        SRTSOCKET group = connection_socket_;
+        if (group == SRT_INVALID_SOCK) {
+            continue;
+        }
+        
+        std::vector<std::string> events;
+        std::vector<size_t> redial;
+        {
+            std::lock_guard<std::mutex> lock(links_mutex_);
+            auto now = std::chrono::steady_clock::now();
+            std::vector<size_t> changed;
+            size_t up_count = 0;
+            for (size_t i = 0; i < links_.size(); i++) {
+                Link& link = links_[i];
+                SRT_SOCKSTATUS state = link.sock == SRT_INVALID_SOCK ? SRTS_NONEXIST : srt_getsockstate(link.sock);
+                if (state > SRTS_CONNECTED) {
+                    link.sock = SRT_INVALID_SOCK;  // libsrt has dropped it from the group
+                }
+                bool up = state == SRTS_CONNECTED;
+                if (up != link.up) {
+                    link.up = up;
+                    changed.push_back(i);
+                }
+                link.stats.connected = up;
+                up_count += up ? 1 : 0;
+                
+                if (link.sock == SRT_INVALID_SOCK && now >= link.retry_at) {
+                    link.retry_at = now + std::chrono::milliseconds(LINK_RETRY_MS);
+                    redial.push_back(i);
+                }
+            }
+            for (size_t i : changed) {
+                events.push_back("link " + links_[i].stats.address + (links_[i].up ? " up" : " down") + " (" +
+                                 std::to_string(up_count) + " of " + std::to_string(links_.size()) + " up)");
+            }
+        }
+        
+        if (state_callback_) {
+            for (const std::string& event : events) {
+                state_callback_(true, event);
+            }
+        }
+        
+        for (size_t i : redial) {
+            GroupLink link;
+            {
+                std::lock_guard<std::mutex> lock(links_mutex_);
+                link = links_[i].config;
+            }
+            SRTSOCKET sock = connectLink(group, link);
+            if (sock == SRT_INVALID_SOCK) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(links_mutex_);
+            if (connection_socket_ == group) {
+                links_[i].sock = sock;
+                links_[i].stats.reconnects++;
+            }
+        }
+    }
+}
+
+std::vector<SRTTransport::LinkStats> SRTTransport::getLinkStats() {
+    std::vector<LinkStats> result;
+    if (!bonded()) {
+        return result;
+    }
+    
+    std::lock_guard<std::mutex> lock(links_mutex_);
+    std::vector<SRT_SOCKGROUPDATA> members(links_.size());
+    size_t count = members.size();
+    SRTSOCKET group = connection_socket_;
+    int found = group == SRT_INVALID_SOCK ? -1 : srt_group_data(group, members.data(), &count);
+    
+    for (Link& link : links_) {
+        link.stats.active = false;
+        if (link.sock != SRT_INVALID_SOCK) {
+            for (int m = 0; m < found; m++) {
+                if (members[m].id == link.sock) {
+                    link.stats.active = members[m].memberstate == SRT_GST_RUNNING;
+                }
+            }
+            SRT_TRACEBSTATS trace;
+            if (srt_bistats(link.sock, &trace, 0, 1) == 0) {
+                link.stats.packets_sent = trace.pktSentTotal;
+                link.stats.packets_send_lost = trace.pktSndLoss;
+                link.stats.packets_retransmitted = trace.pktRetrans;
+                link.stats.rtt_ms = trace.msRTT;
+                link.stats.send_rate_mbps = trace.mbpsSendRate;
+            }
+        }
+        result.push_back(link.stats);
+    }
+    return result;
+}
+
 bool SRTTransport::startListener() {
     sockaddr_in sa;
     std::memset(&sa, 0, sizeof(sa));
@@ -312,7 +697,16 @@ bool SRTTransport::startListener() {
         return false;
     }
     
-    if (srt_listen(listener_socket_, 1) == SRT_ERROR) {
+    if (config_.accept_groups) {
+        // Bonded callers arrive as one group connection; single callers are
+        // unaffected. Without bonding support in libsrt, serve those only
+        int group_connect = 1;
+        if (srt_setsockopt(listener_socket_, 0, SRTO_GROUPCONNECT, &group_connect, sizeof(group_connect)) != 0) {
+            setError(std::string("Bonded callers not accepted: ") + srt_getlasterror_str());
+        }
+    }
+    
+    if (srt_listen(listener_socket_, std::max(1, config_.max_clients)) == SRT_ERROR) {
         setError(std::string("Listen failed: ") + srt_getlasterror_str());
         return false;
     }
@@ -323,6 +717,10 @@ bool SRTTransport::startListener() {
 void SRTTransport::receiveLoop() {
     uint8_t buffer[SRT_BUFFER_SIZE];
     
+    if (config_.placement.active()) {
+        ThreadPlacement::apply(config_.placement, ThreadRole::NETWORK, "srt-recv");
+    }
+    
     while (running_) {
         try {
             SRTSOCKET sock = connection_socket_;
@@ -347,7 +745,12 @@ void SRTTransport::receiveLoop() {
                             state_callback_(false, last_error_);
                         }
                         
-                        if (config_.mode == Mode::CALLER && config_.enable_reconnect) {
+                        if (bonded()) {
+                            // Every link is down: the group thread starts a new group
+                            while (running_ && connection_socket_ == sock) {
+                                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                            }
+                        } else if (config_.mode == Mode::CALLER && config_.enable_reconnect) {
                             // Reconnect logic for caller
                             srt_close(connection_socket_);
                             connection_socket_ = srt_create_socket();
@@ -403,6 +806,10 @@ void SRTTransport::receiveLoop() {
 }
 
 void SRTTransport::acceptLoop() {
+    if (config_.placement.active()) {
+        ThreadPlacement::apply(config_.placement, ThreadRole::NETWORK, "srt-accept");
+    }
+    
     while (running_) {
         try {
             sockaddr_storage client_addr;
@@ -452,6 +859,15 @@ void SRTTransport::acceptLoop() {
 }
 
 void SRTTransport::updateStats() {
+    if (fanOut()) {
+        // Per-client numbers come from getClientStats()
+        std::lock_guard<std::mutex> clients_lock(clients_mutex_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.clients = static_cast<int32_t>(clients_.size());
+        stats_.connected = !clients_.empty();
+        return;
+    }
+    
     SRTSOCKET sock = connection_socket_;
     if (sock == SRT_INVALID_SOCK || !connected_) {
         return;
@@ -463,10 +879,235 @@ void SRTTransport::updateStats() {
         
         stats_.packets_lost = stats.pktRcvLoss;
         stats_.packets_retransmitted = stats.pktRetrans;
+        stats_.packets_send_lost = stats.pktSndLoss;
+        stats_.packets_send_dropped = stats.pktSndDrop;
         stats_.rtt_ms = stats.msRTT;
         stats_.bandwidth_mbps = stats.mbpsBandwidth;
         stats_.send_buffer_available = stats.byteAvailSndBuf;
         stats_.recv_buffer_available = stats.byteAvailRcvBuf;
+        stats_.send_buffer_bytes = stats.byteSndBuf;
+        stats_.send_buffer_ms = stats.msSndBuf;
+        stats_.send_rate_mbps = stats.mbpsSendRate;
+    }
+}
+
+void SRTTransport::serveLoop() {
+    if (config_.placement.active()) {
+        ThreadPlacement::apply(config_.placement, ThreadRole::NETWORK, "srt-serve");
+    }
+    
+    SRT_EPOLL_EVENT events[16];
+    char discard[SRT_BUFFER_SIZE];
+    
+    while (running_) {
+        int count = srt_epoll_uwait(epoll_id_, events, 16, SERVE_POLL_MS);
+        if (count < 0) {
+            // Listener closed under us (stopping) or epoll gone
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        
+        for (int i = 0; i < count && running_; i++) {
+            SRTSOCKET sock = events[i].fd;
+            if (sock == listener_socket_) {
+                acceptClient();
+                continue;
+            }
+            if (events[i].events & SRT_EPOLL_ERR) {
+                removeClient(sock, "left");
+                continue;
+            }
+            // Callers send nothing in live mode; drain whatever arrives
+            while (srt_recvmsg2(sock, discard, sizeof(discard), nullptr) > 0) {
+            }
+            if (srt_getsockstate(sock) > SRTS_CONNECTED) {
+                removeClient(sock, "left");
+            }
+        }
+    }
+}
+
+void SRTTransport::acceptClient() {
+    sockaddr_storage client_addr;
+    int addr_len = sizeof(client_addr);
+    SRTSOCKET sock = srt_accept(listener_socket_, reinterpret_cast<sockaddr*>(&client_addr), &addr_len);
+    if (sock == SRT_INVALID_SOCK) {
+        return;  // Nothing pending after all
+    }
+    
+    std::string address = formatAddress(client_addr);
+    std::string event;
+    bool accepted = false;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        if (static_cast<int32_t>(clients_.size()) >= config_.max_clients) {
+            srt_close(sock);
+            std::lock_guard<std::mutex> stats_lock(mutex_);
+            stats_.clients_rejected++;
+            event = "refused client " + address + ": " + std::to_string(config_.max_clients) + " clients already";
+        } else {
+            // Options are inherited from the listener; sending must not block
+            bool blocking = false;
+            srt_setsockopt(sock, 0, SRTO_SNDSYN, &blocking, sizeof(blocking));
+            srt_setsockopt(sock, 0, SRTO_RCVSYN, &blocking, sizeof(blocking));
+            int events = SRT_EPOLL_IN | SRT_EPOLL_ERR;
+            srt_epoll_add_usock(epoll_id_, sock, &events);
+            
+            Client client;
+            client.sock = sock;
+            client.address = address;
+            client.connected_at = std::chrono::steady_clock::now();
+            client.stats.address = address;
+            clients_.push_back(client);
+            connected_ = true;
+            accepted = true;
+            event = "client " + address + " (" + std::to_string(clients_.size()) + " of " +
+                    std::to_string(config_.max_clients) + ")";
+        }
+    }
+    
+    if (state_callback_) {
+        state_callback_(accepted, event);
+    }
+}
+
+void SRTTransport::removeClient(SRTSOCKET sock, const std::string& reason) {
+    std::string event;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        auto it = std::find_if(clients_.begin(), clients_.end(), [sock](const Client& c) { return c.sock == sock; });
+        if (it == clients_.end()) {
+            return;
+        }
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - it->connected_at).count();
+        char summary[160];
+        std::snprintf(summary, sizeof(summary), " after %.1f s, %lld frames skipped",
+                      seconds, static_cast<long long>(it->stats.frames_skipped));
+        event = "client " + it->address + " " + reason + summary;
+        
+        srt_epoll_remove_usock(epoll_id_, sock);
+        srt_close(sock);
+        clients_.erase(it);
+        connected_ = !clients_.empty();
+        event += " (" + std::to_string(clients_.size()) + " of " + std::to_string(config_.max_clients) + ")";
+    }
+    
+    if (state_callback_) {
+        state_callback_(false, event);
+    }
+}
+
+void SRTTransport::closeClients() {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    for (const Client& client : clients_) {
+        srt_close(client.sock);
+    }
+    clients_.clear();
+}
+
+void SRTTransport::beginFrame(size_t bytes) {
+    if (!fanOut()) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    int64_t max_bandwidth;
+    {
+        std::lock_guard<std::mutex> stats_lock(mutex_);
+        max_bandwidth = config_.max_bandwidth;
+    }
+    
+    SendBudget::Config budget_config;
+    budget_config.latency_ms = config_.latency_ms;
+    SendBudget budget(budget_config);
+    
+    auto now = std::chrono::steady_clock::now();
+    frames_marked_ = true;
+    for (Client& client : clients_) {
+        // libsrt's estimate of the link, no faster than SRTO_MAXBW lets it send
+        if (now - client.drain_at >= std::chrono::milliseconds(DRAIN_REFRESH_MS)) {
+            SRT_TRACEBSTATS trace;
+            double rate = 0.0;
+            if (srt_bstats(client.sock, &trace, 0) == 0) {
+                rate = trace.mbpsBandwidth * 1000000.0 / 8.0;
+            }
+            if (max_bandwidth > 0 && (rate <= 0.0 || rate > static_cast<double>(max_bandwidth))) {
+                rate = static_cast<double>(max_bandwidth);
+            }
+            client.drain_bytes_per_sec = rate;
+            client.drain_at = now;
+        }
+        
+        // Returns the span of the buffered data in ms, or SRT_ERROR
+        size_t blocks = 0;
+        SendBudget::Backlog backlog;
+        int span_ms = srt_getsndbuffer(client.sock, &blocks, &backlog.bytes);
+        if (span_ms == SRT_ERROR) {
+            client.skipping = false;  // Broken; the serve loop retires it
+            continue;
+        }
+        backlog.span_ms = span_ms;
+        backlog.drain_bytes_per_sec = client.drain_bytes_per_sec;
+        
+        client.skipping = !budget.admit(backlog, bytes) ||
+                          backlog.bytes + bytes > static_cast<size_t>(config_.send_buffer_size);
+        if (client.skipping) {
+            client.stats.frames_skipped++;
+        }
+    }
+}
+
+bool SRTTransport::sendToClients(const uint8_t* data, size_t size) {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    
+    bool delivered = false;
+    for (Client& client : clients_) {
+        if (client.skipping) {
+            client.stats.packets_skipped++;
+            continue;
+        }
+        
+        int sent = srt_sendmsg2(client.sock, reinterpret_cast<const char*>(data), static_cast<int>(size), nullptr);
+        if (sent == SRT_ERROR) {
+            // Buffer full (SRT_EASYNCSND) or broken; a broken client is
+            // retired by the serve loop. Within a frame, skip the rest of it
+            client.stats.packets_skipped++;
+            if (frames_marked_) {
+                client.skipping = true;
+                client.stats.frames_skipped++;
+            }
+            continue;
+        }
+        
+        client.stats.bytes_sent += sent;
+        client.stats.packets_sent++;
+        stats_.bytes_sent += sent;
+        stats_.packets_sent++;
+        delivered = true;
+    }
+    return delivered;
+}
+
+std::vector<SRTTransport::ClientStats> SRTTransport::getClientStats() {
+    std::vector<ClientStats> result;
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    auto now = std::chrono::steady_clock::now();
+    for (Client& client : clients_) {
+        fillClientStats(client.sock, client.stats);
+        client.stats.connected_s = std::chrono::duration<double>(now - client.connected_at).count();
+        result.push_back(client.stats);
+    }
+    return result;
+}
+
+void SRTTransport::fillClientStats(SRTSOCKET sock, ClientStats& stats) {
+    SRT_TRACEBSTATS trace;
+    if (srt_bistats(sock, &trace, 0, 1) == 0) {
+        stats.packets_retransmitted = trace.pktRetrans;
+        stats.packets_send_dropped = trace.pktSndDrop;
+        stats.rtt_ms = trace.msRTT;
+        stats.send_buffer_ms = trace.msSndBuf;
     }
 }
 
@@ -4,8 +4,12 @@
 #include <functional>
 #include <memory>
 #include <atomic>
+#include <chrono>
 #include <thread>
 #include <mutex>
+#include <vector>
+
+#include "thread_placement.h"
 
 // Forward declare SRT socket type
 typedef int SRTSOCKET;
@@ -14,14 +18,51 @@ namespace jpegxs {
 
 /**
  * SRT Transport wrapper for low-latency streaming
+ *
+ * A listener with max_clients set fans one stream out to several callers:
+ * an srt_epoll loop accepts and retires clients, and send() hands each
+ * packet to every client without blocking. A client that could not drain
+ * its backlog and the next frame within half the latency (SendBudget) skips
+ * that whole frame, as does one that refuses a packet mid-frame, so a slow
+ * viewer loses whole frames on its own link instead of late packets, and
+ * never holds up the encoder or the other viewers. Joins,
+ * leaves and refusals reach the state callback (connected = a join).
+ *
+ * A caller with bonding set connects an SRT socket group over every listed
+ * link (libsrt built with ENABLE_BONDING). BROADCAST sends each packet on
+ * all links and the receiver keeps the first copy, so a loss or outage on
+ * one link costs nothing and needs no retransmit inside the latency budget.
+ * BACKUP sends on the highest-weight healthy link and switches to a standby
+ * as soon as the active one stops acknowledging. A maintenance thread
+ * reconnects links that drop while the group stays up and starts a new
+ * group once every link is down; link losses and recoveries reach the
+ * state callback (connected = true, the group is up).
+ * A listener with accept_groups takes bonded callers as one connection.
  */
 class SRTTransport {
 public:
+    // SRTO_PAYLOADSIZE: the largest live-mode message, and the size native framing fills
+    static constexpr size_t LIVE_PAYLOAD_SIZE = 1456;
+    
     enum class Mode {
         CALLER,    // Client mode (connects to server)
         LISTENER   // Server mode (listens for connections)
     };
     
+    enum class Bonding {
+        NONE,
+        BROADCAST, // Every packet on every link
+        BACKUP     // Main link with standbys
+    };
+    
+    // One link of a bonded caller
+    struct GroupLink {
+        std::string address;
+        uint16_t port = 9000;
+        std::string bind_address;          // Local interface (e.g. the second ISP's); empty = any
+        uint16_t weight = 0;               // BACKUP priority; 0 = by list order, first is main
+    };
+    
     struct Config {
         Mode mode = Mode::CALLER;
         std::string address = "127.0.0.1";
@@ -43,6 +84,20 @@ public:
         // Connection
         int32_t connect_timeout_ms = 3000;
         bool enable_reconnect = true;
+        
+        // Listener: 0 = one peer, replaced by each new caller; N = fan out
+        // send() to up to N callers, refusing more
+        int32_t max_clients = 0;
+        
+        // Caller: bond these links (address/port unused); listener: accept
+        // bonded callers as well as single ones (SRTO_GROUPCONNECT)
+        Bonding bonding = Bonding::NONE;
+        std::vector<GroupLink> links;
+        int32_t backup_stability_ms = 0;   // BACKUP: silence before a switch (SRTO_GROUPMINSTABLETIMEO, 0 = libsrt default)
+        bool accept_groups = false;
+        
+        // CPU/NUMA placement for libsrt's internal threads and our receive loop
+        PlacementPlan placement;
     };
     
     struct Stats {
@@ -53,15 +108,53 @@ public:
         int64_t packets_received = 0;
         int64_t packets_lost = 0;
         int64_t packets_retransmitted = 0;
+        int64_t packets_send_lost = 0;       // Reported lost by the receiver (NAK)
+        int64_t packets_send_dropped = 0;    // Dropped by the sender (too late)
         
         // Timing stats
         double rtt_ms = 0.0;
         double bandwidth_mbps = 0.0;
         int32_t send_buffer_available = 0;
         int32_t recv_buffer_available = 0;
+        int32_t send_buffer_bytes = 0;       // Unacknowledged bytes in flight
+        double send_buffer_ms = 0.0;         // Timespan of data in the send buffer
+        double send_rate_mbps = 0.0;
+        int64_t max_bandwidth = 0;           // Current SRTO_MAXBW (bytes/sec)
         
         // Connection state
         bool connected = false;
+        
+        // Fan-out listener
+        int32_t clients = 0;
+        int64_t clients_rejected = 0;        // Refused at max_clients
+    };
+    
+    // One fan-out client (listener with max_clients)
+    struct ClientStats {
+        std::string address;                 // host:port of the caller
+        double connected_s = 0.0;
+        int64_t bytes_sent = 0;
+        int64_t packets_sent = 0;
+        int64_t packets_skipped = 0;         // Not queued: frame skipped or send buffer full
+        int64_t frames_skipped = 0;          // Frames missed in whole or part
+        int64_t packets_retransmitted = 0;
+        int64_t packets_send_dropped = 0;    // Dropped by libsrt (too late)
+        double rtt_ms = 0.0;
+        double send_buffer_ms = 0.0;
+    };
+    
+    // One link of a bonded caller
+    struct LinkStats {
+        std::string address;                 // host:port as configured
+        bool connected = false;
+        bool active = false;                 // Carrying data (BACKUP: the main link)
+        uint16_t weight = 0;
+        int64_t reconnects = 0;
+        int64_t packets_sent = 0;
+        int64_t packets_send_lost = 0;       // Reported lost by the receiver (NAK)
+        int64_t packets_retransmitted = 0;
+        double rtt_ms = 0.0;
+        double send_rate_mbps = 0.0;
     };
     
     using DataCallback = std::function<void(const uint8_t* data, size_t size)>;
@@ -81,20 +174,30 @@ public:
     // Data transmission
     bool send(const uint8_t* data, size_t size);
     
+    // Fan-out: the packets up to the next call make one frame of this many
+    // bytes. Clients that could not send all of it in time skip the frame
+    void beginFrame(size_t bytes);
+    
     // Callbacks
     void setDataCallback(DataCallback callback);
     void setStateCallback(StateCallback callback);
     
     // Statistics
     Stats getStats() const;
+    Stats pollStats();  // Refresh from libsrt, then return (for sender-side control loops)
     void resetStats();
+    std::vector<ClientStats> getClientStats();  // Fan-out clients, refreshed from libsrt
+    std::vector<LinkStats> getLinkStats();      // Bonded caller links, refreshed from libsrt
+    
+    // Runtime tuning (applied to the live connection and any future reconnects)
+    bool setMaxBandwidth(int64_t bytes_per_sec);
     
     // Error handling
     std::string getLastError() const;
     
 private:
     Config config_;
-    SRTSOCKET connection_socket_; // Active data connection
+    std::atomic<SRTSOCKET> connection_socket_; // Active data connection (bonded: replaced by the group thread)
     SRTSOCKET listener_socket_;   // For listener mode (server)
     std::atomic<bool> running_;
     std::atomic<bool> connected_;
@@ -102,6 +205,34 @@ private:
     std::unique_ptr<std::thread> recv_thread_;
     std::unique_ptr<std::thread> accept_thread_;
     
+    // Fan-out listener
+    struct Client {
+        SRTSOCKET sock;
+        std::string address;
+        std::chrono::steady_clock::time_point connected_at;
+        bool skipping = false;               // Rest of the current frame
+        double drain_bytes_per_sec = 0.0;    // Link estimate, refreshed by beginFrame()
+        std::chrono::steady_clock::time_point drain_at;
+        ClientStats stats;
+    };
+    std::vector<Client> clients_;            // Guarded by clients_mutex_
+    std::mutex clients_mutex_;
+    int epoll_id_ = -1;
+    bool frames_marked_ = false;             // beginFrame() in use
+    std::unique_ptr<std::thread> serve_thread_;
+    
+    // Bonded caller
+    struct Link {
+        GroupLink config;
+        SRTSOCKET sock;                      // Member socket; SRT_INVALID_SOCK while down
+        bool up = false;
+        std::chrono::steady_clock::time_point retry_at;
+        LinkStats stats;
+    };
+    std::vector<Link> links_;                // Guarded by links_mutex_
+    std::mutex links_mutex_;
+    std::unique_ptr<std::thread> group_thread_;
+    
     DataCallback data_callback_;
     StateCallback state_callback_;
     
@@ -114,9 +245,20 @@ private:
     void cleanupSRT();
     bool configureSRTSocket(SRTSOCKET sock);
     bool connectCaller();
+    bool bonded() const { return config_.mode == Mode::CALLER && config_.bonding != Bonding::NONE; }
+    bool connectGroup();
+    SRTSOCKET connectLink(SRTSOCKET group, const GroupLink& link);
+    void groupLoop();
     bool startListener();
     void receiveLoop();
     void acceptLoop();
+    bool fanOut() const { return config_.mode == Mode::LISTENER && config_.max_clients > 0; }
+    void serveLoop();
+    void acceptClient();
+    void removeClient(SRTSOCKET sock, const std::string& reason);
+    void closeClients();
+    bool sendToClients(const uint8_t* data, size_t size);
+    static void fillClientStats(SRTSOCKET sock, ClientStats& stats);
     void updateStats();
     void setError(const std::string& error);
     
@@ -0,0 +1,72 @@
+#include "stripe_framing.h"
+#include <cstring>
+
+namespace jpegxs {
+
+static const uint8_t STRIPE_MAGIC[4] = { 'J', 'X', 'S', 'T' };
+static const size_t FIXED_HEADER_SIZE = 16;
+static const size_t STRIPE_ENTRY_SIZE = 12;
+
+static void put_u32(uint8_t* dst, uint32_t value) {
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)value;
+}
+
+static uint32_t get_u32(const uint8_t* src) {
+    return ((uint32_t)src[0] << 24) | ((uint32_t)src[1] << 16) | ((uint32_t)src[2] << 8) | src[3];
+}
+
+bool StripeFraming::isStriped(const uint8_t* data, size_t size) {
+    return size >= FIXED_HEADER_SIZE && std::memcmp(data, STRIPE_MAGIC, sizeof(STRIPE_MAGIC)) == 0;
+}
+
+void StripeFraming::writeHeader(uint8_t* dst, uint32_t width, uint32_t height, const std::vector<Stripe>& stripes) {
+    std::memcpy(dst, STRIPE_MAGIC, sizeof(STRIPE_MAGIC));
+    dst[4] = VERSION;
+    dst[5] = (uint8_t)stripes.size();
+    dst[6] = 0;
+    dst[7] = 0;
+    put_u32(dst + 8, width);
+    put_u32(dst + 12, height);
+
+    uint8_t* entry = dst + FIXED_HEADER_SIZE;
+    for (const Stripe& stripe : stripes) {
+        put_u32(entry, stripe.first_row);
+        put_u32(entry + 4, stripe.rows);
+        put_u32(entry + 8, (uint32_t)stripe.size);
+        entry += STRIPE_ENTRY_SIZE;
+    }
+}
+
+bool StripeFraming::parse(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height, std::vector<Stripe>& stripes) {
+    if (!isStriped(data, size) || data[4] != VERSION) return false;
+
+    size_t count = data[5];
+    if (count == 0 || count > MAX_STRIPES || size < headerSize(count)) return false;
+
+    width = get_u32(data + 8);
+    height = get_u32(data + 12);
+
+    stripes.resize(count);
+    const uint8_t* entry = data + FIXED_HEADER_SIZE;
+    size_t offset = headerSize(count);
+    uint32_t next_row = 0;
+
+    for (Stripe& stripe : stripes) {
+        stripe.first_row = get_u32(entry);
+        stripe.rows = get_u32(entry + 4);
+        stripe.size = get_u32(entry + 8);
+        entry += STRIPE_ENTRY_SIZE;
+
+        // Stripes must tile the frame top to bottom without gaps
+        if (stripe.first_row != next_row || stripe.rows == 0 || stripe.size > size - offset) return false;
+        stripe.data = data + offset;
+        offset += stripe.size;
+        next_row += stripe.rows;
+    }
+    return next_row == height;
+}
+
+} // namespace jpegxs
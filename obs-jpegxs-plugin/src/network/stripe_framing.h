@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace jpegxs {
+
+/**
+ * Framing for stripe-parallel encoding.
+ *
+ * A striped frame is one RTP/SRT payload carrying N independent JPEG XS
+ * codestreams, each covering a band of full-width rows:
+ *
+ *   "JXST" | version(1) | count(1) | reserved(2) | width(4) | height(4)
+ *   count x { first_row(4) | rows(4) | size(4) }
+ *   codestream 0 | codestream 1 | ...
+ *
+ * All fields are big-endian. A plain codestream starts with the SOC marker
+ * (0xFF10), so the two cannot be confused and unstriped senders stay compatible.
+ */
+class StripeFraming {
+public:
+    struct Stripe {
+        uint32_t first_row = 0;
+        uint32_t rows = 0;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+    };
+
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t MAX_STRIPES = 16;
+
+    static bool isStriped(const uint8_t* data, size_t size);
+    static constexpr size_t headerSize(size_t stripe_count) { return 16 + stripe_count * 12; }
+
+    // Writes headerSize(stripes.size()) bytes (data pointers are not used)
+    static void writeHeader(uint8_t* dst, uint32_t width, uint32_t height, const std::vector<Stripe>& stripes);
+
+    // Stripe data pointers refer into `data`; false if truncated or inconsistent
+    static bool parse(const uint8_t* data, size_t size, uint32_t& width, uint32_t& height, std::vector<Stripe>& stripes);
+};
+
+} // namespace jpegxs
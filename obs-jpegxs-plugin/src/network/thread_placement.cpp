@@ -0,0 +1,595 @@
+#include "thread_placement.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #include <windows.h>
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+    #include <ifaddrs.h>
+    #include <cerrno>
+#endif
+
+#ifdef __linux__
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+#endif
+
+#ifdef __APPLE__
+    #include <pthread/qos.h>
+#endif
+
+namespace jpegxs {
+
+#ifdef __linux__
+// <numaif.h> lives in libnuma-dev; the two syscalls are all we need
+static const int MPOL_DEFAULT_MODE = 0;
+static const int MPOL_PREFERRED_MODE = 1;
+static const unsigned long MAX_NUMA_NODES = 1024;
+using NodeMask = unsigned long[MAX_NUMA_NODES / (8 * sizeof(unsigned long))];
+
+static long set_mempolicy_sys(int mode, const unsigned long* mask, unsigned long maxnode) {
+    return syscall(SYS_set_mempolicy, mode, mask, maxnode);
+}
+
+static long get_mempolicy_sys(int* mode, unsigned long* mask, unsigned long maxnode) {
+    return syscall(SYS_get_mempolicy, mode, mask, maxnode, nullptr, 0UL);
+}
+
+static long current_tid() {
+    return syscall(SYS_gettid);
+}
+#endif
+
+// SCHED_FIFO priorities, for the roles that wake briefly to meet a
+// deadline (the pacer's is tightest). They stay below the default
+// threaded-IRQ priority (50) so NIC interrupts are still serviced ahead of
+// us. Encode, decode and codec threads are busy for most of every frame:
+// under SCHED_FIFO they would keep ksoftirqd and kworkers off their CPUs
+// for that long, so they get a nice value instead (0 here).
+static int realtime_priority(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::PACER:   return 49;
+        case ThreadRole::NETWORK: return 48;
+        case ThreadRole::AUDIO:   return 48;
+        default:                  return 0;
+    }
+}
+
+static const int ELEVATED_NICE = -10;
+
+// ---------------------------------------------------------------------------
+// CpuSet / PlacementPlan
+
+std::string CpuSet::toString() const {
+    std::string out;
+    size_t i = 0;
+    while (i < cpus.size()) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) j++;
+        if (!out.empty()) out += ",";
+        out += std::to_string(cpus[i]);
+        if (j > i) out += "-" + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return out;
+}
+
+CpuSet CpuSet::parse(const std::string& list) {
+    CpuSet set;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(std::remove_if(item.begin(), item.end(), ::isspace), item.end());
+        if (item.empty()) continue;
+
+        char* end = nullptr;
+        long first = strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (end == item.c_str() || first < 0) continue;
+        if (*end == '-') {
+            const char* second = end + 1;
+            last = strtol(second, &end, 10);
+            if (end == second) continue;
+        }
+        if (*end != '\0' || last < first || last >= 4096) continue;
+
+        for (long cpu = first; cpu <= last; cpu++) {
+            set.cpus.push_back((int)cpu);
+        }
+    }
+    std::sort(set.cpus.begin(), set.cpus.end());
+    set.cpus.erase(std::unique(set.cpus.begin(), set.cpus.end()), set.cpus.end());
+    return set;
+}
+
+bool PlacementPlan::active() const {
+    if (numa_node >= 0 || realtime) return true;
+    for (const CpuSet& set : cpus) {
+        if (!set.empty()) return true;
+    }
+    return false;
+}
+
+// Explicit role list, else the NUMA node's CPUs, else unpinned
+static CpuSet effective_cpus(const PlacementPlan& plan, ThreadRole role) {
+    const CpuSet& explicit_set = plan.cpusFor(role);
+    if (!explicit_set.empty()) return explicit_set;
+    if (plan.numa_node >= 0) return ThreadPlacement::numaNodeCpus(plan.numa_node);
+    return CpuSet();
+}
+
+// ---------------------------------------------------------------------------
+// Thread registry (for snapshot())
+
+namespace {
+
+struct Entry {
+    std::string name;
+    ThreadRole role;
+    std::string cpus;
+    bool realtime = false;
+#ifdef _WIN32
+    HANDLE handle = nullptr;
+#endif
+    // Previous sample, for deltas
+    double prev_cpu_ms = 0.0;
+    uint64_t prev_migrations = 0;
+    uint64_t prev_switches = 0;
+    std::chrono::steady_clock::time_point prev_time;
+};
+
+std::mutex registry_mutex;
+std::map<long, Entry> registry;
+
+long thread_key() {
+#ifdef _WIN32
+    return (long)GetCurrentThreadId();
+#elif defined(__linux__)
+    return current_tid();
+#else
+    return (long)(uintptr_t)pthread_self();
+#endif
+}
+
+// Removes the thread from the registry when it exits
+struct Registration {
+    long key = 0;
+    ~Registration() {
+        if (key == 0) return;
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto it = registry.find(key);
+        if (it != registry.end()) {
+#ifdef _WIN32
+            if (it->second.handle) CloseHandle(it->second.handle);
+#endif
+            registry.erase(it);
+        }
+    }
+};
+
+thread_local Registration registration;
+
+void register_thread(const char* name, ThreadRole role, const CpuSet& cpus, bool realtime) {
+    long key = thread_key();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    Entry& entry = registry[key];
+    entry.name = name ? name : ThreadPlacement::roleName(role);
+    entry.role = role;
+    entry.cpus = cpus.toString();
+    entry.realtime = realtime;
+    entry.prev_time = std::chrono::steady_clock::now();
+#ifdef _WIN32
+    if (!entry.handle) {
+        DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(),
+                        &entry.handle, THREAD_QUERY_LIMITED_INFORMATION, FALSE, 0);
+    }
+#endif
+    registration.key = key;
+}
+
+#ifdef __linux__
+struct LinuxSample {
+    double cpu_ms = 0.0;
+    int last_cpu = -1;
+    uint64_t migrations = 0;
+    uint64_t involuntary_switches = 0;
+};
+
+bool read_linux_sample(long tid, LinuxSample& sample) {
+    std::string base = "/proc/self/task/" + std::to_string(tid);
+
+    std::ifstream stat_file(base + "/stat");
+    std::string stat;
+    if (!std::getline(stat_file, stat)) return false;
+
+    // comm (field 2) may contain spaces; fields resume after the last ')'
+    size_t close = stat.rfind(')');
+    if (close == std::string::npos) return false;
+    std::istringstream fields(stat.substr(close + 2));
+    std::vector<std::string> values;
+    std::string value;
+    while (fields >> value) values.push_back(value);
+
+    // values[0] is field 3 (state): utime=14, stime=15, processor=39
+    if (values.size() < 37) return false;
+    double ticks_per_ms = sysconf(_SC_CLK_TCK) / 1000.0;
+    uint64_t utime = strtoull(values[11].c_str(), nullptr, 10);
+    uint64_t stime = strtoull(values[12].c_str(), nullptr, 10);
+    sample.cpu_ms = (utime + stime) / ticks_per_ms;
+    sample.last_cpu = atoi(values[36].c_str());
+
+    // Migration and switch counters (present with CONFIG_SCHED_DEBUG)
+    std::ifstream sched_file(base + "/sched");
+    std::string line;
+    while (std::getline(sched_file, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        uint64_t count = strtoull(line.c_str() + colon + 1, nullptr, 10);
+        if (line.compare(0, 16, "se.nr_migrations") == 0) {
+            sample.migrations = count;
+        } else if (line.compare(0, 23, "nr_involuntary_switches") == 0) {
+            sample.involuntary_switches = count;
+        }
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Apply
+
+#ifdef __linux__
+static bool set_affinity(const CpuSet& cpus) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu : cpus.cpus) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &mask);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+}
+
+static bool prefer_node(int node) {
+    if (node < 0 || (unsigned long)node >= MAX_NUMA_NODES) return false;
+    NodeMask mask = {};
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    return set_mempolicy_sys(MPOL_PREFERRED_MODE, mask, MAX_NUMA_NODES + 1) == 0;
+}
+
+static bool set_realtime(ThreadRole role) {
+    if (realtime_priority(role) <= 0) return false;
+    sched_param param = {};
+    param.sched_priority = realtime_priority(role);
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+// Per thread on Linux; needs CAP_SYS_NICE or an RLIMIT_NICE that allows it
+static bool set_nice(int nice) {
+    return setpriority(PRIO_PROCESS, (id_t)current_tid(), nice) == 0;
+}
+#endif
+
+bool ThreadPlacement::apply(const PlacementPlan& plan, ThreadRole role, const char* name, std::string* error) {
+    CpuSet cpus = effective_cpus(plan, role);
+    std::string problems;
+    bool realtime = false;
+
+    auto note = [&](const std::string& problem) {
+        if (!problems.empty()) problems += "; ";
+        problems += problem;
+    };
+
+#if defined(__linux__)
+    if (name) {
+        // Thread names are limited to 15 characters + NUL
+        char short_name[16];
+        snprintf(short_name, sizeof(short_name), "%s", name);
+        pthread_setname_np(pthread_self(), short_name);
+    }
+    if (!cpus.empty() && !set_affinity(cpus)) {
+        note("affinity " + cpus.toString() + " rejected");
+    }
+    if (plan.numa_node >= 0 && !prefer_node(plan.numa_node)) {
+        note("set_mempolicy(node " + std::to_string(plan.numa_node) + ") failed");
+    }
+    if (plan.realtime) {
+        bool fifo_role = realtime_priority(role) > 0;
+        realtime = set_realtime(role);
+        if (!realtime) {
+            // Bulk roles, or no CAP_SYS_NICE / RLIMIT_RTPRIO: a negative nice
+            // value, which needs CAP_SYS_NICE too unless RLIMIT_NICE allows it
+            bool niced = set_nice(ELEVATED_NICE);
+            if (fifo_role) {
+                note(niced ? "SCHED_FIFO not permitted, using nice -10"
+                           : "SCHED_FIFO and nice -10 not permitted (no CAP_SYS_NICE or rtprio/nice limit), normal priority");
+            } else if (!niced) {
+                note("nice -10 not permitted (no CAP_SYS_NICE or nice limit), normal priority");
+            }
+        }
+    }
+#elif defined(_WIN32)
+    if (!cpus.empty()) {
+        DWORD_PTR mask = 0;
+        for (int cpu : cpus.cpus) {
+            if (cpu < 64) mask |= (DWORD_PTR)1 << cpu;
+        }
+        if (!mask || !SetThreadAffinityMask(GetCurrentThread(), mask)) {
+            note("affinity " + cpus.toString() + " rejected");
+        }
+    }
+    if (plan.numa_node >= 0) {
+        // Windows allocates from the node of the first-touching thread's CPU
+        // by default, so pinning is what keeps buffers local.
+        if (cpus.empty()) note("NUMA node without CPUs has no effect on Windows");
+    }
+    if (plan.realtime) {
+        int priority = (role == ThreadRole::PACER) ? THREAD_PRIORITY_TIME_CRITICAL :
+                       (role == ThreadRole::CODEC) ? THREAD_PRIORITY_ABOVE_NORMAL :
+                                                     THREAD_PRIORITY_HIGHEST;
+        realtime = SetThreadPriority(GetCurrentThread(), priority) != 0;
+        if (!realtime) note("SetThreadPriority failed");
+    }
+#elif defined(__APPLE__)
+    if (name) pthread_setname_np(name);
+    if (!cpus.empty()) note("CPU affinity is not supported on macOS");
+    if (plan.realtime) {
+        realtime = pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+        if (!realtime) note("QoS class not applied");
+    }
+#else
+    if (!cpus.empty() || plan.realtime) note("thread placement not supported on this platform");
+#endif
+
+    register_thread(name, role, cpus, realtime);
+
+    if (error) *error = problems;
+    return problems.empty();
+}
+
+// ---------------------------------------------------------------------------
+// ScopedInherit
+
+namespace {
+struct SavedState {
+#ifdef __linux__
+    cpu_set_t affinity;
+    int policy;
+    sched_param param;
+    int nice;
+    int mem_mode;
+    unsigned long mem_mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))];
+#elif defined(_WIN32)
+    DWORD_PTR affinity;
+    int priority;
+#else
+    int unused;
+#endif
+};
+} // namespace
+
+ThreadPlacement::ScopedInherit::ScopedInherit(const PlacementPlan& plan, ThreadRole role) {
+    if (!plan.active()) return;
+
+    saved_.resize(sizeof(SavedState));
+    SavedState* state = reinterpret_cast<SavedState*>(saved_.data());
+
+#ifdef __linux__
+    // Threads created by pthread_create inherit affinity, scheduling policy
+    // (glibc default PTHREAD_INHERIT_SCHED) and memory policy from the creator.
+    pthread_getaffinity_np(pthread_self(), sizeof(state->affinity), &state->affinity);
+    pthread_getschedparam(pthread_self(), &state->policy, &state->param);
+    errno = 0;
+    state->nice = getpriority(PRIO_PROCESS, (id_t)current_tid());
+    if (errno != 0) state->nice = 0;
+    if (get_mempolicy_sys(&state->mem_mode, state->mem_mask, MAX_NUMA_NODES + 1) != 0) {
+        state->mem_mode = -1;
+    }
+
+    CpuSet cpus = effective_cpus(plan, role);
+    if (!cpus.empty()) set_affinity(cpus);
+    if (plan.numa_node >= 0) prefer_node(plan.numa_node);
+    if (plan.realtime && !set_realtime(role)) set_nice(ELEVATED_NICE);
+    applied_ = true;
+#elif defined(_WIN32)
+    // Windows threads start with the process affinity, so only priority is
+    // inherited in practice; affinity is applied for code running in scope.
+    state->priority = GetThreadPriority(GetCurrentThread());
+    state->affinity = 0;
+    CpuSet cpus = effective_cpus(plan, role);
+    if (!cpus.empty()) {
+        DWORD_PTR mask = 0;
+        for (int cpu : cpus.cpus) {
+            if (cpu < 64) mask |= (DWORD_PTR)1 << cpu;
+        }
+        if (mask) state->affinity = SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
+    applied_ = true;
+#else
+    (void)state;
+    (void)role;
+#endif
+}
+
+ThreadPlacement::ScopedInherit::~ScopedInherit() {
+    if (!applied_) return;
+    SavedState* state = reinterpret_cast<SavedState*>(saved_.data());
+
+#ifdef __linux__
+    pthread_setaffinity_np(pthread_self(), sizeof(state->affinity), &state->affinity);
+    pthread_setschedparam(pthread_self(), state->policy, &state->param);
+    set_nice(state->nice);
+    if (state->mem_mode == MPOL_DEFAULT_MODE) {
+        set_mempolicy_sys(MPOL_DEFAULT_MODE, nullptr, 0);
+    } else if (state->mem_mode > 0) {
+        set_mempolicy_sys(state->mem_mode, state->mem_mask, MAX_NUMA_NODES + 1);
+    }
+#elif defined(_WIN32)
+    if (state->affinity) SetThreadAffinityMask(GetCurrentThread(), state->affinity);
+    SetThreadPriority(GetCurrentThread(), state->priority);
+#else
+    (void)state;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// NUMA topology
+
+CpuSet ThreadPlacement::numaNodeCpus(int node) {
+#ifdef __linux__
+    if (node < 0) return CpuSet();
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (std::getline(file, list)) return CpuSet::parse(list);
+#else
+    (void)node;
+#endif
+    return CpuSet();
+}
+
+int ThreadPlacement::numaNodeForInterface(const std::string& local_ip) {
+#ifdef __linux__
+    if (local_ip.empty() || local_ip == "0.0.0.0") return -1;
+
+    in_addr target = {};
+    if (inet_pton(AF_INET, local_ip.c_str(), &target) != 1) return -1;
+
+    ifaddrs* addrs = nullptr;
+    if (getifaddrs(&addrs) != 0) return -1;
+
+    std::string ifname;
+    for (ifaddrs* ifa = addrs; ifa; ifa = ifa->ifa_next) {
+        if (!ifa->ifa_addr || ifa->ifa_addr->sa_family != AF_INET) continue;
+        const sockaddr_in* addr = reinterpret_cast<const sockaddr_in*>(ifa->ifa_addr);
+        if (addr->sin_addr.s_addr == target.s_addr) {
+            ifname = ifa->ifa_name;
+            break;
+        }
+    }
+    freeifaddrs(addrs);
+    if (ifname.empty()) return -1;
+
+    // Virtual interfaces (lo, bridges) have no device link and report no node
+    std::ifstream file("/sys/class/net/" + ifname + "/device/numa_node");
+    int node = -1;
+    if (!(file >> node)) return -1;
+    return node;
+#else
+    (void)local_ip;
+    return -1;
+#endif
+}
+
+std::string ThreadPlacement::localAddressFor(const std::string& remote_ip) {
+    sockaddr_in remote = {};
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(9);
+    if (inet_pton(AF_INET, remote_ip.c_str(), &remote.sin_addr) != 1) return "";
+
+    // Connecting a UDP socket only consults the routing table; nothing is sent
+#ifdef _WIN32
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET) return "";
+#else
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) return "";
+#endif
+
+    std::string result;
+    sockaddr_in local = {};
+    socklen_t len = sizeof(local);
+    if (connect(sock, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) == 0 &&
+        getsockname(sock, reinterpret_cast<sockaddr*>(&local), &len) == 0) {
+        char buf[INET_ADDRSTRLEN];
+        if (inet_ntop(AF_INET, &local.sin_addr, buf, sizeof(buf))) result = buf;
+    }
+
+#ifdef _WIN32
+    closesocket(sock);
+#else
+    close(sock);
+#endif
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// Stats
+
+std::vector<ThreadPlacement::ThreadStats> ThreadPlacement::snapshot() {
+    std::vector<ThreadStats> result;
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto& item : registry) {
+        Entry& entry = item.second;
+        ThreadStats stats;
+        stats.name = entry.name;
+        stats.role = entry.role;
+        stats.cpus = entry.cpus;
+        stats.realtime = entry.realtime;
+
+        uint64_t migrations = 0;
+        uint64_t switches = 0;
+#ifdef __linux__
+        LinuxSample sample;
+        if (!read_linux_sample(item.first, sample)) continue;
+        stats.cpu_time_ms = sample.cpu_ms;
+        stats.last_cpu = sample.last_cpu;
+        migrations = sample.migrations;
+        switches = sample.involuntary_switches;
+#elif defined(_WIN32)
+        FILETIME created, exited, kernel, user;
+        if (!entry.handle || !GetThreadTimes(entry.handle, &created, &exited, &kernel, &user)) continue;
+        auto to_ms = [](const FILETIME& ft) {
+            return ((uint64_t)ft.dwHighDateTime << 32 | ft.dwLowDateTime) / 10000.0;
+        };
+        stats.cpu_time_ms = to_ms(kernel) + to_ms(user);
+#endif
+
+        double wall_ms = std::chrono::duration<double, std::milli>(now - entry.prev_time).count();
+        if (wall_ms > 0.0) {
+            stats.cpu_percent = 100.0 * (stats.cpu_time_ms - entry.prev_cpu_ms) / wall_ms;
+        }
+        stats.migrations = migrations - std::min(migrations, entry.prev_migrations);
+        stats.involuntary_switches = switches - std::min(switches, entry.prev_switches);
+
+        entry.prev_cpu_ms = stats.cpu_time_ms;
+        entry.prev_migrations = migrations;
+        entry.prev_switches = switches;
+        entry.prev_time = now;
+
+        result.push_back(stats);
+    }
+    return result;
+}
+
+std::string ThreadPlacement::roleName(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::ENCODE:  return "encode";
+        case ThreadRole::CODEC:   return "codec";
+        case ThreadRole::PACER:   return "pacer";
+        case ThreadRole::NETWORK: return "network";
+        case ThreadRole::DECODE:  return "decode";
+        case ThreadRole::AUDIO:   return "audio";
+        default:                  return "unknown";
+    }
+}
+
+} // namespace jpegxs
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jpegxs {
+
+/**
+ * Pipeline stages that can be placed independently
+ */
+enum class ThreadRole {
+    ENCODE,     // encode_worker (repack consumer, packetizer)
+    CODEC,      // SVT-JPEG-XS worker threads (inherit from the creating thread)
+    PACER,      // ST 2110 pacer
+    NETWORK,    // SRT/UDP send and receive loops
+    DECODE,     // Receiver decode path
+    AUDIO,      // Audio receive
+    COUNT
+};
+
+/**
+ * Set of logical CPUs, parsed from Linux-style lists ("0-3,8,10-11")
+ */
+struct CpuSet {
+    std::vector<int> cpus;
+
+    bool empty() const { return cpus.empty(); }
+    std::string toString() const;
+    static CpuSet parse(const std::string& list);
+};
+
+/**
+ * Where each stage runs and whether it may use real-time scheduling.
+ * Roles without an explicit CPU list fall back to the CPUs of numa_node,
+ * so setting only the node keeps the whole pipeline next to the NIC.
+ */
+struct PlacementPlan {
+    CpuSet cpus[static_cast<int>(ThreadRole::COUNT)];
+    int numa_node = -1;     // -1 = no NUMA preference
+    bool realtime = false;  // SCHED_FIFO (pacer/network/audio) or nice -10 where permitted
+
+    const CpuSet& cpusFor(ThreadRole role) const { return cpus[static_cast<int>(role)]; }
+    CpuSet& cpusFor(ThreadRole role) { return cpus[static_cast<int>(role)]; }
+    bool active() const;
+};
+
+/**
+ * Applies a PlacementPlan to threads and tracks them for verification.
+ * Affinity and real-time priority are best effort: failures (no
+ * CAP_SYS_NICE, rtprio limits, unsupported platform) are reported, not fatal.
+ */
+class ThreadPlacement {
+public:
+    struct ThreadStats {
+        std::string name;
+        ThreadRole role = ThreadRole::ENCODE;
+        std::string cpus;              // Requested CPU list (empty = unpinned)
+        int last_cpu = -1;             // CPU the thread last ran on
+        double cpu_time_ms = 0.0;      // User + system time
+        double cpu_percent = 0.0;      // Since the previous snapshot
+        uint64_t migrations = 0;       // Scheduler migrations since the previous snapshot
+        uint64_t involuntary_switches = 0;
+        bool realtime = false;
+    };
+
+    /**
+     * Pin the calling thread, set its memory policy and priority, and
+     * register it for stats until it exits.
+     * @param error Receives a description of anything that could not be applied
+     * @return true if everything requested was applied
+     */
+    static bool apply(const PlacementPlan& plan, ThreadRole role, const char* name, std::string* error = nullptr);
+
+    /**
+     * Temporarily give the calling thread a role's placement so threads it
+     * spawns (e.g. SVT workers during encoder init) inherit it.
+     */
+    class ScopedInherit {
+    public:
+        ScopedInherit(const PlacementPlan& plan, ThreadRole role);
+        ~ScopedInherit();
+        ScopedInherit(const ScopedInherit&) = delete;
+        ScopedInherit& operator=(const ScopedInherit&) = delete;
+    private:
+        bool applied_ = false;
+        std::vector<uint8_t> saved_;  // Platform affinity/priority state
+    };
+
+    // NUMA node of the NIC that owns a local IP (-1 if unknown / not Linux)
+    static int numaNodeForInterface(const std::string& local_ip);
+    // Local IP the routing table would use to reach remote_ip (empty on failure)
+    static std::string localAddressFor(const std::string& remote_ip);
+    static CpuSet numaNodeCpus(int node);
+
+    // Per-thread CPU and migration stats for all registered threads
+    static std::vector<ThreadStats> snapshot();
+    static std::string roleName(ThreadRole role);
+};
+
+} // namespace jpegxs
@@ -74,9 +74,13 @@ QWidget* JpegXSDock::setupTransmitterTab() {
     latencySpinBox->setValue(20);
     latencySpinBox->setSuffix(" ms");
     
+    adaptiveBitrateCheckbox = new QCheckBox("Adaptive Bitrate (back off on congestion)", srtWidget);
+    adaptiveBitrateCheckbox->setChecked(false);
+    
     srtLayout->addRow("Destination URL:", srtUrlEdit);
     srtLayout->addRow("Passphrase:", passphraseEdit);
     srtLayout->addRow("Latency:", latencySpinBox);
+    srtLayout->addRow(adaptiveBitrateCheckbox);
     layout->addWidget(srtWidget);
     
     // ST 2110 Container
@@ -133,6 +137,11 @@ QWidget* JpegXSDock::setupTransmitterTab() {
 
     encLayout->addRow("Compression Ratio:", compressionRatioSpinBox);
     encLayout->addRow("Profile:", profileCombo);
+    
+    // Re-encode with new settings while streaming, without reconnecting
+    applyEncoderButton = new QPushButton("Apply Live", encGroup);
+    applyEncoderButton->setEnabled(false);
+    encLayout->addRow("", applyEncoderButton);
     layout->addWidget(encGroup);
 
     // Controls
@@ -158,6 +167,7 @@ QWidget* JpegXSDock::setupTransmitterTab() {
     // Connect signals
     connect(startButton, &QPushButton::clicked, this, &JpegXSDock::onStartClicked);
     connect(stopButton, &QPushButton::clicked, this, &JpegXSDock::onStopClicked);
+    connect(applyEncoderButton, &QPushButton::clicked, this, &JpegXSDock::onApplyEncoderClicked);
     connect(transportModeCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(onTransportModeChanged(int)));
     
     return tab;
@@ -182,6 +192,7 @@ void JpegXSDock::onStartClicked() {
     obs_data_set_string(settings, "srt_url", srtUrlEdit->text().toUtf8().constData());
     obs_data_set_int(settings, "srt_latency", latencySpinBox->value());
     obs_data_set_string(settings, "srt_passphrase", passphraseEdit->text().toUtf8().constData());
+    obs_data_set_bool(settings, "srt_adaptive_bitrate", adaptiveBitrateCheckbox->isChecked());
     
     // ST 2110
     obs_data_set_string(settings, "st2110_dest_ip", st2110DestIpEdit->text().toUtf8().constData());
@@ -211,6 +222,7 @@ void JpegXSDock::onStartClicked() {
     if (obs_output_start(jpegxs_output)) {
         startButton->setEnabled(false);
         stopButton->setEnabled(true);
+        applyEncoderButton->setEnabled(true);
         updateStatus("STREAMING");
         statusLabel->setStyleSheet("font-size: 14px; font-weight: bold; color: #2ea043;");
     } else {
@@ -228,11 +240,22 @@ void JpegXSDock::onStopClicked() {
         
         startButton->setEnabled(true);
         stopButton->setEnabled(false);
+        applyEncoderButton->setEnabled(false);
         updateStatus("STOPPED");
         statusLabel->setStyleSheet("font-size: 14px; font-weight: bold; color: #da3633;");
     }
 }
 
+void JpegXSDock::onApplyEncoderClicked() {
+    if (!jpegxs_output) return;
+    
+    obs_data_t *settings = obs_output_get_settings(jpegxs_output);
+    obs_data_set_double(settings, "compression_ratio", compressionRatioSpinBox->value());
+    obs_data_set_string(settings, "profile", profileCombo->currentData().toString().toUtf8().constData());
+    obs_output_update(jpegxs_output, settings);
+    obs_data_release(settings);
+}
+
 void JpegXSDock::updateStatus(const QString &status) {
     statusLabel->setText(status);
 }
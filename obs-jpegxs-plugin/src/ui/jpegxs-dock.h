@@ -25,6 +25,7 @@ private slots:
     // Transmitter Slots
     void onStartClicked();
     void onStopClicked();
+    void onApplyEncoderClicked();
     void onTransportModeChanged(int index);
     
     // Receiver Slots
@@ -43,6 +44,7 @@ private:
     QLineEdit *srtUrlEdit;
     QSpinBox *latencySpinBox;
     QLineEdit *passphraseEdit;
+    QCheckBox *adaptiveBitrateCheckbox;
     
     QLineEdit *st2110DestIpEdit;
     QSpinBox *st2110DestPortSpin;
@@ -54,6 +56,7 @@ private:
     
     QDoubleSpinBox *compressionRatioSpinBox;
     QComboBox *profileCombo;
+    QPushButton *applyEncoderButton;
     
     QPushButton *startButton;
     QPushButton *stopButton;
@@ -0,0 +1,96 @@
+/*
+ * PixelRepacker throughput: GB/s per kernel and instruction set
+ * Not a test; run by hand on the target machine (bench_pixel_repack [seconds])
+ */
+
+#include "encoder/pixel_repack.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace jpegxs;
+
+namespace {
+
+struct Format {
+    const char *name;
+    RepackChroma chroma;
+    int input_bit_depth;
+    int output_bit_depth;
+};
+
+const Format FORMATS[] = {
+    { "I420 8-bit",     RepackChroma::CHROMA_420,  8,  8 },
+    { "I444 8-bit",     RepackChroma::CHROMA_444,  8,  8 },
+    { "I010 10-bit",    RepackChroma::CHROMA_420, 10, 10 },
+    { "I210 10-bit",    RepackChroma::CHROMA_422, 10, 10 },
+    { "I412 12->10",    RepackChroma::CHROMA_444, 12, 10 },
+};
+
+const RepackIsa ISAS[] = {
+    RepackIsa::SCALAR, RepackIsa::SSE41, RepackIsa::AVX2, RepackIsa::AVX512, RepackIsa::NEON
+};
+
+// OBS pads rows to 32 bytes or more; keep the strided path honest
+const uint32_t ROW_PADDING = 64;
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const uint32_t width = 3840, height = 2160;
+    double seconds = argc > 1 ? std::atof(argv[1]) : 0.5;
+    if (seconds <= 0.0) seconds = 0.5;
+
+    std::printf("%ux%u, %.1f s per kernel, widest %s\n", width, height, seconds,
+                PixelRepacker::isa_name(PixelRepacker::detect_isa()));
+    std::printf("%-14s %-8s %-22s %10s %10s\n", "format", "isa", "kernel", "frames/s", "GB/s");
+
+    for (const Format &format : FORMATS) {
+        uint32_t bytes = format.input_bit_depth > 8 ? 2 : 1;
+        uint32_t w_uv = format.chroma == RepackChroma::CHROMA_444 ? width : width / 2;
+        uint32_t h_uv = format.chroma == RepackChroma::CHROMA_420 ? height / 2 : height;
+
+        std::vector<uint8_t> planes[3];
+        uint32_t linesize[3];
+        const uint8_t *src[3];
+        size_t src_bytes = 0;
+        for (int p = 0; p < 3; p++) {
+            linesize[p] = (p ? w_uv : width) * bytes + ROW_PADDING;
+            planes[p].assign((size_t)linesize[p] * (p ? h_uv : height), 0x15);
+            src[p] = planes[p].data();
+            src_bytes += (size_t)(p ? w_uv : width) * bytes * (p ? h_uv : height);
+        }
+
+        for (RepackIsa isa : ISAS) {
+            PixelRepacker repacker;
+            if (repacker.set_isa(isa) != isa) continue;  // Not on this CPU
+            if (!repacker.configure(width, height, format.chroma, format.input_bit_depth, format.output_bit_depth)) {
+                continue;
+            }
+            std::vector<uint8_t> dst(repacker.packed_size());
+
+            // Warm the caches and page in the destination before timing
+            repacker.repack(src, linesize, dst.data());
+
+            using Clock = std::chrono::steady_clock;
+            uint64_t frames = 0;
+            Clock::time_point start = Clock::now();
+            double elapsed = 0.0;
+            do {
+                for (int i = 0; i < 8; i++) repacker.repack(src, linesize, dst.data());
+                frames += 8;
+                elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            } while (elapsed < seconds);
+
+            // Bytes read plus bytes written, the traffic the kernel is bound by
+            double traffic = (double)(src_bytes + repacker.packed_size()) * frames;
+            std::printf("%-14s %-8s %-22s %10.1f %10.2f\n", format.name, PixelRepacker::isa_name(isa),
+                        repacker.kernel_name(), frames / elapsed, traffic / elapsed / 1e9);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+/*
+ * AudioJitterBuffer: reordering, loss, and clock drift tracking
+ */
+
+#include "decoder/audio_jitter_buffer.h"
+#include "test_common.h"
+
+#include <cmath>
+
+using namespace jpegxs;
+
+namespace {
+
+const uint32_t RATE = 48000;
+const uint32_t PACKET_FRAMES = 480;   // 10 ms
+const uint64_t PULL_NS = 1000000ULL;  // 48 frames
+
+struct Packet {
+    uint32_t timestamp;
+    uint64_t arrival_ns;
+};
+
+AudioJitterBuffer::Config config()
+{
+    AudioJitterBuffer::Config c;
+    c.channels = 2;
+    c.sample_rate = RATE;
+    return c;
+}
+
+// A ramp of the RTP position (from 1, so silence stands out), which linear
+// interpolation passes through unchanged: a played frame tells where it came from
+void push_ramp(AudioJitterBuffer &buffer, const Packet &packet, uint32_t first_timestamp)
+{
+    std::vector<float> left(PACKET_FRAMES), right(PACKET_FRAMES);
+    for (uint32_t i = 0; i < PACKET_FRAMES; i++) {
+        left[i] = (float)(packet.timestamp - first_timestamp + i + 1);
+        right[i] = -left[i];
+    }
+    const float *planes[2] = { left.data(), right.data() };
+    buffer.push(planes, PACKET_FRAMES, packet.timestamp, packet.arrival_ns);
+}
+
+} // namespace
+
+static void test_reorder_and_loss()
+{
+    // A floor that covers the swaps before the jitter estimate has seen any
+    AudioJitterBuffer::Config c = config();
+    c.min_depth_ms = 30;
+    AudioJitterBuffer buffer;
+    CHECK(buffer.configure(c));
+
+    // 2 s of packets, neighbours swapped, one lost; timestamps wrap mid-stream
+    const uint32_t first = 0xFFFFFFFFu - 20 * PACKET_FRAMES;
+    const uint32_t lost = 100;
+    std::vector<Packet> packets;
+    for (uint32_t n = 0; n < 200; n++) {
+        uint32_t k = n ^ 1;
+        packets.push_back({ first + k * PACKET_FRAMES, 1000000000ULL + n * 10000000ULL });
+    }
+
+    auto near_lost = [&](float v) {
+        return v > lost * PACKET_FRAMES - 1 && v < (lost + 1) * PACKET_FRAMES + 2;
+    };
+
+    size_t next = 0;
+    uint32_t audio_pulls = 0, silent_frames = 0;
+    float previous = 0.0f;
+    for (uint64_t now = 1000000000ULL; now < 2990000000ULL; now += PULL_NS) {
+        for (; next < packets.size() && packets[next].arrival_ns <= now; next++) {
+            if ((packets[next].timestamp - first) / PACKET_FRAMES != lost) push_ramp(buffer, packets[next], first);
+        }
+
+        const float *planes[2];
+        if (!buffer.pull(planes) || !buffer.playing()) continue;
+        audio_pulls++;
+        for (uint32_t i = 0; i < 48; i++) {
+            float v = planes[0][i];
+            CHECK(planes[1][i] == -v);
+            if (v == 0.0f) {
+                // Only the lost packet plays as silence
+                CHECK(near_lost(previous));
+                silent_frames++;
+                continue;
+            }
+            // Frames either side of it interpolate towards that silence
+            if (near_lost(previous) && v < previous) continue;
+
+            // Elsewhere each frame is one on from the last, give or take the resampling step
+            if (previous != 0.0f && !near_lost(v)) CHECK(std::fabs(v - previous - 1.0f) < 0.02f);
+            previous = v;
+        }
+    }
+
+    AudioJitterBuffer::Stats stats = buffer.get_stats();
+    CHECK(audio_pulls > 1900);
+    CHECK(silent_frames >= PACKET_FRAMES - 2 && silent_frames <= PACKET_FRAMES + 2);
+    CHECK(stats.underruns == 0 && stats.resyncs == 0);
+    CHECK(stats.late_packets == 1);  // Only the first swap: the stream anchors on what arrives first
+    CHECK(std::fabs(stats.jitter_ms - 20.0) < 1.0);  // A packet early, its neighbour as late
+}
+
+static void test_drift_tracking()
+{
+    // The sender's clock runs 200 ppm fast; packets arrive with 0-4 ms of jitter
+    const double drift_ppm = 200.0;
+    AudioJitterBuffer buffer;
+    CHECK(buffer.configure(config()));
+
+    std::vector<float> tone(PACKET_FRAMES, 0.25f);
+    const float *planes_in[2] = { tone.data(), tone.data() };
+    std::mt19937 rng(3);
+
+    uint64_t packet = 0;
+    uint64_t start_ns = 1000000000ULL;
+    uint64_t underruns_after_fill = 0;
+    bool filled = false;
+    for (uint64_t now = start_ns; now < start_ns + 120000000000ULL; now += PULL_NS) {
+        for (;;) {
+            double sent = (double)packet * PACKET_FRAMES / (RATE * (1.0 + drift_ppm * 1e-6)) * 1e9;
+            uint64_t arrival = start_ns + (uint64_t)sent + rng() % 4000000;
+            if (arrival > now) break;
+            buffer.push(planes_in, PACKET_FRAMES, (uint32_t)(packet * PACKET_FRAMES), arrival);
+            packet++;
+        }
+
+        const float *planes[2];
+        if (buffer.pull(planes) && buffer.playing()) filled = true;
+        if (filled) underruns_after_fill = buffer.get_stats().underruns;
+    }
+
+    AudioJitterBuffer::Stats stats = buffer.get_stats();
+    CHECK(filled && underruns_after_fill == 0);
+    CHECK(stats.skipped_frames == 0);
+    CHECK(std::fabs(stats.drift_ppm - drift_ppm) < 25.0);
+    CHECK(std::fabs(stats.depth_ms - stats.target_ms) < 2.0);
+}
+
+static void test_stream_stop()
+{
+    AudioJitterBuffer buffer;
+    CHECK(buffer.configure(config()));
+    const float *planes[2];
+    CHECK(!buffer.pull(planes));  // Nothing yet
+
+    Packet packet = { 1000, 1000000000ULL };
+    for (int i = 0; i < 10; i++, packet.timestamp += PACKET_FRAMES) push_ramp(buffer, packet, 1000);
+    CHECK(buffer.pull(planes) && buffer.playing());
+
+    // A second of pulls without packets returns to idle
+    bool stopped = false;
+    for (int i = 0; i < 1000 && !stopped; i++) stopped = !buffer.pull(planes);
+    CHECK(stopped && !buffer.playing());
+
+    CHECK(!buffer.configure(AudioJitterBuffer::Config{ 0 }));
+}
+
+int main()
+{
+    test_reorder_and_loss();
+    test_drift_tracking();
+    test_stream_stop();
+    std::printf("audio_jitter_buffer: ok\n");
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * CodestreamSlices: PIH parsing and slice boundary scanning
+ */
+
+#include "network/codestream_slices.h"
+#include "test_common.h"
+
+#include <cstring>
+
+using namespace jpegxs;
+using namespace jpegxs::test;
+
+static void test_layout()
+{
+    CodestreamSpec spec;
+    spec.height = 1080;
+    std::vector<uint8_t> cs = make_codestream(spec);
+
+    CodestreamSlices::Layout layout;
+    CHECK(CodestreamSlices::parseHeader(cs.data(), cs.size(), layout));
+    CHECK(layout.header_size == 30);
+    CHECK(layout.height == 1080);
+    CHECK(layout.slice_lines == 16);
+    CHECK(layout.slice_count == 68);  // 1080 / 16 rounded up
+    CHECK(CodestreamSlices::codestreamLength(cs.data(), layout) == cs.size());
+
+    CodestreamSlices::setCodestreamLength(cs.data(), layout, 0x01020304);
+    CHECK(CodestreamSlices::codestreamLength(cs.data(), layout) == 0x01020304);
+}
+
+static void test_slices_cover_codestream()
+{
+    for (uint32_t nly = 0; nly <= 5; nly++) {
+        CodestreamSpec spec;
+        spec.height = 540;
+        spec.hsl = 2;
+        spec.nly = nly;
+        spec.seed = 10 + nly;
+        std::vector<uint8_t> cs = make_codestream(spec);
+
+        CodestreamSlices::Layout layout;
+        std::vector<SliceSpan> slices;
+        CHECK(CodestreamSlices::parseHeader(cs.data(), cs.size(), layout));
+        CHECK(layout.slice_lines == (2u << nly));
+        CHECK(CodestreamSlices::findSlices(cs.data(), cs.size(), layout, slices));
+        CHECK(slices.size() == slice_count(spec));
+
+        // Back to back from the header to the end, each led by its own SLH
+        size_t expected = layout.header_size;
+        for (size_t i = 0; i < slices.size(); i++) {
+            const SliceSpan &slice = slices[i];
+            CHECK(slice.index == i);
+            CHECK(slice.offset == expected);
+            CHECK(slice.intact);
+            const uint8_t *p = cs.data() + slice.offset;
+            CHECK(p[0] == 0xFF && p[1] == 0x20 && p[4] == (uint8_t)(i >> 8) && p[5] == (uint8_t)i);
+            expected += slice.size;
+        }
+        CHECK(expected == cs.size());
+    }
+}
+
+static void test_single_slice()
+{
+    CodestreamSpec spec;
+    spec.height = 8;  // Less than one slice of 16 lines
+    std::vector<uint8_t> cs = make_codestream(spec);
+
+    CodestreamSlices::Layout layout;
+    std::vector<SliceSpan> slices;
+    CHECK(CodestreamSlices::parseHeader(cs.data(), cs.size(), layout));
+    CHECK(layout.slice_count == 1);
+    CHECK(CodestreamSlices::findSlices(cs.data(), cs.size(), layout, slices));
+    CHECK(slices.size() == 1 && slices[0].size == cs.size() - layout.header_size);
+}
+
+static void test_false_marker_in_slice_data()
+{
+    CodestreamSpec spec;
+    std::vector<uint8_t> cs = make_codestream(spec);
+    CodestreamSlices::Layout layout;
+    std::vector<SliceSpan> slices;
+    CHECK(CodestreamSlices::parseHeader(cs.data(), cs.size(), layout));
+    CHECK(CodestreamSlices::findSlices(cs.data(), cs.size(), layout, slices));
+    std::vector<SliceSpan> expected = slices;
+
+    // An SLH lookalike with an index that is not the next one is slice data
+    const uint8_t fake[6] = { 0xFF, 0x20, 0x00, 0x04, 0x00, 0x03 };
+    size_t at = slices[0].offset + 20;
+    std::memcpy(cs.data() + at, fake, sizeof(fake));
+    CHECK(CodestreamSlices::findSlices(cs.data(), cs.size(), layout, slices));
+    CHECK(slices.size() == expected.size());
+    for (size_t i = 0; i < slices.size(); i++) {
+        CHECK(slices[i].offset == expected[i].offset && slices[i].size == expected[i].size);
+    }
+}
+
+static void test_rejects_malformed()
+{
+    CodestreamSpec spec;
+    const std::vector<uint8_t> good = make_codestream(spec);
+    CodestreamSlices::Layout layout;
+    std::vector<SliceSpan> slices;
+
+    CHECK(!CodestreamSlices::parseHeader(good.data(), 0, layout));
+    CHECK(!CodestreamSlices::parseHeader(good.data(), 20, layout));  // Cut inside the PIH
+
+    std::vector<uint8_t> cs = good;
+    cs[1] = 0x11;  // No SOC
+    CHECK(!CodestreamSlices::parseHeader(cs.data(), cs.size(), layout));
+
+    cs = good;
+    cs[2 + 14] = cs[2 + 15] = 0;  // Height 0
+    CHECK(!CodestreamSlices::parseHeader(cs.data(), cs.size(), layout));
+
+    cs = good;
+    cs[2 + 18] = cs[2 + 19] = 0;  // Hsl 0
+    CHECK(!CodestreamSlices::parseHeader(cs.data(), cs.size(), layout));
+
+    cs = good;
+    cs[2 + 3] = 60;  // PIH length runs past the header
+    CHECK(!CodestreamSlices::parseHeader(cs.data(), 40, layout));
+
+    // Header fine, slices not
+    CHECK(CodestreamSlices::parseHeader(good.data(), good.size(), layout));
+    CHECK(CodestreamSlices::findSlices(good.data(), good.size(), layout, slices));
+    const std::vector<SliceSpan> good_slices = slices;
+
+    cs = good;
+    cs.pop_back();  // No EOC
+    CHECK(!CodestreamSlices::findSlices(cs.data(), cs.size(), layout, slices));
+
+    cs = good;
+    cs[good_slices[2].offset + 5] = 0x09;  // Slice 2 renumbered
+    CHECK(!CodestreamSlices::findSlices(cs.data(), cs.size(), layout, slices));
+
+    cs = good;
+    cs.resize(good_slices[1].offset + 3);  // Truncated mid-frame
+    CHECK(!CodestreamSlices::findSlices(cs.data(), cs.size(), layout, slices));
+}
+
+int main()
+{
+    test_layout();
+    test_slices_cover_codestream();
+    test_single_slice();
+    test_false_marker_in_slice_data();
+    test_rejects_malformed();
+    std::printf("codestream_slices: ok\n");
+    return 0;
+}
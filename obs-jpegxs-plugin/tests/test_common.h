@@ -0,0 +1,93 @@
+/*
+ * Unit Test Helpers
+ * A check macro that survives NDEBUG, and synthetic JPEG XS codestreams
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                             \
+        }                                                                             \
+    } while (0)
+
+namespace jpegxs {
+namespace test {
+
+/**
+ * A plain codestream with the structure CodestreamSlices walks: SOC, a PIH
+ * (Lcod, height, Hsl, NLy set, everything else zero), one SLH-led slice per
+ * slice_lines rows and EOC. Slice data never contains 0xFF, so the only
+ * markers are the real ones.
+ */
+struct CodestreamSpec {
+    uint32_t height = 64;
+    uint32_t hsl = 1;            // Precinct rows per slice
+    uint32_t nly = 4;            // 2^NLy lines per precinct row
+    size_t slice_bytes = 300;    // Minimum; each slice adds up to slice_jitter more
+    size_t slice_jitter = 200;
+    uint32_t seed = 1;
+};
+
+inline uint32_t slice_count(const CodestreamSpec &spec)
+{
+    uint32_t lines = spec.hsl << spec.nly;
+    return (spec.height + lines - 1) / lines;
+}
+
+inline std::vector<uint8_t> make_codestream(const CodestreamSpec &spec)
+{
+    std::mt19937 rng(spec.seed);
+    std::vector<uint8_t> cs = { 0xFF, 0x10 };
+
+    // PIH: marker, Lpih = 26, then Lcod at +4, Hf at +14, Hsl at +18, NLy at +26
+    size_t pih = cs.size();
+    cs.resize(pih + 28, 0);
+    cs[pih] = 0xFF;
+    cs[pih + 1] = 0x12;
+    cs[pih + 3] = 26;
+    cs[pih + 14] = (uint8_t)(spec.height >> 8);
+    cs[pih + 15] = (uint8_t)spec.height;
+    cs[pih + 18] = (uint8_t)(spec.hsl >> 8);
+    cs[pih + 19] = (uint8_t)spec.hsl;
+    cs[pih + 26] = (uint8_t)spec.nly;
+
+    uint32_t slices = slice_count(spec);
+    for (uint32_t i = 0; i < slices; i++) {
+        const uint8_t slh[6] = { 0xFF, 0x20, 0x00, 0x04, (uint8_t)(i >> 8), (uint8_t)i };
+        cs.insert(cs.end(), slh, slh + 6);
+        size_t n = spec.slice_bytes + (spec.slice_jitter ? rng() % spec.slice_jitter : 0);
+        for (size_t k = 0; k < n; k++) {
+            cs.push_back((uint8_t)(rng() % 255));
+        }
+    }
+    cs.push_back(0xFF);
+    cs.push_back(0x11);
+
+    uint32_t length = (uint32_t)cs.size();
+    cs[pih + 4] = (uint8_t)(length >> 24);
+    cs[pih + 5] = (uint8_t)(length >> 16);
+    cs[pih + 6] = (uint8_t)(length >> 8);
+    cs[pih + 7] = (uint8_t)length;
+    return cs;
+}
+
+// Bytes the slice parser cannot make sense of (sent whole, like a striped frame)
+inline std::vector<uint8_t> make_opaque(size_t size, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> data(size);
+    for (uint8_t &b : data) b = (uint8_t)(rng() % 255);
+    return data;
+}
+
+} // namespace test
+} // namespace jpegxs
@@ -0,0 +1,171 @@
+/*
+ * PixelRepacker: every kernel against the scalar one, and against the
+ * reference layout, for each chroma format and bit-depth pair
+ */
+
+#include "encoder/pixel_repack.h"
+#include "test_common.h"
+
+#include <cstring>
+
+using namespace jpegxs;
+
+namespace {
+
+struct Format {
+    RepackChroma chroma;
+    int input_bit_depth;
+    int output_bit_depth;
+};
+
+const Format FORMATS[] = {
+    { RepackChroma::CHROMA_420,  8,  8 },   // I420
+    { RepackChroma::CHROMA_422,  8,  8 },   // I422
+    { RepackChroma::CHROMA_444,  8,  8 },   // I444
+    { RepackChroma::CHROMA_420, 10, 10 },   // I010
+    { RepackChroma::CHROMA_422, 10, 10 },   // I210
+    { RepackChroma::CHROMA_420, 12, 10 },
+    { RepackChroma::CHROMA_422, 12, 10 },
+    { RepackChroma::CHROMA_444, 12, 10 },   // I412
+};
+
+const RepackIsa ISAS[] = {
+    RepackIsa::SSE41, RepackIsa::AVX2, RepackIsa::AVX512, RepackIsa::NEON
+};
+
+// A strided OBS frame: rows padded past the samples, padding filled with a
+// value no kernel may copy
+struct SourceFrame {
+    std::vector<uint8_t> planes[3];
+    uint32_t linesize[3];
+    uint32_t samples[3];
+    uint32_t rows[3];
+
+    const uint8_t *data[3];
+};
+
+void make_source(SourceFrame &frame, uint32_t width, uint32_t height, const Format &format,
+                 uint32_t padding, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    uint32_t bytes = format.input_bit_depth > 8 ? 2 : 1;
+    uint32_t w_uv = format.chroma == RepackChroma::CHROMA_444 ? width : width / 2;
+    uint32_t h_uv = format.chroma == RepackChroma::CHROMA_420 ? height / 2 : height;
+    for (int p = 0; p < 3; p++) {
+        frame.samples[p] = p ? w_uv : width;
+        frame.rows[p] = p ? h_uv : height;
+        frame.linesize[p] = frame.samples[p] * bytes + padding;
+        std::vector<uint8_t> &plane = frame.planes[p];
+        plane.assign((size_t)frame.linesize[p] * frame.rows[p], 0xEE);
+        for (uint32_t y = 0; y < frame.rows[p]; y++) {
+            uint8_t *row = plane.data() + (size_t)y * frame.linesize[p];
+            for (uint32_t x = 0; x < frame.samples[p]; x++) {
+                if (bytes == 1) {
+                    row[x] = (uint8_t)rng();
+                } else {
+                    uint16_t v = (uint16_t)(rng() & ((1u << format.input_bit_depth) - 1));
+                    std::memcpy(row + x * 2, &v, 2);
+                }
+            }
+        }
+        frame.data[p] = plane.data();
+    }
+}
+
+// What the encoder expects: planes back to back, samples at the coded depth
+std::vector<uint8_t> reference(const SourceFrame &frame, const Format &format)
+{
+    int shift = format.input_bit_depth - format.output_bit_depth;
+    std::vector<uint8_t> out;
+    for (int p = 0; p < 3; p++) {
+        for (uint32_t y = 0; y < frame.rows[p]; y++) {
+            const uint8_t *row = frame.planes[p].data() + (size_t)y * frame.linesize[p];
+            if (format.input_bit_depth == 8) {
+                out.insert(out.end(), row, row + frame.samples[p]);
+                continue;
+            }
+            for (uint32_t x = 0; x < frame.samples[p]; x++) {
+                uint16_t v;
+                std::memcpy(&v, row + x * 2, 2);
+                v = (uint16_t)(v >> shift);
+                const uint8_t *b = reinterpret_cast<const uint8_t *>(&v);
+                out.insert(out.end(), b, b + 2);
+            }
+        }
+    }
+    return out;
+}
+
+std::vector<uint8_t> repack(const SourceFrame &frame, uint32_t width, uint32_t height, const Format &format,
+                            RepackIsa isa, RepackIsa *used)
+{
+    PixelRepacker repacker;
+    *used = repacker.set_isa(isa);
+    CHECK(repacker.configure(width, height, format.chroma, format.input_bit_depth, format.output_bit_depth));
+    std::vector<uint8_t> dst(repacker.packed_size() + 64, 0xCD);
+    repacker.repack(frame.data, frame.linesize, dst.data());
+
+    // Nothing written past the packed frame
+    for (size_t i = repacker.packed_size(); i < dst.size(); i++) CHECK(dst[i] == 0xCD);
+    dst.resize(repacker.packed_size());
+    return dst;
+}
+
+} // namespace
+
+static void test_kernels_match_reference()
+{
+    // Widths that end on and off every vector width; padded and tight rows
+    const uint32_t sizes[][2] = { { 1920, 1080 }, { 1282, 722 }, { 66, 4 }, { 2, 2 } };
+    const uint32_t paddings[] = { 0, 64, 6 };
+
+    uint32_t compared = 0;
+    uint32_t seed = 1;
+    for (const Format &format : FORMATS) {
+        for (const auto &size : sizes) {
+            for (uint32_t padding : paddings) {
+                SourceFrame frame;
+                make_source(frame, size[0], size[1], format, padding, seed++);
+                std::vector<uint8_t> expected = reference(frame, format);
+
+                RepackIsa used;
+                CHECK(repack(frame, size[0], size[1], format, RepackIsa::SCALAR, &used) == expected);
+                CHECK(used == RepackIsa::SCALAR);
+
+                for (RepackIsa isa : ISAS) {
+                    if (repack(frame, size[0], size[1], format, isa, &used) != expected) {
+                        std::fprintf(stderr, "%s: %ux%u %d->%d-bit chroma %d padding %u differs\n",
+                                     PixelRepacker::isa_name(used), size[0], size[1], format.input_bit_depth,
+                                     format.output_bit_depth, (int)format.chroma, padding);
+                        CHECK(false);
+                    }
+                    if (used == isa) compared++;
+                }
+            }
+        }
+    }
+    std::printf("pixel_repack: widest kernel %s, %u SIMD runs compared\n",
+                PixelRepacker::isa_name(PixelRepacker::detect_isa()), compared);
+}
+
+static void test_unsupported()
+{
+    PixelRepacker repacker;
+    CHECK(!repacker.configure(64, 64, RepackChroma::CHROMA_420, 10, 8));
+    CHECK(!repacker.configure(64, 64, RepackChroma::CHROMA_420, 8, 10));
+    CHECK(std::strcmp(repacker.kernel_name(), "none") == 0);
+
+    // An instruction set the CPU lacks falls back to the detected one
+    RepackIsa detected = PixelRepacker::detect_isa();
+    RepackIsa foreign = detected == RepackIsa::NEON ? RepackIsa::AVX2 : RepackIsa::NEON;
+    CHECK(repacker.set_isa(foreign) == detected);
+    CHECK(PixelRepacker::supported_isa(RepackIsa::SCALAR) == RepackIsa::SCALAR);
+}
+
+int main()
+{
+    test_kernels_match_reference();
+    test_unsupported();
+    std::printf("pixel_repack: ok\n");
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * PlaneScaler: the SIMD box kernels against the scalar one
+ */
+
+#include "encoder/plane_scaler.h"
+#include "test_common.h"
+
+#include <cstring>
+
+using namespace jpegxs;
+
+namespace {
+
+struct Case {
+    uint32_t src_width, src_height;
+    uint32_t dst_width, dst_height;
+    RepackChroma chroma;
+    int bit_depth;
+};
+
+size_t packed_size(uint32_t width, uint32_t height, RepackChroma chroma, int bit_depth)
+{
+    PixelRepacker layout;
+    CHECK(layout.configure(width, height, chroma, bit_depth, bit_depth));
+    return layout.packed_size();
+}
+
+std::vector<uint8_t> random_frame(const Case &c, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> frame(packed_size(c.src_width, c.src_height, c.chroma, c.bit_depth));
+    if (c.bit_depth > 8) {
+        // Samples stay within the coded depth, as the repacker leaves them
+        for (size_t i = 0; i + 1 < frame.size(); i += 2) {
+            uint16_t v = (uint16_t)(rng() & ((1u << c.bit_depth) - 1));
+            std::memcpy(&frame[i], &v, 2);
+        }
+    } else {
+        for (uint8_t &b : frame) b = (uint8_t)rng();
+    }
+    return frame;
+}
+
+std::vector<uint8_t> scale(const Case &c, RepackIsa isa, const std::vector<uint8_t> &src, RepackIsa *used)
+{
+    PlaneScaler scaler;
+    *used = scaler.set_isa(isa);
+    CHECK(scaler.configure(c.src_width, c.src_height, c.dst_width, c.dst_height, c.chroma, c.bit_depth));
+    std::vector<uint8_t> dst(packed_size(c.dst_width, c.dst_height, c.chroma, c.bit_depth), 0xCD);
+    scaler.scale(src.data(), dst.data());
+    return dst;
+}
+
+} // namespace
+
+static void test_box_rounding()
+{
+    // One 2x2 block per output sample: (a + b + c + d + 2) >> 2
+    Case c = { 4, 2, 2, 1, RepackChroma::CHROMA_444, 8 };
+    std::vector<uint8_t> src(packed_size(4, 2, c.chroma, 8));
+    const uint8_t y[8] = { 0, 1, 10, 20,
+                           1, 1, 30, 41 };
+    std::memcpy(src.data(), y, sizeof(y));
+    RepackIsa used;
+    std::vector<uint8_t> dst = scale(c, RepackIsa::SCALAR, src, &used);
+    CHECK(used == RepackIsa::SCALAR);
+    CHECK(dst[0] == 1);   // 3 / 4 rounds to 1
+    CHECK(dst[1] == 25);  // 101 / 4 rounds to 25
+}
+
+static void test_simd_matches_scalar()
+{
+    const Case cases[] = {
+        { 1920, 1080,  960, 540, RepackChroma::CHROMA_420,  8 },
+        { 3840, 2160,  960, 540, RepackChroma::CHROMA_420,  8 },  // Two box steps
+        { 1000,  600,  500, 300, RepackChroma::CHROMA_420,  8 },  // Rows end off the vector width
+        { 1282,  720,  641, 360, RepackChroma::CHROMA_422,  8 },
+        { 1920, 1080,  960, 540, RepackChroma::CHROMA_422, 10 },
+        { 1282,  722,  641, 361, RepackChroma::CHROMA_444, 10 },
+        { 3840, 2160, 1280, 720, RepackChroma::CHROMA_420, 10 },  // Box step, then bilinear
+        { 1920, 1080, 1280, 720, RepackChroma::CHROMA_444,  8 },  // Bilinear only
+    };
+    const RepackIsa candidates[] = {
+        RepackIsa::SSE41, RepackIsa::AVX2, RepackIsa::AVX512, RepackIsa::NEON
+    };
+
+    uint32_t compared = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const Case &c = cases[i];
+        std::vector<uint8_t> src = random_frame(c, (uint32_t)i + 1);
+        RepackIsa used;
+        std::vector<uint8_t> reference = scale(c, RepackIsa::SCALAR, src, &used);
+
+        for (RepackIsa isa : candidates) {
+            if (scale(c, isa, src, &used) != reference) {
+                std::fprintf(stderr, "case %zu: %s differs from scalar\n", i, PixelRepacker::isa_name(used));
+                CHECK(false);
+            }
+            if (used == isa) compared++;
+        }
+    }
+    std::printf("plane_scaler: widest kernel %s, %u SIMD runs compared\n",
+                PixelRepacker::isa_name(PixelRepacker::detect_isa()), compared);
+}
+
+int main()
+{
+    test_box_rounding();
+    test_simd_matches_scalar();
+    std::printf("plane_scaler: ok\n");
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * RateController: back-off on congestion, additive recovery, clamping
+ */
+
+#include "network/rate_controller.h"
+#include "test_common.h"
+
+#include <cmath>
+
+using namespace jpegxs;
+
+namespace {
+
+const uint64_t INTERVAL_NS = 500000000ULL;
+
+// Cumulative sender counters, advanced one interval at a time
+struct Link {
+    SRTTransport::Stats stats;
+    uint64_t now_ns = 1000000000ULL;
+
+    Link() { stats.connected = true; }
+
+    bool step(RateController &controller, double buffer_ms = 0.0, int64_t retrans = 0, int64_t dropped = 0)
+    {
+        now_ns += INTERVAL_NS;
+        stats.packets_sent += 1000;
+        stats.packets_retransmitted += retrans;
+        stats.packets_send_dropped += dropped;
+        stats.send_buffer_ms = buffer_ms;
+        CHECK(controller.due(now_ns));
+        return controller.update(stats, now_ns);
+    }
+};
+
+RateController::Config config()
+{
+    RateController::Config c;
+    c.min_mbps = 50.0;
+    c.max_mbps = 500.0;
+    c.latency_ms = 20;
+    c.interval_ns = INTERVAL_NS;
+    return c;
+}
+
+bool near(double a, double b)
+{
+    return std::fabs(a - b) < 1e-9;
+}
+
+} // namespace
+
+static void test_baseline_and_interval()
+{
+    RateController controller(config());
+    CHECK(near(controller.getTargetMbps(), 500.0));
+
+    Link link;
+    CHECK(controller.due(link.now_ns));
+    CHECK(!controller.update(link.stats, link.now_ns));  // First sample is the baseline
+    CHECK(!controller.due(link.now_ns + INTERVAL_NS - 1));
+    CHECK(controller.due(link.now_ns + INTERVAL_NS));
+
+    // Samples inside the interval are ignored even when congested
+    link.stats.send_buffer_ms = 100.0;
+    CHECK(!controller.update(link.stats, link.now_ns + 1));
+    CHECK(near(controller.getTargetMbps(), 500.0));
+
+    // Disconnected: no decision, and the next sample is a fresh baseline
+    SRTTransport::Stats down;
+    CHECK(!controller.update(down, link.now_ns + INTERVAL_NS));
+    CHECK(controller.due(link.now_ns + INTERVAL_NS + 1));
+}
+
+static void test_backoff()
+{
+    RateController controller(config());
+    Link link;
+    controller.update(link.stats, link.now_ns);
+
+    // Send buffer past half the latency: multiplicative decrease
+    CHECK(link.step(controller, 15.0));
+    CHECK(near(controller.getTargetMbps(), 400.0));
+
+    // Retransmits over 2%: decrease again
+    CHECK(link.step(controller, 0.0, 50));
+    CHECK(near(controller.getTargetMbps(), 320.0));
+
+    // Packets dropped too late: the harder decrease
+    CHECK(link.step(controller, 0.0, 0, 1));
+    CHECK(near(controller.getTargetMbps(), 192.0));
+
+    // Growing but under the limit: hold
+    CHECK(!link.step(controller, 3.0));
+    CHECK(!link.step(controller, 6.0));
+    CHECK(near(controller.getTargetMbps(), 192.0));
+
+    RateController::Stats stats = controller.getStats();
+    CHECK(stats.decreases == 3 && stats.increases == 0);
+    CHECK(near(stats.retrans_rate, 0.0) && near(stats.send_buffer_ms, 6.0));
+}
+
+static void test_recovery_and_limits()
+{
+    RateController controller(config());
+    Link link;
+    controller.update(link.stats, link.now_ns);
+
+    // Sustained congestion bottoms out at the floor
+    for (int i = 0; i < 30; i++) link.step(controller, 0.0, 0, 10);
+    CHECK(near(controller.getTargetMbps(), 50.0));
+    CHECK(!link.step(controller, 0.0, 0, 10));
+
+    // Every third clean interval adds 5% of the ceiling
+    CHECK(!link.step(controller));
+    CHECK(!link.step(controller));
+    CHECK(link.step(controller));
+    CHECK(near(controller.getTargetMbps(), 75.0));
+
+    // ...up to the ceiling and no further
+    for (int i = 0; i < 100; i++) link.step(controller);
+    CHECK(near(controller.getTargetMbps(), 500.0));
+
+    // reset() clamps its start into range
+    controller.reset(1000.0);
+    CHECK(near(controller.getTargetMbps(), 500.0));
+    controller.reset(1.0);
+    CHECK(near(controller.getTargetMbps(), 50.0));
+}
+
+static void test_max_bandwidth()
+{
+    // Bitrate in bytes/s with packet overhead and retransmit headroom
+    CHECK(RateController::maxBandwidthFor(0.0) == 0);
+    int64_t bw = RateController::maxBandwidthFor(100.0);
+    CHECK(bw > 100000000 / 8 && bw < 100000000 / 8 * 2);
+    CHECK(RateController::maxBandwidthFor(200.0) > bw);
+}
+
+int main()
+{
+    test_baseline_and_interval();
+    test_backoff();
+    test_recovery_and_limits();
+    test_max_bandwidth();
+    std::printf("rate_controller: ok\n");
+    return 0;
+}
@@ -0,0 +1,346 @@
+/*
+ * RTPPacketizer / RTPDepacketizer round trips, in slice and codestream mode
+ */
+
+#include "network/rtp_packet.h"
+#include "test_common.h"
+
+#include <cstring>
+#include <set>
+
+using namespace jpegxs;
+using namespace jpegxs::test;
+
+namespace {
+
+using Packets = std::vector<std::vector<uint8_t>>;
+
+struct Frame {
+    uint32_t timestamp;
+    std::vector<uint8_t> data;
+    std::vector<SliceSpan> slices;
+};
+
+const size_t HEADERS = RTPPacket::HEADER_SIZE + RTPPacket::PAYLOAD_HEADER_SIZE;
+
+struct PayloadFields {
+    bool marker;
+    uint16_t seq;
+    bool t, k, l;
+    uint8_t i, f;
+    uint16_t sep, p;
+
+    // Slice mode: -1 for the codestream header, else the slice index
+    int unit() const { return k ? sep - 1 : -1; }
+};
+
+// Decoded by hand from the RFC 9134 bit layout, not through RTPPacket
+PayloadFields fields(const std::vector<uint8_t> &packet)
+{
+    CHECK(packet.size() > HEADERS);
+    uint32_t w = ((uint32_t)packet[12] << 24) | ((uint32_t)packet[13] << 16) | ((uint32_t)packet[14] << 8) | packet[15];
+    return { (packet[1] & 0x80) != 0, (uint16_t)((packet[2] << 8) | packet[3]),
+             (w >> 31) != 0, ((w >> 30) & 1) != 0, ((w >> 29) & 1) != 0,
+             (uint8_t)((w >> 27) & 3), (uint8_t)((w >> 22) & 0x1F),
+             (uint16_t)((w >> 11) & 0x7FF), (uint16_t)(w & 0x7FF) };
+}
+
+Packets packetize(RTPPacketizer &packetizer, const std::vector<uint8_t> &frame, uint32_t timestamp,
+                  bool marker = true)
+{
+    Packets packets;
+    packetizer.packetize(frame.data(), frame.size(), timestamp, marker,
+                         [&](const uint8_t *data, size_t size) { packets.emplace_back(data, data + size); });
+    return packets;
+}
+
+// Feed packets (minus the skipped ones), taking every frame that completes
+std::vector<Frame> deliver(RTPDepacketizer &depacketizer, const Packets &packets, const std::set<size_t> &skip = {})
+{
+    std::vector<Frame> frames;
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (skip.count(i)) continue;
+        if (!depacketizer.processPacket(packets[i].data(), packets[i].size())) continue;
+        while (depacketizer.isFrameReady()) {
+            Frame frame;
+            frame.timestamp = depacketizer.getFrameTimestamp();
+            depacketizer.takeFrame(frame.data, frame.slices);
+            frames.push_back(std::move(frame));
+        }
+    }
+    return frames;
+}
+
+// The receiver starts collecting after the first marker
+void sync(RTPPacketizer &packetizer, RTPDepacketizer &depacketizer)
+{
+    CHECK(deliver(depacketizer, packetize(packetizer, make_opaque(100, 99), 0)).empty());
+}
+
+std::vector<SliceSpan> slices_of(const std::vector<uint8_t> &cs)
+{
+    CodestreamSlices::Layout layout;
+    std::vector<SliceSpan> slices;
+    CHECK(CodestreamSlices::parseHeader(cs.data(), cs.size(), layout));
+    CHECK(CodestreamSlices::findSlices(cs.data(), cs.size(), layout, slices));
+    return slices;
+}
+
+// Packets of one unit: -1 for the codestream header, else the slice index
+std::vector<size_t> unit_packets(const Packets &packets, int unit)
+{
+    std::vector<size_t> result;
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (fields(packets[i]).unit() == unit) result.push_back(i);
+    }
+    return result;
+}
+
+} // namespace
+
+static void test_slice_mode_round_trip()
+{
+    RTPPacketizer packetizer(200);
+    RTPDepacketizer depacketizer;
+    sync(packetizer, depacketizer);
+
+    for (uint32_t n = 0; n < 6; n++) {
+        CodestreamSpec spec;
+        spec.height = 96 + 16 * n;
+        spec.seed = n + 1;
+        std::vector<uint8_t> cs = make_codestream(spec);
+        Packets packets = packetize(packetizer, cs, 3000 * (n + 1));
+
+        // The header unit, then one per slice, each counting its packets from 0
+        // and flagging its last; only the frame's last packet has the marker
+        int unit = -2;
+        uint16_t next_packet = 0;
+        for (size_t i = 0; i < packets.size(); i++) {
+            PayloadFields f = fields(packets[i]);
+            CHECK(f.t && f.k && f.i == 0);
+            CHECK(f.f == (n + 1) % 32);  // The sync frame was 0
+            CHECK(f.marker == (i + 1 == packets.size()));
+            if (f.unit() != unit) {
+                CHECK(f.unit() == unit + 1 || (unit == -2 && f.unit() == -1));
+                CHECK(i == 0 || fields(packets[i - 1]).l);
+                next_packet = 0;
+                unit = f.unit();
+            } else {
+                CHECK(!fields(packets[i - 1]).l);
+            }
+            CHECK(f.p == next_packet++);
+        }
+        CHECK(fields(packets.back()).l);
+        CHECK(unit + 1 == (int)slice_count(spec));
+
+        std::vector<Frame> frames = deliver(depacketizer, packets);
+        CHECK(frames.size() == 1);
+        CHECK(frames[0].timestamp == 3000 * (n + 1));
+        CHECK(frames[0].data == cs);
+
+        std::vector<SliceSpan> expected = slices_of(cs);
+        CHECK(frames[0].slices.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            CHECK(frames[0].slices[i].index == expected[i].index);
+            CHECK(frames[0].slices[i].offset == expected[i].offset);
+            CHECK(frames[0].slices[i].size == expected[i].size);
+            CHECK(frames[0].slices[i].intact);
+        }
+    }
+    CHECK(depacketizer.getStats().packets_lost == 0);
+    CHECK(depacketizer.getStats().frames_damaged == 0);
+}
+
+static void test_codestream_mode_round_trip()
+{
+    RTPPacketizer packetizer(200);
+    packetizer.setSliceMode(false);
+    RTPDepacketizer depacketizer;
+    sync(packetizer, depacketizer);
+
+    CodestreamSpec spec;
+    std::vector<uint8_t> cs = make_codestream(spec);
+    Packets packets = packetize(packetizer, cs, 1000);
+    CHECK(packets.size() == (cs.size() + 199) / 200);
+    for (size_t i = 0; i < packets.size(); i++) {
+        // One unit, the frame: P counts its packets, L marks the last
+        PayloadFields f = fields(packets[i]);
+        CHECK(f.t && !f.k && f.sep == 0 && f.p == i);
+        CHECK(f.l == (i + 1 == packets.size()) && f.marker == f.l);
+    }
+
+    std::vector<Frame> frames = deliver(depacketizer, packets);
+    CHECK(frames.size() == 1 && frames[0].data == cs && frames[0].slices.empty());
+
+    // Slice mode still sends what it cannot parse as one codestream
+    RTPPacketizer sliced(200);
+    std::vector<uint8_t> opaque = make_opaque(1000, 5);
+    for (const auto &packet : packetize(sliced, opaque, 2000)) {
+        CHECK(!fields(packet).k);
+    }
+}
+
+static void test_slice_loss_damages_one_slice()
+{
+    RTPPacketizer packetizer(100);
+    RTPDepacketizer depacketizer;
+    sync(packetizer, depacketizer);
+
+    CodestreamSpec spec;
+    std::vector<uint8_t> cs = make_codestream(spec);
+    Packets packets = packetize(packetizer, cs, 1000);
+    std::vector<size_t> slice2 = unit_packets(packets, 2);
+    CHECK(slice2.size() >= 3);
+
+    std::vector<Frame> frames = deliver(depacketizer, packets, { slice2[1] });
+    CHECK(frames.size() == 1);
+    const Frame &frame = frames[0];
+    CHECK(frame.data.size() == cs.size() - (packets[slice2[1]].size() - HEADERS));
+
+    std::vector<SliceSpan> expected = slices_of(cs);
+    CHECK(frame.slices.size() == expected.size());
+    for (const SliceSpan &slice : frame.slices) {
+        CHECK(slice.intact == (slice.index != 2));
+        if (!slice.intact) continue;
+        const SliceSpan &original = expected[slice.index];
+        CHECK(slice.size == original.size);
+        CHECK(std::memcmp(frame.data.data() + slice.offset, cs.data() + original.offset, slice.size) == 0);
+    }
+
+    const RTPDepacketizer::Stats &stats = depacketizer.getStats();
+    CHECK(stats.packets_lost == 1);
+    CHECK(stats.frames_damaged == 1 && stats.slices_damaged == 1);
+}
+
+static void test_loss_at_slice_boundary()
+{
+    // Slice 2 arrived whole (its L packet came); slice 3 lost its first packet
+    RTPPacketizer packetizer(100);
+    RTPDepacketizer depacketizer;
+    sync(packetizer, depacketizer);
+
+    CodestreamSpec spec;
+    std::vector<uint8_t> cs = make_codestream(spec);
+    Packets packets = packetize(packetizer, cs, 1000);
+    std::vector<size_t> slice3 = unit_packets(packets, 3);
+    std::vector<Frame> frames = deliver(depacketizer, packets, { slice3[0] });
+    CHECK(frames.size() == 1);
+    for (const SliceSpan &slice : frames[0].slices) {
+        CHECK(slice.intact == (slice.index != 3));
+    }
+
+    // Now the tail of slice 2: the loss is found from the missing L
+    std::vector<uint8_t> next = make_codestream(spec);
+    packets = packetize(packetizer, next, 2000);
+    std::vector<size_t> slice2 = unit_packets(packets, 2);
+    frames = deliver(depacketizer, packets, { slice2.back() });
+    CHECK(frames.size() == 1);
+    for (const SliceSpan &slice : frames[0].slices) {
+        CHECK(slice.intact == (slice.index != 2));
+    }
+}
+
+static void test_counter_limits()
+{
+    // Codestream mode: past 2048 packets the SEP counter extends P
+    RTPPacketizer packetizer(100);
+    packetizer.setSliceMode(false);
+    RTPDepacketizer depacketizer;
+    sync(packetizer, depacketizer);
+
+    std::vector<uint8_t> large = make_opaque(2100 * 100, 4);
+    Packets packets = packetize(packetizer, large, 1000);
+    CHECK(packets.size() == 2100);
+    CHECK(fields(packets[2047]).sep == 0 && fields(packets[2047]).p == 2047);
+    CHECK(fields(packets[2048]).sep == 1 && fields(packets[2048]).p == 0);
+    std::vector<Frame> frames = deliver(depacketizer, packets);
+    CHECK(frames.size() == 1 && frames[0].data == large);
+
+    // More slices than the SEP counter holds: the frame goes out in codestream mode
+    RTPPacketizer sliced(1400);
+    CodestreamSpec spec;
+    spec.height = 16 * 2100;
+    spec.slice_bytes = 10;
+    spec.slice_jitter = 0;
+    std::vector<uint8_t> cs = make_codestream(spec);
+    packets = packetize(sliced, cs, 2000);
+    for (const auto &packet : packets) CHECK(!fields(packet).k);
+
+    // As does a slice with more packets than the P counter holds
+    RTPPacketizer small(16);
+    spec = CodestreamSpec();
+    spec.slice_bytes = 2049 * 16;
+    packets = packetize(small, make_codestream(spec), 3000);
+    CHECK(!fields(packets[0]).k);
+}
+
+static void test_header_loss_drops_frame()
+{
+    RTPPacketizer packetizer(100);
+    RTPDepacketizer depacketizer;
+    sync(packetizer, depacketizer);
+
+    CodestreamSpec spec;
+    std::vector<uint8_t> first = make_codestream(spec);
+    spec.seed = 2;
+    std::vector<uint8_t> second = make_codestream(spec);
+
+    CHECK(deliver(depacketizer, packetize(packetizer, first, 1000), { 0 }).empty());
+    std::vector<Frame> frames = deliver(depacketizer, packetize(packetizer, second, 2000));
+    CHECK(frames.size() == 1 && frames[0].timestamp == 2000 && frames[0].data == second);
+}
+
+static void test_codestream_loss_drops_frame()
+{
+    RTPPacketizer packetizer(200);
+    packetizer.setSliceMode(false);
+    RTPDepacketizer depacketizer;
+    sync(packetizer, depacketizer);
+
+    std::vector<uint8_t> first = make_opaque(2000, 1);
+    std::vector<uint8_t> second = make_opaque(1500, 2);
+    CHECK(deliver(depacketizer, packetize(packetizer, first, 1000), { 4 }).empty());
+    std::vector<Frame> frames = deliver(depacketizer, packetize(packetizer, second, 2000));
+    CHECK(frames.size() == 1 && frames[0].data == second);
+}
+
+static void test_unterminated_frame_then_single_packet_frame()
+{
+    // A sliced frame sent without its marker stays open; the next frame's
+    // only packet both completes it and carries its own marker. Both go out.
+    RTPPacketizer packetizer(200);
+    RTPDepacketizer depacketizer;
+    sync(packetizer, depacketizer);
+
+    CodestreamSpec spec;
+    std::vector<uint8_t> sliced = make_codestream(spec);
+    Packets first = packetize(packetizer, sliced, 1000, false);
+    CHECK(deliver(depacketizer, first).empty());
+
+    packetizer.setSliceMode(false);
+    std::vector<uint8_t> small = make_opaque(50, 3);
+    Packets second = packetize(packetizer, small, 2000);
+    CHECK(second.size() == 1 && fields(second[0]).marker);
+
+    std::vector<Frame> frames = deliver(depacketizer, second);
+    CHECK(frames.size() == 2);
+    CHECK(frames[0].timestamp == 1000);
+    CHECK(frames[0].data == sliced);
+    CHECK(!frames[0].slices.back().intact);  // Without the marker the last slice may be short
+    CHECK(frames[1].timestamp == 2000 && frames[1].data == small && frames[1].slices.empty());
+    CHECK(depacketizer.getStats().frames_assembled == 2);
+}
+
+int main()
+{
+    test_slice_mode_round_trip();
+    test_codestream_mode_round_trip();
+    test_slice_loss_damages_one_slice();
+    test_loss_at_slice_boundary();
+    test_counter_limits();
+    test_header_loss_drops_frame();
+    test_codestream_loss_drops_frame();
+    test_unterminated_frame_then_single_packet_frame();
+    std::printf("rtp_packet: ok\n");
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * SendBudget: a fan-out client slower than the stream loses whole frames,
+ * never late packets; one that keeps up loses nothing
+ */
+
+#include "network/send_budget.h"
+#include "test_common.h"
+
+#include <deque>
+
+using namespace jpegxs;
+
+namespace {
+
+const size_t PACKET_BYTES = 1456;
+const uint64_t STEP_US = 100;
+
+// A client's send buffer: packets queued at once, leaving at the link rate
+struct Client {
+    struct Packet {
+        uint32_t frame;
+        size_t bytes;
+        uint64_t queued_us;
+    };
+
+    double bytes_per_sec;
+    std::deque<Packet> queue;
+    size_t queued_bytes = 0;
+    double credit = 0.0;
+
+    uint32_t frames_admitted = 0;
+    uint64_t bytes_admitted = 0;
+    uint32_t frames_skipped = 0;
+    uint64_t packets_late = 0;
+    double worst_wait_ms = 0.0;
+
+    explicit Client(double mbps) : bytes_per_sec(mbps * 1000000.0 / 8.0) {}
+
+    SendBudget::Backlog backlog(uint64_t now_us) const
+    {
+        SendBudget::Backlog b;
+        b.bytes = queued_bytes;
+        b.span_ms = queue.empty() ? 0.0 : (now_us - queue.front().queued_us) / 1000.0;
+        b.drain_bytes_per_sec = bytes_per_sec;
+        return b;
+    }
+
+    void offer(const SendBudget &budget, uint32_t frame, size_t frame_bytes, uint64_t now_us)
+    {
+        if (!budget.admit(backlog(now_us), frame_bytes)) {
+            frames_skipped++;
+            return;
+        }
+        frames_admitted++;
+        bytes_admitted += frame_bytes;
+        for (size_t left = frame_bytes; left > 0;) {
+            size_t bytes = left < PACKET_BYTES ? left : PACKET_BYTES;
+            queue.push_back({ frame, bytes, now_us });
+            queued_bytes += bytes;
+            left -= bytes;
+        }
+    }
+
+    // Packets that leave after the latency are dropped by TLPKTDROP
+    void drain(uint64_t now_us, int32_t latency_ms)
+    {
+        credit += bytes_per_sec * STEP_US / 1e6;
+        while (!queue.empty() && credit >= queue.front().bytes) {
+            const Packet &packet = queue.front();
+            double wait_ms = (now_us - packet.queued_us) / 1000.0;
+            if (wait_ms > worst_wait_ms) worst_wait_ms = wait_ms;
+            if (wait_ms > latency_ms) packets_late++;
+            credit -= packet.bytes;
+            queued_bytes -= packet.bytes;
+            queue.pop_front();
+        }
+        if (queue.empty()) credit = 0.0;  // An idle link banks nothing
+    }
+};
+
+// 10 s of 60 fps frames averaging frame_bytes, alternately larger and smaller
+void run(Client &client, const SendBudget::Config &config, size_t frame_bytes)
+{
+    SendBudget budget(config);
+    uint64_t next_frame_us = 0;
+    uint32_t frame = 0;
+    for (uint64_t now_us = 0; now_us < 10000000ULL; now_us += STEP_US) {
+        if (now_us >= next_frame_us) {
+            size_t bytes = frame % 2 ? frame_bytes * 5 / 4 : frame_bytes * 3 / 4;
+            client.offer(budget, frame++, bytes, now_us);
+            next_frame_us = frame * 1000000ULL / 60;
+        }
+        client.drain(now_us, config.latency_ms);
+    }
+}
+
+} // namespace
+
+static void test_slow_client_skips_whole_frames()
+{
+    // 480 Mbps of 1 MB frames to a 300 Mbps client
+    SendBudget::Config config;
+    config.latency_ms = 120;
+    Client client(300.0);
+    run(client, config, 1000000);
+
+    // Everything it was sent arrived in time: the losses are all whole frames
+    CHECK(client.packets_late == 0);
+    CHECK(client.worst_wait_ms <= config.latency_ms * config.budget_ratio + 1.0);
+    CHECK(client.frames_skipped > 0);
+
+    // And it still gets close to what its link can carry
+    double delivered_mbps = client.bytes_admitted * 8 / 10.0 / 1e6;
+    std::printf("send_budget: 300 Mbps client took %u of %u frames, %.0f Mbps\n", client.frames_admitted,
+                client.frames_admitted + client.frames_skipped, delivered_mbps);
+    CHECK(delivered_mbps > 300.0 * 0.8 && delivered_mbps < 300.0 * 1.02);  // The last frames still queued
+}
+
+static void test_fast_client_skips_nothing()
+{
+    SendBudget::Config config;
+    config.latency_ms = 120;
+    Client client(1000.0);
+    run(client, config, 1000000);
+    CHECK(client.frames_skipped == 0);
+    CHECK(client.packets_late == 0);
+}
+
+static void test_stalled_client()
+{
+    SendBudget budget(SendBudget::Config{});
+
+    // Link rate not known yet: admitted until what it holds has waited too long
+    SendBudget::Backlog backlog;
+    backlog.bytes = 4000000;
+    backlog.span_ms = 5.0;
+    CHECK(budget.admit(backlog, 1000000));
+    backlog.span_ms = 15.0;
+    CHECK(!budget.admit(backlog, 1000000));
+
+    // A frame that alone outlasts the budget is never sent
+    backlog = SendBudget::Backlog();
+    backlog.drain_bytes_per_sec = 10000000.0;
+    CHECK(SendBudget::drainMs(backlog, 100000) == 10.0);
+    CHECK(budget.admit(backlog, 100000));
+    CHECK(!budget.admit(backlog, 100001));
+}
+
+int main()
+{
+    test_slow_client_skips_whole_frames();
+    test_fast_client_skips_nothing();
+    test_stalled_client();
+    std::printf("send_budget: ok\n");
+    return 0;
+}
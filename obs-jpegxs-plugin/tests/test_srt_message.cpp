@@ -0,0 +1,207 @@
+/*
+ * SRTMessagePacketizer / SRTMessageDepacketizer round trips and losses
+ */
+
+#include "network/srt_message.h"
+#include "test_common.h"
+
+#include <cstring>
+#include <set>
+
+using namespace jpegxs;
+using namespace jpegxs::test;
+
+namespace {
+
+using Messages = std::vector<std::vector<uint8_t>>;
+
+struct Frame {
+    uint32_t timestamp;
+    std::vector<uint8_t> data;
+    std::vector<SliceSpan> slices;
+};
+
+const size_t MESSAGE_SIZE = 1456;
+
+Messages packetize(SRTMessagePacketizer &packetizer, const std::vector<uint8_t> &frame, uint32_t timestamp)
+{
+    Messages messages;
+    packetizer.packetize(frame.data(), frame.size(), timestamp,
+                         [&](const uint8_t *data, size_t size) { messages.emplace_back(data, data + size); });
+    return messages;
+}
+
+std::vector<Frame> deliver(SRTMessageDepacketizer &depacketizer, const Messages &messages,
+                           const std::set<size_t> &skip = {})
+{
+    std::vector<Frame> frames;
+    for (size_t i = 0; i < messages.size(); i++) {
+        if (skip.count(i)) continue;
+        if (depacketizer.processMessage(messages[i].data(), messages[i].size()) && depacketizer.isFrameReady()) {
+            Frame frame;
+            frame.timestamp = depacketizer.getFrameTimestamp();
+            depacketizer.takeFrame(frame.data, frame.slices);
+            frames.push_back(std::move(frame));
+        }
+    }
+    return frames;
+}
+
+std::vector<uint8_t> large_codestream(uint32_t seed)
+{
+    CodestreamSpec spec;
+    spec.height = 1080;
+    spec.slice_bytes = 600;
+    spec.slice_jitter = 2000;
+    spec.seed = seed;
+    return make_codestream(spec);
+}
+
+} // namespace
+
+static void test_round_trip()
+{
+    SRTMessagePacketizer packetizer(MESSAGE_SIZE);
+    SRTMessageDepacketizer depacketizer;
+
+    for (uint32_t n = 0; n < 4; n++) {
+        std::vector<uint8_t> cs = large_codestream(n + 1);
+        Messages messages = packetize(packetizer, cs, 1000 + n);
+
+        // Full messages except the last, which alone carries END
+        for (size_t i = 0; i < messages.size(); i++) {
+            const std::vector<uint8_t> &m = messages[i];
+            CHECK(SRTMessage::isMessage(m.data(), m.size()));
+            CHECK(m[1] == (uint8_t)n);
+            bool last = i + 1 == messages.size();
+            CHECK(((m[0] & SRTMessage::END) != 0) == last);
+            if (!last) CHECK(m.size() == MESSAGE_SIZE);
+        }
+
+        std::vector<Frame> frames = deliver(depacketizer, messages);
+        CHECK(frames.size() == 1);
+        CHECK(frames[0].timestamp == 1000 + n);
+        CHECK(frames[0].data == cs);
+        CHECK(frames[0].slices.size() == 68);
+        for (const SliceSpan &slice : frames[0].slices) {
+            CHECK(slice.intact);
+            CHECK(cs[slice.offset] == 0xFF && cs[slice.offset + 1] == 0x20);
+        }
+    }
+
+    // Sent whole: no slice table
+    std::vector<uint8_t> opaque = make_opaque(10000, 7);
+    std::vector<Frame> frames = deliver(depacketizer, packetize(packetizer, opaque, 2000));
+    CHECK(frames.size() == 1 && frames[0].data == opaque && frames[0].slices.empty());
+
+    // A frame that fits one message
+    std::vector<uint8_t> tiny = make_opaque(100, 8);
+    frames = deliver(depacketizer, packetize(packetizer, tiny, 3000));
+    CHECK(frames.size() == 1 && frames[0].data == tiny);
+
+    const SRTMessageDepacketizer::Stats &stats = depacketizer.getStats();
+    CHECK(stats.gaps == 0 && stats.frames_damaged == 0 && stats.frames_dropped == 0);
+    CHECK(stats.frames_assembled == 6);
+}
+
+static void test_loss_damages_overlapped_slices()
+{
+    SRTMessagePacketizer packetizer(MESSAGE_SIZE);
+    SRTMessageDepacketizer depacketizer;
+
+    std::vector<uint8_t> cs = large_codestream(11);
+    Messages messages = packetize(packetizer, cs, 1000);
+    size_t lost = messages.size() / 2;
+    std::vector<Frame> frames = deliver(depacketizer, messages, { lost });
+    CHECK(frames.size() == 1);
+
+    // Same size (payloads land at their offsets); intact slices match,
+    // and the damage covers the lost byte range and nothing else
+    const Frame &frame = frames[0];
+    CHECK(frame.data.size() == cs.size());
+    const uint8_t *m = messages[lost].data();
+    size_t stream_offset = ((size_t)m[4] << 24) | ((size_t)m[5] << 16) | ((size_t)m[6] << 8) | m[7];
+    size_t prefix = SRTMessage::PREFIX_SIZE + frame.slices.size() * 4;
+    size_t from = stream_offset - prefix;
+    size_t to = from + messages[lost].size() - SRTMessage::HEADER_SIZE;
+
+    uint32_t damaged = 0;
+    for (const SliceSpan &slice : frame.slices) {
+        bool overlaps = slice.offset < to && slice.offset + slice.size > from;
+        CHECK(slice.intact == !overlaps);
+        if (slice.intact) {
+            CHECK(std::memcmp(frame.data.data() + slice.offset, cs.data() + slice.offset, slice.size) == 0);
+        } else {
+            damaged++;
+        }
+    }
+    CHECK(damaged >= 1);
+    CHECK(depacketizer.getStats().frames_damaged == 1);
+    CHECK(depacketizer.getStats().slices_damaged == damaged);
+}
+
+static void test_prefix_loss_drops_frame()
+{
+    SRTMessagePacketizer packetizer(MESSAGE_SIZE);
+    SRTMessageDepacketizer depacketizer;
+
+    std::vector<uint8_t> first = large_codestream(21);
+    std::vector<uint8_t> second = large_codestream(22);
+    CHECK(deliver(depacketizer, packetize(packetizer, first, 1000), { 0 }).empty());
+    std::vector<Frame> frames = deliver(depacketizer, packetize(packetizer, second, 2000));
+    CHECK(frames.size() == 1 && frames[0].timestamp == 2000 && frames[0].data == second);
+    CHECK(depacketizer.getStats().frames_dropped == 1);
+}
+
+static void test_end_loss_completed_by_next_frame()
+{
+    SRTMessagePacketizer packetizer(MESSAGE_SIZE);
+    SRTMessageDepacketizer depacketizer;
+
+    std::vector<uint8_t> first = large_codestream(31);
+    std::vector<uint8_t> second = large_codestream(32);
+    Messages messages = packetize(packetizer, first, 1000);
+    CHECK(deliver(depacketizer, messages, { messages.size() - 1 }).empty());
+
+    // The next frame number closes the first, with its tail slice damaged
+    Messages next = packetize(packetizer, second, 2000);
+    std::vector<Frame> frames = deliver(depacketizer, next);
+    CHECK(frames.size() == 2);
+    CHECK(frames[0].timestamp == 1000 && !frames[0].slices.back().intact);
+    CHECK(frames[1].timestamp == 2000 && frames[1].data == second);
+}
+
+static void test_unsliced_loss_drops_frame()
+{
+    SRTMessagePacketizer packetizer(MESSAGE_SIZE);
+    SRTMessageDepacketizer depacketizer;
+
+    std::vector<uint8_t> opaque = make_opaque(20000, 41);
+    CHECK(deliver(depacketizer, packetize(packetizer, opaque, 1000), { 3 }).empty());
+    CHECK(depacketizer.getStats().frames_dropped == 1);
+}
+
+static void test_framing_told_apart_from_rtp()
+{
+    const uint8_t rtp[24] = { 0x80, 96 };
+    const uint8_t message[24] = { SRTMessage::VERSION_BITS };
+    CHECK(!SRTMessage::isMessage(rtp, sizeof(rtp)));
+    CHECK(SRTMessage::isMessage(message, sizeof(message)));
+    CHECK(!SRTMessage::isMessage(message, SRTMessage::HEADER_SIZE));  // No payload
+
+    SRTMessageDepacketizer depacketizer;
+    CHECK(!depacketizer.processMessage(rtp, sizeof(rtp)));
+    CHECK(depacketizer.getStats().messages_received == 0);
+}
+
+int main()
+{
+    test_round_trip();
+    test_loss_damages_overlapped_slices();
+    test_prefix_loss_drops_frame();
+    test_end_loss_completed_by_next_frame();
+    test_unsliced_loss_drops_frame();
+    test_framing_told_apart_from_rtp();
+    std::printf("srt_message: ok\n");
+    return 0;
+}